@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_OS_AWAITABLE_HPP
+#define REALM_OS_AWAITABLE_HPP
+
+#include "collection_notifications.hpp"
+#include "shared_realm.hpp"
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace realm {
+
+// Awaitable adapters for the callback-based async APIs, shaped after the
+// awaitable interface of the Coroutines TS (await_ready()/await_suspend()/
+// await_resume()) so that a binding's coroutine types can be built directly
+// on the notifier machinery. The object store builds as C++14 and so cannot
+// use coroutine_handle itself; the continuation is instead a plain function
+// pointer plus context, which a coroutine shim's await_suspend() passes a
+// thunk resuming its handle to, and which non-coroutine consumers can use
+// as an unboxed one-shot continuation.
+
+// Awaits the next change notification for a collection (Results or List),
+// including the initial notification delivered after registration. The
+// continuation is invoked on the collection's thread. After await_resume()
+// the awaitable can be awaited again for the following change; if more than
+// one notification is delivered between awaits, only the most recent
+// changeset is kept. Must be used only from the collection's thread, and is
+// registered with the collection's notifier by pointer and so cannot be
+// moved or copied.
+class NextChangeAwaitable {
+public:
+    template<typename Collection>
+    explicit NextChangeAwaitable(Collection& collection)
+    : m_token(collection.add_notification_callback(this))
+    {
+    }
+
+    NextChangeAwaitable(NextChangeAwaitable const&) = delete;
+    NextChangeAwaitable& operator=(NextChangeAwaitable const&) = delete;
+
+    bool await_ready() const noexcept
+    {
+        return m_ready;
+    }
+
+    // Store the continuation to be invoked when the next notification
+    // arrives. Returns false if a notification is already waiting to be
+    // consumed, in which case the consumer should resume immediately
+    // instead of suspending.
+    bool await_suspend(void (*resume)(void*), void* context) noexcept
+    {
+        if (m_ready)
+            return false;
+        m_resume = resume;
+        m_context = context;
+        return true;
+    }
+
+    // The changeset of the notification which completed the await, or
+    // rethrows the error reported by the notifier
+    CollectionChangeSet await_resume()
+    {
+        m_ready = false;
+        if (m_error)
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        return std::move(m_change);
+    }
+
+    // Callback interface invoked by the notifier; not for use by consumers
+    void before(CollectionChangeSet const&) { }
+    void after(CollectionChangeSet const& change)
+    {
+        m_change = change;
+        complete();
+    }
+    void error(std::exception_ptr error)
+    {
+        m_error = error;
+        complete();
+    }
+
+private:
+    void complete()
+    {
+        m_ready = true;
+        if (auto resume = std::exchange(m_resume, nullptr))
+            resume(m_context);
+    }
+
+    CollectionChangeSet m_change;
+    std::exception_ptr m_error;
+    void (*m_resume)(void*) = nullptr;
+    void* m_context = nullptr;
+    bool m_ready = false;
+
+    // Last so that it unregisters the pointer to this object before the
+    // rest of the members are destroyed
+    NotificationToken m_token;
+};
+
+// Awaits Realm::async_begin_transaction(): completes on the background
+// writer thread with a Realm instance confined to that thread which has an
+// active write transaction. The resumed consumer must perform its writes
+// and commit (or roll back) before it next suspends or returns, as the
+// transaction is rolled back when control returns to the background write
+// loop. The completion state is shared with the queued write, so dropping
+// the awaitable before it completes simply discards the transaction.
+class AsyncWriteAwaitable {
+public:
+    explicit AsyncWriteAwaitable(Realm& realm)
+    : m_state(std::make_shared<State>())
+    {
+        auto state = m_state;
+        realm.async_begin_transaction([state](std::shared_ptr<Realm> background_realm) {
+            void (*resume)(void*) = nullptr;
+            void* context = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->realm = std::move(background_realm);
+                state->ready = true;
+                std::swap(resume, state->resume);
+                context = state->context;
+            }
+            if (resume)
+                resume(context);
+        });
+    }
+
+    AsyncWriteAwaitable(AsyncWriteAwaitable const&) = delete;
+    AsyncWriteAwaitable& operator=(AsyncWriteAwaitable const&) = delete;
+
+    bool await_ready() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->ready;
+    }
+
+    // As NextChangeAwaitable::await_suspend(). The continuation is invoked
+    // on the background writer thread.
+    bool await_suspend(void (*resume)(void*), void* context) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->ready)
+            return false;
+        m_state->resume = resume;
+        m_state->context = context;
+        return true;
+    }
+
+    // The background Realm instance whose write transaction is active
+    std::shared_ptr<Realm> await_resume()
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->ready = false;
+        return std::move(m_state->realm);
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::shared_ptr<Realm> realm;
+        void (*resume)(void*) = nullptr;
+        void* context = nullptr;
+        bool ready = false;
+    };
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace realm
+
+#endif // REALM_OS_AWAITABLE_HPP
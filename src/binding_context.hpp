@@ -21,8 +21,10 @@
 
 #include "index_set.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace realm {
@@ -97,6 +99,30 @@ public:
     // desired.
     virtual std::vector<ObserverState> get_observed_rows() { return {}; }
 
+    // Incremental alternative to overriding get_observed_rows(): register and
+    // unregister individual rows as observation begins and ends, and the
+    // observer state for each advance is built from the registered rows
+    // instead of being requested from the binding. Both operations are O(1),
+    // and the registered row indices are kept up to date as rows are moved or
+    // deleted by advances. A binding should use either this or
+    // get_observed_rows(), not both; registered rows take precedence.
+    void add_observed_row(size_t table_ndx, size_t row_ndx, void* info);
+
+    // Unregister a row registered with add_observed_row(). `row_ndx` must be
+    // the row's index as of the current read transaction version.
+    void remove_observed_row(size_t table_ndx, size_t row_ndx, void* info);
+
+    // Get the observer state for the rows registered with add_observed_row(),
+    // falling back to get_observed_rows() if no rows are registered. Called by
+    // the object store before each advance; not for use by bindings.
+    std::vector<ObserverState> observed_rows();
+
+    // Replace the registered rows with the post-advance state of `observers`,
+    // dropping any rows which were invalidated. Called by the object store
+    // after computing the changes for an advance; not for use by bindings.
+    void update_observed_rows(std::vector<ObserverState> const& observers,
+                              std::vector<void*> const& invalidated);
+
     // Called immediately before the read transaction is advanced if detailed
     // change information was requested (by returning a non-empty array from
     // get_observed_rows()).
@@ -160,10 +186,64 @@ public:
             return std::tie(lft.table_ndx, lft.row_ndx) < std::tie(rgt.table_ndx, rgt.row_ndx);
         }
     };
+
+private:
+    // Rows registered with add_observed_row(), grouped by table so that an
+    // advance can find a table's observers without scanning the rest. Each row
+    // may have more than one observer registered on it.
+    std::unordered_map<size_t, std::unordered_map<size_t, std::vector<void*>>> m_observed_rows;
 };
 
 inline void BindingContext::will_change(std::vector<ObserverState> const&, std::vector<void*> const&) { }
 inline void BindingContext::did_change(std::vector<ObserverState> const&, std::vector<void*> const&, bool) { }
+
+inline void BindingContext::add_observed_row(size_t table_ndx, size_t row_ndx, void* info)
+{
+    m_observed_rows[table_ndx][row_ndx].push_back(info);
+}
+
+inline void BindingContext::remove_observed_row(size_t table_ndx, size_t row_ndx, void* info)
+{
+    auto table = m_observed_rows.find(table_ndx);
+    if (table == m_observed_rows.end())
+        return;
+    auto row = table->second.find(row_ndx);
+    if (row == table->second.end())
+        return;
+    auto& infos = row->second;
+    infos.erase(std::remove(begin(infos), end(infos), info), end(infos));
+    if (infos.empty()) {
+        table->second.erase(row);
+        if (table->second.empty())
+            m_observed_rows.erase(table);
+    }
+}
+
+inline std::vector<BindingContext::ObserverState> BindingContext::observed_rows()
+{
+    if (m_observed_rows.empty())
+        return get_observed_rows();
+    std::vector<ObserverState> observers;
+    for (auto& table : m_observed_rows) {
+        for (auto& row : table.second) {
+            for (auto info : row.second)
+                observers.push_back({table.first, row.first, info, {}});
+        }
+    }
+    return observers;
+}
+
+inline void BindingContext::update_observed_rows(std::vector<ObserverState> const& observers,
+                                                 std::vector<void*> const& invalidated)
+{
+    if (m_observed_rows.empty())
+        return;
+    m_observed_rows.clear();
+    for (auto& observer : observers) {
+        if (std::find(begin(invalidated), end(invalidated), observer.info) == end(invalidated))
+            m_observed_rows[observer.table_ndx][observer.row_ndx].push_back(observer.info);
+    }
+}
 } // namespace realm
 
 #endif /* BINDING_CONTEXT_HPP */
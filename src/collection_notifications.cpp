@@ -59,3 +59,10 @@ void NotificationToken::suppress_next()
 {
     m_notifier.load()->suppress_next_notification(m_token);
 }
+
+void NotificationToken::set_priority(NotifierPriority priority)
+{
+    if (auto notifier = m_notifier.load()) {
+        notifier->set_priority(priority);
+    }
+}
@@ -32,6 +32,12 @@ namespace _impl {
     class CollectionNotifier;
 }
 
+// The scheduling priority classes for the background work done to compute
+// change notifications. The worker thread computes and publishes the
+// changesets for all higher-priority notifiers before running any
+// lower-priority ones.
+enum class NotifierPriority : uint8_t { High, Normal, Low };
+
 // A token which keeps an asynchronous query alive
 struct NotificationToken {
     NotificationToken() = default;
@@ -46,6 +52,11 @@ struct NotificationToken {
 
     void suppress_next();
 
+    // Set the scheduling priority of the underlying notifier. This applies to
+    // the notifier as a whole and not just this token's callback, so the
+    // highest priority requested wins if it's set on multiple tokens.
+    void set_priority(NotifierPriority priority);
+
 private:
     util::AtomicSharedPtr<_impl::CollectionNotifier> m_notifier;
     size_t m_token;
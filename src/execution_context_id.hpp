@@ -26,6 +26,7 @@
 #include <type_traits>
 #endif
 
+#include <cstdint>
 #include <cstring>
 #include <thread>
 
@@ -80,7 +81,10 @@ public:
 
     bool operator==(const AnyExecutionContextID& other) const
     {
-        return m_type == other.m_type && std::memcmp(&m_storage, &other.m_storage, sizeof(m_storage)) == 0;
+        // m_packed losslessly encodes the stored value, so no comparison of
+        // the storage itself is needed. This runs on every
+        // Realm::verify_thread() call, i.e. on every accessor operation.
+        return m_packed == other.m_packed && m_type == other.m_type;
     }
 
     bool operator!=(const AnyExecutionContextID& other) const
@@ -92,10 +96,18 @@ private:
     template <typename T>
     AnyExecutionContextID(Type type, T value) : m_type(type)
     {
-        // operator== relies on being able to compare the raw bytes of m_storage,
-        // so zero everything before intializing the portion in use.
+        // m_packed is built from the raw bytes of m_storage, so zero
+        // everything before intializing the portion in use.
         std::memset(&m_storage, 0, sizeof(m_storage));
         new (&m_storage) T(std::move(value));
+
+        // Capture the identity as a single integer so that equality is an
+        // integer compare rather than a memcmp of the storage. Both of the
+        // representable types fit in 64 bits, making the encoding lossless.
+        static_assert(sizeof(T) <= sizeof(m_packed),
+                      "Execution context identifiers must fit in 64 bits");
+        std::memcpy(&m_packed, &m_storage,
+                    sizeof(m_storage) < sizeof(m_packed) ? sizeof(m_storage) : sizeof(m_packed));
     }
 
     template <typename> struct TypeForStorageType;
@@ -105,6 +117,7 @@ private:
 #else
     std::aligned_union<1, std::thread::id, AbstractExecutionContextID>::type m_storage;
 #endif
+    std::uint64_t m_packed = 0;
     Type m_type;
 };
 
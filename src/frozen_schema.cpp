@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "frozen_schema.hpp"
+
+#include "object_schema.hpp"
+#include "schema.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace realm;
+
+namespace {
+// Assigns each distinct string an offset in the arena, with all occurrences
+// of a string sharing one copy
+class StringInterner {
+public:
+    void add(std::string const& str)
+    {
+        auto it = m_offsets.emplace(str, m_size);
+        if (it.second)
+            m_size += str.size();
+    }
+
+    std::unique_ptr<char[]> pack()
+    {
+        auto strings = std::make_unique<char[]>(m_size);
+        for (auto& entry : m_offsets)
+            memcpy(strings.get() + entry.second, entry.first.data(), entry.first.size());
+        return strings;
+    }
+
+    StringData get(char const* strings, std::string const& str) const noexcept
+    {
+        return StringData(strings + m_offsets.find(str)->second, str.size());
+    }
+
+private:
+    std::unordered_map<std::string, size_t> m_offsets;
+    size_t m_size = 0;
+};
+} // anonymous namespace
+
+FrozenSchema::FrozenSchema(Schema const& schema)
+{
+    StringInterner interner;
+    size_t property_count = 0;
+    for (auto& object : schema) {
+        interner.add(object.name);
+        interner.add(object.primary_key);
+        property_count += object.persisted_properties.size() + object.computed_properties.size();
+        for (auto properties : {&object.persisted_properties, &object.computed_properties}) {
+            for (auto& property : *properties) {
+                interner.add(property.name);
+                interner.add(property.object_type);
+                interner.add(property.link_origin_property_name);
+            }
+        }
+    }
+
+    m_strings = interner.pack();
+    m_properties.reserve(property_count);
+    m_objects.reserve(schema.size());
+
+    auto intern = [&](std::string const& str) { return interner.get(m_strings.get(), str); };
+    for (auto& object : schema) {
+        m_objects.push_back({intern(object.name), intern(object.primary_key),
+                             m_properties.size(), object.persisted_properties.size(),
+                             object.persisted_properties.size() + object.computed_properties.size()});
+        for (auto properties : {&object.persisted_properties, &object.computed_properties}) {
+            for (auto& property : *properties) {
+                m_properties.push_back({intern(property.name), intern(property.object_type),
+                                        intern(property.link_origin_property_name),
+                                        property.type, property.is_primary, property.is_indexed,
+                                        property.is_nullable, property.table_column});
+            }
+        }
+    }
+}
+
+FrozenSchema::ObjectType const* FrozenSchema::find(StringData name) const noexcept
+{
+    auto it = std::lower_bound(begin(), end(), name, [](ObjectType const& lft, StringData rgt) {
+        return lft.name < rgt;
+    });
+    if (it == end() || it->name != name)
+        return nullptr;
+    return it;
+}
+
+FrozenSchema::Property const*
+FrozenSchema::property_for_name(ObjectType const& object, StringData name) const noexcept
+{
+    auto props_begin = properties_begin(object), props_end = properties_end(object);
+    auto it = std::find_if(props_begin, props_end,
+                           [&](Property const& property) { return property.name == name; });
+    return it == props_end ? nullptr : it;
+}
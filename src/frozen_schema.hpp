@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_FROZEN_SCHEMA_HPP
+#define REALM_FROZEN_SCHEMA_HPP
+
+#include "property.hpp"
+
+#include <realm/string_data.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace realm {
+class Schema;
+
+// An immutable, cache-friendly snapshot of a Schema.
+//
+// The mutable representation stores each property's strings in separate
+// heap-allocated std::strings, so iterating the properties of an object type
+// (as accessor code does for every object read or written) chases a pointer
+// per string. The frozen form packs every string into a single contiguous
+// arena with duplicates interned, and stores the properties of all object
+// types in one flat array, so a type's properties and their names occupy
+// consecutive memory.
+//
+// A FrozenSchema is built by Schema::frozen() (eagerly by Schema::validate())
+// and is immutable afterwards; schema editing continues to operate on the
+// mutable form and produces a new frozen snapshot. The table column indices
+// are the ones the source Schema had when the snapshot was taken.
+class FrozenSchema {
+public:
+    struct Property {
+        StringData name;
+        StringData object_type;
+        StringData link_origin_property_name;
+        PropertyType type;
+        bool is_primary;
+        bool is_indexed;
+        bool is_nullable;
+        size_t table_column;
+    };
+
+    struct ObjectType {
+        StringData name;
+        StringData primary_key;
+
+        // Position of this type's properties in the flat property array,
+        // with the persisted properties followed by the computed ones
+        size_t first_property;
+        size_t persisted_property_count;
+        size_t property_count;
+    };
+
+    explicit FrozenSchema(Schema const& schema);
+
+    // The object types, sorted by name as in the source Schema
+    ObjectType const* begin() const noexcept { return m_objects.data(); }
+    ObjectType const* end() const noexcept { return m_objects.data() + m_objects.size(); }
+    size_t size() const noexcept { return m_objects.size(); }
+
+    // Find an object type by name, or null if there is none
+    ObjectType const* find(StringData name) const noexcept;
+
+    // The properties of the given object type; persisted properties first,
+    // then computed ones
+    Property const* properties_begin(ObjectType const& object) const noexcept
+    {
+        return m_properties.data() + object.first_property;
+    }
+    Property const* properties_end(ObjectType const& object) const noexcept
+    {
+        return m_properties.data() + object.first_property + object.property_count;
+    }
+
+    // Find a property of the given object type by name, or null if there is
+    // none. Persisted properties take precedence over computed ones with the
+    // same name, as with ObjectSchema::property_for_name().
+    Property const* property_for_name(ObjectType const& object, StringData name) const noexcept;
+
+private:
+    // All strings referenced by the object types and properties, interned
+    // and packed end-to-end
+    std::unique_ptr<char[]> m_strings;
+    std::vector<Property> m_properties;
+    std::vector<ObjectType> m_objects;
+};
+}
+
+#endif /* REALM_FROZEN_SCHEMA_HPP */
@@ -22,9 +22,11 @@
 
 #include <asl.h>
 #include <assert.h>
+#include <chrono>
 #include <fcntl.h>
 #include <sstream>
 #include <sys/event.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <system_error>
@@ -130,6 +132,18 @@ ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
         throw std::system_error(errno, std::system_category());
     }
 
+    // Map a small shared-memory block next to the fifo which carries the
+    // timestamp of the most recent commit when commit latency stats are
+    // enabled. If setting it up fails the stats are simply unavailable.
+    std::string latency_path = path + ".lat";
+    m_latency_fd = open(latency_path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (m_latency_fd != -1 && ftruncate(m_latency_fd, sizeof(std::atomic<int64_t>)) == 0) {
+        void* addr = mmap(nullptr, sizeof(std::atomic<int64_t>), PROT_READ | PROT_WRITE, MAP_SHARED, m_latency_fd, 0);
+        if (addr != MAP_FAILED) {
+            m_commit_time = static_cast<std::atomic<int64_t>*>(addr);
+        }
+    }
+
 #else // !TARGET_OS_TV
 
     // tvOS does not support named pipes, so use an anonymous pipe instead
@@ -178,6 +192,10 @@ ExternalCommitHelper::~ExternalCommitHelper()
 {
     notify_fd(m_shutdown_write_fd, m_shutdown_read_fd);
     m_thread.wait(); // Wait for the thread to exit
+
+    if (m_commit_time) {
+        munmap(m_commit_time, sizeof(std::atomic<int64_t>));
+    }
 }
 
 void ExternalCommitHelper::listen()
@@ -214,12 +232,26 @@ void ExternalCommitHelper::listen()
         }
         assert(event.ident == (uint32_t)m_notify_fd);
 
+        // Consume the commit timestamp, if the committing process wrote one,
+        // and report the time from that commit to this dispatch
+        if (m_commit_time) {
+            if (int64_t ns = m_commit_time->exchange(0, std::memory_order_acq_rel)) {
+                auto latency = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::nanoseconds(ns);
+                m_parent.record_commit_notification_latency(latency);
+            }
+        }
+
         m_parent.on_change();
     }
 }
 
 void ExternalCommitHelper::notify_others()
 {
+    if (m_commit_time && RealmCoordinator::commit_latency_stats_enabled()) {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+        m_commit_time->store(ns, std::memory_order_release);
+    }
     if (m_notify_fd_write != -1) {
         notify_fd(m_notify_fd_write, m_notify_fd);
     }
@@ -16,6 +16,8 @@
 //
 ////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
+#include <cstdint>
 #include <future>
 
 namespace realm {
@@ -75,6 +77,14 @@ private:
     // it should be shut down.
     FdHolder m_shutdown_read_fd;
     FdHolder m_shutdown_write_fd;
+
+    // The steady-clock time of the most recent commit in nanoseconds, mapped
+    // shared with the other processes which have the Realm open, or null if
+    // mapping it failed (or on tvOS, where notifications never cross
+    // processes). Only written when commit latency stats are enabled (see
+    // RealmCoordinator::set_commit_latency_stats_enabled()).
+    FdHolder m_latency_fd;
+    std::atomic<int64_t>* m_commit_time = nullptr;
 };
 } // namespace _impl
 } // namespace realm
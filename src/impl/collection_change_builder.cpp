@@ -50,6 +50,9 @@ void CollectionChangeBuilder::merge(CollectionChangeBuilder&& c)
     verify();
     c.verify();
 
+    flush_pending_column_modifications();
+    c.flush_pending_column_modifications();
+
     auto for_each_col = [&](auto&& f) {
         f(modifications, c.modifications);
         if (m_track_columns) {
@@ -155,6 +158,10 @@ void CollectionChangeBuilder::clean_up_stale_moves()
 
 void CollectionChangeBuilder::parse_complete()
 {
+    // This is the last point before the per-table change info is read by
+    // notifiers, so ensure `columns` is fully materialized
+    flush_pending_column_modifications();
+
     moves.reserve(m_move_mapping.size());
     for (auto move : m_move_mapping) {
         REALM_ASSERT_DEBUG(deletions.contains(move.second));
@@ -177,16 +184,53 @@ void CollectionChangeBuilder::modify(size_t ndx, size_t col)
     if (!m_track_columns || col == IndexSet::npos)
         return;
 
+    if (col < 64) {
+        m_pending_column_masks[ndx] |= uint64_t(1) << col;
+        return;
+    }
+
     if (col >= columns.size())
         columns.resize(col + 1);
     columns[col].add(ndx);
 }
 
+void CollectionChangeBuilder::flush_pending_column_modifications()
+{
+    if (m_pending_column_masks.empty())
+        return;
+
+    std::vector<std::pair<size_t, uint64_t>> pending(begin(m_pending_column_masks),
+                                                     end(m_pending_column_masks));
+    std::sort(begin(pending), end(pending));
+    m_pending_column_masks.clear();
+
+    uint64_t all_columns = 0;
+    for (auto& row : pending)
+        all_columns |= row.second;
+
+    // Expand the masks one column at a time so that each column's rows form
+    // a sorted batch
+    std::vector<size_t> rows;
+    for (size_t col = 0; all_columns; ++col, all_columns >>= 1) {
+        if (!(all_columns & 1))
+            continue;
+        rows.clear();
+        for (auto& row : pending) {
+            if (row.second & (uint64_t(1) << col))
+                rows.push_back(row.first);
+        }
+        if (col >= columns.size())
+            columns.resize(col + 1);
+        columns[col].add_sorted(rows);
+    }
+}
+
 template<typename Func>
 void CollectionChangeBuilder::for_each_col(Func&& f)
 {
     f(modifications);
     if (m_track_columns) {
+        flush_pending_column_modifications();
         for (auto& col : columns)
             f(col);
     }
@@ -224,6 +268,22 @@ void CollectionChangeBuilder::insert(size_t index, size_t count, bool track_move
         m_move_mapping.insert(pair);
 }
 
+void CollectionChangeBuilder::append(size_t index, size_t count, bool track_moves)
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT_DEBUG(modifications.empty() || std::prev(modifications.end())->second <= index);
+    REALM_ASSERT_DEBUG(insertions.empty() || std::prev(insertions.end())->second <= index);
+    for (auto const& move : moves)
+        REALM_ASSERT_DEBUG(move.to < index);
+#endif
+
+    // As nothing is tracked at or above the append point there is nothing to
+    // shift: the modifications, pending column masks and moves are all
+    // unaffected, and the insertion itself is just a trailing range
+    if (track_moves)
+        insertions.insert_at(index, count);
+}
+
 void CollectionChangeBuilder::erase(size_t index)
 {
     for_each_col([=](auto& col) { col.erase_at(index); });
@@ -245,10 +305,12 @@ void CollectionChangeBuilder::erase(size_t index)
 void CollectionChangeBuilder::clear(size_t old_size)
 {
     if (old_size != std::numeric_limits<size_t>::max()) {
-        for (auto range : deletions)
+        deletions.for_each_range([&](auto range) {
             old_size += range.second - range.first;
-        for (auto range : insertions)
+        });
+        insertions.for_each_range([&](auto range) {
             old_size -= range.second - range.first;
+        });
     }
 
     modifications.clear();
@@ -256,6 +318,7 @@ void CollectionChangeBuilder::clear(size_t old_size)
     moves.clear();
     m_move_mapping.clear();
     columns.clear();
+    m_pending_column_masks.clear();
     deletions.set(old_size);
 }
 
@@ -486,12 +549,16 @@ void CollectionChangeBuilder::verify()
 
 void CollectionChangeBuilder::insert_column(size_t ndx)
 {
+    // The pending masks are keyed on column index, so they need to be
+    // expanded before the columns are renumbered
+    flush_pending_column_modifications();
     if (ndx < columns.size())
         columns.insert(columns.begin() + ndx, IndexSet{});
 }
 
 void CollectionChangeBuilder::move_column(size_t from, size_t to)
 {
+    flush_pending_column_modifications();
     if (from >= columns.size() && to >= columns.size())
         return;
     if (from >= columns.size() || to >= columns.size())
@@ -700,6 +767,66 @@ private:
     }
 };
 
+// Size of change at which the LIS-based move calculation is preferred over
+// the LCS-based one. The LIS path is asymptotically better but loses the
+// LCS path's preference for keeping unmodified blocks in place, which only
+// matters for diffs small enough for a human to follow anyway
+const size_t lis_size_threshold = 256;
+
+// Compute the minimal move set for a reshuffled set of unique rows: the rows
+// forming the longest increasing subsequence of old positions have kept
+// their relative order, and every other row is removed from its old position
+// and inserted at its new one. Runs in O(n log n) via patience sorting,
+// unlike the LCS algorithm below whose recursion can go quadratic when a
+// re-sort reshuffles a large prefix, but requires the row indices to be
+// unique so it can't be used for LinkList-backed views.
+void calculate_moves_lis(std::vector<RowInfo> const& rows,
+                         std::vector<LongestCommonSubsequenceCalculator::Row> const& a,
+                         CollectionChangeSet& changeset)
+{
+    std::unordered_map<size_t, size_t> old_position;
+    old_position.reserve(a.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        old_position[a[i].row_index] = i;
+
+    // The old position of each row, in new table-view order
+    std::vector<size_t> perm(rows.size());
+    for (size_t j = 0; j < rows.size(); ++j)
+        perm[j] = old_position[rows[j].row_index];
+
+    // `pile_tops[k]` is the position with the smallest old position which
+    // ends an increasing subsequence of length k + 1
+    std::vector<size_t> pile_tops;
+    std::vector<size_t> predecessor(perm.size(), IndexSet::npos);
+    for (size_t j = 0; j < perm.size(); ++j) {
+        auto it = std::lower_bound(begin(pile_tops), end(pile_tops), perm[j],
+                                   [&](size_t lft, size_t value) { return perm[lft] < value; });
+        if (it != begin(pile_tops))
+            predecessor[j] = *std::prev(it);
+        if (it == end(pile_tops))
+            pile_tops.push_back(j);
+        else
+            *it = j;
+    }
+
+    std::vector<bool> kept(perm.size(), false);
+    for (size_t j = pile_tops.back(); j != IndexSet::npos; j = predecessor[j])
+        kept[j] = true;
+
+    // The new positions are visited in ascending order, but the old ones are
+    // not, so buffer and sort them before adding to the index set
+    std::vector<size_t> deleted_tv_indices;
+    for (size_t j = 0; j < perm.size(); ++j) {
+        if (kept[j])
+            continue;
+        deleted_tv_indices.push_back(a[perm[j]].tv_index);
+        changeset.insertions.add(rows[j].tv_index);
+    }
+    std::sort(begin(deleted_tv_indices), end(deleted_tv_indices));
+    for (auto tv_index : deleted_tv_indices)
+        changeset.deletions.add(tv_index);
+}
+
 void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& changeset)
 {
     // The RowInfo array contains information about the old and new TV indices of
@@ -735,6 +862,16 @@ void calculate_moves_sorted(std::vector<RowInfo>& rows, CollectionChangeSet& cha
         return std::tie(lft.row_index, lft.tv_index) < std::tie(rgt.row_index, rgt.tv_index);
     });
 
+    // For large changes use the LIS-based calculation if the rows are unique
+    // (`b` is sorted by row index, so duplicates are adjacent)
+    if (rows.size() - first_difference >= lis_size_threshold) {
+        bool has_duplicates = false;
+        for (size_t i = 1; i < b.size() && !has_duplicates; ++i)
+            has_duplicates = b[i].row_index == b[i - 1].row_index;
+        if (!has_duplicates)
+            return calculate_moves_lis(rows, a, changeset);
+    }
+
     // Calculate the LCS of the two sequences
     auto matches = LongestCommonSubsequenceCalculator(a, b, first_difference,
                                                       changeset.modifications).m_longest_matches;
@@ -763,69 +900,116 @@ CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<size_t> c
     CollectionChangeBuilder ret;
 
     size_t deleted = 0;
-    std::vector<RowInfo> old_rows;
-    old_rows.reserve(prev_rows.size());
-    for (size_t i = 0; i < prev_rows.size(); ++i) {
-        if (prev_rows[i] == IndexSet::npos) {
-            ++deleted;
-            ret.deletions.add(i);
-        }
-        else
-            old_rows.push_back({prev_rows[i], IndexSet::npos, i, i - deleted});
-    }
-    std::sort(begin(old_rows), end(old_rows), [](auto& lft, auto& rgt) {
-        return lft.row_index < rgt.row_index;
-    });
-
     std::vector<RowInfo> new_rows;
     new_rows.reserve(next_rows.size());
-    for (size_t i = 0; i < next_rows.size(); ++i) {
-        new_rows.push_back({next_rows[i], IndexSet::npos, i, 0});
-    }
-    std::sort(begin(new_rows), end(new_rows), [](auto& lft, auto& rgt) {
-        return lft.row_index < rgt.row_index;
-    });
 
     // Don't add rows which were modified to not match the query to `deletions`
     // immediately because the unsorted move logic needs to be able to
     // distinguish them from rows which were outright deleted
     IndexSet removed;
 
-    // Now that our old and new sets of rows are sorted by row index, we can
-    // iterate over them and either record old+new TV indices for rows present
-    // in both, or mark them as inserted/deleted if they appear only in one
-    size_t i = 0, j = 0;
-    while (i < old_rows.size() && j < new_rows.size()) {
-        auto old_index = old_rows[i];
-        auto new_index = new_rows[j];
-        if (old_index.row_index == new_index.row_index) {
-            new_rows[j].prev_tv_index = old_rows[i].tv_index;
-            new_rows[j].shifted_tv_index = old_rows[i].shifted_tv_index;
-            ++i;
-            ++j;
-        }
-        else if (old_index.row_index < new_index.row_index) {
-            removed.add(old_index.tv_index);
-            ++i;
+    if (move_candidates) {
+        // When we have move candidates the rows are in table order and so are
+        // unique and sorted, which lets us match the old rows to the new ones
+        // with a single hash lookup per row rather than sorting both arrays
+        // by row index and merging them, and leaves `new_rows` already in TV
+        // order for the move calculation below
+        std::unordered_map<size_t, std::pair<size_t, size_t>> old_row_positions;
+        old_row_positions.reserve(prev_rows.size());
+        std::vector<size_t> deleted_indices;
+        for (size_t i = 0; i < prev_rows.size(); ++i) {
+            if (prev_rows[i] == IndexSet::npos) {
+                ++deleted;
+                deleted_indices.push_back(i);
+            }
+            else
+                old_row_positions.emplace(prev_rows[i], std::make_pair(i, i - deleted));
         }
-        else {
-            ret.insertions.add(new_index.tv_index);
-            ++j;
+        ret.deletions.add_sorted(deleted_indices);
+
+        std::vector<size_t> inserted_indices;
+        for (size_t i = 0; i < next_rows.size(); ++i) {
+            auto it = old_row_positions.find(next_rows[i]);
+            if (it == old_row_positions.end()) {
+                inserted_indices.push_back(i);
+                continue;
+            }
+            new_rows.push_back({next_rows[i], it->second.first, i, it->second.second});
+            old_row_positions.erase(it);
         }
+        ret.insertions.add_sorted(inserted_indices);
+
+        // Everything which wasn't matched up no longer matches the query. The
+        // leftover map entries are unordered, but there's typically far fewer
+        // of them than total rows, so sorting just them is cheaper than the
+        // full sorts being avoided
+        std::vector<size_t> removed_tv_indices;
+        removed_tv_indices.reserve(old_row_positions.size());
+        for (auto& row : old_row_positions)
+            removed_tv_indices.push_back(row.second.first);
+        std::sort(begin(removed_tv_indices), end(removed_tv_indices));
+        removed.add_sorted(removed_tv_indices);
     }
+    else {
+        std::vector<RowInfo> old_rows;
+        old_rows.reserve(prev_rows.size());
+        std::vector<size_t> deleted_indices;
+        for (size_t i = 0; i < prev_rows.size(); ++i) {
+            if (prev_rows[i] == IndexSet::npos) {
+                ++deleted;
+                deleted_indices.push_back(i);
+            }
+            else
+                old_rows.push_back({prev_rows[i], IndexSet::npos, i, i - deleted});
+        }
+        ret.deletions.add_sorted(deleted_indices);
+        std::sort(begin(old_rows), end(old_rows), [](auto& lft, auto& rgt) {
+            return lft.row_index < rgt.row_index;
+        });
 
-    for (; i < old_rows.size(); ++i)
-        removed.add(old_rows[i].tv_index);
-    for (; j < new_rows.size(); ++j)
-        ret.insertions.add(new_rows[j].tv_index);
+        for (size_t i = 0; i < next_rows.size(); ++i) {
+            new_rows.push_back({next_rows[i], IndexSet::npos, i, 0});
+        }
+        std::sort(begin(new_rows), end(new_rows), [](auto& lft, auto& rgt) {
+            return lft.row_index < rgt.row_index;
+        });
 
-    // Filter out the new insertions since we don't need them for any of the
-    // further calculations
-    new_rows.erase(std::remove_if(begin(new_rows), end(new_rows),
-                                  [](auto& row) { return row.prev_tv_index == IndexSet::npos; }),
-                   end(new_rows));
-    std::sort(begin(new_rows), end(new_rows),
-              [](auto& lft, auto& rgt) { return lft.tv_index < rgt.tv_index; });
+        // Now that our old and new sets of rows are sorted by row index, we can
+        // iterate over them and either record old+new TV indices for rows present
+        // in both, or mark them as inserted/deleted if they appear only in one
+        size_t i = 0, j = 0;
+        while (i < old_rows.size() && j < new_rows.size()) {
+            auto old_index = old_rows[i];
+            auto new_index = new_rows[j];
+            if (old_index.row_index == new_index.row_index) {
+                new_rows[j].prev_tv_index = old_rows[i].tv_index;
+                new_rows[j].shifted_tv_index = old_rows[i].shifted_tv_index;
+                ++i;
+                ++j;
+            }
+            else if (old_index.row_index < new_index.row_index) {
+                removed.add(old_index.tv_index);
+                ++i;
+            }
+            else {
+                ret.insertions.add(new_index.tv_index);
+                ++j;
+            }
+        }
+
+        for (; i < old_rows.size(); ++i)
+            removed.add(old_rows[i].tv_index);
+        for (; j < new_rows.size(); ++j)
+            ret.insertions.add(new_rows[j].tv_index);
+
+        // Filter out the new insertions since we don't need them for any of the
+        // further calculations
+        new_rows.erase(std::remove_if(begin(new_rows), end(new_rows),
+                                      [](auto& row) { return row.prev_tv_index == IndexSet::npos; }),
+                       end(new_rows));
+        std::sort(begin(new_rows), end(new_rows),
+                  [](auto& lft, auto& rgt) { return lft.tv_index < rgt.tv_index; });
+    }
 
     for (auto& row : new_rows) {
         if (row_did_change(row.row_index)) {
@@ -864,6 +1048,8 @@ CollectionChangeBuilder CollectionChangeBuilder::calculate(std::vector<size_t> c
 
 CollectionChangeSet CollectionChangeBuilder::finalize() &&
 {
+    flush_pending_column_modifications();
+
     // Calculate which indices in the old collection were modified
     auto modifications_in_old = modifications;
     modifications_in_old.erase_at(insertions);
@@ -23,6 +23,7 @@
 
 #include <realm/util/optional.hpp>
 
+#include <cstdint>
 #include <unordered_map>
 
 namespace realm {
@@ -54,6 +55,10 @@ public:
     void merge(CollectionChangeBuilder&&);
 
     void insert(size_t ndx, size_t count=1, bool track_moves=true);
+    // insert() specialized for insertions at the end of the collection,
+    // where none of the shifting of previously-tracked indices can apply.
+    // precondition: `ndx` must be greater than every tracked index
+    void append(size_t ndx, size_t count=1, bool track_moves=true);
     void modify(size_t ndx, size_t col=-1);
     void erase(size_t ndx);
     void clear(size_t old_size);
@@ -79,10 +84,20 @@ public:
 
 private:
     std::unordered_map<size_t, size_t> m_move_mapping;
+
+    // Staging area for per-column modification info. modify() ORs a bit into
+    // the row's mask rather than updating one IndexSet per touched column,
+    // and the masks are only expanded into the per-column IndexSets in
+    // `columns` when an operation needs to read or transform them, so an
+    // update to a wide row costs a single IndexSet insertion and some
+    // 64-bit ORs. Columns past 63 take the direct path.
+    std::unordered_map<size_t, uint64_t> m_pending_column_masks;
+
     bool m_track_columns = true;
 
     template<typename Func>
     void for_each_col(Func&& f);
+    void flush_pending_column_modifications();
 
     void verify();
 };
@@ -20,10 +20,15 @@
 
 #include "impl/realm_coordinator.hpp"
 #include "shared_realm.hpp"
+#include "util/tracing.hpp"
 
 #include <realm/group_shared.hpp>
 #include <realm/link_view.hpp>
 
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
 using namespace realm;
 using namespace realm::_impl;
 
@@ -34,15 +39,55 @@ CollectionNotifier::get_modification_checker(TransactionChangeInfo const& info,
     // First check if any of the tables accessible from the root table were
     // actually modified. This can be false if there were only insertions, or
     // deletions which were not linked to by any row in the linking table
-    auto table_modified = [&](auto& tbl) {
-        return tbl.table_ndx < info.tables.size()
-            && !info.tables[tbl.table_ndx].modifications.empty();
-    };
-    if (!any_of(begin(m_related_tables), end(m_related_tables), table_modified)) {
+    if (!any_related_table_modified(info)) {
         return [](size_t) { return false; };
     }
 
-    return DeepChangeChecker(info, root_table, m_related_tables);
+    // If the root table has no outgoing links (or deep change info is
+    // disabled) rows can only be modified directly, making the link-graph
+    // traversal unnecessary
+    if (m_related_tables.size() == 1 && m_related_tables[0].links.empty()) {
+        auto& changes = info.tables[m_related_tables[0].table_ndx];
+        // When every callback observes an explicit set of columns, a row only
+        // counts as modified if one of those columns actually changed
+        if (m_filtered_columns) {
+            auto& columns = changes.columns;
+            auto& filtered = *m_filtered_columns;
+            return [&columns, &filtered](size_t ndx) {
+                return std::any_of(begin(filtered), end(filtered), [&](auto col) {
+                    return col < columns.size() && columns[col].contains(ndx);
+                });
+            };
+        }
+        auto& modifications = changes.modifications;
+        return [&modifications](size_t ndx) { return modifications.contains(ndx); };
+    }
+
+    return DeepChangeChecker(info, root_table, m_related_tables, m_filtered_columns);
+}
+
+bool CollectionNotifier::any_related_table_modified(TransactionChangeInfo const& info) const noexcept
+{
+    auto table_modified = [&](auto& tbl) {
+        if (tbl.table_ndx >= info.tables.size())
+            return false;
+        auto& changes = info.tables[tbl.table_ndx];
+        if (changes.modifications.empty())
+            return false;
+        // If the only relevant table is the collection's own and all of its
+        // modifications were to unobserved columns then nothing of interest
+        // was modified. This shortcut doesn't apply when the table has
+        // outgoing links, as rows are then also modified indirectly by
+        // changes to the rows they link to.
+        if (m_filtered_columns && m_related_tables.size() == 1 && m_related_tables[0].links.empty()) {
+            auto& columns = changes.columns;
+            return std::any_of(begin(*m_filtered_columns), end(*m_filtered_columns), [&](auto col) {
+                return col < columns.size() && !columns[col].empty();
+            });
+        }
+        return true;
+    };
+    return any_of(begin(m_related_tables), end(m_related_tables), table_modified);
 }
 
 void DeepChangeChecker::find_related_tables(std::vector<RelatedTable>& out, Table const& table)
@@ -69,12 +114,14 @@ void DeepChangeChecker::find_related_tables(std::vector<RelatedTable>& out, Tabl
 
 DeepChangeChecker::DeepChangeChecker(TransactionChangeInfo const& info,
                                      Table const& root_table,
-                                     std::vector<RelatedTable> const& related_tables)
+                                     std::vector<RelatedTable> const& related_tables,
+                                     util::Optional<std::vector<size_t>> filtered_columns)
 : m_info(info)
 , m_root_table(root_table)
 , m_root_table_ndx(root_table.get_index_in_group())
 , m_root_modifications(m_root_table_ndx < info.tables.size() ? &info.tables[m_root_table_ndx].modifications : nullptr)
 , m_related_tables(related_tables)
+, m_filtered_columns(std::move(filtered_columns))
 {
 }
 
@@ -153,14 +200,23 @@ bool DeepChangeChecker::check_row(Table const& table, size_t idx, size_t depth)
 
 bool DeepChangeChecker::operator()(size_t ndx)
 {
-    if (m_root_modifications && m_root_modifications->contains(ndx))
-        return true;
+    if (m_root_modifications && m_root_modifications->contains(ndx)) {
+        if (!m_filtered_columns)
+            return true;
+        auto& columns = m_info.tables[m_root_table_ndx].columns;
+        if (std::any_of(begin(*m_filtered_columns), end(*m_filtered_columns),
+                        [&](auto col) { return col < columns.size() && columns[col].contains(ndx); }))
+            return true;
+        // The direct modifications were all to unobserved columns, but a
+        // row reached through a link may still have changed
+    }
     return check_row(m_root_table, ndx, 0);
 }
 
 CollectionNotifier::CollectionNotifier(std::shared_ptr<Realm> realm)
 : m_realm(std::move(realm))
 , m_sg_version(Realm::Internal::get_shared_group(*m_realm)->get_version_of_current_transaction())
+, m_deep_change_info(m_realm->config().compute_deep_change_info)
 {
 }
 
@@ -171,7 +227,9 @@ CollectionNotifier::~CollectionNotifier()
     unregister();
 }
 
-size_t CollectionNotifier::add_callback(CollectionChangeCallback callback)
+size_t CollectionNotifier::add_callback(CollectionChangeCallback callback,
+                                        std::chrono::milliseconds minimum_interval,
+                                        util::Optional<std::vector<size_t>> observed_columns)
 {
     m_realm->verify_thread();
 
@@ -187,7 +245,8 @@ size_t CollectionNotifier::add_callback(CollectionChangeCallback callback)
 
     std::lock_guard<std::mutex> lock(m_callback_mutex);
     auto token = next_token();
-    m_callbacks.push_back({std::move(callback), {}, {}, token, false, false});
+    m_callbacks.push_back({std::move(callback), {}, {}, token, false, false,
+                           minimum_interval, {}, std::move(observed_columns)});
     if (m_callback_index == npos) { // Don't need to wake up if we're already sending notifications
         Realm::Internal::get_coordinator(*m_realm).wake_up_notifier_worker();
         m_have_callbacks = true;
@@ -265,12 +324,44 @@ std::unique_lock<std::mutex> CollectionNotifier::lock_target()
 
 void CollectionNotifier::set_table(Table const& table)
 {
+    m_root_table_ndx = table.get_index_in_group();
     m_related_tables.clear();
+    if (!m_deep_change_info) {
+        // Only direct changes to the collection's own table are relevant,
+        // so don't follow any of its links
+        m_related_tables.push_back({table.get_index_in_group(), {}});
+        return;
+    }
     DeepChangeChecker::find_related_tables(m_related_tables, table);
 }
 
+void CollectionNotifier::update_filtered_columns()
+{
+    std::lock_guard<std::mutex> lock(m_callback_mutex);
+    if (m_callbacks.empty()) {
+        m_filtered_columns = util::none;
+        return;
+    }
+
+    std::vector<size_t> columns;
+    for (auto& callback : m_callbacks) {
+        if (!callback.observed_columns) {
+            // This callback observes every column, so no filtering can be done
+            m_filtered_columns = util::none;
+            return;
+        }
+        columns.insert(columns.end(), callback.observed_columns->begin(),
+                       callback.observed_columns->end());
+    }
+    std::sort(begin(columns), end(columns));
+    columns.erase(std::unique(begin(columns), end(columns)), end(columns));
+    m_filtered_columns = std::move(columns);
+}
+
 void CollectionNotifier::add_required_change_info(TransactionChangeInfo& info)
 {
+    update_filtered_columns();
+
     if (!do_add_required_change_info(info) || m_related_tables.empty()) {
         return;
     }
@@ -283,6 +374,118 @@ void CollectionNotifier::add_required_change_info(TransactionChangeInfo& info)
     for (auto& tbl : m_related_tables) {
         info.table_modifications_needed[tbl.table_ndx] = true;
     }
+
+    // Derived properties are invalidated from the per-column change info,
+    // which is otherwise skipped for tables which don't need it, and column
+    // filtering needs it to attribute modifications to columns
+    if ((m_have_derived_properties || m_filtered_columns) && m_root_table_ndx != size_t(-1)) {
+        if (m_root_table_ndx >= info.table_columns_needed.size())
+            info.table_columns_needed.resize(m_root_table_ndx + 1, false);
+        info.table_columns_needed[m_root_table_ndx] = true;
+    }
+}
+
+size_t CollectionNotifier::add_derived_property(std::vector<size_t> columns, DerivedFunction compute)
+{
+    std::lock_guard<std::mutex> lock(m_derived_mutex);
+    size_t token = m_next_derived_token++;
+    m_derived_properties.push_back({token, std::move(columns), std::move(compute), {}});
+    m_have_derived_properties.store(true, std::memory_order_relaxed);
+    return token;
+}
+
+void CollectionNotifier::remove_derived_property(size_t token)
+{
+    std::lock_guard<std::mutex> lock(m_derived_mutex);
+    auto it = std::find_if(begin(m_derived_properties), end(m_derived_properties),
+                           [&](auto const& derived) { return derived.token == token; });
+    REALM_ASSERT(it != end(m_derived_properties));
+    m_derived_properties.erase(it);
+    m_have_derived_properties.store(!m_derived_properties.empty(), std::memory_order_relaxed);
+}
+
+util::Any CollectionNotifier::get_derived_value(size_t token, Table const& table, size_t row_ndx)
+{
+    std::lock_guard<std::mutex> lock(m_derived_mutex);
+    auto it = std::find_if(begin(m_derived_properties), end(m_derived_properties),
+                           [&](auto const& derived) { return derived.token == token; });
+    REALM_ASSERT(it != end(m_derived_properties));
+    auto pos = it->values.find(row_ndx);
+    if (pos == it->values.end())
+        pos = it->values.emplace(row_ndx, it->compute(table, row_ndx)).first;
+    return pos->second;
+}
+
+void CollectionNotifier::update_derived_values(Table const& table, TransactionChangeInfo const& info)
+{
+    if (!m_have_derived_properties.load(std::memory_order_relaxed))
+        return;
+
+    size_t table_ndx = table.get_index_in_group();
+    if (table_ndx >= info.tables.size())
+        return;
+    auto& change = info.tables[table_ndx];
+    if (change.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_derived_mutex);
+    for (auto& derived : m_derived_properties) {
+        if (!change.deletions.empty() || !change.insertions.empty() || !change.moves.empty()) {
+            // The cache is keyed by row index, so once rows have shifted
+            // around it's cheaper to drop it and recompute lazily than to
+            // remap every entry through the moves
+            derived.values.clear();
+            continue;
+        }
+        for (size_t col : derived.columns) {
+            if (col >= change.columns.size())
+                continue;
+            for (auto row : change.columns[col].as_indexes()) {
+                if (row < table.size())
+                    derived.values[row] = derived.compute(table, row);
+            }
+        }
+    }
+}
+
+bool CollectionNotifier::all_callbacks_throttled(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_callback_mutex);
+    if (m_callbacks.empty())
+        return false;
+    return std::all_of(begin(m_callbacks), end(m_callbacks),
+                       [&](auto const& callback) { return is_throttled(callback, now); });
+}
+
+TransactionChangeInfo* CollectionNotifier::throttle_change_info(TransactionChangeInfo& info)
+{
+    auto bank_tables = [&] {
+        for (size_t i = 0; i < info.tables.size(); ++i) {
+            if (i < m_banked_tables.size())
+                m_banked_tables[i].merge(CollectionChangeBuilder(info.tables[i]));
+            else
+                m_banked_tables.push_back(info.tables[i]);
+        }
+    };
+
+    if (all_callbacks_throttled(std::chrono::steady_clock::now())) {
+        // Every callback is inside its minimum delivery interval, so bank
+        // this frame's table-level changes and skip computing a changeset
+        bank_tables();
+        return nullptr;
+    }
+
+    if (m_banked_tables.empty())
+        return &info;
+
+    // Merge the current frame's changes onto the banked span from the frames
+    // which skipped computation, and compute against the combined info so
+    // that the changeset delivered covers the entire span since the last
+    // delivery
+    bank_tables();
+    m_banked_info.tables = std::move(m_banked_tables);
+    m_banked_tables.clear();
+    return &m_banked_info;
 }
 
 void CollectionNotifier::prepare_handover()
@@ -302,33 +505,36 @@ void CollectionNotifier::prepare_handover()
 void CollectionNotifier::before_advance()
 {
     for_each_callback([&](auto& lock, auto& callback) {
-        if (callback.changes_to_deliver.empty()) {
+        if (!callback.changes_to_deliver) {
             return;
         }
 
+        // retain a reference to the shared changeset rather than copying it
+        // so that removing the callback from within it can't result in a
+        // dangling pointer, and acquire a local reference to the callback
         auto changes = callback.changes_to_deliver;
-        // acquire a local reference to the callback so that removing the
-        // callback from within it can't result in a dangling pointer
         auto cb = callback.fn;
         lock.unlock();
-        cb.before(changes);
+        cb.before(*changes);
     });
 }
 
 void CollectionNotifier::after_advance()
 {
     for_each_callback([&](auto& lock, auto& callback) {
-        if (callback.initial_delivered && callback.changes_to_deliver.empty()) {
+        if (callback.initial_delivered && !callback.changes_to_deliver) {
             return;
         }
         callback.initial_delivered = true;
+        if (callback.minimum_interval.count() > 0)
+            callback.next_delivery = std::chrono::steady_clock::now() + callback.minimum_interval;
 
         auto changes = std::move(callback.changes_to_deliver);
         // acquire a local reference to the callback so that removing the
         // callback from within it can't result in a dangling pointer
         auto cb = callback.fn;
         lock.unlock();
-        cb.after(changes);
+        cb.after(changes ? *changes : CollectionChangeSet{});
     });
 }
 
@@ -354,13 +560,71 @@ bool CollectionNotifier::is_for_realm(Realm& realm) const noexcept
     return m_realm.get() == &realm;
 }
 
+bool CollectionNotifier::shares_tables_with(CollectionNotifier const& other) const noexcept
+{
+    // Notifiers which have not yet discovered which tables they read from have
+    // to be assumed to overlap with everything
+    if (m_related_tables.empty() || other.m_related_tables.empty())
+        return true;
+    return any_of(begin(m_related_tables), end(m_related_tables), [&](auto&& table) {
+        return any_of(begin(other.m_related_tables), end(other.m_related_tables),
+                      [&](auto&& other_table) { return other_table.table_ndx == table.table_ndx; });
+    });
+}
+
+void CollectionNotifier::run()
+{
+    util::trace::Scope trace_scope(util::trace::Event::notifier_run, this);
+    do_run();
+}
+
 bool CollectionNotifier::package_for_delivery()
 {
+    util::trace::Scope trace_scope(util::trace::Event::notifier_package, this);
     if (!prepare_to_deliver())
         return false;
     std::lock_guard<std::mutex> l(m_callback_mutex);
-    for (auto& callback : m_callbacks)
-        callback.changes_to_deliver = std::move(callback.accumulated_changes).finalize();
+    auto now = std::chrono::steady_clock::now();
+
+    // Callbacks inside their minimum delivery interval keep accumulating
+    // rather than being packaged. Finalizing a changeset empties the builder,
+    // so a throttled callback which shares a builder with one that is being
+    // packaged has to diverge onto its own copy first.
+    std::unordered_set<CollectionChangeBuilder*> finalizing;
+    for (auto& callback : m_callbacks) {
+        if (callback.accumulated_changes && !is_throttled(callback, now))
+            finalizing.insert(callback.accumulated_changes.get());
+    }
+    for (auto& callback : m_callbacks) {
+        if (callback.accumulated_changes && is_throttled(callback, now)
+            && finalizing.count(callback.accumulated_changes.get())) {
+            callback.accumulated_changes = std::make_shared<CollectionChangeBuilder>(*callback.accumulated_changes);
+        }
+    }
+
+    // Finalize each distinct accumulated changeset once and deliver the
+    // resulting immutable changeset to every callback which shared it
+    std::unordered_map<CollectionChangeBuilder*, std::shared_ptr<const CollectionChangeSet>> finalized;
+    for (auto& callback : m_callbacks) {
+        if (is_throttled(callback, now)) {
+            callback.changes_to_deliver = nullptr;
+            continue;
+        }
+        auto builder = std::move(callback.accumulated_changes);
+        if (!builder) {
+            callback.changes_to_deliver = nullptr;
+            continue;
+        }
+        auto it = finalized.find(builder.get());
+        if (it == finalized.end()) {
+            auto changes = std::move(*builder).finalize();
+            std::shared_ptr<const CollectionChangeSet> shared;
+            if (!changes.empty())
+                shared = std::make_shared<CollectionChangeSet>(std::move(changes));
+            it = finalized.emplace(builder.get(), std::move(shared)).first;
+        }
+        callback.changes_to_deliver = it->second;
+    }
     return true;
 }
 
@@ -395,16 +659,30 @@ void CollectionNotifier::detach()
 void CollectionNotifier::add_changes(CollectionChangeBuilder change)
 {
     std::lock_guard<std::mutex> lock(m_callback_mutex);
+
+    // Callbacks which share an accumulated changeset continue to share after
+    // this merge, so the new change only needs to be merged into each
+    // distinct changeset once rather than once per callback
+    bool have_existing_changes = any_of(begin(m_callbacks), end(m_callbacks), [](auto& callback) {
+        return bool(callback.accumulated_changes);
+    });
+    std::shared_ptr<CollectionChangeBuilder> new_changes;
+    std::unordered_set<CollectionChangeBuilder*> merged;
     for (auto& callback : m_callbacks) {
         if (callback.skip_next) {
-            REALM_ASSERT_DEBUG(callback.accumulated_changes.empty());
+            REALM_ASSERT_DEBUG(!callback.accumulated_changes);
             callback.skip_next = false;
         }
+        else if (callback.accumulated_changes) {
+            if (merged.insert(callback.accumulated_changes.get()).second)
+                callback.accumulated_changes->merge(CollectionChangeBuilder(change));
+        }
         else {
-            if (&callback == &m_callbacks.back())
-                callback.accumulated_changes.merge(std::move(change));
-            else
-                callback.accumulated_changes.merge(CollectionChangeBuilder(change));
+            if (!new_changes) {
+                new_changes = std::make_shared<CollectionChangeBuilder>(
+                    have_existing_changes ? CollectionChangeBuilder(change) : std::move(change));
+            }
+            callback.accumulated_changes = new_changes;
         }
     }
 }
@@ -446,6 +724,7 @@ void NotifierPackage::package_and_wait(util::Optional<VersionID::version_type> t
     }
     REALM_ASSERT(m_version || m_notifiers.empty());
 
+    m_coordinator->count_notifier_deliveries(m_notifiers.size());
     m_coordinator = nullptr;
 }
 
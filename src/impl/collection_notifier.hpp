@@ -20,13 +20,17 @@
 #define REALM_BACKGROUND_COLLECTION_HPP
 
 #include "impl/collection_change_builder.hpp"
+#include "util/any.hpp"
 
+#include <realm/util/optional.hpp>
 #include <realm/version_id.hpp>
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 
@@ -36,6 +40,7 @@ class SharedGroup;
 class Table;
 
 namespace _impl {
+class ObjectNotifier;
 class RealmCoordinator;
 
 struct ListChangeInfo {
@@ -48,11 +53,27 @@ struct ListChangeInfo {
 struct TransactionChangeInfo {
     std::vector<bool> table_modifications_needed;
     std::vector<bool> table_moves_needed;
+    // Tables for which per-column modification info is actually consumed.
+    // Column-level index sets are skipped entirely for other tables, as
+    // maintaining them through merges is a significant part of the cost of
+    // running a notifier
+    std::vector<bool> table_columns_needed;
     std::vector<ListChangeInfo> lists;
     std::vector<CollectionChangeBuilder> tables;
     std::vector<std::vector<size_t>> column_indices;
     std::vector<size_t> table_indices;
     bool track_all;
+    // The commits advanced over were proven (via their published commit
+    // metadata) to not touch any table the notifiers registered interest in,
+    // and the transact-log parse was skipped outright. Notifiers can treat
+    // their previous results as still valid rather than recomputing them.
+    bool proven_unchanged;
+    // The object notifiers observing rows of each table, collected while
+    // registering interest so that the first one to run can match every
+    // observed row against the table's modifications in a single pass rather
+    // than each notifier searching the modification set separately. See
+    // ObjectNotifier::do_run().
+    std::unordered_map<size_t, std::vector<ObjectNotifier*>> object_notifiers;
 };
 
 class DeepChangeChecker {
@@ -66,8 +87,12 @@ public:
         std::vector<OutgoingLink> links;
     };
 
+    // If `filtered_columns` is engaged, direct modifications to the root
+    // table only count when they touch one of the given columns.
+    // Modifications reached through links are not filtered.
     DeepChangeChecker(TransactionChangeInfo const& info, Table const& root_table,
-                      std::vector<RelatedTable> const& related_tables);
+                      std::vector<RelatedTable> const& related_tables,
+                      util::Optional<std::vector<size_t>> filtered_columns = util::none);
 
     bool operator()(size_t row_ndx);
 
@@ -82,6 +107,7 @@ private:
     IndexSet const* const m_root_modifications;
     std::vector<IndexSet> m_not_modified;
     std::vector<RelatedTable> const& m_related_tables;
+    const util::Optional<std::vector<size_t>> m_filtered_columns;
 
     struct Path {
         size_t table;
@@ -115,8 +141,24 @@ public:
 
     // Add a callback to be called each time the collection changes
     // This can only be called from the target collection's thread
+    // If `minimum_interval` is non-zero, at most one notification is
+    // delivered to the callback per interval. Changes arriving while the
+    // callback is inside the interval are coalesced into a single changeset
+    // which is delivered with the first notification after the interval has
+    // elapsed, and frames for which every callback on the notifier is inside
+    // its interval skip the changeset computation entirely.
+    // If `observed_columns` is engaged, modifications to the collection's
+    // table only produce a notification when they touch one of the given
+    // columns. Insertions, deletions and moves are always delivered, as are
+    // modifications to rows reached through links. When every callback on
+    // the notifier observes an explicit column set, rows modified only in
+    // unobserved columns are excluded from the modification scan itself;
+    // the scan is shared between the callbacks, so it filters on the union
+    // of their observed columns.
     // Returns a token which can be passed to remove_callback()
-    size_t add_callback(CollectionChangeCallback callback);
+    size_t add_callback(CollectionChangeCallback callback,
+                        std::chrono::milliseconds minimum_interval = std::chrono::milliseconds::zero(),
+                        util::Optional<std::vector<size_t>> observed_columns = util::none);
     // Remove a previously added token. The token is no longer valid after
     // calling this function and must not be used again. This function can be
     // called from any thread.
@@ -124,17 +166,55 @@ public:
 
     void suppress_next_notification(size_t token);
 
+    // A function which derives a display value from the stored properties of
+    // the given row of a table
+    using DerivedFunction = std::function<util::Any (Table const&, size_t)>;
+
+    // Register a derived property computed by `compute` from the given
+    // columns of the collection's table. Cached values are invalidated using
+    // the per-column change information, and only the rows whose dependency
+    // columns were actually modified are recomputed — on the worker thread,
+    // before the change notification is delivered, against the version being
+    // delivered. Returns a token which can be passed to
+    // remove_derived_property() and get_derived_value().
+    size_t add_derived_property(std::vector<size_t> columns, DerivedFunction compute);
+    // Remove a previously registered derived property and its cached values.
+    // The token is no longer valid after calling this function.
+    void remove_derived_property(size_t token);
+
+    // Get the derived value for the given row, computing and caching it with
+    // the given table if no value has been computed for the row yet
+    util::Any get_derived_value(size_t token, Table const& table, size_t row_ndx);
+
     // ------------------------------------------------------------------------
     // API for RealmCoordinator to manage running things and calling callbacks
 
     bool is_for_realm(Realm&) const noexcept;
     Realm* get_realm() const noexcept { return m_realm.get(); }
 
+    // Returns whether this notifier and `other` need to read from any of the
+    // same tables, and so must not have their run() methods called concurrently
+    bool shares_tables_with(CollectionNotifier const& other) const noexcept;
+
+    // Raise the scheduling priority of this notifier on the background worker.
+    // The highest priority ever requested wins, and takes effect the next time
+    // the worker runs.
+    void set_priority(NotifierPriority priority) noexcept
+    {
+        auto current = m_priority.load();
+        while (priority < current && !m_priority.compare_exchange_weak(current, priority)) { }
+    }
+    NotifierPriority priority() const noexcept { return m_priority; }
+
     // Get the SharedGroup version which this collection can attach to (if it's
     // in handover mode), or can deliver to (if it's been handed over to the BG worker alredad)
     // precondition: RealmCoordinator::m_notifier_mutex is locked
     VersionID version() const noexcept { return m_sg_version; }
 
+    // When the notifier was created, which is when it entered the
+    // coordinator's staging queue. Used for the queue-time statistics.
+    std::chrono::steady_clock::time_point created_at() const noexcept { return m_created_at; }
+
     // Release references to all core types
     // This is called on the worker thread to ensure that non-thread-safe things
     // can be destroyed on the correct thread, even if the last reference to the
@@ -161,6 +241,12 @@ public:
 
     bool is_alive() const noexcept;
 
+    // Approximate number of rows retained by this notifier on behalf of its
+    // target collection (e.g. the TableView produced by a query), for memory
+    // accounting. Updated by the subclass on the worker thread; may be read
+    // from any thread.
+    size_t retained_row_count() const noexcept { return m_retained_rows.load(std::memory_order_relaxed); }
+
     // precondition: RealmCoordinator::m_notifier_mutex is locked *or* is called on worker thread
     bool has_run() const noexcept { return m_has_run; }
 
@@ -177,8 +263,10 @@ public:
     // precondition: RealmCoordinator::m_notifier_mutex is locked
     void add_required_change_info(TransactionChangeInfo& info);
 
+    // Recalculate the changeset for the currently attached version, wrapped
+    // in a tracepoint around the subclass's do_run()
     // precondition: RealmCoordinator::m_notifier_mutex is unlocked
-    virtual void run() = 0;
+    void run();
 
     // precondition: RealmCoordinator::m_notifier_mutex is locked
     void prepare_handover();
@@ -191,10 +279,42 @@ protected:
     void add_changes(CollectionChangeBuilder change);
     void set_table(Table const& table);
     std::unique_lock<std::mutex> lock_target();
+    std::vector<DeepChangeChecker::RelatedTable> const& related_tables() const noexcept { return m_related_tables; }
 
     std::function<bool (size_t)> get_modification_checker(TransactionChangeInfo const&, Table const&);
 
+    void set_retained_row_count(size_t count) noexcept { m_retained_rows.store(count, std::memory_order_relaxed); }
+
+    // The union of the observed column sets of the registered callbacks, or
+    // none if any callback (or the collection itself, when there are no
+    // callbacks) observes every column. Updated once per frame from
+    // add_required_change_info() and only valid on the worker thread.
+    util::Optional<std::vector<size_t>> const& filtered_columns() const noexcept { return m_filtered_columns; }
+
+    // Check whether any of the tables reachable from the root table were
+    // modified in this transaction, i.e. whether the checker returned from
+    // get_modification_checker() could ever return true. Collections can use
+    // this to skip their per-row modification scan entirely when the commit
+    // only contained insertions or structural changes.
+    bool any_related_table_modified(TransactionChangeInfo const&) const noexcept;
+
+    // Recompute the derived properties for the rows of `table` whose
+    // dependency columns were modified in this transaction, and discard the
+    // cache when rows were inserted, removed or moved. Called by subclasses
+    // on the worker thread from do_run().
+    void update_derived_values(Table const& table, TransactionChangeInfo const& info);
+
+    // Get the change info which this frame's changeset should be computed
+    // from, or nullptr if every callback is currently inside its minimum
+    // delivery interval. In the latter case the frame's table-level changes
+    // are banked and merged into the info returned for the next frame which
+    // does compute a changeset, so that throttled frames skip the changeset
+    // computation without losing any changes. Called by subclasses on the
+    // worker thread from do_run().
+    TransactionChangeInfo* throttle_change_info(TransactionChangeInfo& info);
+
 private:
+    virtual void do_run() = 0;
     virtual void do_attach_to(SharedGroup&) = 0;
     virtual void do_detach_from(SharedGroup&) = 0;
     virtual void do_prepare_handover(SharedGroup&) = 0;
@@ -209,15 +329,44 @@ private:
 
     bool m_has_run = false;
     bool m_error = false;
+
+    const std::chrono::steady_clock::time_point m_created_at = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> m_retained_rows{0};
     std::vector<DeepChangeChecker::RelatedTable> m_related_tables;
+    size_t m_root_table_ndx = -1;
+    // False when the Realm was opened with compute_deep_change_info
+    // disabled, in which case m_related_tables is limited to the root table
+    // and modifications to linked-to objects are not reported
+    bool m_deep_change_info = true;
 
     struct Callback {
         CollectionChangeCallback fn;
-        CollectionChangeBuilder accumulated_changes;
-        CollectionChangeSet changes_to_deliver;
+        // Accumulated changes are shared between all callbacks which have
+        // seen exactly the same sequence of changes, so that twenty
+        // callbacks on one collection accumulate one changeset rather than
+        // twenty identical copies. Callbacks diverge (and stop sharing)
+        // only via skip_next or by being added mid-accumulation. Null means
+        // no accumulated changes.
+        std::shared_ptr<CollectionChangeBuilder> accumulated_changes;
+        // The changeset is finalized once per delivery and then shared
+        // immutably between before_advance() and after_advance(), so that
+        // handing it to a callback with m_callback_mutex unlocked only has
+        // to retain a reference rather than deep-copy the IndexSets. Null
+        // when there is nothing to deliver.
+        std::shared_ptr<const CollectionChangeSet> changes_to_deliver;
         size_t token;
         bool initial_delivered;
         bool skip_next;
+        // Minimum time between deliveries to this callback. Zero means the
+        // callback is notified for every change.
+        std::chrono::milliseconds minimum_interval;
+        // The earliest time at which the next changeset may be delivered to
+        // this callback. Only meaningful when minimum_interval is non-zero.
+        std::chrono::steady_clock::time_point next_delivery;
+        // When engaged, only modifications to these columns of the
+        // collection's table are of interest to this callback
+        util::Optional<std::vector<size_t>> observed_columns;
     };
 
     // Currently registered callbacks and a mutex which must always be held
@@ -231,10 +380,45 @@ private:
     // some extra work.
     std::atomic<bool> m_have_callbacks = {false};
 
+    std::atomic<NotifierPriority> m_priority = {NotifierPriority::Normal};
+
+    struct DerivedProperty {
+        size_t token;
+        std::vector<size_t> columns;
+        DerivedFunction compute;
+        std::unordered_map<size_t, util::Any> values;
+    };
+
+    // Registered derived properties and their cached values, written on the
+    // worker thread and read on the target thread under m_derived_mutex
+    std::mutex m_derived_mutex;
+    std::vector<DerivedProperty> m_derived_properties;
+    size_t m_next_derived_token = 0;
+
+    // Cached value for if m_derived_properties is empty, for the same
+    // reasons as m_have_callbacks
+    std::atomic<bool> m_have_derived_properties = {false};
+
     // Iteration variable for looping over callbacks
     // remove_callback() updates this when needed
     size_t m_callback_index = -1;
 
+    // See filtered_columns()
+    util::Optional<std::vector<size_t>> m_filtered_columns;
+    void update_filtered_columns();
+
+    // Table-level changes banked by throttle_change_info() for frames which
+    // skipped the changeset computation, and the combined info handed back
+    // to do_run() once a frame computes again. Only used on the worker thread.
+    std::vector<CollectionChangeBuilder> m_banked_tables;
+    TransactionChangeInfo m_banked_info = {};
+
+    static bool is_throttled(Callback const& callback, std::chrono::steady_clock::time_point now) noexcept
+    {
+        return callback.minimum_interval.count() > 0 && now < callback.next_delivery;
+    }
+    bool all_callbacks_throttled(std::chrono::steady_clock::time_point now);
+
     template<typename Fn>
     void for_each_callback(Fn&& fn);
 
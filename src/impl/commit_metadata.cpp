@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/commit_metadata.hpp"
+
+#include <atomic>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+constexpr uint64_t c_magic = 0x61746d635f6d6c72; // "rlm_cmta"
+constexpr uint32_t c_format_version = 1;
+constexpr uint32_t c_record_count = 256;
+} // anonymous namespace
+
+// One slot per version, modulo the record count. A record is written by
+// storing zero to the version, then the mask, then the actual version, all
+// sequentially consistent; a reader which loads the version it wants both
+// before and after loading the mask is therefore guaranteed that the mask
+// belongs to that version, even if another process was concurrently reusing
+// the slot for a different version. std::atomic<uint64_t> is lock-free and
+// has the same representation as a plain uint64_t on every supported
+// platform, so the zero-filled freshly-created file is a valid initial
+// state and the atomics work across processes through the shared mapping.
+struct CommitMetadata::Record {
+    std::atomic<uint64_t> version;
+    std::atomic<uint64_t> mask;
+};
+
+struct CommitMetadata::Header {
+    uint64_t magic;
+    uint32_t format_version;
+    uint32_t record_count;
+};
+
+std::string CommitMetadata::path_for_realm(std::string const& realm_path)
+{
+    return realm_path + ".commit_metadata";
+}
+
+std::unique_ptr<CommitMetadata> CommitMetadata::open(std::string const& realm_path, bool create)
+{
+#ifndef _WIN32
+    size_t size = sizeof(Header) + sizeof(Record) * c_record_count;
+    auto path = path_for_realm(realm_path);
+    int fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0
+        || (size_t(info.st_size) < size && (!create || ::ftruncate(fd, off_t(size)) != 0))) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* data = ::mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ,
+                        MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    auto header = static_cast<Header*>(data);
+    if (create && header->magic == 0) {
+        // Two processes creating the file at the same time both initialize
+        // it, but they write identical values so the race is harmless
+        header->format_version = c_format_version;
+        header->record_count = c_record_count;
+        header->magic = c_magic;
+    }
+    if (header->magic != c_magic || header->format_version != c_format_version
+        || header->record_count != c_record_count) {
+        ::munmap(data, size);
+        return nullptr;
+    }
+    return std::unique_ptr<CommitMetadata>(new CommitMetadata(data, size));
+#else
+    // No shared-memory support on Windows yet; readers then always parse
+    static_cast<void>(realm_path);
+    static_cast<void>(create);
+    return nullptr;
+#endif
+}
+
+void CommitMetadata::remove(std::string const& realm_path)
+{
+    std::remove(path_for_realm(realm_path).c_str());
+}
+
+CommitMetadata::~CommitMetadata()
+{
+#ifndef _WIN32
+    ::munmap(m_data, m_size);
+#endif
+}
+
+CommitMetadata::Record& CommitMetadata::record_for(uint64_t version) const noexcept
+{
+    auto records = reinterpret_cast<Record*>(static_cast<char*>(m_data) + sizeof(Header));
+    return records[version % c_record_count];
+}
+
+void CommitMetadata::publish(uint64_t version, uint64_t modified_tables) noexcept
+{
+    // See the comment on Record for the ordering requirements
+    auto& record = record_for(version);
+    record.version = 0;
+    record.mask = modified_tables;
+    record.version = version;
+}
+
+bool CommitMetadata::no_changes_for(uint64_t begin_version, uint64_t end_version,
+                                    uint64_t interest_mask) const noexcept
+{
+    if (end_version - begin_version > c_record_count)
+        return false;
+    for (uint64_t version = begin_version + 1; version <= end_version; ++version) {
+        auto& record = record_for(version);
+        if (record.version != version)
+            return false;
+        uint64_t mask = record.mask;
+        // Re-check after reading the mask in case the slot was concurrently
+        // being reused for a different version
+        if (record.version != version)
+            return false;
+        if (mask & interest_mask)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_COMMIT_METADATA_HPP
+#define REALM_COMMIT_METADATA_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace realm {
+namespace _impl {
+// Per-commit metadata records, stored in a small memory-mapped sidecar file
+// next to the Realm file.
+//
+// Every reader process wakes up and walks the transact log on every commit,
+// even for commits which only touched tables no local observer cares about.
+// Writers publish a record for each commit they make — the new version
+// number plus a bitmask of the group-level tables the commit modified — and
+// readers compare the records against the tables their notifiers observe,
+// skipping the transact-log parse entirely when no published commit
+// intersects them.
+//
+// The records are strictly an optimization and are safe to lose: a reader
+// which can't find a consistent record for a version falls back to parsing
+// the transact log as before. A record which overstates the modified tables
+// is also safe, so writers publish all-ones masks when in doubt (such as for
+// commits which changed the set of tables, which shifts the indices the
+// masks are built from).
+class CommitMetadata {
+public:
+    // The sidecar path for the Realm file at `realm_path`
+    static std::string path_for_realm(std::string const& realm_path);
+
+    // Map the sidecar for the Realm file at `realm_path`, creating and
+    // initializing the file first if `create` is true (readers which merely
+    // consume the records should pass false). Returns null (and never
+    // throws) if the file is missing, damaged, or the platform is
+    // unsupported, in which case everything behaves as if no metadata was
+    // ever published.
+    static std::unique_ptr<CommitMetadata> open(std::string const& realm_path, bool create);
+
+    // Delete the sidecar, if present. Must be called when the Realm file
+    // itself is deleted or replaced, as version numbers restart in a new
+    // file and the old file's records would claim the wrong tables for them.
+    static void remove(std::string const& realm_path);
+
+    ~CommitMetadata();
+
+    // The bit for the group-level table index `table_ndx` in a
+    // modified-table mask. Indices which don't fit in 64 bits all share the
+    // top bit.
+    static uint64_t table_bit(size_t table_ndx) noexcept
+    {
+        return 1ULL << (table_ndx < 63 ? table_ndx : 63);
+    }
+
+    // Publish the modified-table mask for the commit which produced
+    // `version`. Older records are overwritten as versions wrap around the
+    // fixed-size record array.
+    void publish(uint64_t version, uint64_t modified_tables) noexcept;
+
+    // Check that every version in (begin_version, end_version] has a
+    // consistent record and that none of their masks intersect
+    // `interest_mask`. Returns false — meaning the caller must parse the
+    // transact log normally — when any record is missing, torn, or claims a
+    // table in the interest mask.
+    bool no_changes_for(uint64_t begin_version, uint64_t end_version,
+                        uint64_t interest_mask) const noexcept;
+
+private:
+    struct Record;
+    struct Header;
+
+    CommitMetadata(void* data, size_t size) : m_data(data), m_size(size) { }
+
+    Record& record_for(uint64_t version) const noexcept;
+
+    void* m_data;
+    size_t m_size;
+};
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_COMMIT_METADATA_HPP
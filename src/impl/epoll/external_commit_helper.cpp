@@ -24,11 +24,15 @@
 #include <realm/group_shared_options.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <errno.h>
 #include <fcntl.h>
 #include <sstream>
 #include <stdlib.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <system_error>
@@ -88,19 +92,32 @@ public:
     static DaemonThread& shared();
 private:
     void listen();
+    void work();
 
-    // To protect the accessing m_helpers on the daemon thread.
+    // To protect the accessing m_helpers and the work queue.
     std::mutex m_mutex;
     std::vector<ExternalCommitHelper*> m_helpers;
+    // Helpers with an unconsumed wakeup, waiting for a worker to call
+    // on_change() for them
+    std::deque<ExternalCommitHelper*> m_work_queue;
+    std::condition_variable m_work_cv;
+    // Signalled whenever a worker finishes a helper's on_change(), so that
+    // remove_commit_helper() can wait for in-flight work
+    std::condition_variable m_work_done_cv;
+    bool m_shutdown = false;
     // The listener thread
     std::thread m_thread;
+    // Worker threads which the on_change() calls are dispatched to, so that
+    // one slow Realm does not delay notifications for every other Realm in
+    // the process
+    std::vector<std::thread> m_workers;
     // File descriptor for epoll
     FdHolder m_epoll_fd;
     // The two ends of an anonymous pipe used to notify the kqueue() thread that it should be shut down.
     FdHolder m_shutdown_read_fd;
     FdHolder m_shutdown_write_fd;
-    // Daemon thread id. For checking unexpected dead locks.
-    std::thread::id m_thread_id;
+    // Listener and worker thread ids. For checking unexpected dead locks.
+    std::vector<std::thread::id> m_thread_ids;
 };
 
 
@@ -160,6 +177,19 @@ ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
         throw std::system_error(errno, std::system_category());
     }
 
+    // Map a small shared-memory block next to the fifo which is used to
+    // coalesce notifications: the fifo write and epoll wakeup are skipped
+    // while the listeners haven't consumed the previous one. If setting it
+    // up fails we just write to the fifo for every commit as before.
+    std::string counter_path = path + ".cnt";
+    m_counter_fd = open(counter_path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (m_counter_fd != -1 && ftruncate(m_counter_fd, sizeof(SharedState)) == 0) {
+        void* addr = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, m_counter_fd, 0);
+        if (addr != MAP_FAILED) {
+            m_shared_state = static_cast<SharedState*>(addr);
+        }
+    }
+
     // Lock is inside add_commit_helper.
     DaemonThread::shared().add_commit_helper(this);
 }
@@ -167,6 +197,9 @@ ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
 ExternalCommitHelper::~ExternalCommitHelper()
 {
     DaemonThread::shared().remove_commit_helper(this);
+    if (m_shared_state) {
+        munmap(m_shared_state, sizeof(SharedState));
+    }
 }
 
 ExternalCommitHelper::DaemonThread::DaemonThread()
@@ -208,13 +241,44 @@ ExternalCommitHelper::DaemonThread::DaemonThread()
             throw;
         }
     });
-    m_thread_id = m_thread.get_id();
+    m_thread_ids.push_back(m_thread.get_id());
+
+    // A handful of workers is enough: the work is mostly waiting on the
+    // notifier SharedGroup, and per-helper serialization caps the usable
+    // parallelism at the number of distinct Realms with pending commits
+    unsigned worker_count = std::thread::hardware_concurrency();
+    worker_count = worker_count == 0 ? 2 : std::min(worker_count, 4u);
+    for (unsigned i = 0; i < worker_count; ++i) {
+        m_workers.emplace_back([=] {
+            try {
+                work();
+            }
+            catch (std::exception const& e) {
+                LOGE("uncaught exception in notifier worker thread: %s: %s\n", typeid(e).name(), e.what());
+                throw;
+            }
+            catch (...) {
+                LOGE("uncaught exception in notifier worker thread\n");
+                throw;
+            }
+        });
+        m_thread_ids.push_back(m_workers.back().get_id());
+    }
 }
 
 ExternalCommitHelper::DaemonThread::~DaemonThread()
 {
     notify_fd(m_shutdown_write_fd);
     m_thread.join(); // Wait for the thread to exit
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
 }
 
 ExternalCommitHelper::DaemonThread& ExternalCommitHelper::DaemonThread::shared()
@@ -226,7 +290,8 @@ ExternalCommitHelper::DaemonThread& ExternalCommitHelper::DaemonThread::shared()
 void ExternalCommitHelper::DaemonThread::add_commit_helper(ExternalCommitHelper* helper)
 {
     // Called in the deamon thread loop, dead lock will happen.
-    REALM_ASSERT(std::this_thread::get_id() != m_thread_id);
+    REALM_ASSERT(std::find(m_thread_ids.begin(), m_thread_ids.end(),
+                           std::this_thread::get_id()) == m_thread_ids.end());
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -245,9 +310,10 @@ void ExternalCommitHelper::DaemonThread::add_commit_helper(ExternalCommitHelper*
 void ExternalCommitHelper::DaemonThread::remove_commit_helper(ExternalCommitHelper* helper)
 {
     // Called in the deamon thread loop, dead lock will happen.
-    REALM_ASSERT(std::this_thread::get_id() != m_thread_id);
+    REALM_ASSERT(std::find(m_thread_ids.begin(), m_thread_ids.end(),
+                           std::this_thread::get_id()) == m_thread_ids.end());
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
 
     m_helpers.erase(std::remove(m_helpers.begin(), m_helpers.end(), helper), m_helpers.end());
 
@@ -255,6 +321,13 @@ void ExternalCommitHelper::DaemonThread::remove_commit_helper(ExternalCommitHelp
     // though this argument is ignored. See man page of epoll_ctl.
     epoll_event event{};
     epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, helper->m_notify_fd, &event);
+
+    // Pull the helper out of the work queue and wait for any in-flight
+    // on_change() to return, as the helper is about to be destroyed
+    m_work_queue.erase(std::remove(m_work_queue.begin(), m_work_queue.end(), helper), m_work_queue.end());
+    helper->m_work_queued = false;
+    helper->m_work_pending = false;
+    m_work_done_cv.wait(lock, [&] { return !helper->m_work_running; });
 }
 
 void ExternalCommitHelper::DaemonThread::listen()
@@ -289,14 +362,81 @@ void ExternalCommitHelper::DaemonThread::listen()
             std::lock_guard<std::mutex> lock(m_mutex);
             for (auto helper : m_helpers) {
                 if (ev.data.u32 == (uint32_t)helper->m_notify_fd) {
-                    helper->m_parent.on_change();
+                    if (helper->m_work_running) {
+                        // A worker is inside this helper's on_change(); make
+                        // it run once more when it's done rather than calling
+                        // it concurrently
+                        helper->m_work_pending = true;
+                    }
+                    else if (!helper->m_work_queued) {
+                        helper->m_work_queued = true;
+                        m_work_queue.push_back(helper);
+                        m_work_cv.notify_one();
+                    }
                 }
             }
         }
     }
 }
 
+void ExternalCommitHelper::DaemonThread::work()
+{
+    pthread_setname_np(pthread_self(), "Realm notification worker");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_work_cv.wait(lock, [&] { return m_shutdown || !m_work_queue.empty(); });
+        if (m_shutdown) {
+            return;
+        }
+
+        ExternalCommitHelper* helper = m_work_queue.front();
+        m_work_queue.pop_front();
+        helper->m_work_queued = false;
+        helper->m_work_running = true;
+
+        lock.unlock();
+        // Clear the pending flag before processing the change so that commits
+        // made while we're inside on_change() signal a new wakeup rather than
+        // being lost
+        if (helper->m_shared_state) {
+            helper->m_shared_state->pending.store(0, std::memory_order_release);
+            // Consume the commit timestamp, if the committing process wrote
+            // one, and report the time from that commit to this dispatch
+            if (int64_t ns = helper->m_shared_state->last_commit_at.exchange(0, std::memory_order_acq_rel)) {
+                auto latency = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::nanoseconds(ns);
+                helper->m_parent.record_commit_notification_latency(latency);
+            }
+        }
+        helper->m_parent.on_change();
+        lock.lock();
+
+        helper->m_work_running = false;
+        if (helper->m_work_pending) {
+            helper->m_work_pending = false;
+            helper->m_work_queued = true;
+            m_work_queue.push_back(helper);
+            m_work_cv.notify_one();
+        }
+        m_work_done_cv.notify_all();
+    }
+}
+
 void ExternalCommitHelper::notify_others()
 {
+    if (m_shared_state) {
+        if (RealmCoordinator::commit_latency_stats_enabled()) {
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+            m_shared_state->last_commit_at.store(ns, std::memory_order_release);
+        }
+        m_shared_state->version.fetch_add(1, std::memory_order_release);
+        // If the previous wakeup hasn't been consumed yet the listeners will
+        // see this commit when they process that one, so the syscalls can be
+        // skipped entirely
+        if (m_shared_state->pending.exchange(1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
     notify_fd(m_notify_fd);
 }
@@ -16,6 +16,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -58,11 +59,37 @@ private:
 
     class DaemonThread;
 
+    // Layout of the small shared-memory block mapped next to the fifo.
+    // `version` counts commits, and `pending` is set while a wakeup has been
+    // signalled but not yet consumed by the listeners, so that back-to-back
+    // commits coalesce into a single fifo write and epoll wakeup.
+    // `last_commit_at` is the steady-clock time of the most recent commit,
+    // in nanoseconds, or zero; it is only written when commit latency stats
+    // are enabled (see RealmCoordinator::set_commit_latency_stats_enabled()).
+    struct SharedState {
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> pending;
+        std::atomic<int64_t> last_commit_at;
+    };
+
     RealmCoordinator& m_parent;
 
     // Read-write file descriptor for the named pipe which is waited on for
     // changes and written to when a commit is made
     FdHolder m_notify_fd;
+    // File descriptor backing the shared-memory commit counter
+    FdHolder m_counter_fd;
+    // The mapped commit counter, or null if mapping it failed and every
+    // commit should write to the fifo
+    SharedState* m_shared_state = nullptr;
+
+    // Dispatch state guarded by the DaemonThread's mutex. A helper is in the
+    // work queue at most once and its on_change() calls never overlap;
+    // `m_work_pending` records a wakeup which arrived while a worker was
+    // already inside on_change() so that it runs once more afterwards.
+    bool m_work_queued = false;
+    bool m_work_running = false;
+    bool m_work_pending = false;
 };
 
 } // namespace _impl
@@ -26,12 +26,23 @@
 using namespace realm;
 using namespace realm::_impl;
 
+namespace {
+// All SharedGroups for a file must agree on durability, so this has to
+// match what Realm::open_with_config() picks for the coordinator's config
+SharedGroupOptions::Durability durability_for(RealmCoordinator& parent)
+{
+    if (parent.is_in_memory())
+        return SharedGroupOptions::Durability::MemOnly;
+    if (parent.get_config()->group_commit_enabled())
+        return SharedGroupOptions::Durability::Unsafe;
+    return SharedGroupOptions::Durability::Full;
+}
+} // anonymous namespace
+
 ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
 : m_parent(parent)
 , m_history(realm::make_in_realm_history(parent.get_path()))
-, m_sg(*m_history, SharedGroupOptions(parent.is_in_memory() ? SharedGroupOptions::Durability::MemOnly
-                                                            : SharedGroupOptions::Durability::Full,
-                                      parent.get_encryption_key().data()))
+, m_sg(*m_history, SharedGroupOptions(durability_for(parent), parent.get_encryption_key().data()))
 , m_thread(std::async(std::launch::async, [=] {
     m_sg.begin_read();
     while (m_sg.wait_for_change()) {
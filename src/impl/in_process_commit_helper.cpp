@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/in_process_commit_helper.hpp"
+
+#include "impl/realm_coordinator.hpp"
+
+using namespace realm;
+using namespace realm::_impl;
+
+InProcessCommitHelper::InProcessCommitHelper(RealmCoordinator& parent)
+: m_parent(parent)
+, m_thread([this] {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [&] { return m_pending || m_shutdown; });
+        if (m_shutdown)
+            return;
+        m_pending = false;
+        lock.unlock();
+        m_parent.on_change();
+        lock.lock();
+    }
+})
+{
+}
+
+InProcessCommitHelper::~InProcessCommitHelper()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void InProcessCommitHelper::notify_others()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = true;
+    }
+    m_cv.notify_one();
+}
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_IN_PROCESS_COMMIT_HELPER_HPP
+#define REALM_IN_PROCESS_COMMIT_HELPER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace realm {
+namespace _impl {
+class RealmCoordinator;
+
+// Commit notification helper for in-memory Realms, which are never written
+// by another process. The cross-process listening machinery which
+// ExternalCommitHelper needs (named pipes, kqueue/epoll file descriptors, a
+// dedicated SharedGroup blocking in wait_for_change()) is replaced with a
+// worker thread woken directly by this process's own commits via a condition
+// variable, which makes these Realms much cheaper to open.
+class InProcessCommitHelper {
+public:
+    InProcessCommitHelper(RealmCoordinator& parent);
+    ~InProcessCommitHelper();
+
+    // Wake the worker thread to deliver notifications for a new commit.
+    // Multiple calls before the worker gets to run are coalesced.
+    void notify_others();
+
+private:
+    RealmCoordinator& m_parent;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_pending = false;
+    bool m_shutdown = false;
+
+    // The worker thread; must be last so that everything it uses is
+    // initialized before it starts
+    std::thread m_thread;
+};
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_IN_PROCESS_COMMIT_HELPER_HPP
@@ -80,8 +80,11 @@ bool ListNotifier::do_add_required_change_info(TransactionChangeInfo& info)
     return true;
 }
 
-void ListNotifier::run()
+void ListNotifier::do_run()
 {
+    if (m_info && m_lv && m_lv->is_attached())
+        update_derived_values(m_lv->get_target_table(), *m_info);
+
     if (!m_lv || !m_lv->is_attached()) {
         // LV was deleted, so report all of the rows being removed if this is
         // the first run after that
@@ -95,19 +98,36 @@ void ListNotifier::run()
         return;
     }
 
-    auto row_did_change = get_modification_checker(*m_info, m_lv->get_target_table());
-    for (size_t i = 0; i < m_lv->size(); ++i) {
-        if (m_change.modifications.contains(i))
-            continue;
-        if (row_did_change(m_lv->get(i).get_index()))
-            m_change.modifications.add(i);
+    // Frames for which every callback is inside its minimum delivery
+    // interval skip the modification scan entirely; the link list operations
+    // recorded in m_change keep accumulating in the meantime, and the banked
+    // table info is merged back in for the first frame which scans again.
+    auto info = throttle_change_info(*m_info);
+    if (!info) {
+        m_prev_size = m_lv->size();
+        return;
     }
 
-    for (auto const& move : m_change.moves) {
-        if (m_change.modifications.contains(move.to))
-            continue;
-        if (row_did_change(m_lv->get(move.to).get_index()))
-            m_change.modifications.add(move.to);
+    // The insertions, deletions and moves in m_change were built directly
+    // from the link list instructions by the transaction log parser, so the
+    // only thing left to discover is which of the target rows were modified.
+    // If nothing reachable from the target table was modified (e.g. the
+    // commit was a plain append to the list) the whole scan can be skipped.
+    if (any_related_table_modified(*info)) {
+        auto row_did_change = get_modification_checker(*info, m_lv->get_target_table());
+        for (size_t i = 0; i < m_lv->size(); ++i) {
+            if (m_change.modifications.contains(i))
+                continue;
+            if (row_did_change(m_lv->get(i).get_index()))
+                m_change.modifications.add(i);
+        }
+
+        for (auto const& move : m_change.moves) {
+            if (m_change.modifications.contains(move.to))
+                continue;
+            if (row_did_change(m_lv->get(move.to).get_index()))
+                m_change.modifications.add(move.to);
+        }
     }
 
     m_prev_size = m_lv->size();
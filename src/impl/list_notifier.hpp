@@ -43,7 +43,7 @@ private:
     CollectionChangeBuilder m_change;
     TransactionChangeInfo* m_info;
 
-    void run() override;
+    void do_run() override;
 
     void do_prepare_handover(SharedGroup&) override;
 
@@ -33,16 +33,18 @@ struct CppContext {
 template<>
 class NativeAccessor<util::Any, CppContext*> {
 public:
-    static bool dict_has_value_for_key(CppContext*, util::Any dict, const std::string &prop_name) {
-        return any_cast<AnyDict>(dict).count(prop_name) != 0;
+    // Cast to references rather than values so that checking for and reading
+    // each property doesn't deep-copy the entire dictionary or list
+    static bool dict_has_value_for_key(CppContext*, util::Any& dict, const std::string &prop_name) {
+        return any_cast<AnyDict&>(dict).count(prop_name) != 0;
     }
 
-    static util::Any dict_value_for_key(CppContext*, util::Any dict, const std::string &prop_name) {
-        return any_cast<AnyDict>(dict).at(prop_name);
+    static util::Any dict_value_for_key(CppContext*, util::Any& dict, const std::string &prop_name) {
+        return any_cast<AnyDict&>(dict).at(prop_name);
     }
 
-    static size_t list_size(CppContext*, util::Any& v) { return any_cast<AnyVector>(v).size(); }
-    static util::Any list_value_at_index(CppContext*, util::Any& v, size_t index) { return any_cast<AnyVector>(v)[index]; }
+    static size_t list_size(CppContext*, util::Any& v) { return any_cast<AnyVector&>(v).size(); }
+    static util::Any list_value_at_index(CppContext*, util::Any& v, size_t index) { return any_cast<AnyVector&>(v)[index]; }
 
     static bool has_default_value_for_property(CppContext* context, Realm*, ObjectSchema const& object, std::string const& prop) {
         auto it = context->defaults.find(object.name);
@@ -20,6 +20,9 @@
 
 #include "shared_realm.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace realm;
 using namespace realm::_impl;
 
@@ -58,16 +61,63 @@ bool ObjectNotifier::do_add_required_change_info(TransactionChangeInfo& info)
 {
     REALM_ASSERT(!m_handover);
     m_info = &info;
+    m_row_modified = util::none;
     if (m_row && m_row->is_attached()) {
         size_t table_ndx = m_row->get_table()->get_index_in_group();
         if (table_ndx >= info.table_modifications_needed.size())
             info.table_modifications_needed.resize(table_ndx + 1);
         info.table_modifications_needed[table_ndx] = true;
+        // Object notifiers are the only consumer of column-level info
+        if (table_ndx >= info.table_columns_needed.size())
+            info.table_columns_needed.resize(table_ndx + 1);
+        info.table_columns_needed[table_ndx] = true;
+        info.object_notifiers[table_ndx].push_back(this);
     }
     return false;
 }
 
-void ObjectNotifier::run()
+void ObjectNotifier::match_observed_rows(size_t table_ndx, CollectionChangeBuilder const& change)
+{
+    auto it = m_info->object_notifiers.find(table_ndx);
+    if (it == m_info->object_notifiers.end()) {
+        m_row_modified = change.modifications.contains(m_row->get_index());
+        return;
+    }
+
+    // Match every notifier observing this table in one pass, walking
+    // whichever side is smaller: with few modified rows each is probed
+    // against a hash of the observed rows, and with few observed rows each
+    // is looked up in the modification set directly.
+    auto& notifiers = it->second;
+    if (change.modifications.count() < notifiers.size()) {
+        std::unordered_multimap<size_t, ObjectNotifier*> observed;
+        observed.reserve(notifiers.size());
+        for (auto notifier : notifiers) {
+            notifier->m_row_modified = false;
+            if (notifier->m_row && notifier->m_row->is_attached())
+                observed.emplace(notifier->m_row->get_index(), notifier);
+        }
+        for (auto row_ndx : change.modifications.as_indexes()) {
+            auto matches = observed.equal_range(row_ndx);
+            for (auto match = matches.first; match != matches.second; ++match)
+                match->second->m_row_modified = true;
+        }
+    }
+    else {
+        for (auto notifier : notifiers) {
+            notifier->m_row_modified = notifier->m_row && notifier->m_row->is_attached()
+                                    && change.modifications.contains(notifier->m_row->get_index());
+        }
+    }
+
+    // A notifier is only absent from the list if its row was detached when
+    // interest was registered, but don't rely on that for this one as we're
+    // about to read the result
+    if (!m_row_modified)
+        m_row_modified = change.modifications.contains(m_row->get_index());
+}
+
+void ObjectNotifier::do_run()
 {
     if (!m_row)
         return;
@@ -81,13 +131,23 @@ void ObjectNotifier::run()
     if (table_ndx >= m_info->tables.size())
         return;
     auto& change = m_info->tables[table_ndx];
-    if (!change.modifications.contains(m_row->get_index()))
+    size_t row_ndx = m_row->get_index();
+    if (!m_row_modified)
+        match_observed_rows(table_ndx, change);
+    if (!*m_row_modified)
+        return;
+    // When every callback observes an explicit set of columns, suppress the
+    // notification if none of those columns were modified
+    auto& filtered = filtered_columns();
+    if (filtered && std::none_of(begin(*filtered), end(*filtered), [&](auto col) {
+            return col < change.columns.size() && change.columns[col].contains(row_ndx);
+        }))
         return;
     m_change.modifications.add(0);
     m_change.columns.reserve(change.columns.size());
     for (auto& col : change.columns) {
         m_change.columns.emplace_back();
-        if (col.contains(m_row->get_index()))
+        if (col.contains(row_ndx))
             m_change.columns.back().add(0);
     }
 }
@@ -37,7 +37,14 @@ private:
     CollectionChangeBuilder m_change;
     TransactionChangeInfo* m_info;
 
-    void run() override;
+    // Whether this notifier's row was modified, as computed by the shared
+    // per-table matching pass. Disengaged until the pass has run; the first
+    // notifier for the table to run performs the pass for all of them.
+    util::Optional<bool> m_row_modified;
+
+    void match_observed_rows(size_t table_ndx, CollectionChangeBuilder const& change);
+
+    void do_run() override;
 
     void do_prepare_handover(SharedGroup&) override;
 
@@ -19,13 +19,19 @@
 #include "impl/realm_coordinator.hpp"
 
 #include "impl/collection_notifier.hpp"
+#include "impl/commit_metadata.hpp"
 #include "impl/external_commit_helper.hpp"
+#include "impl/in_process_commit_helper.hpp"
+#include "impl/schema_cache.hpp"
 #include "impl/transact_log_handler.hpp"
 #include "impl/weak_realm_notifier.hpp"
 #include "binding_context.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
 #include "schema.hpp"
+#include "util/event_loop_signal.hpp"
+#include "util/format.hpp"
+#include "util/tracing.hpp"
 
 #if REALM_ENABLE_SYNC
 #include "sync/sync_config.hpp"
@@ -36,21 +42,50 @@
 #include <realm/group_shared.hpp>
 #include <realm/lang_bind_helper.hpp>
 #include <realm/string_data.hpp>
+#include <realm/util/file.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <unordered_map>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace realm;
 using namespace realm::_impl;
 
-static auto& s_coordinator_mutex = *new std::mutex;
-static auto& s_coordinators_per_path = *new std::unordered_map<std::string, std::weak_ptr<RealmCoordinator>>;
+// The coordinator registry is sharded by a hash of the path so that opening
+// Realms at different paths from many threads doesn't all serialize on a
+// single global mutex
+namespace {
+struct CoordinatorRegistryShard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<RealmCoordinator>> coordinators_per_path;
+};
+constexpr size_t c_coordinator_shard_count = 16;
+} // anonymous namespace
+static auto& s_coordinator_shards = *new std::array<CoordinatorRegistryShard, c_coordinator_shard_count>;
+
+static CoordinatorRegistryShard& shard_for_path(StringData path)
+{
+    size_t hash = std::hash<std::string>()(path);
+    return s_coordinator_shards[hash % c_coordinator_shard_count];
+}
 
 std::shared_ptr<RealmCoordinator> RealmCoordinator::get_coordinator(StringData path)
 {
-    std::lock_guard<std::mutex> lock(s_coordinator_mutex);
+    auto& shard = shard_for_path(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    auto& weak_coordinator = s_coordinators_per_path[path];
+    auto& weak_coordinator = shard.coordinators_per_path[path];
     if (auto coordinator = weak_coordinator.lock()) {
         return coordinator;
     }
@@ -70,9 +105,10 @@ std::shared_ptr<RealmCoordinator> RealmCoordinator::get_coordinator(const Realm:
 
 std::shared_ptr<RealmCoordinator> RealmCoordinator::get_existing_coordinator(StringData path)
 {
-    std::lock_guard<std::mutex> lock(s_coordinator_mutex);
-    auto it = s_coordinators_per_path.find(path);
-    return it == s_coordinators_per_path.end() ? nullptr : it->second.lock();
+    auto& shard = shard_for_path(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.coordinators_per_path.find(path);
+    return it == shard.coordinators_per_path.end() ? nullptr : it->second.lock();
 }
 
 void RealmCoordinator::create_sync_session()
@@ -81,17 +117,17 @@ void RealmCoordinator::create_sync_session()
     if (m_sync_session)
         return;
 
-    if (!m_config.encryption_key.empty() && !m_config.sync_config->realm_encryption_key) {
+    if (!m_config->encryption_key.empty() && !m_config->sync_config->realm_encryption_key) {
         throw std::logic_error("A realm encryption key was specified in Realm::Config but not in SyncConfig");
-    } else if (m_config.sync_config->realm_encryption_key && m_config.encryption_key.empty()) {
+    } else if (m_config->sync_config->realm_encryption_key && m_config->encryption_key.empty()) {
         throw std::logic_error("A realm encryption key was specified in SyncConfig but not in Realm::Config");
-    } else if (m_config.sync_config->realm_encryption_key &&
-               !std::equal(m_config.sync_config->realm_encryption_key->begin(), m_config.sync_config->realm_encryption_key->end(),
-                           m_config.encryption_key.begin(), m_config.encryption_key.end())) {
+    } else if (m_config->sync_config->realm_encryption_key &&
+               !std::equal(m_config->sync_config->realm_encryption_key->begin(), m_config->sync_config->realm_encryption_key->end(),
+                           m_config->encryption_key.begin(), m_config->encryption_key.end())) {
         throw std::logic_error("The realm encryption key specified in SyncConfig does not match the one in Realm::Config");
     }
 
-    m_sync_session = SyncManager::shared().get_session(m_config.path, *m_config.sync_config);
+    m_sync_session = SyncManager::shared().get_session(m_config->path, *m_config->sync_config);
 
     std::weak_ptr<RealmCoordinator> weak_self = shared_from_this();
     SyncSession::Internal::set_sync_transact_callback(*m_sync_session,
@@ -103,8 +139,8 @@ void RealmCoordinator::create_sync_session()
                 self->m_notifier->notify_others();
         }
     });
-    if (m_config.sync_config->error_handler) {
-        SyncSession::Internal::set_error_handler(*m_sync_session, m_config.sync_config->error_handler);
+    if (m_config->sync_config->error_handler) {
+        SyncSession::Internal::set_error_handler(*m_sync_session, m_config->sync_config->error_handler);
     }
 #endif
 }
@@ -133,41 +169,46 @@ void RealmCoordinator::set_config(const Realm::Config& config)
     bool no_existing_realm = std::all_of(begin(m_weak_realm_notifiers), end(m_weak_realm_notifiers),
                                          [](auto& notifier) { return notifier.expired(); });
     if (no_existing_realm) {
-        m_config = config;
+        m_config = std::make_shared<const Realm::Config>(config);
     }
     else {
-        if (m_config.read_only() != config.read_only()) {
+        if (m_config->read_only() != config.read_only()) {
             throw MismatchedConfigException("Realm at path '%1' already opened with different read permissions.", config.path);
         }
-        if (m_config.in_memory != config.in_memory) {
+        if (m_config->in_memory != config.in_memory) {
             throw MismatchedConfigException("Realm at path '%1' already opened with different inMemory settings.", config.path);
         }
-        if (m_config.encryption_key != config.encryption_key) {
+        if (m_config->encryption_key != config.encryption_key) {
             throw MismatchedConfigException("Realm at path '%1' already opened with a different encryption key.", config.path);
         }
-        if (m_config.schema_mode != config.schema_mode) {
+        if (m_config->schema_mode != config.schema_mode) {
             throw MismatchedConfigException("Realm at path '%1' already opened with a different schema mode.", config.path);
         }
+        // The durability of the SharedGroup is fixed when the file is first
+        // opened, so all instances must agree on whether commits sync
+        if (m_config->group_commit_enabled() != config.group_commit_enabled()) {
+            throw MismatchedConfigException("Realm at path '%1' already opened with different group commit settings.", config.path);
+        }
         if (config.schema && m_schema_version != ObjectStore::NotVersioned && m_schema_version != config.schema_version) {
             throw MismatchedConfigException("Realm at path '%1' already opened with different schema version.", config.path);
         }
 
 #if REALM_ENABLE_SYNC
-        if (bool(m_config.sync_config) != bool(config.sync_config)) {
+        if (bool(m_config->sync_config) != bool(config.sync_config)) {
             throw MismatchedConfigException("Realm at path '%1' already opened with different sync configurations.", config.path);
         }
 
         if (config.sync_config) {
-            if (m_config.sync_config->user != config.sync_config->user) {
+            if (m_config->sync_config->user != config.sync_config->user) {
                 throw MismatchedConfigException("Realm at path '%1' already opened with different sync user.", config.path);
             }
-            if (m_config.sync_config->realm_url != config.sync_config->realm_url) {
+            if (m_config->sync_config->realm_url != config.sync_config->realm_url) {
                 throw MismatchedConfigException("Realm at path '%1' already opened with different sync server URL.", config.path);
             }
-            if (m_config.sync_config->transformer != config.sync_config->transformer) {
+            if (m_config->sync_config->transformer != config.sync_config->transformer) {
                 throw MismatchedConfigException("Realm at path '%1' already opened with different transformer.", config.path);
             }
-            if (m_config.sync_config->realm_encryption_key != config.sync_config->realm_encryption_key) {
+            if (m_config->sync_config->realm_encryption_key != config.sync_config->realm_encryption_key) {
                 throw MismatchedConfigException("Realm at path '%1' already opened with sync session encryption key.", config.path);
             }
         }
@@ -223,15 +264,25 @@ std::shared_ptr<Realm> RealmCoordinator::get_realm(Realm::Config config)
 
     if (!realm) {
         realm = Realm::make_shared_realm(std::move(config), shared_from_this());
-        if (!config.read_only() && !m_notifier && config.automatic_change_notifications) {
-            try {
-                m_notifier = std::make_unique<ExternalCommitHelper>(*this);
+        if (!config.read_only() && !m_notifier && !m_in_process_notifier && config.automatic_change_notifications) {
+            if (config.in_memory) {
+                // In-memory Realms are only ever written from within this
+                // process, so commits can be signalled directly rather than
+                // through the cross-process listening machinery and the file
+                // descriptors it needs
+                m_in_process_notifier = std::make_unique<InProcessCommitHelper>(*this);
             }
-            catch (std::system_error const& ex) {
-                throw RealmFileException(RealmFileException::Kind::AccessError, get_path(), ex.code().message(), "");
+            else {
+                try {
+                    m_notifier = std::make_unique<ExternalCommitHelper>(*this);
+                }
+                catch (std::system_error const& ex) {
+                    throw RealmFileException(RealmFileException::Kind::AccessError, get_path(), ex.code().message(), "");
+                }
             }
         }
-        m_weak_realm_notifiers.emplace_back(realm, m_config.cache);
+        m_weak_realm_notifiers.emplace_back(realm, m_config->cache);
+        warm_file_cache();
     }
 
     if (schema) {
@@ -244,7 +295,127 @@ std::shared_ptr<Realm> RealmCoordinator::get_realm(Realm::Config config)
 
 std::shared_ptr<Realm> RealmCoordinator::get_realm()
 {
-    return get_realm(m_config);
+    return get_realm(*m_config);
+}
+
+namespace {
+// Shared state for get_realm_async(). This keeps the coordinator (and with
+// it the work done by the background open: the initialized file, performed
+// migration and warm schema cache) alive until delivery, and owns the signal
+// used to hop back to the calling thread. The signal's callback holds a
+// reference to this state and the state holds the signal, a cycle which the
+// delivery callback breaks once it has run.
+struct AsyncOpenState {
+    std::shared_ptr<RealmCoordinator> coordinator;
+    Realm::Config config;
+    std::function<void(std::shared_ptr<Realm>, std::exception_ptr)> callback;
+    std::exception_ptr error;
+    std::shared_ptr<void> signal;
+};
+
+struct AsyncOpenDeliverer {
+    std::shared_ptr<AsyncOpenState> state;
+
+    void operator()() const
+    {
+        // Releasing the signal destroys this functor, so move everything
+        // needed onto the stack first and touch only locals afterwards
+        auto local = state;
+        local->signal.reset();
+
+        std::shared_ptr<Realm> realm;
+        auto error = local->error;
+        if (!error) {
+            try {
+                realm = local->coordinator->get_realm(std::move(local->config));
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        }
+        local->callback(std::move(realm), error);
+    }
+};
+} // anonymous namespace
+
+void RealmCoordinator::get_realm_async(Realm::Config config,
+                                       std::function<void(std::shared_ptr<Realm>, std::exception_ptr)> callback)
+{
+    auto state = std::make_shared<AsyncOpenState>();
+    state->coordinator = shared_from_this();
+    state->config = config;
+    state->callback = std::move(callback);
+    // The signal has to be created on the calling thread so that delivery
+    // happens on this thread's event loop
+    state->signal = std::make_shared<util::EventLoopSignal<AsyncOpenDeliverer>>(AsyncOpenDeliverer{state});
+
+    // The slow work is done with a Realm instance private to the background
+    // thread rather than the one which will be delivered, as Realm instances
+    // are confined to the thread which opened them. The config's schema is
+    // kept so that the migration runs on the background thread, and by the
+    // time the delivery callback opens the caller's instance the only work
+    // left is constructing the (cached) object.
+    config.execution_context = util::none;
+    config.cache = false;
+    std::thread([state, config = std::move(config)]() mutable {
+        try {
+            auto realm = state->coordinator->get_realm(std::move(config));
+            state->coordinator->wait_for_initial_download();
+        }
+        catch (...) {
+            state->error = std::current_exception();
+        }
+        // Hold a strong reference over notify() so that the delivery
+        // callback releasing the state doesn't tear the signal out from
+        // under us
+        auto signal = std::static_pointer_cast<util::EventLoopSignal<AsyncOpenDeliverer>>(state->signal);
+        signal->notify();
+    }).detach();
+}
+
+void RealmCoordinator::wait_for_initial_download()
+{
+#if REALM_ENABLE_SYNC
+    std::shared_ptr<SyncSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_realm_mutex);
+        session = m_sync_session;
+    }
+    if (!session)
+        return;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool complete = false;
+    std::error_code error;
+    bool waiting = session->wait_for_download_completion([&](std::error_code ec) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = ec;
+        complete = true;
+        cv.notify_one();
+    });
+    if (!waiting)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return complete; });
+    if (error)
+        throw std::system_error(error);
+#endif
+}
+
+std::shared_ptr<Realm> RealmCoordinator::get_cached_realm(AnyExecutionContextID execution_context) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_realm_mutex);
+    for (auto& cached_realm : m_weak_realm_notifiers) {
+        if (!cached_realm.is_cached_for_execution_context(execution_context))
+            continue;
+        // can be null if we jumped in between ref count hitting zero and
+        // unregister_realm() getting the lock
+        if (auto realm = cached_realm.realm())
+            return realm;
+    }
+    return nullptr;
 }
 
 bool RealmCoordinator::get_cached_schema(Schema& schema, uint64_t& schema_version,
@@ -259,6 +430,52 @@ bool RealmCoordinator::get_cached_schema(Schema& schema, uint64_t& schema_versio
     return true;
 }
 
+bool RealmCoordinator::get_cached_schema_for_version(uint64_t version, Schema& schema) const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_schema_cache_mutex);
+    if (!m_cached_schema || version < m_schema_transaction_version_min || version > m_schema_transaction_version_max)
+        return false;
+    schema = *m_cached_schema;
+    return true;
+}
+
+bool RealmCoordinator::load_cached_schema(uint64_t version, uint64_t schema_version, Schema& schema)
+{
+    std::lock_guard<std::mutex> lock(m_schema_cache_mutex);
+    if (m_cached_schema) {
+        if (version < m_schema_transaction_version_min || version > m_schema_transaction_version_max)
+            return false;
+        schema = *m_cached_schema;
+        return true;
+    }
+
+    // The schema cache file would be both unprotected and visible to anyone
+    // inspecting the directory, so don't use it for encrypted files
+    if (m_config->in_memory || !m_config->encryption_key.empty())
+        return false;
+
+    uint64_t cached_schema_version = 0;
+    auto cached = schema_cache::load(schema_cache::path_for_realm(m_config->path),
+                                     version, cached_schema_version);
+    if (!cached || cached_schema_version != schema_version)
+        return false;
+
+    m_cached_schema = std::move(cached);
+    m_schema_version = schema_version;
+    m_schema_transaction_version_min = version;
+    m_schema_transaction_version_max = version;
+    schema = *m_cached_schema;
+    return true;
+}
+
+bool RealmCoordinator::schema_unchanged_between(uint64_t begin_version, uint64_t end_version) const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_schema_cache_mutex);
+    return m_cached_schema
+        && begin_version >= m_schema_transaction_version_min
+        && end_version <= m_schema_transaction_version_max;
+}
+
 void RealmCoordinator::cache_schema(Schema const& new_schema, uint64_t new_schema_version,
                                     uint64_t transaction_version)
 {
@@ -279,6 +496,11 @@ void RealmCoordinator::clear_schema_cache_and_set_schema_version(uint64_t new_sc
     std::lock_guard<std::mutex> lock(m_schema_cache_mutex);
     m_cached_schema = util::none;
     m_schema_version = new_schema_version;
+    // The file itself is being deleted or replaced, so a new file at this
+    // path must not pick up the old file's persisted schema or its commit
+    // metadata, whose version numbers will be reused by the new file
+    schema_cache::remove(schema_cache::path_for_realm(m_config->path));
+    CommitMetadata::remove(m_config->path);
 }
 
 void RealmCoordinator::advance_schema_cache(uint64_t previous, uint64_t next)
@@ -297,10 +519,41 @@ RealmCoordinator::RealmCoordinator() = default;
 
 RealmCoordinator::~RealmCoordinator()
 {
-    std::lock_guard<std::mutex> coordinator_lock(s_coordinator_mutex);
-    for (auto it = s_coordinators_per_path.begin(); it != s_coordinators_per_path.end(); ) {
+    m_file_warm_stop = true;
+    if (m_file_warm_thread.joinable())
+        m_file_warm_thread.join();
+
+    stop_worker_threads();
+
+    // Make any commits which group commit was still batching durable before
+    // the file is abandoned. Best-effort only as destructors can't report
+    // failure.
+    if (m_unsynced_commits) {
+        try {
+            sync_group_commits();
+        }
+        catch (...) {
+        }
+    }
+
+    if (m_config->compact_on_close_bytes && !m_config->in_memory && !m_config->read_only())
+        compact_on_close();
+
+    // Persist the schema so that the next open of this file can skip reading
+    // it from the Group if no commits have been made in between
+    if (!m_config->in_memory && m_config->encryption_key.empty()) {
+        std::lock_guard<std::mutex> lock(m_schema_cache_mutex);
+        if (m_cached_schema) {
+            schema_cache::write(schema_cache::path_for_realm(m_config->path), *m_cached_schema,
+                                m_schema_version, m_schema_transaction_version_max);
+        }
+    }
+
+    auto& shard = shard_for_path(m_config->path);
+    std::lock_guard<std::mutex> coordinator_lock(shard.mutex);
+    for (auto it = shard.coordinators_per_path.begin(); it != shard.coordinators_per_path.end(); ) {
         if (it->second.expired()) {
-            it = s_coordinators_per_path.erase(it);
+            it = shard.coordinators_per_path.erase(it);
         }
         else {
             ++it;
@@ -308,6 +561,54 @@ RealmCoordinator::~RealmCoordinator()
     }
 }
 
+void RealmCoordinator::compact_on_close() noexcept
+{
+#if !WIN32
+    // Release everything of ours which still has the file open so that it
+    // doesn't block the compaction
+    m_notifier = nullptr;
+    m_notifier_sg_pool.clear();
+    m_notifier_sg = nullptr;
+    m_notifier_history = nullptr;
+    m_advancer_sg = nullptr;
+    m_advancer_history = nullptr;
+
+    try {
+        // open_with_config() evaluates the launch compaction hook, which
+        // was already run when the file was opened and needs a Realm
+        // instance anyway
+        auto config = *m_config;
+        config.should_compact_on_launch_function = nullptr;
+
+        std::unique_ptr<Replication> history;
+        std::unique_ptr<SharedGroup> sg;
+        std::unique_ptr<Group> read_only_group;
+        Realm::open_with_config(config, history, sg, read_only_group, nullptr);
+
+        // Getting stats requires committing a write transaction beforehand,
+        // and the write lock being unavailable means someone else has the
+        // file open and compaction would fail anyway
+        size_t free_space = -1;
+        size_t used_space = -1;
+        Group* group = nullptr;
+        if (!sg->try_begin_write(group))
+            return;
+        sg->commit();
+        sg->get_stats(free_space, used_space);
+
+        uint64_t file_size = free_space + used_space;
+        if (file_size > m_config->compact_on_close_bytes
+            && double(used_space) < m_config->compact_on_close_utilization * double(file_size)) {
+            sg->compact();
+        }
+    }
+    catch (...) {
+        // Compaction on close is strictly best-effort; the next open works
+        // regardless of whether it happened
+    }
+#endif
+}
+
 void RealmCoordinator::unregister_realm(Realm* realm)
 {
     std::lock_guard<std::mutex> lock(m_realm_mutex);
@@ -319,16 +620,17 @@ void RealmCoordinator::unregister_realm(Realm* realm)
 void RealmCoordinator::clear_cache()
 {
     std::vector<WeakRealm> realms_to_close;
-    {
-        std::lock_guard<std::mutex> lock(s_coordinator_mutex);
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        for (auto& weak_coordinator : s_coordinators_per_path) {
+        for (auto& weak_coordinator : shard.coordinators_per_path) {
             auto coordinator = weak_coordinator.second.lock();
             if (!coordinator) {
                 continue;
             }
 
             coordinator->m_notifier = nullptr;
+            coordinator->m_in_process_notifier = nullptr;
 
             // Gather a list of all of the realms which will be removed
             for (auto& weak_realm_notifier : coordinator->m_weak_realm_notifiers) {
@@ -338,7 +640,7 @@ void RealmCoordinator::clear_cache()
             }
         }
 
-        s_coordinators_per_path.clear();
+        shard.coordinators_per_path.clear();
     }
 
     // Close all of the previously cached Realms. This can't be done while
@@ -353,9 +655,9 @@ void RealmCoordinator::clear_cache()
 void RealmCoordinator::clear_all_caches()
 {
     std::vector<std::weak_ptr<RealmCoordinator>> to_clear;
-    {
-        std::lock_guard<std::mutex> lock(s_coordinator_mutex);
-        for (auto iter : s_coordinators_per_path) {
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& iter : shard.coordinators_per_path) {
             to_clear.push_back(iter.second);
         }
     }
@@ -369,14 +671,61 @@ void RealmCoordinator::clear_all_caches()
 void RealmCoordinator::assert_no_open_realms() noexcept
 {
 #ifdef REALM_DEBUG
-    std::lock_guard<std::mutex> lock(s_coordinator_mutex);
-    REALM_ASSERT(s_coordinators_per_path.empty());
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        REALM_ASSERT(shard.coordinators_per_path.empty());
+    }
 #endif
 }
 
+void RealmCoordinator::warm_file_cache()
+{
+    using WarmStrategy = Realm::Config::WarmStrategy;
+    if (m_file_warm_started || m_config->in_memory || m_config->warm_strategy == WarmStrategy::None)
+        return;
+    m_file_warm_started = true;
+
+    if (m_config->warm_strategy == WarmStrategy::Advise) {
+        // Just a hint, so failing to deliver it is not an error
+#ifndef _WIN32
+        int fd = ::open(m_config->path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+#if REALM_PLATFORM_APPLE
+            struct stat info;
+            if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+                radvisory advice;
+                advice.ra_offset = 0;
+                advice.ra_count = int(std::min<off_t>(info.st_size, std::numeric_limits<int>::max()));
+                ::fcntl(fd, F_RDADVISE, &advice);
+            }
+#elif defined(POSIX_FADV_WILLNEED)
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+            ::close(fd);
+        }
+#endif
+        return;
+    }
+
+    m_file_warm_thread = std::thread([this, config = m_config] {
+        // Reading the file sequentially through a second descriptor pulls
+        // its pages into the same OS page cache that core's mapping of the
+        // file faults from, without needing access to the mapping itself
+        std::ifstream file(config->path, std::ios::binary);
+        if (!file.is_open())
+            return;
+        std::vector<char> buffer(1024 * 1024);
+        while (!m_file_warm_stop && file.read(buffer.data(), std::streamsize(buffer.size()))) {
+        }
+    });
+}
+
 void RealmCoordinator::wake_up_notifier_worker()
 {
-    if (m_notifier) {
+    if (m_in_process_notifier) {
+        m_in_process_notifier->notify_others();
+    }
+    else if (m_notifier) {
         // FIXME: this wakes up the notification workers for all processes and
         // not just us. This might be worth optimizing in the future.
         m_notifier->notify_others();
@@ -385,7 +734,7 @@ void RealmCoordinator::wake_up_notifier_worker()
 
 void RealmCoordinator::commit_write(Realm& realm)
 {
-    REALM_ASSERT(!m_config.read_only());
+    REALM_ASSERT(!m_config->read_only());
     REALM_ASSERT(realm.is_in_transaction());
 
     {
@@ -394,7 +743,10 @@ void RealmCoordinator::commit_write(Realm& realm)
         // skip version
         std::lock_guard<std::mutex> l(m_notifier_mutex);
 
+        if (m_config->publish_commit_metadata)
+            begin_commit_metadata();
         transaction::commit(*Realm::Internal::get_shared_group(realm));
+        did_end_write();
 
         // Don't need to check m_new_notifiers because those don't skip versions
         bool have_notifiers = std::any_of(m_notifiers.begin(), m_notifiers.end(),
@@ -402,8 +754,14 @@ void RealmCoordinator::commit_write(Realm& realm)
         if (have_notifiers) {
             m_notifier_skip_version = Realm::Internal::get_shared_group(realm)->get_version_of_current_transaction();
         }
+
+        if (m_metadata_sg_ready)
+            publish_commit_metadata();
     }
 
+    if (m_config->group_commit_enabled())
+        did_commit_without_sync();
+
 #if REALM_ENABLE_SYNC
     // Realm could be closed in did_change. So send sync notification first before did_change.
     if (m_sync_session) {
@@ -416,14 +774,130 @@ void RealmCoordinator::commit_write(Realm& realm)
         realm.m_binding_context->did_change({}, {});
     }
 
-    if (m_notifier) {
+    if (m_in_process_notifier) {
+        m_in_process_notifier->notify_others();
+    }
+    else if (m_notifier) {
         m_notifier->notify_others();
     }
 }
 
+void RealmCoordinator::did_commit_without_sync()
+{
+    std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+    ++m_unsynced_commits;
+    if (m_config->group_commit_max_commits && m_unsynced_commits >= m_config->group_commit_max_commits) {
+        sync_group_commits();
+        return;
+    }
+    if (m_config->group_commit_interval_ms) {
+        auto elapsed = std::chrono::steady_clock::now() - m_last_group_commit_sync;
+        if (elapsed >= std::chrono::milliseconds(m_config->group_commit_interval_ms))
+            sync_group_commits();
+    }
+}
+
+void RealmCoordinator::sync_pending_commits()
+{
+    if (!m_config->group_commit_enabled())
+        return;
+    std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+    if (m_unsynced_commits)
+        sync_group_commits();
+}
+
+void RealmCoordinator::sync_group_commits()
+{
+    // The commits were performed through the SharedGroup's mappings, but
+    // syncing via a separate descriptor still flushes them as the dirty
+    // pages belong to the file and not the mapping
+    util::File(m_config->path, util::File::mode_Update).sync();
+    m_unsynced_commits = 0;
+    m_last_group_commit_sync = std::chrono::steady_clock::now();
+}
+
+void RealmCoordinator::open_commit_metadata()
+{
+    if (m_commit_metadata_opened || m_config->in_memory)
+        return;
+    m_commit_metadata_opened = true;
+    m_commit_metadata = CommitMetadata::open(m_config->path, m_config->publish_commit_metadata);
+}
+
+void RealmCoordinator::begin_commit_metadata()
+{
+    // The committing transaction still holds the write lock, so no other
+    // commit can land between here and the commit itself and beginning a
+    // read transaction now pins the metadata SharedGroup at exactly the
+    // version the commit is based on
+    m_metadata_sg_ready = false;
+    if (m_config->in_memory)
+        return;
+    try {
+        open_commit_metadata();
+        if (!m_commit_metadata)
+            return;
+        if (!m_metadata_sg) {
+            std::unique_ptr<Group> read_only_group;
+            Realm::open_with_config(*m_config, m_metadata_history, m_metadata_sg, read_only_group, nullptr);
+            REALM_ASSERT(!read_only_group);
+        }
+        m_metadata_sg->begin_read();
+        m_metadata_sg_ready = true;
+    }
+    catch (...) {
+        // The metadata is strictly an optimization: readers parse the
+        // transact log as usual for any commit without a record
+        m_metadata_sg = nullptr;
+        m_metadata_history = nullptr;
+    }
+}
+
+void RealmCoordinator::publish_commit_metadata()
+{
+    m_metadata_sg_ready = false;
+    try {
+        // The parsed span begins with the commit just made, but can extend
+        // past it if another process managed to commit after ours; the
+        // union mask is then published for every version in the span, which
+        // merely overstates what those commits modified
+        auto begin = m_metadata_sg->get_version_of_current_transaction().version;
+        uint64_t mask = 0;
+        transaction::advance(*m_metadata_sg, mask);
+        auto end = m_metadata_sg->get_version_of_current_transaction().version;
+        m_metadata_sg->end_read();
+        for (auto version = begin + 1; version <= end; ++version)
+            m_commit_metadata->publish(version, mask);
+    }
+    catch (...) {
+        m_metadata_sg = nullptr;
+        m_metadata_history = nullptr;
+    }
+}
+
+bool RealmCoordinator::can_skip_transact_log_parse(TransactionChangeInfo const& info, VersionID version)
+{
+    if (!m_commit_metadata || info.track_all)
+        return false;
+    if (!m_notifier_sg || m_notifier_sg->get_transact_stage() != SharedGroup::transact_Reading)
+        return false;
+    auto begin = m_notifier_sg->get_version_of_current_transaction().version;
+    if (version.version <= begin)
+        return false;
+
+    uint64_t interest = 0;
+    for (size_t i = 0; i < info.table_modifications_needed.size(); ++i) {
+        if (info.table_modifications_needed[i])
+            interest |= CommitMetadata::table_bit(i);
+    }
+    for (auto& list : info.lists)
+        interest |= CommitMetadata::table_bit(list.table_ndx);
+    return interest && m_commit_metadata->no_changes_for(begin, version.version, interest);
+}
+
 void RealmCoordinator::pin_version(VersionID versionid)
 {
-    REALM_ASSERT_DEBUG(!m_notifier_mutex.try_lock());
+    REALM_ASSERT_DEBUG(!m_new_notifier_mutex.try_lock());
     if (m_async_error) {
         return;
     }
@@ -431,7 +905,7 @@ void RealmCoordinator::pin_version(VersionID versionid)
     if (!m_advancer_sg) {
         try {
             std::unique_ptr<Group> read_only_group;
-            Realm::open_with_config(m_config, m_advancer_history, m_advancer_sg, read_only_group, nullptr);
+            Realm::open_with_config(*m_config, m_advancer_history, m_advancer_sg, read_only_group, nullptr);
             REALM_ASSERT(!read_only_group);
             m_advancer_sg->begin_read(versionid);
         }
@@ -457,12 +931,213 @@ void RealmCoordinator::pin_version(VersionID versionid)
     }
 }
 
+void RealmCoordinator::queue_async_write(std::function<void(std::shared_ptr<Realm>)> fn)
+{
+    std::lock_guard<std::mutex> lock(m_async_write_mutex);
+    m_async_write_queue.push_back(std::move(fn));
+    if (!m_async_write_thread_running) {
+        m_async_write_thread_running = true;
+        // The thread owns a strong reference to the coordinator so that the
+        // file stays open until all of the queued writes have been performed,
+        // and is detached so that the coordinator being released on it once
+        // that reference is dropped doesn't try to join the thread with itself
+        std::thread([self = shared_from_this()] { self->async_write_loop(); }).detach();
+    }
+}
+
+void RealmCoordinator::async_write_loop()
+{
+    std::unique_lock<std::mutex> lock(m_async_write_mutex);
+    while (!m_async_write_queue.empty()) {
+        auto fn = std::move(m_async_write_queue.front());
+        m_async_write_queue.erase(m_async_write_queue.begin());
+        lock.unlock();
+
+        // The Realm is opened fresh for each write rather than being cached
+        // so that this thread doesn't hold a read transaction open (and pin
+        // that version) while sitting idle between writes
+        auto config = *get_config();
+        config.execution_context = util::none;
+        config.cache = false;
+        // Open with the file's schema rather than the config's so that this
+        // still works after an update_schema_async() has moved the file past
+        // the schema version the file was originally opened with
+        config.schema = util::none;
+        auto realm = get_realm(std::move(config));
+        try {
+            realm->begin_transaction();
+            fn(realm);
+        }
+        catch (...) {
+            // Errors from committing are reported via async_commit()'s
+            // completion handler; a callback which throws before finishing
+            // the transaction gets it rolled back below
+        }
+        if (realm->is_in_transaction())
+            realm->cancel_transaction();
+
+        lock.lock();
+    }
+    m_async_write_thread_running = false;
+}
+
+void RealmCoordinator::close_async(std::unique_ptr<Replication> history,
+                                   std::unique_ptr<SharedGroup> shared_group,
+                                   std::function<void()> completion)
+{
+    // The thread owns a strong reference to the coordinator so that if this
+    // was the last open Realm for the file, the coordinator's own teardown
+    // (joining the notifier workers, compaction on close) also happens here
+    // rather than on the closing thread. It has to be detached for the same
+    // reason: the coordinator being released on it can't join it with itself.
+    std::thread([self = shared_from_this(), history = std::move(history),
+                 shared_group = std::move(shared_group), completion = std::move(completion)]() mutable {
+        // Destroyed in the same order as Realm's members: the SharedGroup's
+        // read transaction must be ended before its history goes away
+        shared_group = nullptr;
+        history = nullptr;
+        self = nullptr;
+        if (completion)
+            completion();
+    }).detach();
+}
+
+RealmCoordinator::PinnedVersionInfo RealmCoordinator::get_pinned_version_info()
+{
+    PinnedVersionInfo info;
+    std::lock_guard<std::mutex> lock(m_notifier_mutex);
+    std::lock_guard<std::mutex> new_notifier_lock(m_new_notifier_mutex);
+
+    using sgf = SharedGroupFriend;
+    uint_fast64_t latest = 0;
+    auto check = [&](SharedGroup* sg) {
+        if (!sg || sg->get_transact_stage() != SharedGroup::transact_Reading)
+            return;
+        auto version = sg->get_version_of_current_transaction();
+        if (!info.oldest_pinned_version.version || version < info.oldest_pinned_version)
+            info.oldest_pinned_version = version;
+        latest = std::max(latest, sgf::get_version_of_latest_snapshot(*sg));
+    };
+    check(m_notifier_sg.get());
+    check(m_advancer_sg.get());
+
+    if (latest > info.oldest_pinned_version.version)
+        info.version_lag = latest - info.oldest_pinned_version.version;
+
+    if (!m_config->in_memory) {
+        try {
+            util::File file(m_config->path, util::File::mode_Read);
+            info.file_size = static_cast<uint64_t>(file.get_size());
+        }
+        catch (util::File::AccessError const&) {
+            // Leave file_size at zero if the file can't be read
+        }
+    }
+    return info;
+}
+
+static size_t schema_heap_size(Schema const& schema)
+{
+    size_t size = schema.size() * sizeof(ObjectSchema);
+    for (auto& object_schema : schema) {
+        size += object_schema.name.capacity() + object_schema.primary_key.capacity();
+        size += (object_schema.persisted_properties.capacity()
+               + object_schema.computed_properties.capacity()) * sizeof(Property);
+        for (auto properties : {&object_schema.persisted_properties, &object_schema.computed_properties}) {
+            for (auto& property : *properties) {
+                size += property.name.capacity() + property.object_type.capacity()
+                      + property.link_origin_property_name.capacity();
+            }
+        }
+    }
+    return size;
+}
+
+RealmCoordinator::MemoryStats RealmCoordinator::get_memory_stats()
+{
+    MemoryStats stats;
+    stats.path = m_config->path;
+
+    auto pinned = get_pinned_version_info();
+    stats.file_size = pinned.file_size;
+    stats.version_lag = pinned.version_lag;
+
+    {
+        std::lock_guard<std::mutex> lock(m_notifier_mutex);
+        std::lock_guard<std::mutex> new_notifier_lock(m_new_notifier_mutex);
+        stats.notifier_count = m_notifiers.size() + m_new_notifiers.size();
+        for (auto& notifier : m_notifiers)
+            stats.notifier_retained_rows += notifier->retained_row_count();
+        for (auto& notifier : m_new_notifiers)
+            stats.notifier_retained_rows += notifier->retained_row_count();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_schema_cache_mutex);
+        if (m_cached_schema)
+            stats.schema_cache_size = schema_heap_size(*m_cached_schema);
+    }
+    return stats;
+}
+
+static void append_json_string(std::string& out, std::string const& str)
+{
+    out += '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        }
+        else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+std::string RealmCoordinator::get_memory_stats_json()
+{
+    // Collect strong references first so that no registry shard's mutex is
+    // held while gathering the stats, which take coordinator-level locks
+    std::vector<std::shared_ptr<RealmCoordinator>> coordinators;
+    for (auto& shard : s_coordinator_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& entry : shard.coordinators_per_path) {
+            if (auto coordinator = entry.second.lock())
+                coordinators.push_back(std::move(coordinator));
+        }
+    }
+
+    std::string json = "[";
+    for (auto& coordinator : coordinators) {
+        if (json.size() > 1)
+            json += ',';
+        auto stats = coordinator->get_memory_stats();
+        json += "{\"path\":";
+        append_json_string(json, stats.path);
+        json += util::format(",\"file_size\":%1,\"version_lag\":%2,\"notifier_count\":%3"
+                             ",\"notifier_retained_rows\":%4,\"schema_cache_size\":%5}",
+                             stats.file_size, stats.version_lag, stats.notifier_count,
+                             stats.notifier_retained_rows, stats.schema_cache_size);
+    }
+    json += ']';
+    return json;
+}
+
 void RealmCoordinator::register_notifier(std::shared_ptr<CollectionNotifier> notifier)
 {
     auto version = notifier->version();
     auto& self = Realm::Internal::get_coordinator(*notifier->get_realm());
     {
-        std::lock_guard<std::mutex> lock(self.m_notifier_mutex);
+        // Serializing on m_new_notifier_mutex rather than m_notifier_mutex
+        // means that this does not block while the worker thread is busy
+        // running the already-registered notifiers
+        std::lock_guard<std::mutex> lock(self.m_new_notifier_mutex);
         self.pin_version(version);
         self.m_new_notifiers.push_back(std::move(notifier));
     }
@@ -507,7 +1182,114 @@ void RealmCoordinator::clean_up_dead_notifiers()
     }
 }
 
+namespace {
+// Process-wide worker pool which runs coordinators' notifiers when
+// Config::use_shared_notifier_pool is enabled. Work for a single coordinator
+// is serialized: a coordinator is never run on two threads at once, and
+// signals which arrive while it is queued or running coalesce into a single
+// follow-up run, preserving the ordering that running inline on the commit
+// listener thread provides.
+class SharedNotifierPool {
+public:
+    static SharedNotifierPool& shared()
+    {
+        static SharedNotifierPool pool;
+        return pool;
+    }
+
+    void enqueue(std::shared_ptr<RealmCoordinator> coordinator)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_scheduled.find(coordinator.get());
+        if (it != m_scheduled.end()) {
+            // Already queued or running; just ask for another run afterwards
+            it->second = true;
+            return;
+        }
+        m_scheduled.emplace(coordinator.get(), false);
+        m_queue.push_back(std::move(coordinator));
+
+        // Start a thread per scheduled coordinator up to the core count; more
+        // than that can't help, as runs for a single coordinator never overlap
+        size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        if (m_threads.size() < std::min(m_queue.size() + m_running, max_threads))
+            m_threads.emplace_back(&SharedNotifierPool::worker, this);
+        m_cv.notify_one();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::shared_ptr<RealmCoordinator>> m_queue;
+    // Coordinators which are currently queued or running, and whether another
+    // signal has arrived for them since they were queued
+    std::unordered_map<const RealmCoordinator*, bool> m_scheduled;
+    std::vector<std::thread> m_threads;
+    size_t m_running = 0;
+    bool m_shutdown = false;
+
+    ~SharedNotifierPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        m_cv.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    void worker()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv.wait(lock, [&] { return m_shutdown || !m_queue.empty(); });
+            if (m_shutdown)
+                return;
+            auto coordinator = std::move(m_queue.front());
+            m_queue.erase(m_queue.begin());
+            ++m_running;
+            while (true) {
+                lock.unlock();
+                coordinator->run_pooled_notifiers();
+                lock.lock();
+                auto it = m_scheduled.find(coordinator.get());
+                if (!it->second) {
+                    m_scheduled.erase(it);
+                    break;
+                }
+                // Another commit arrived while we were running; go again
+                it->second = false;
+            }
+            --m_running;
+            // Drop the strong reference outside the lock, as it may be the
+            // last one and destroying a coordinator does real work
+            lock.unlock();
+            coordinator.reset();
+            lock.lock();
+        }
+    }
+};
+} // anonymous namespace
+
 void RealmCoordinator::on_change()
+{
+    util::trace::point(util::trace::Event::coordinator_on_change, this);
+    if (m_config->use_shared_notifier_pool) {
+        // Hand the work off to the process-wide pool so that this file's
+        // commit listener can get back to waiting for commits
+        SharedNotifierPool::shared().enqueue(shared_from_this());
+        return;
+    }
+    run_async_notifiers();
+
+    std::lock_guard<std::mutex> lock(m_realm_mutex);
+    for (auto& realm : m_weak_realm_notifiers) {
+        realm.notify();
+    }
+}
+
+void RealmCoordinator::run_pooled_notifiers()
 {
     run_async_notifiers();
 
@@ -556,6 +1338,7 @@ public:
             m_info.push_back({
                 m_current->table_modifications_needed,
                 m_current->table_moves_needed,
+                m_current->table_columns_needed,
                 std::move(m_current->lists)});
             m_current = &m_info.back();
             return true;
@@ -615,6 +1398,10 @@ private:
 void RealmCoordinator::run_async_notifiers()
 {
     std::unique_lock<std::mutex> lock(m_notifier_mutex);
+    // Only held while consuming the staged notifiers and using the advancer
+    // SharedGroup; released before the main notifier work so that new
+    // registrations aren't blocked behind it
+    std::unique_lock<std::mutex> new_notifier_lock(m_new_notifier_mutex);
 
     clean_up_dead_notifiers();
 
@@ -622,6 +1409,24 @@ void RealmCoordinator::run_async_notifiers()
         return;
     }
 
+    // Map the commit-metadata sidecar (if any) while the lock is held, so
+    // that it can be read without the lock when deciding whether the
+    // transact-log parse can be skipped below
+    open_commit_metadata();
+
+    // A burst of commits wakes up the worker once per commit, but the first
+    // pass advances the notifiers all the way to the newest version in a
+    // single transact-log pass which merges all of the pending versions'
+    // changes. If that's already happened there's nothing left to do for the
+    // remaining wake-ups, so check for that before doing any real work.
+    using sgf = SharedGroupFriend;
+    if (m_new_notifiers.empty() && !m_notifier_skip_version.version && m_notifier_sg
+        && m_notifier_sg->get_transact_stage() == SharedGroup::transact_Reading
+        && sgf::get_version_of_latest_snapshot(*m_notifier_sg)
+               == m_notifier_sg->get_version_of_current_transaction().version) {
+        return;
+    }
+
     if (!m_async_error) {
         open_helper_shared_group();
     }
@@ -636,53 +1441,104 @@ void RealmCoordinator::run_async_notifiers()
 
     // Advance all of the new notifiers to the most recent version, if any
     auto new_notifiers = std::move(m_new_notifiers);
-    IncrementalChangeInfo new_notifier_change_info(*m_advancer_sg, new_notifiers);
+    if (!new_notifiers.empty()) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> stats_lock(m_notifier_stats_mutex);
+        for (auto& notifier : new_notifiers) {
+            auto queued = std::chrono::duration_cast<std::chrono::microseconds>(now - notifier->created_at());
+            ++m_notifier_stats.notifiers_queued;
+            m_notifier_stats.total_queue_time += queued;
+            m_notifier_stats.max_queue_time = std::max(m_notifier_stats.max_queue_time, queued);
+        }
+    }
+    std::unique_ptr<IncrementalChangeInfo> new_notifier_change_info;
+    bool fold_new_notifiers = false;
 
     if (!new_notifiers.empty()) {
         REALM_ASSERT_3(m_advancer_sg->get_transact_stage(), ==, SharedGroup::transact_Reading);
+
+        auto min_version = (*std::min_element(new_notifiers.begin(), new_notifiers.end(),
+                                              [](auto&& lft, auto&& rgt) {
+                                                  return lft->version() < rgt->version();
+                                              }))->version();
         REALM_ASSERT_3(m_advancer_sg->get_version_of_current_transaction().version,
-                       <=, new_notifiers.front()->version().version);
-
-        // The advancer SG can be at an older version than the oldest new notifier
-        // if a notifier was added and then removed before it ever got the chance
-        // to run, as we don't move the pin forward when removing dead notifiers
-        transaction::advance(*m_advancer_sg, nullptr, new_notifiers.front()->version());
-
-        // Advance each of the new notifiers to the latest version, attaching them
-        // to the SG at their handover version. This requires a unique
-        // TransactionChangeInfo for each source version, so that things don't
-        // see changes from before the version they were handed over from.
-        // Each Info has all of the changes between that source version and the
-        // next source version, and they'll be merged together later after
-        // releasing the lock
-        for (auto& notifier : new_notifiers) {
-            new_notifier_change_info.advance_incremental(notifier->version());
-            notifier->attach_to(*m_advancer_sg);
-            notifier->add_required_change_info(new_notifier_change_info.current());
+                       <=, min_version.version);
+
+        // If the oldest new notifier lags the latest version by more than the
+        // configured limit, don't compute fine-grained changesets for the span
+        // it missed: walking a long transact-log span is what makes laggards
+        // expensive, and their first notification delivers the initial state
+        // anyway.
+        bool force_advance = false;
+        if (m_config->max_notifier_version_lag) {
+            auto lag = sgf::get_version_of_latest_snapshot(*m_advancer_sg) - min_version.version;
+            force_advance = lag > m_config->max_notifier_version_lag;
         }
-        new_notifier_change_info.advance_to_final(VersionID{});
 
-        for (auto& notifier : new_notifiers) {
-            notifier->detach();
+        // When every new notifier's handover version falls between the main
+        // SG's current version and the latest one, the new notifiers can be
+        // folded into the main incremental pass below rather than being
+        // advanced separately here, so that the span shared with the
+        // pre-existing notifiers is only processed once. The main SG's read
+        // transaction is at an older version than any of the handover
+        // versions, so it keeps them importable without the advancer's pin.
+        fold_new_notifiers = !force_advance && !m_notifier_skip_version.version
+                          && m_notifier_sg->get_transact_stage() == SharedGroup::transact_Reading
+                          && !(min_version < m_notifier_sg->get_version_of_current_transaction());
+        if (fold_new_notifiers) {
+            m_advancer_sg->end_read();
         }
+        else {
+            // The advancer SG can be at an older version than the oldest new notifier
+            // if a notifier was added and then removed before it ever got the chance
+            // to run, as we don't move the pin forward when removing dead notifiers
+            transaction::advance(*m_advancer_sg, nullptr, min_version);
+
+            // Advance each of the new notifiers to the latest version, attaching them
+            // to the SG at their handover version. This requires a unique
+            // TransactionChangeInfo for each source version, so that things don't
+            // see changes from before the version they were handed over from.
+            // Each Info has all of the changes between that source version and the
+            // next source version, and they'll be merged together later after
+            // releasing the lock
+            new_notifier_change_info = std::make_unique<IncrementalChangeInfo>(*m_advancer_sg, new_notifiers);
+            for (auto& notifier : new_notifiers) {
+                if (force_advance)
+                    transaction::advance(*m_advancer_sg, nullptr, notifier->version());
+                else
+                    new_notifier_change_info->advance_incremental(notifier->version());
+                notifier->attach_to(*m_advancer_sg);
+                if (!force_advance)
+                    notifier->add_required_change_info(new_notifier_change_info->current());
+            }
+            if (force_advance)
+                transaction::advance(*m_advancer_sg, nullptr, VersionID{});
+            else
+                new_notifier_change_info->advance_to_final(VersionID{});
 
-        // We want to advance the non-new notifiers to the same version as the
-        // new notifiers to avoid having to merge changes from any new
-        // transaction that happen immediately after this into the new notifier
-        // changes
-        version = m_advancer_sg->get_version_of_current_transaction();
-        m_advancer_sg->end_read();
+            for (auto& notifier : new_notifiers) {
+                notifier->detach();
+            }
+
+            // We want to advance the non-new notifiers to the same version as the
+            // new notifiers to avoid having to merge changes from any new
+            // transaction that happen immediately after this into the new notifier
+            // changes
+            version = m_advancer_sg->get_version_of_current_transaction();
+            m_advancer_sg->end_read();
+        }
     }
-    else {
-        // If we have no new notifiers we want to just advance to the latest
-        // version, but we have to pick a "latest" version while holding the
-        // notifier lock to avoid advancing over a transaction which should be
-        // skipped
+    if (new_notifiers.empty() || fold_new_notifiers) {
+        // If we're not advancing the new notifiers separately we want to just
+        // advance to the latest version, but we have to pick a "latest"
+        // version while holding the notifier lock to avoid advancing over a
+        // transaction which should be skipped
         m_advancer_sg->begin_read();
         version = m_advancer_sg->get_version_of_current_transaction();
         m_advancer_sg->end_read();
     }
     REALM_ASSERT_3(m_advancer_sg->get_transact_stage(), ==, SharedGroup::transact_Ready);
+    new_notifier_lock.unlock();
 
     auto skip_version = m_notifier_skip_version;
     m_notifier_skip_version = {0, 0};
@@ -701,34 +1557,63 @@ void RealmCoordinator::run_async_notifiers()
             notifier->add_required_change_info(change_info.current());
         change_info.advance_to_final(skip_version);
 
-        for (auto& notifier : notifiers)
-            notifier->run();
-
-        lock.lock();
-        for (auto& notifier : notifiers)
-            notifier->prepare_handover();
-        lock.unlock();
+        run_notifiers_by_priority(lock, notifiers);
     }
 
     // Advance the non-new notifiers to the same version as we advanced the new
-    // ones to (or the latest if there were no new ones)
-    IncrementalChangeInfo change_info(*m_notifier_sg, notifiers);
-    for (auto& notifier : notifiers) {
-        notifier->add_required_change_info(change_info.current());
+    // ones to (or the latest if there were no new ones). Folded-in new
+    // notifiers join this pass partway through: the SG attaches them as it
+    // passes through their handover versions, so the span they share with the
+    // pre-existing notifiers is only processed once.
+    auto all_notifiers = notifiers;
+    if (fold_new_notifiers)
+        all_notifiers.insert(all_notifiers.end(), new_notifiers.begin(), new_notifiers.end());
+    IncrementalChangeInfo change_info(*m_notifier_sg, all_notifiers);
+    if (fold_new_notifiers) {
+        auto is_new = [&](auto const& notifier) {
+            return std::find(new_notifiers.begin(), new_notifiers.end(), notifier) != new_notifiers.end();
+        };
+        for (auto& notifier : all_notifiers) {
+            change_info.advance_incremental(notifier->version());
+            if (is_new(notifier))
+                notifier->attach_to(*m_notifier_sg);
+            notifier->add_required_change_info(change_info.current());
+        }
+    }
+    else {
+        for (auto& notifier : all_notifiers) {
+            notifier->add_required_change_info(change_info.current());
+        }
+
+        // If every commit being advanced over published a metadata record
+        // and none of them touched a table the notifiers need, the parse
+        // couldn't produce any changes. Drop the requirements so that
+        // advance_to_final() takes the parse-free path; the notifiers still
+        // run against the (empty, marked as proven) change info so that
+        // their handover versions move forward.
+        if (!all_notifiers.empty() && can_skip_transact_log_parse(change_info.current(), version)) {
+            auto& info = change_info.current();
+            info.table_modifications_needed.clear();
+            info.table_moves_needed.clear();
+            info.table_columns_needed.clear();
+            info.lists.clear();
+            info.proven_unchanged = true;
+        }
     }
     change_info.advance_to_final(version);
 
     // Attach the new notifiers to the main SG and move them to the main list
     for (auto& notifier : new_notifiers) {
-        notifier->attach_to(*m_notifier_sg);
+        if (!fold_new_notifiers)
+            notifier->attach_to(*m_notifier_sg);
         notifier->run();
     }
 
     // Change info is now all ready, so the notifiers can now perform their
-    // background work
-    for (auto& notifier : notifiers) {
-        notifier->run();
-    }
+    // background work. Higher-priority notifiers are run and published first
+    // so that they can be delivered before the lower-priority changesets have
+    // even been computed.
+    run_notifiers_by_priority(lock, notifiers);
 
     // Reacquire the lock while updating the fields that are actually read on
     // other threads
@@ -736,19 +1621,218 @@ void RealmCoordinator::run_async_notifiers()
     for (auto& notifier : new_notifiers) {
         notifier->prepare_handover();
     }
-    for (auto& notifier : notifiers) {
-        notifier->prepare_handover();
+
+    {
+        // Count the versions advanced over in this pass, for get_notifier_stats()
+        std::lock_guard<std::mutex> stats_lock(m_notifier_stats_mutex);
+        if (m_last_observed_version && version.version > m_last_observed_version)
+            m_notifier_stats.commits_observed += version.version - m_last_observed_version;
+        m_last_observed_version = version.version;
+    }
+    {
+        std::lock_guard<std::mutex> new_lock(m_new_notifier_mutex);
+        clean_up_dead_notifiers();
     }
-    clean_up_dead_notifiers();
     m_notifier_cv.notify_all();
 }
 
+void RealmCoordinator::run_notifiers_by_priority(std::unique_lock<std::mutex>& lock,
+                                                 std::vector<std::shared_ptr<CollectionNotifier>>& notifiers)
+{
+    REALM_ASSERT(!lock.owns_lock());
+
+    // Process the notifiers one priority class at a time, making each class's
+    // changesets available for delivery before computing the next one's
+    std::stable_sort(notifiers.begin(), notifiers.end(),
+                     [](auto const& a, auto const& b) { return a->priority() < b->priority(); });
+    for (size_t begin = 0; begin < notifiers.size();) {
+        size_t end = begin + 1;
+        while (end < notifiers.size() && notifiers[end]->priority() == notifiers[begin]->priority())
+            ++end;
+
+        std::vector<std::shared_ptr<CollectionNotifier>> batch(notifiers.begin() + begin,
+                                                               notifiers.begin() + end);
+        run_notifier_batch(lock, batch);
+
+        begin = end;
+    }
+}
+
+void RealmCoordinator::run_notifier_batch(std::unique_lock<std::mutex>& lock,
+                                          std::vector<std::shared_ptr<CollectionNotifier>> const& notifiers)
+{
+    REALM_ASSERT(!lock.owns_lock());
+
+    auto prepare_and_publish = [&] {
+        lock.lock();
+        for (auto& notifier : notifiers)
+            notifier->prepare_handover();
+        m_notifier_cv.notify_all();
+        lock.unlock();
+    };
+
+    // Group together notifiers which read from any of the same tables, as
+    // notifiers within a group have to be run serially relative to each other
+    std::vector<std::vector<CollectionNotifier*>> groups;
+    for (auto& notifier : notifiers) {
+        auto it = std::find_if(groups.begin(), groups.end(), [&](auto& group) {
+            return std::any_of(group.begin(), group.end(), [&](auto* other) {
+                return notifier->shares_tables_with(*other);
+            });
+        });
+        if (it == groups.end())
+            groups.push_back({notifier.get()});
+        else
+            it->push_back(notifier.get());
+    }
+
+    size_t max_workers = std::thread::hardware_concurrency();
+    if (groups.size() < 2 || max_workers < 2 || m_config->notifier_shared_group_pool_size == 0) {
+        for (auto& notifier : notifiers)
+            notifier->run();
+        prepare_and_publish();
+        return;
+    }
+
+    // Move each group after the first onto its own SharedGroup from the pool,
+    // pinned at the version we're running at, so that the worker threads never
+    // share any Group accessors. Groups for which no SharedGroup is available
+    // stay on the main notifier SharedGroup and run on this thread.
+    auto version = m_notifier_sg->get_version_of_current_transaction();
+    struct PooledGroup {
+        std::vector<CollectionNotifier*>* group;
+        PooledSharedGroup* sg;
+    };
+    std::vector<PooledGroup> pooled_groups;
+    for (size_t i = 1; i < groups.size(); ++i) {
+        auto* pooled = checkout_pooled_shared_group(version);
+        if (!pooled)
+            break;
+        for (auto* notifier : groups[i]) {
+            notifier->detach();
+            notifier->attach_to(*pooled->shared_group);
+        }
+        pooled_groups.push_back({&groups[i], pooled});
+    }
+
+    if (pooled_groups.empty()) {
+        for (auto& notifier : notifiers)
+            notifier->run();
+        prepare_and_publish();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> worker_lock(m_worker_mutex);
+        start_worker_threads(std::min(pooled_groups.size(), max_workers));
+        m_worker_tasks_in_flight = pooled_groups.size();
+        for (auto& pooled : pooled_groups) {
+            auto* group = pooled.group;
+            m_worker_queue.push_back([group] {
+                for (auto* notifier : *group)
+                    notifier->run();
+            });
+        }
+        m_worker_cv.notify_all();
+        worker_lock.unlock();
+
+        // Run the groups which didn't get a private SharedGroup on this
+        // thread while the workers process theirs
+        for (auto* notifier : groups[0])
+            notifier->run();
+        for (size_t i = pooled_groups.size() + 1; i < groups.size(); ++i) {
+            for (auto* notifier : groups[i])
+                notifier->run();
+        }
+
+        worker_lock.lock();
+        m_worker_done_cv.wait(worker_lock, [&] { return m_worker_tasks_in_flight == 0; });
+    }
+
+    // prepare_handover() has to happen while the notifiers are still attached
+    // to the SharedGroup their TableViews were produced on
+    prepare_and_publish();
+
+    // Return the pooled notifiers to the main SharedGroup so that the next
+    // advance moves everything together again
+    for (auto& pooled : pooled_groups) {
+        for (auto* notifier : *pooled.group) {
+            notifier->detach();
+            notifier->attach_to(*m_notifier_sg);
+        }
+        pooled.sg->shared_group->end_read();
+    }
+}
+
+RealmCoordinator::PooledSharedGroup* RealmCoordinator::checkout_pooled_shared_group(VersionID version)
+{
+    for (auto& pooled : m_notifier_sg_pool) {
+        if (pooled->shared_group->get_transact_stage() == SharedGroup::transact_Ready) {
+            pooled->shared_group->begin_read(version);
+            return pooled.get();
+        }
+    }
+    if (m_notifier_sg_pool.size() >= m_config->notifier_shared_group_pool_size)
+        return nullptr;
+
+    try {
+        auto pooled = std::make_unique<PooledSharedGroup>();
+        std::unique_ptr<Group> read_only_group;
+        Realm::open_with_config(*m_config, pooled->history, pooled->shared_group, read_only_group, nullptr);
+        REALM_ASSERT(!read_only_group);
+        pooled->shared_group->begin_read(version);
+        m_notifier_sg_pool.push_back(std::move(pooled));
+        return m_notifier_sg_pool.back().get();
+    }
+    catch (...) {
+        // Running without a private SharedGroup is always an option, so a
+        // failure to open another one just means less parallelism
+        return nullptr;
+    }
+}
+
+void RealmCoordinator::start_worker_threads(size_t count)
+{
+    while (m_worker_threads.size() < count) {
+        m_worker_threads.emplace_back([this] {
+            std::unique_lock<std::mutex> lock(m_worker_mutex);
+            while (true) {
+                m_worker_cv.wait(lock, [&] { return m_worker_shutdown || !m_worker_queue.empty(); });
+                if (m_worker_shutdown)
+                    return;
+                auto task = std::move(m_worker_queue.back());
+                m_worker_queue.pop_back();
+                lock.unlock();
+                task();
+                lock.lock();
+                if (--m_worker_tasks_in_flight == 0)
+                    m_worker_done_cv.notify_all();
+            }
+        });
+    }
+}
+
+void RealmCoordinator::stop_worker_threads()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_worker_mutex);
+        if (m_worker_threads.empty())
+            return;
+        m_worker_shutdown = true;
+    }
+    m_worker_cv.notify_all();
+    for (auto& thread : m_worker_threads)
+        thread.join();
+    m_worker_threads.clear();
+    m_worker_shutdown = false;
+}
+
 void RealmCoordinator::open_helper_shared_group()
 {
     if (!m_notifier_sg) {
         try {
             std::unique_ptr<Group> read_only_group;
-            Realm::open_with_config(m_config, m_notifier_history, m_notifier_sg, read_only_group, nullptr);
+            Realm::open_with_config(*m_config, m_notifier_history, m_notifier_sg, read_only_group, nullptr);
             REALM_ASSERT(!read_only_group);
             m_notifier_sg->begin_read();
         }
@@ -767,7 +1851,9 @@ void RealmCoordinator::open_helper_shared_group()
 void RealmCoordinator::advance_to_ready(Realm& realm)
 {
     std::unique_lock<std::mutex> lock(m_notifier_mutex);
+    std::unique_lock<std::mutex> new_notifier_lock(m_new_notifier_mutex);
     _impl::NotifierPackage notifiers(m_async_error, notifiers_for_realm(realm), this);
+    new_notifier_lock.unlock();
     lock.unlock();
     notifiers.package_and_wait(util::none);
 
@@ -791,7 +1877,8 @@ void RealmCoordinator::advance_to_ready(Realm& realm)
         }
     }
 
-    transaction::advance(sg, realm.m_binding_context.get(), notifiers);
+    transaction::advance(sg, realm.m_binding_context.get(), notifiers,
+                         &Realm::Internal::get_schema_changed_tables(realm));
 }
 
 std::vector<std::shared_ptr<_impl::CollectionNotifier>> RealmCoordinator::notifiers_for_realm(Realm& realm)
@@ -814,12 +1901,15 @@ bool RealmCoordinator::advance_to_latest(Realm& realm)
 
     auto& sg = Realm::Internal::get_shared_group(realm);
     std::unique_lock<std::mutex> lock(m_notifier_mutex);
+    std::unique_lock<std::mutex> new_notifier_lock(m_new_notifier_mutex);
     _impl::NotifierPackage notifiers(m_async_error, notifiers_for_realm(realm), this);
+    new_notifier_lock.unlock();
     lock.unlock();
     notifiers.package_and_wait(sgf::get_version_of_latest_snapshot(*sg));
 
     auto version = sg->get_version_of_current_transaction();
-    transaction::advance(sg, realm.m_binding_context.get(), notifiers);
+    transaction::advance(sg, realm.m_binding_context.get(), notifiers,
+                         &Realm::Internal::get_schema_changed_tables(realm));
 
     // Realm could be closed in the callbacks.
     if (realm.is_closed())
@@ -833,11 +1923,152 @@ void RealmCoordinator::promote_to_write(Realm& realm)
     REALM_ASSERT(!realm.is_in_transaction());
 
     std::unique_lock<std::mutex> lock(m_notifier_mutex);
+    std::unique_lock<std::mutex> new_notifier_lock(m_new_notifier_mutex);
     _impl::NotifierPackage notifiers(m_async_error, notifiers_for_realm(realm), this);
+    new_notifier_lock.unlock();
     lock.unlock();
 
     auto& sg = Realm::Internal::get_shared_group(realm);
-    transaction::begin(sg, realm.m_binding_context.get(), notifiers);
+    auto wait_start = std::chrono::steady_clock::now();
+    transaction::begin(sg, realm.m_binding_context.get(), notifiers,
+                       &Realm::Internal::get_schema_changed_tables(realm));
+    // Callbacks invoked while beginning the transaction can close the Realm,
+    // in which case there is no write transaction to record
+    if (!realm.is_closed() && realm.is_in_transaction())
+        did_begin_write(std::chrono::steady_clock::now() - wait_start);
+}
+
+void RealmCoordinator::did_begin_write(std::chrono::steady_clock::duration wait)
+{
+    auto wait_us = std::chrono::duration_cast<std::chrono::microseconds>(wait);
+    std::function<void(std::chrono::microseconds)> callback;
+    {
+        std::lock_guard<std::mutex> lock(m_write_stats_mutex);
+        ++m_write_stats.acquisitions;
+        m_write_stats.total_wait += wait_us;
+        m_write_stats.max_wait = std::max(m_write_stats.max_wait, wait_us);
+
+        size_t bucket = 0;
+        for (auto usec = wait_us.count(); usec > 1 && bucket + 1 < m_write_stats.wait_histogram.size(); usec >>= 1)
+            ++bucket;
+        ++m_write_stats.wait_histogram[bucket];
+
+        m_write_stats.current_holder = std::this_thread::get_id();
+        m_write_acquired_at = std::chrono::steady_clock::now();
+        if (m_write_wait_callback && wait_us >= m_write_wait_threshold)
+            callback = m_write_wait_callback;
+    }
+    // Invoked with the mutex released as the callback is free to call back
+    // into the coordinator (e.g. to read the stats)
+    if (callback)
+        callback(wait_us);
+}
+
+void RealmCoordinator::did_end_write()
+{
+    std::lock_guard<std::mutex> lock(m_write_stats_mutex);
+    m_write_stats.current_holder = {};
+}
+
+RealmCoordinator::WriteLockStats RealmCoordinator::get_write_lock_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_write_stats_mutex);
+    auto stats = m_write_stats;
+    if (stats.current_holder != std::thread::id()) {
+        stats.current_hold_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_write_acquired_at);
+    }
+    return stats;
+}
+
+void RealmCoordinator::set_write_lock_wait_callback(std::chrono::microseconds threshold,
+                                                    std::function<void(std::chrono::microseconds)> callback)
+{
+    std::lock_guard<std::mutex> lock(m_write_stats_mutex);
+    m_write_wait_threshold = threshold;
+    m_write_wait_callback = std::move(callback);
+}
+
+static std::atomic<bool> s_commit_latency_stats_enabled{false};
+
+void RealmCoordinator::set_commit_latency_stats_enabled(bool enabled)
+{
+    s_commit_latency_stats_enabled = enabled;
+}
+
+bool RealmCoordinator::commit_latency_stats_enabled() noexcept
+{
+    return s_commit_latency_stats_enabled.load(std::memory_order_relaxed);
+}
+
+void RealmCoordinator::record_commit_notification_latency(std::chrono::steady_clock::duration latency)
+{
+    // The timestamp may have been written by another process; the clocks are
+    // comparable, but guard against skew producing a nonsensical value
+    if (latency.count() < 0)
+        latency = {};
+    auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+
+    std::lock_guard<std::mutex> lock(m_notification_stats_mutex);
+    ++m_notification_stats.notifications;
+    m_notification_stats.total_latency += latency_us;
+    m_notification_stats.max_latency = std::max(m_notification_stats.max_latency, latency_us);
+
+    size_t bucket = 0;
+    for (auto usec = latency_us.count(); usec > 1 && bucket + 1 < m_notification_stats.latency_histogram.size(); usec >>= 1)
+        ++bucket;
+    ++m_notification_stats.latency_histogram[bucket];
+}
+
+RealmCoordinator::CommitNotificationStats RealmCoordinator::get_commit_notification_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_notification_stats_mutex);
+    return m_notification_stats;
+}
+
+void RealmCoordinator::count_notifier_deliveries(size_t count)
+{
+    if (count == 0)
+        return;
+    std::lock_guard<std::mutex> lock(m_notifier_stats_mutex);
+    m_notifier_stats.deliveries += count;
+}
+
+RealmCoordinator::NotifierStats RealmCoordinator::get_notifier_stats()
+{
+    NotifierStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_notifier_stats_mutex);
+        stats = m_notifier_stats;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now() - m_notifier_stats_start);
+    if (elapsed.count() > 0)
+        stats.commits_per_second = stats.commits_observed / elapsed.count();
+
+    std::lock_guard<std::mutex> lock(m_notifier_mutex);
+    std::lock_guard<std::mutex> new_notifier_lock(m_new_notifier_mutex);
+
+    using sgf = SharedGroupFriend;
+    uint_fast64_t latest = 0;
+    auto check_latest = [&](SharedGroup* sg) {
+        if (sg && sg->get_transact_stage() == SharedGroup::transact_Reading)
+            latest = std::max(latest, sgf::get_version_of_latest_snapshot(*sg));
+    };
+    check_latest(m_notifier_sg.get());
+    check_latest(m_advancer_sg.get());
+
+    stats.notifier_version_lags.reserve(m_notifiers.size() + m_new_notifiers.size());
+    auto add_lag = [&](auto const& notifier) {
+        auto version = notifier->version().version;
+        stats.notifier_version_lags.push_back(latest > version ? latest - version : 0);
+    };
+    for (auto& notifier : m_notifiers)
+        add_lag(notifier);
+    for (auto& notifier : m_new_notifiers)
+        add_lag(notifier);
+    return stats;
 }
 
 void RealmCoordinator::process_available_async(Realm& realm)
@@ -845,14 +2076,17 @@ void RealmCoordinator::process_available_async(Realm& realm)
     REALM_ASSERT(!realm.is_in_transaction());
 
     std::unique_lock<std::mutex> lock(m_notifier_mutex);
+    std::unique_lock<std::mutex> new_notifier_lock(m_new_notifier_mutex);
     auto notifiers = notifiers_for_realm(realm);
+    auto error = m_async_error;
+    new_notifier_lock.unlock();
     if (notifiers.empty())
         return;
 
-    if (auto error = m_async_error) {
+    if (error) {
         lock.unlock();
         for (auto& notifier : notifiers)
-            notifier->deliver_error(m_async_error);
+            notifier->deliver_error(error);
         return;
     }
 
@@ -864,6 +2098,7 @@ void RealmCoordinator::process_available_async(Realm& realm)
     };
     notifiers.erase(std::remove_if(begin(notifiers), end(notifiers), package), end(notifiers));
     lock.unlock();
+    count_notifier_deliveries(notifiers.size());
 
     // no before advance because the Realm is already at the given version,
     // because we're either sending initial notifications or the write was
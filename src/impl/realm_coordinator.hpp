@@ -23,8 +23,13 @@
 
 #include <realm/version_id.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
+#include <thread>
 
 namespace realm {
 class Replication;
@@ -35,8 +40,11 @@ class SyncSession;
 
 namespace _impl {
 class CollectionNotifier;
+class CommitMetadata;
 class ExternalCommitHelper;
+class InProcessCommitHelper;
 class WeakRealmNotifier;
+struct TransactionChangeInfo;
 
 // RealmCoordinator manages the weak cache of Realm instances and communication
 // between per-thread Realm instances for a given file
@@ -55,12 +63,30 @@ public:
     std::shared_ptr<Realm> get_realm(Realm::Config config);
     std::shared_ptr<Realm> get_realm();
 
-    Realm::Config get_config() const { return m_config; }
+    // Open a Realm on a background thread, performing the file open, schema
+    // verification, any migration and (for synchronized Realms) the initial
+    // download there, and then invoke the callback on the calling thread's
+    // event loop with a Realm instance confined to the calling thread, or
+    // with the exception which prevented opening it
+    void get_realm_async(Realm::Config config,
+                         std::function<void(std::shared_ptr<Realm>, std::exception_ptr)> callback);
+
+    // Get the cached Realm for the given execution context, or null if there
+    // is none. Unlike get_realm() this performs no config or schema
+    // validation, so it is suitable for hot paths which acquire and release a
+    // Realm instance very frequently.
+    std::shared_ptr<Realm> get_cached_realm(AnyExecutionContextID execution_context) noexcept;
+
+    // The config is stored as an immutable shared payload, so handing it out
+    // is a refcount bump rather than a deep copy of the schema, encryption
+    // key and path strings. Callers which need a modified config copy the
+    // payload explicitly.
+    std::shared_ptr<const Realm::Config> get_config() const { return m_config; }
 
     uint64_t get_schema_version() const noexcept { return m_schema_version; }
-    const std::string& get_path() const noexcept { return m_config.path; }
-    const std::vector<char>& get_encryption_key() const noexcept { return m_config.encryption_key; }
-    bool is_in_memory() const noexcept { return m_config.in_memory; }
+    const std::string& get_path() const noexcept { return m_config->path; }
+    const std::vector<char>& get_encryption_key() const noexcept { return m_config->encryption_key; }
+    bool is_in_memory() const noexcept { return m_config->in_memory; }
 
     // To avoid having to re-read and validate the file's schema every time a
     // new read transaction is begun, RealmCoordinator maintains a cache of the
@@ -73,6 +99,25 @@ public:
     // to. Returns false if there is no cached schema.
     bool get_cached_schema(Schema& schema, uint64_t& schema_version, uint64_t& transaction) const noexcept;
 
+    // Get the cached schema if it is known to be valid at the given
+    // transaction version. Returns false if there is no cached schema or it
+    // does not cover that version.
+    bool get_cached_schema_for_version(uint64_t version, Schema& schema) const noexcept;
+
+    // Get the schema as of the given transaction version, from the in-memory
+    // cache if it covers that version or otherwise from the schema cache
+    // file written by the previous coordinator for this path. The file is
+    // only trusted if it was written at exactly `version` and its schema
+    // version matches `schema_version`. Returns false if neither cache can
+    // supply the schema and it must be read from the Group.
+    bool load_cached_schema(uint64_t version, uint64_t schema_version, Schema& schema);
+
+    // Whether the cached schema is known to be valid at both of the given
+    // transaction versions, i.e. no schema change occurred between them.
+    // Unlike get_cached_schema_for_version() this does not copy the schema,
+    // so it can be used to cheaply skip schema work entirely.
+    bool schema_unchanged_between(uint64_t begin_version, uint64_t end_version) const noexcept;
+
     // Cache the state of the schema at the given transaction version
     void cache_schema(Schema const& new_schema, uint64_t new_schema_version,
                       uint64_t transaction_version);
@@ -82,6 +127,134 @@ public:
     void clear_schema_cache_and_set_schema_version(uint64_t new_schema_version);
 
 
+    // Information about the transaction versions currently pinned by the
+    // background notifier machinery. The file must retain the history between
+    // the oldest pinned version and the latest snapshot, so a persistently
+    // large version_lag translates directly into file growth.
+    struct PinnedVersionInfo {
+        // The oldest version pinned by a notifier SharedGroup, or {0, 0} if
+        // nothing is currently pinned
+        VersionID oldest_pinned_version = {0, 0};
+        // Number of commits between the oldest pinned version and the latest
+        // snapshot
+        uint_fast64_t version_lag = 0;
+        // Current size of the Realm file in bytes (zero for in-memory Realms)
+        uint64_t file_size = 0;
+    };
+    PinnedVersionInfo get_pinned_version_info();
+
+    // Snapshot of the memory retained on behalf of this coordinator's Realm
+    // file, for attributing process RSS growth to individual open Realms
+    struct MemoryStats {
+        // Path of the Realm file
+        std::string path;
+        // Size of the file in bytes (zero for in-memory Realms). The file is
+        // mapped in its entirety, so this bounds the coordinator's mmap span.
+        uint64_t file_size = 0;
+        // Number of commits of history which must be retained in the file
+        // for the benefit of versions pinned by the notifier machinery
+        uint_fast64_t version_lag = 0;
+        // Registered notifiers, including ones the worker has not yet seen
+        size_t notifier_count = 0;
+        // Total rows retained by the notifiers' TableViews
+        size_t notifier_retained_rows = 0;
+        // Approximate heap footprint of the cached file schema in bytes
+        size_t schema_cache_size = 0;
+    };
+    MemoryStats get_memory_stats();
+
+    // Memory stats for every live coordinator in the process, serialized as
+    // a JSON array for fleet telemetry
+    static std::string get_memory_stats_json();
+
+    // Statistics about write transactions started through this coordinator,
+    // for diagnosing write lock contention. Waits are measured around the
+    // entire promotion to write, which also covers advancing the read
+    // transaction to the latest version, but long stalls are almost always
+    // time spent waiting for the write lock itself. Writers in other
+    // processes are not visible here.
+    struct WriteLockStats {
+        // Number of write transactions which have been started
+        uint_fast64_t acquisitions = 0;
+        // Total and worst-case time spent waiting to start them
+        std::chrono::microseconds total_wait = {};
+        std::chrono::microseconds max_wait = {};
+        // Histogram of wait times: bucket i counts waits of at least 2^i
+        // and less than 2^(i+1) microseconds (bucket zero includes waits
+        // under a microsecond, and the last bucket everything longer)
+        std::array<uint_fast64_t, 20> wait_histogram = {};
+        // Thread currently in a write transaction via this coordinator and
+        // how long it has been writing; a default-constructed id when no
+        // local thread is
+        std::thread::id current_holder;
+        std::chrono::microseconds current_hold_time = {};
+    };
+    WriteLockStats get_write_lock_stats() const;
+
+    // Register a function invoked on the acquiring thread, once the write
+    // transaction has begun, whenever starting it took at least `threshold`.
+    // The callback receives the time spent waiting.
+    void set_write_lock_wait_callback(std::chrono::microseconds threshold,
+                                      std::function<void(std::chrono::microseconds)> callback);
+
+    // Called by Realm when starting and ending write transactions to keep
+    // the write lock statistics up to date. Do not call directly.
+    void did_begin_write(std::chrono::steady_clock::duration wait);
+    void did_end_write();
+
+    // Statistics about the latency of commit notifications: the time from a
+    // commit (in this or any other process) to this process dispatching
+    // on_change() for it. Collection is off by default because it requires
+    // timestamping every commit, and the timestamp is written by the
+    // committing process, so it must be enabled in every process whose
+    // commits should be measured. Back-to-back commits coalesce into a
+    // single notification, which is measured from the most recent of them.
+    struct CommitNotificationStats {
+        // Number of notifications with a measured latency
+        uint_fast64_t notifications = 0;
+        // Total and worst-case commit-to-dispatch latency
+        std::chrono::microseconds total_latency = {};
+        std::chrono::microseconds max_latency = {};
+        // Histogram of latencies: bucket i counts latencies of at least 2^i
+        // and less than 2^(i+1) microseconds (bucket zero includes latencies
+        // under a microsecond, and the last bucket everything longer)
+        std::array<uint_fast64_t, 20> latency_histogram = {};
+    };
+    CommitNotificationStats get_commit_notification_stats() const;
+
+    // Toggle commit timestamping process-wide
+    static void set_commit_latency_stats_enabled(bool enabled);
+    static bool commit_latency_stats_enabled() noexcept;
+
+    // Called by the ExternalCommitHelper when dispatching a commit
+    // notification which has a timestamp attached. Do not call directly.
+    void record_commit_notification_latency(std::chrono::steady_clock::duration latency);
+
+    // Throughput and lag statistics for the notifier machinery, intended for
+    // detecting notifier starvation (growing version lag or queue times)
+    // before it becomes user-visible
+    struct NotifierStats {
+        // Commits (version transitions) the background worker has advanced
+        // over, and the resulting rate since the coordinator was created.
+        // Commits made while no notifiers are registered are not observed.
+        uint_fast64_t commits_observed = 0;
+        double commits_per_second = 0;
+        // Number of changesets packaged for delivery to callbacks
+        uint_fast64_t deliveries = 0;
+        // How many notifiers have passed through the staging queue, and the
+        // total and worst-case time from creation to their first run
+        uint_fast64_t notifiers_queued = 0;
+        std::chrono::microseconds total_queue_time = {};
+        std::chrono::microseconds max_queue_time = {};
+        // For each currently registered notifier, how many versions behind
+        // the newest snapshot its most recent run was
+        std::vector<uint_fast64_t> notifier_version_lags;
+    };
+    NotifierStats get_notifier_stats();
+
+    // Called by NotifierPackage when packaging changesets. Do not call directly.
+    void count_notifier_deliveries(size_t count);
+
     // Asynchronously call notify() on every Realm instance for this coordinator's
     // path, including those in other processes
     void send_commit_notifications(Realm&);
@@ -109,6 +282,11 @@ public:
     // Called by m_notifier when there's a new commit to send notifications for
     void on_change();
 
+    // Called by the process-wide notifier worker pool to run this
+    // coordinator's notifiers (see Config::use_shared_notifier_pool).
+    // Do not call directly.
+    void run_pooled_notifiers();
+
     static void register_notifier(std::shared_ptr<CollectionNotifier> notifier);
 
     // Advance the Realm to the most recent transaction version which all async
@@ -134,11 +312,31 @@ public:
     // other Realm instances for that path, including in other processes
     void commit_write(Realm& realm);
 
+    // Durably sync any commits which group commit has batched up but not
+    // yet synced (see Config::group_commit_interval_ms). Called by
+    // Realm::flush(), and a no-op when group commit is not in use.
+    void sync_pending_commits();
+
+    // Queue a closure to be invoked on a background thread with a Realm
+    // instance confined to that thread in a write transaction. Used to
+    // implement Realm::async_begin_transaction().
+    void queue_async_write(std::function<void(std::shared_ptr<Realm>)>);
+
+    // Tear down a closing Realm's transaction state on a background thread,
+    // invoking the completion callback (if any) once the file has been fully
+    // released. Called by Realm::close_async() with the state it detached.
+    void close_async(std::unique_ptr<Replication> history,
+                     std::unique_ptr<SharedGroup> shared_group,
+                     std::function<void()> completion);
+
     template<typename Pred>
     std::unique_lock<std::mutex> wait_for_notifiers(Pred&& wait_predicate);
 
 private:
-    Realm::Config m_config;
+    // The payload is never mutated once published; set_config() replaces it
+    // wholesale (under m_realm_mutex) when the first Realm for the file is
+    // opened or reopened.
+    std::shared_ptr<const Realm::Config> m_config = std::make_shared<Realm::Config>();
 
     mutable std::mutex m_schema_cache_mutex;
     util::Optional<Schema> m_cached_schema;
@@ -151,10 +349,16 @@ private:
 
     std::mutex m_notifier_mutex;
     std::condition_variable m_notifier_cv;
-    std::vector<std::shared_ptr<_impl::CollectionNotifier>> m_new_notifiers;
     std::vector<std::shared_ptr<_impl::CollectionNotifier>> m_notifiers;
     VersionID m_notifier_skip_version = {0, 0};
 
+    // Guards m_new_notifiers, the advancer SharedGroup and m_async_error so
+    // that registering a notifier doesn't have to wait for the worker thread
+    // while it's processing the already-registered notifiers. Must be acquired
+    // after m_notifier_mutex when both are needed.
+    std::mutex m_new_notifier_mutex;
+    std::vector<std::shared_ptr<_impl::CollectionNotifier>> m_new_notifiers;
+
     // SharedGroup used for actually running async notifiers
     // Will have a read transaction iff m_notifiers is non-empty
     std::unique_ptr<Replication> m_notifier_history;
@@ -167,22 +371,159 @@ private:
     std::unique_ptr<SharedGroup> m_advancer_sg;
     std::exception_ptr m_async_error;
 
+    // Pool of SharedGroups which independent groups of notifiers are moved to
+    // while being run in parallel, so that the worker threads never share
+    // Group accessors. Entries hold a read transaction only while a parallel
+    // run is in progress, and the pool is only touched from the worker thread.
+    struct PooledSharedGroup {
+        std::unique_ptr<Replication> history;
+        std::unique_ptr<SharedGroup> shared_group;
+    };
+    std::vector<std::unique_ptr<PooledSharedGroup>> m_notifier_sg_pool;
+
+    // Mapped commit-metadata sidecar, created lazily (and at most once per
+    // coordinator) by whichever of the writer or reader paths first needs
+    // it. Guarded by m_notifier_mutex while being opened; immutable once
+    // m_commit_metadata_opened is set.
+    std::unique_ptr<_impl::CommitMetadata> m_commit_metadata;
+    bool m_commit_metadata_opened = false;
+
+    // SharedGroup used to parse each local commit for the tables it
+    // modified when publishing commit metadata. Only holds a read
+    // transaction for the duration of a commit_write() call, so it never
+    // pins versions between commits.
+    std::unique_ptr<Replication> m_metadata_history;
+    std::unique_ptr<SharedGroup> m_metadata_sg;
+    bool m_metadata_sg_ready = false;
+
+    // Page-cache warming state (see Config::warm_strategy). The prefault
+    // thread re-checks the stop flag between chunks so that closing the
+    // last Realm doesn't have to wait for the whole file to be read.
+    bool m_file_warm_started = false;
+    std::atomic<bool> m_file_warm_stop{false};
+    std::thread m_file_warm_thread;
+
     std::unique_ptr<_impl::ExternalCommitHelper> m_notifier;
+    // Commit signalling for in-memory Realms, used in place of m_notifier
+    // since no other process can be writing to them
+    std::unique_ptr<_impl::InProcessCommitHelper> m_in_process_notifier;
     std::function<void(VersionID, VersionID)> m_transaction_callback;
 
+    // Worker pool used to run independent notifiers concurrently after the
+    // shared transaction advance. Threads are started lazily the first time a
+    // commit produces more than one independent group of notifiers.
+    std::mutex m_worker_mutex;
+    std::condition_variable m_worker_cv;
+    std::condition_variable m_worker_done_cv;
+    std::vector<std::function<void()>> m_worker_queue;
+    std::vector<std::thread> m_worker_threads;
+    size_t m_worker_tasks_in_flight = 0;
+    bool m_worker_shutdown = false;
+
+    // Queue of closures for Realm::async_begin_transaction() and whether a
+    // background thread is currently draining it. The thread is spawned on
+    // demand, holds a strong reference to the coordinator while it runs, and
+    // exits once the queue is empty.
+    std::mutex m_async_write_mutex;
+    std::vector<std::function<void(std::shared_ptr<Realm>)>> m_async_write_queue;
+    bool m_async_write_thread_running = false;
+
     std::shared_ptr<SyncSession> m_sync_session;
 
+    // Write lock statistics; guarded by m_write_stats_mutex. The holder
+    // fields of m_write_stats are maintained directly, with the hold time
+    // computed from m_write_acquired_at when the stats are read.
+    mutable std::mutex m_write_stats_mutex;
+    WriteLockStats m_write_stats;
+    std::chrono::steady_clock::time_point m_write_acquired_at;
+    std::chrono::microseconds m_write_wait_threshold = {};
+    std::function<void(std::chrono::microseconds)> m_write_wait_callback;
+
+    // Commit notification latency statistics; guarded by its own mutex as
+    // it is updated from the notifier machinery's threads
+    mutable std::mutex m_notification_stats_mutex;
+    CommitNotificationStats m_notification_stats;
+
+    // Notifier throughput statistics; guarded by m_notifier_stats_mutex.
+    // The version lags are not stored but computed when the stats are read.
+    mutable std::mutex m_notifier_stats_mutex;
+    NotifierStats m_notifier_stats;
+    uint_fast64_t m_last_observed_version = 0;
+    const std::chrono::steady_clock::time_point m_notifier_stats_start = std::chrono::steady_clock::now();
+
+    // Group-commit state: how many commits have been made since the file
+    // was last durably synced, and when that sync finished. Only used when
+    // the config enables group commit; the SharedGroup is then opened with
+    // relaxed durability and the syncs happen here instead.
+    std::mutex m_group_commit_mutex;
+    size_t m_unsynced_commits = 0;
+    std::chrono::steady_clock::time_point m_last_group_commit_sync;
+
+    // Check whether the batch limits have been reached after a commit which
+    // did not sync, and sync the file if so
+    // must not be called with m_group_commit_mutex locked
+    void did_commit_without_sync();
+    // must be called with m_group_commit_mutex locked
+    void sync_group_commits();
+
+    // Evaluate Config::compact_on_close_bytes and compact the file if the
+    // policy says to. Only called from the destructor, after every Realm
+    // instance for the file is gone; releases the coordinator's own
+    // SharedGroups so that they don't block the compaction.
+    void compact_on_close() noexcept;
+
     // must be called with m_notifier_mutex locked
     void pin_version(VersionID version);
 
     void set_config(const Realm::Config&);
     void create_sync_session();
 
+    // Block the calling thread until the sync session for this Realm has
+    // downloaded every changeset which the server currently has for it,
+    // throwing std::system_error if the download fails. No-op if the Realm
+    // is not synchronized.
+    void wait_for_initial_download();
+
     void run_async_notifiers();
+    void run_notifier_batch(std::unique_lock<std::mutex>& lock,
+                            std::vector<std::shared_ptr<_impl::CollectionNotifier>> const& notifiers);
+    void run_notifiers_by_priority(std::unique_lock<std::mutex>& lock,
+                                   std::vector<std::shared_ptr<_impl::CollectionNotifier>>& notifiers);
+    PooledSharedGroup* checkout_pooled_shared_group(VersionID version);
+    void async_write_loop();
+    void start_worker_threads(size_t count);
+    void stop_worker_threads();
     void open_helper_shared_group();
     void advance_helper_shared_group_to_latest();
     void clean_up_dead_notifiers();
 
+    // Map the commit-metadata sidecar if it hasn't been attempted yet,
+    // creating the file when this process publishes metadata. Called with
+    // m_notifier_mutex held. A sidecar created by another process after the
+    // first attempt here fails is picked up the next time the file is opened.
+    void open_commit_metadata();
+
+    // Pin m_metadata_sg at the version the commit being made in
+    // commit_write() is based on. Called with m_notifier_mutex held, while
+    // the write transaction is still open so that no other commit can slip
+    // in between the pin and the commit itself.
+    void begin_commit_metadata();
+
+    // Parse the just-made commit with m_metadata_sg and publish its
+    // modified-table record. Called with m_notifier_mutex held, after
+    // transaction::commit().
+    void publish_commit_metadata();
+
+    // True when every commit between m_notifier_sg's current version and
+    // `version` published a metadata record and none of them touched a table
+    // `info` requires, meaning the transact-log parse would find nothing.
+    bool can_skip_transact_log_parse(TransactionChangeInfo const& info, VersionID version);
+
+    // Start warming the OS page cache for the file per Config::warm_strategy.
+    // Called with m_realm_mutex held; only the first call does anything, so
+    // concurrent opens of the same file don't duplicate the work.
+    void warm_file_cache();
+
     std::vector<std::shared_ptr<_impl::CollectionNotifier>> notifiers_for_realm(Realm&);
 };
 
@@ -18,13 +18,17 @@
 
 #include "impl/results_notifier.hpp"
 
+#include <algorithm>
+
 using namespace realm;
 using namespace realm::_impl;
 
 ResultsNotifier::ResultsNotifier(Results& target)
 : CollectionNotifier(target.get_realm())
 , m_target_results(&target)
+, m_sort_columns(target.get_sort_columns())
 , m_target_is_in_table_order(target.is_in_table_order())
+, m_limit(target.get_limit())
 {
     Query q = target.get_query();
     set_table(*q.get_table());
@@ -77,6 +81,14 @@ bool ResultsNotifier::do_add_required_change_info(TransactionChangeInfo& info)
         info.table_moves_needed.resize(table_ndx + 1);
     info.table_moves_needed[table_ndx] = true;
 
+    // Knowing which columns were modified lets the incremental path prove
+    // that a modification couldn't have reordered the sorted view
+    if (!m_sort_columns.empty()) {
+        if (info.table_columns_needed.size() <= table_ndx)
+            info.table_columns_needed.resize(table_ndx + 1, false);
+        info.table_columns_needed[table_ndx] = true;
+    }
+
     return has_run() && have_callbacks();
 }
 
@@ -89,10 +101,19 @@ bool ResultsNotifier::need_to_run()
         auto lock = lock_target();
         // Don't run the query if the results aren't actually going to be used
         if (!get_realm() || (!have_callbacks() && !m_target_results->wants_background_updates())) {
+            // The query results can drift away from the last exported view
+            // while it's not being kept up to date
+            m_exported_view_is_current = false;
             return false;
         }
     }
 
+    // The commits advanced over were proven to not touch any of the tables
+    // this query depends on, so the previous results are still valid
+    if (has_run() && m_info->proven_unchanged) {
+        return false;
+    }
+
     // If we've run previously, check if we need to rerun
     if (has_run() && m_query->sync_view_if_needed() == m_last_seen_version) {
         return false;
@@ -107,9 +128,12 @@ void ResultsNotifier::calculate_changes()
     if (has_run()) {
         auto changes = table_ndx < m_info->tables.size() ? &m_info->tables[table_ndx] : nullptr;
 
+        // Only the rows within the limit are visible to the target, so rows
+        // beyond it are excluded from the diff entirely
+        size_t visible_rows = std::min(m_tv.size(), m_limit);
         std::vector<size_t> next_rows;
-        next_rows.reserve(m_tv.size());
-        for (size_t i = 0; i < m_tv.size(); ++i)
+        next_rows.reserve(visible_rows);
+        for (size_t i = 0; i < visible_rows; ++i)
             next_rows.push_back(m_tv[i].get_index());
 
         util::Optional<IndexSet> move_candidates;
@@ -136,19 +160,106 @@ void ResultsNotifier::calculate_changes()
         m_previous_rows = std::move(next_rows);
     }
     else {
-        m_previous_rows.resize(m_tv.size());
-        for (size_t i = 0; i < m_tv.size(); ++i)
+        m_previous_rows.resize(std::min(m_tv.size(), m_limit));
+        for (size_t i = 0; i < m_previous_rows.size(); ++i)
             m_previous_rows[i] = m_tv[i].get_index();
     }
 }
 
-void ResultsNotifier::run()
+bool ResultsNotifier::try_run_incremental()
+{
+    if (!has_run() || m_distinct || !m_info)
+        return false;
+
+    size_t table_ndx = m_query->get_table()->get_index_in_group();
+    if (table_ndx >= m_info->tables.size())
+        return false;
+
+    // Modifications to rows in tables we link to can change which rows match
+    // the query in ways which we can't determine without rerunning it
+    for (auto& table : related_tables()) {
+        if (table.table_ndx != table_ndx && table.table_ndx < m_info->tables.size()
+            && !m_info->tables[table.table_ndx].empty())
+            return false;
+    }
+
+    // Insertions, deletions and moves always change either the set of matching
+    // rows or the indexes which the TableView needs to store, so only
+    // modification-only changesets can skip the rerun
+    auto& changes = m_info->tables[table_ndx];
+    if (!changes.insertions.empty() || !changes.deletions.empty() || !changes.moves.empty())
+        return false;
+
+    // Testing rows against the query one at a time is only a win when the
+    // commit touched a small number of rows
+    const size_t max_rows_to_test = 100;
+    if (changes.modifications.count() > max_rows_to_test)
+        return false;
+
+    for (auto ndx : changes.modifications.as_indexes()) {
+        bool matches = m_query->count(ndx, ndx + 1) != 0;
+        auto it = std::find(m_previous_rows.begin(), m_previous_rows.end(), ndx);
+        bool was_in_results = it != m_previous_rows.end();
+        // The modification added or removed the row from the results
+        if (matches != was_in_results)
+            return false;
+        // The modification is to a row which this query never matched
+        if (!was_in_results)
+            continue;
+        // The row remains in the results, but its position in a sorted view
+        // may have changed. If we know which columns the sort reads and none
+        // of them were modified then it hasn't, and the full rerun and
+        // re-sort can still be skipped.
+        if (m_sort) {
+            if (m_sort_columns.empty())
+                return false;
+            auto& columns = changes.columns;
+            bool sort_input_changed = std::any_of(m_sort_columns.begin(), m_sort_columns.end(), [&](auto col) {
+                return col < columns.size() && columns[col].contains(ndx);
+            });
+            if (sort_input_changed)
+                return false;
+        }
+        m_changes.modifications.add(it - m_previous_rows.begin());
+    }
+
+    // The matching rows (and their order) are unchanged, so the previously
+    // delivered TableView remains valid and there's nothing to hand over
+    m_last_seen_version = m_query->sync_view_if_needed();
+    return true;
+}
+
+void ResultsNotifier::do_run()
 {
+    if (m_info)
+        update_derived_values(*m_query->get_table(), *m_info);
+
     if (!need_to_run())
         return;
 
+    // If every callback is inside its minimum delivery interval, bank this
+    // frame's changes and skip rerunning the query entirely. The next frame
+    // which does run diffs against the rows from before the skipped span, so
+    // the eventual changeset covers everything since the last delivery.
+    if (!(m_info = throttle_change_info(*m_info))) {
+        m_exported_view_is_current = false;
+        return;
+    }
+
+    // If the commit being processed only modified rows in ways which don't
+    // change which rows match the query, we can update the results from the
+    // row-level change information rather than rerunning the query
+    if (try_run_incremental())
+        return;
+
     m_query->sync_view_if_needed();
-    m_tv = m_query->find_all();
+    // An unsorted limit can be applied by the query itself, which can then
+    // stop once it has found enough matching rows. A sorted limit has to
+    // examine every match and is applied when building the diff instead.
+    if (m_limit != npos && !m_sort && !m_distinct)
+        m_tv = m_query->find_all(0, size_t(-1), m_limit);
+    else
+        m_tv = m_query->find_all();
     if (m_sort) {
         m_tv.sort(m_sort);
     }
@@ -156,12 +267,15 @@ void ResultsNotifier::run()
         m_tv.distinct(m_distinct);
     }
     m_last_seen_version = m_tv.sync_if_needed();
+    set_retained_row_count(m_tv.size());
 
     calculate_changes();
 }
 
 void ResultsNotifier::do_prepare_handover(SharedGroup& sg)
 {
+    m_changes_since_delivery.merge(CollectionChangeBuilder(m_changes));
+
     if (!m_tv.is_attached()) {
         // if the table version didn't change we can just reuse the same handover
         // object and bump its version to the current SG version
@@ -169,14 +283,35 @@ void ResultsNotifier::do_prepare_handover(SharedGroup& sg)
             m_tv_handover->version = sg.get_version_of_current_transaction();
 
         // add_changes() needs to be called even if there are no changes to
-        // clear the skip flag on the callbacks
-        add_changes({});
+        // clear the skip flag on the callbacks. This also delivers any
+        // modifications recorded by the incremental evaluation path.
+        add_changes(std::move(m_changes));
+        REALM_ASSERT(m_changes.empty());
         return;
     }
 
     REALM_ASSERT(m_tv.is_in_sync());
 
+    // If rerunning the query produced exactly the rows which were last
+    // exported there's no need to ship a new copy of the view: just the
+    // changeset is delivered, and the target keeps using the view it
+    // already has. An undelivered handover can have its version bumped as
+    // its contents are also still correct. Limited Results are excluded
+    // because the diff only covers the visible window of the view.
+    bool rows_unchanged = m_changes.insertions.empty()
+                       && m_changes.deletions.empty()
+                       && m_changes.moves.empty();
+    if (m_exported_view_is_current && rows_unchanged && m_limit == npos) {
+        if (m_tv_handover)
+            m_tv_handover->version = sg.get_version_of_current_transaction();
+        add_changes(std::move(m_changes));
+        REALM_ASSERT(m_changes.empty());
+        m_tv = {};
+        return;
+    }
+
     m_tv_handover = sg.export_for_handover(m_tv, MutableSourcePayload::Move);
+    m_exported_view_is_current = true;
 
     add_changes(std::move(m_changes));
     REALM_ASSERT(m_changes.empty());
@@ -200,9 +335,20 @@ void ResultsNotifier::deliver(SharedGroup& sg)
     REALM_ASSERT(!m_query_handover);
     if (m_tv_to_deliver) {
         Results::Internal::set_table_view(*m_target_results,
-                                          std::move(*sg.import_from_handover(std::move(m_tv_to_deliver))));
+                                          std::move(*sg.import_from_handover(std::move(m_tv_to_deliver))),
+                                          m_changes_to_patch);
     }
+    m_changes_to_patch = {};
     REALM_ASSERT(!m_tv_to_deliver);
+
+    // Tell the target that its view matches the query results at this
+    // version, whether because a view was just delivered or because the
+    // export was skipped due to the rows not changing, so that it doesn't
+    // need to rerun the query itself when next used
+    if (m_deliver_view_is_current) {
+        Results::Internal::confirm_view_version(*m_target_results,
+                                                sg.get_version_of_current_transaction());
+    }
 }
 
 bool ResultsNotifier::prepare_to_deliver()
@@ -211,6 +357,9 @@ bool ResultsNotifier::prepare_to_deliver()
     if (!get_realm())
         return false;
     m_tv_to_deliver = std::move(m_tv_handover);
+    m_deliver_view_is_current = m_exported_view_is_current;
+    m_changes_to_patch = std::move(m_changes_since_delivery);
+    m_changes_since_delivery = {};
     return true;
 }
 
@@ -45,14 +45,34 @@ private:
     SortDescriptor m_sort;
     SortDescriptor::HandoverPatch m_distinct_handover;
     SortDescriptor m_distinct;
+
+    // The root-table columns the sort reads, when the target knows them
+    // (see Results::get_sort_columns()). When non-empty, per-column change
+    // info is requested for the table so that the incremental evaluation
+    // path can tell whether a modification could have reordered the view.
+    const std::vector<size_t> m_sort_columns;
     bool m_target_is_in_table_order;
 
+    // Maximum number of rows the target Results can contain, from
+    // Results::limit(), or npos when unlimited
+    size_t m_limit;
+
     // The TableView resulting from running the query. Will be detached unless
     // the query was (re)run since the last time the handover object was created
     TableView m_tv;
     std::unique_ptr<SharedGroup::Handover<TableView>> m_tv_handover;
     std::unique_ptr<SharedGroup::Handover<TableView>> m_tv_to_deliver;
 
+    // Whether the contents of the most recently exported TableView still
+    // match the query's current results. When rerunning the query produces
+    // the same rows in the same order, the export is skipped and only the
+    // changeset is shipped, with deliver() then confirming to the target
+    // that its existing view remains current. Written on the worker thread
+    // in do_prepare_handover() and copied to m_deliver_view_is_current
+    // alongside the handover.
+    bool m_exported_view_is_current = false;
+    bool m_deliver_view_is_current = false;
+
     // The table version from the last time the query was run. Used to avoid
     // rerunning the query when there's no chance of it changing.
     uint_fast64_t m_last_seen_version = -1;
@@ -64,11 +84,20 @@ private:
     CollectionChangeBuilder m_changes;
     TransactionChangeInfo* m_info = nullptr;
 
+    // Changes accumulated since the last delivery to the target Results,
+    // used to patch the target's row index map. m_changes_since_delivery is
+    // written on the worker thread in do_prepare_handover() and moved to
+    // m_changes_to_patch together with the TableView handover, so the two
+    // always describe the same version of the view.
+    CollectionChangeBuilder m_changes_since_delivery;
+    CollectionChangeBuilder m_changes_to_patch;
+
     bool need_to_run();
+    bool try_run_incremental();
     void calculate_changes();
     void deliver(SharedGroup&) override;
 
-    void run() override;
+    void do_run() override;
     void do_prepare_handover(SharedGroup&) override;
     bool do_add_required_change_info(TransactionChangeInfo& info) override;
     bool prepare_to_deliver() override;
@@ -0,0 +1,242 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "impl/schema_cache.hpp"
+
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace realm;
+using namespace realm::_impl;
+
+namespace {
+// Bumped whenever the serialization format below changes; old caches are
+// simply discarded
+const uint32_t format_version = 1;
+const char magic[8] = {'r', 'l', 'm', 's', 'c', 'h', 'm', 'a'};
+
+// 64-bit FNV-1a over the serialized payload, to reject truncated or torn
+// writes without needing an atomic rename
+uint64_t hash_payload(const char* data, size_t size)
+{
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+        value = (value ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    return value;
+}
+
+class Writer {
+public:
+    void append(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            m_data.push_back(char(value >> (i * 8)));
+    }
+
+    void append(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_data.push_back(char(value >> (i * 8)));
+    }
+
+    void append(std::string const& str)
+    {
+        append(uint32_t(str.size()));
+        m_data.insert(m_data.end(), str.begin(), str.end());
+    }
+
+    std::vector<char> const& data() const { return m_data; }
+
+private:
+    std::vector<char> m_data;
+};
+
+// Reads the payload back, with all functions reporting failure by setting
+// a sticky error flag rather than throwing so that a damaged cache of any
+// shape just falls back to reading the schema from the Group
+class Reader {
+public:
+    Reader(const char* data, size_t size) : m_data(data), m_size(size) { }
+
+    uint64_t read_uint64()
+    {
+        uint64_t value = 0;
+        if (!ensure(8))
+            return 0;
+        for (int i = 0; i < 8; ++i)
+            value |= uint64_t(static_cast<unsigned char>(m_data[m_pos + i])) << (i * 8);
+        m_pos += 8;
+        return value;
+    }
+
+    uint32_t read_uint32()
+    {
+        uint32_t value = 0;
+        if (!ensure(4))
+            return 0;
+        for (int i = 0; i < 4; ++i)
+            value |= uint32_t(static_cast<unsigned char>(m_data[m_pos + i])) << (i * 8);
+        m_pos += 4;
+        return value;
+    }
+
+    std::string read_string()
+    {
+        auto size = read_uint32();
+        if (!ensure(size))
+            return "";
+        std::string str(m_data + m_pos, size);
+        m_pos += size;
+        return str;
+    }
+
+    bool valid() const { return !m_error; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    bool m_error = false;
+
+    bool ensure(size_t count)
+    {
+        if (m_size - m_pos < count) {
+            m_error = true;
+            return false;
+        }
+        return true;
+    }
+};
+
+void append_property(Writer& writer, Property const& property)
+{
+    writer.append(property.name);
+    writer.append(uint32_t(property.type));
+    writer.append(property.object_type);
+    writer.append(property.link_origin_property_name);
+    writer.append(uint32_t(property.is_primary << 2 | property.is_indexed << 1 | int(property.is_nullable)));
+    writer.append(uint64_t(property.table_column));
+}
+
+Property read_property(Reader& reader)
+{
+    Property property;
+    property.name = reader.read_string();
+    property.type = PropertyType(reader.read_uint32());
+    property.object_type = reader.read_string();
+    property.link_origin_property_name = reader.read_string();
+    auto flags = reader.read_uint32();
+    property.is_primary = (flags & 4) != 0;
+    property.is_indexed = (flags & 2) != 0;
+    property.is_nullable = (flags & 1) != 0;
+    property.table_column = size_t(reader.read_uint64());
+    return property;
+}
+} // anonymous namespace
+
+std::string schema_cache::path_for_realm(std::string const& realm_path)
+{
+    return realm_path + ".schema_cache";
+}
+
+util::Optional<Schema> schema_cache::load(std::string const& cache_path,
+                                          uint64_t transaction_version,
+                                          uint64_t& schema_version)
+{
+    std::ifstream file(cache_path, std::ios::binary);
+    if (!file)
+        return util::none;
+    std::vector<char> buffer{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (!file.good() && !file.eof())
+        return util::none;
+
+    // Header: magic, format version, payload hash
+    const size_t header_size = sizeof(magic) + 4 + 8;
+    if (buffer.size() < header_size || memcmp(buffer.data(), magic, sizeof(magic)) != 0)
+        return util::none;
+    Reader header(buffer.data() + sizeof(magic), header_size - sizeof(magic));
+    if (header.read_uint32() != format_version)
+        return util::none;
+    if (header.read_uint64() != hash_payload(buffer.data() + header_size, buffer.size() - header_size))
+        return util::none;
+
+    Reader reader(buffer.data() + header_size, buffer.size() - header_size);
+    if (reader.read_uint64() != transaction_version)
+        return util::none;
+    schema_version = reader.read_uint64();
+
+    std::vector<ObjectSchema> objects(reader.read_uint32());
+    for (auto& object : objects) {
+        object.name = reader.read_string();
+        object.primary_key = reader.read_string();
+        size_t persisted_count = reader.read_uint32();
+        size_t computed_count = reader.read_uint32();
+        if (!reader.valid())
+            return util::none;
+        object.persisted_properties.reserve(persisted_count);
+        for (size_t i = 0; i < persisted_count; ++i)
+            object.persisted_properties.push_back(read_property(reader));
+        object.computed_properties.reserve(computed_count);
+        for (size_t i = 0; i < computed_count; ++i)
+            object.computed_properties.push_back(read_property(reader));
+    }
+    if (!reader.valid())
+        return util::none;
+    return Schema(std::move(objects));
+}
+
+void schema_cache::write(std::string const& cache_path, Schema const& schema,
+                         uint64_t schema_version, uint64_t transaction_version)
+{
+    Writer payload;
+    payload.append(transaction_version);
+    payload.append(schema_version);
+    payload.append(uint32_t(schema.size()));
+    for (auto& object : schema) {
+        payload.append(object.name);
+        payload.append(object.primary_key);
+        payload.append(uint32_t(object.persisted_properties.size()));
+        payload.append(uint32_t(object.computed_properties.size()));
+        for (auto& property : object.persisted_properties)
+            append_property(payload, property);
+        for (auto& property : object.computed_properties)
+            append_property(payload, property);
+    }
+
+    Writer header;
+    header.append(format_version);
+    header.append(hash_payload(payload.data().data(), payload.data().size()));
+
+    std::ofstream file(cache_path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return;
+    file.write(magic, sizeof(magic));
+    file.write(header.data().data(), header.data().size());
+    file.write(payload.data().data(), payload.data().size());
+}
+
+void schema_cache::remove(std::string const& cache_path)
+{
+    ::remove(cache_path.c_str());
+}
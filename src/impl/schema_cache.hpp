@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_SCHEMA_CACHE_HPP
+#define REALM_SCHEMA_CACHE_HPP
+
+#include <realm/util/optional.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace realm {
+class Schema;
+
+namespace _impl {
+// Persisted schema cache, stored in a sidecar file next to the Realm file.
+//
+// Reading the schema from the Group on a cold open walks every table and
+// column even though the result is nearly always identical to the previous
+// run's. The cache stores a serialized copy of the schema along with the
+// transaction version it was read at, so an open only has to compare the
+// file's current version against the cached one (and verify the blob's
+// checksum) rather than rebuilding the schema from the Group. Any commit
+// made after the cache was written conservatively invalidates it.
+namespace schema_cache {
+// The sidecar path for the Realm file at `realm_path`
+std::string path_for_realm(std::string const& realm_path);
+
+// Read the cached schema, verifying the blob's hash and that it was written
+// at exactly `transaction_version`. Returns none (and never throws) if the
+// cache is missing, damaged, or was written at a different version.
+util::Optional<Schema> load(std::string const& cache_path, uint64_t transaction_version,
+                            uint64_t& schema_version);
+
+// Write the schema as read at `transaction_version`. Best-effort: failures
+// are swallowed, as the cache is rebuilt from the Group when absent.
+void write(std::string const& cache_path, Schema const& schema,
+           uint64_t schema_version, uint64_t transaction_version);
+
+// Delete the cache, if present. Called when the Realm file itself is
+// deleted or replaced so that a new file cannot pick up a stale cache.
+void remove(std::string const& cache_path);
+} // namespace schema_cache
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_SCHEMA_CACHE_HPP
@@ -20,8 +20,10 @@
 
 #include "binding_context.hpp"
 #include "impl/collection_notifier.hpp"
+#include "impl/commit_metadata.hpp"
 #include "index_set.hpp"
 #include "shared_realm.hpp"
+#include "util/tracing.hpp"
 
 #include <realm/group_shared.hpp>
 #include <realm/lang_bind_helper.hpp>
@@ -87,9 +89,12 @@ KVOAdapter::KVOAdapter(std::vector<BindingContext::ObserverState>& observers, Bi
         table_modifications_needed.resize(*max + 1, false);
     if (*max >= table_moves_needed.size())
         table_moves_needed.resize(*max + 1, false);
+    if (*max >= table_columns_needed.size())
+        table_columns_needed.resize(*max + 1, false);
     for (auto& tbl : tables_needed) {
         table_modifications_needed[tbl] = true;
         table_moves_needed[tbl] = true;
+        table_columns_needed[tbl] = true;
     }
     for (auto& list : m_lists)
         lists.push_back({list.observer->table_ndx, list.observer->row_ndx, list.col, &list.builder});
@@ -104,42 +109,99 @@ void KVOAdapter::before(SharedGroup& sg)
     if (tables.empty())
         return;
 
-    for (auto& observer : m_observers) {
-        size_t table_ndx = new_table_ndx(observer.table_ndx);
-        if (table_ndx >= tables.size())
+    // Sort the observers by table and row so that each table's deletion,
+    // insertion and move information is walked with one forward pass shared
+    // by all of that table's observers, rather than rescanning the ranges
+    // from the start for every observer. The observer vector itself has to
+    // stay in its original order as it is handed to the context as-is.
+    std::vector<BindingContext::ObserverState*> ordered;
+    ordered.reserve(m_observers.size());
+    for (auto& observer : m_observers)
+        ordered.push_back(&observer);
+    std::sort(begin(ordered), end(ordered), [&](auto lft, auto rgt) {
+        auto lft_table = new_table_ndx(lft->table_ndx), rgt_table = new_table_ndx(rgt->table_ndx);
+        return std::tie(lft_table, lft->row_ndx) < std::tie(rgt_table, rgt->row_ndx);
+    });
+
+    bool rows_moved = false;
+    for (auto group = begin(ordered); group != end(ordered);) {
+        size_t table_ndx = new_table_ndx((*group)->table_ndx);
+        auto group_end = std::find_if(group, end(ordered), [&](auto observer) {
+            return new_table_ndx(observer->table_ndx) != table_ndx;
+        });
+        if (table_ndx >= tables.size()) {
+            // No row changes in this table, but the table itself may have moved
+            for (; group != group_end; ++group) {
+                if ((*group)->table_ndx != table_ndx) {
+                    (*group)->table_ndx = table_ndx;
+                    rows_moved = true;
+                }
+            }
             continue;
+        }
 
+        // Cursors into the table's change information, which only ever move
+        // forward as the observed rows are visited in ascending order
         auto const& table = tables[table_ndx];
-        auto const& moves = table.moves;
-        auto idx = observer.row_ndx;
-        auto it = lower_bound(begin(moves), end(moves), idx,
-                              [](auto const& a, auto b) { return a.from < b; });
-        if (it != moves.end() && it->from == idx)
-            idx = it->to;
-        else if (table.deletions.contains(idx)) {
-            m_invalidated.push_back(observer.info);
-            continue;
-        }
-        else
-            idx = table.insertions.shift(table.deletions.unshift(idx));
-        if (table.modifications.contains(idx)) {
-            observer.changes.resize(table.columns.size());
-            size_t i = 0;
-            for (auto& c : table.columns) {
-                auto& change = observer.changes[i];
-                if (table_ndx >= column_indices.size() || column_indices[table_ndx].empty())
-                    change.initial_column_index = i;
-                else if (i >= column_indices[table_ndx].size())
-                    change.initial_column_index = i - column_indices[table_ndx].size() + column_indices[table_ndx].back() + 1;
-                else
-                    change.initial_column_index = column_indices[table_ndx][i];
-                if (change.initial_column_index != npos && c.contains(idx))
-                    change.kind = BindingContext::ColumnInfo::Kind::Set;
-                ++i;
+        auto move_it = table.moves.begin(), move_end = table.moves.end();
+        auto del_it = table.deletions.begin(), del_end = table.deletions.end();
+        auto ins_it = table.insertions.begin(), ins_end = table.insertions.end();
+        size_t deleted_below = 0, inserted_below = 0;
+
+        for (; group != group_end; ++group) {
+            auto& observer = **group;
+            auto idx = observer.row_ndx;
+            while (move_it != move_end && move_it->from < idx)
+                ++move_it;
+            if (move_it != move_end && move_it->from == idx)
+                idx = move_it->to;
+            else {
+                while (del_it != del_end && del_it->second <= idx) {
+                    deleted_below += del_it->second - del_it->first;
+                    ++del_it;
+                }
+                if (del_it != del_end && del_it->first <= idx) {
+                    m_invalidated.push_back(observer.info);
+                    continue;
+                }
+                // Equivalent to insertions.shift(deletions.unshift(idx)), but
+                // resuming from the position the previous observer reached
+                idx = idx - deleted_below + inserted_below;
+                while (ins_it != ins_end && ins_it->first <= idx) {
+                    inserted_below += ins_it->second - ins_it->first;
+                    idx += ins_it->second - ins_it->first;
+                    ++ins_it;
+                }
+            }
+            if (observer.table_ndx != table_ndx || observer.row_ndx != idx) {
+                observer.table_ndx = table_ndx;
+                observer.row_ndx = idx;
+                rows_moved = true;
+            }
+            if (table.modifications.contains(idx)) {
+                observer.changes.resize(table.columns.size());
+                size_t i = 0;
+                for (auto& c : table.columns) {
+                    auto& change = observer.changes[i];
+                    if (table_ndx >= column_indices.size() || column_indices[table_ndx].empty())
+                        change.initial_column_index = i;
+                    else if (i >= column_indices[table_ndx].size())
+                        change.initial_column_index = i - column_indices[table_ndx].size() + column_indices[table_ndx].back() + 1;
+                    else
+                        change.initial_column_index = column_indices[table_ndx][i];
+                    if (change.initial_column_index != npos && c.contains(idx))
+                        change.kind = BindingContext::ColumnInfo::Kind::Set;
+                    ++i;
+                }
             }
         }
     }
 
+    // If the rows are registered on the context rather than being rebuilt by
+    // the binding each time, push the updated positions back to the registry
+    if (rows_moved || !m_invalidated.empty())
+        m_context->update_observed_rows(m_observers, m_invalidated);
+
     for (auto& list : m_lists) {
         if (list.builder.empty())
             continue;
@@ -228,10 +290,17 @@ struct MarkDirtyMixin  {
     bool set_string_unique(size_t, size_t, size_t, StringData) { return true; }
 };
 
+void adjust_for_move(std::vector<size_t>& values, size_t from, size_t to);
+void adjust_ge(std::vector<size_t>& values, size_t i);
+
 class TransactLogValidationMixin {
     // Index of currently selected table
     size_t m_current_table = 0;
 
+    // Group-level indices of tables which had schema changes, if the caller
+    // asked for them to be recorded
+    std::vector<size_t>* m_schema_changes;
+
     REALM_NORETURN
     REALM_NOINLINE
     void schema_error()
@@ -239,10 +308,26 @@ class TransactLogValidationMixin {
         throw std::logic_error("Schema mismatch detected: another process has modified the Realm file's schema in an incompatible way");
     }
 
+    void mark_schema_changed(size_t table_ndx)
+    {
+        if (!m_schema_changes)
+            return;
+        auto& tables = *m_schema_changes;
+        if (std::find(begin(tables), end(tables), table_ndx) == end(tables))
+            tables.push_back(table_ndx);
+    }
+
 protected:
     size_t current_table() const noexcept { return m_current_table; }
 
 public:
+    TransactLogValidationMixin(std::vector<size_t>* schema_changes = nullptr)
+    : m_schema_changes(schema_changes)
+    {
+        if (m_schema_changes)
+            m_schema_changes->clear();
+    }
+
     bool select_descriptor(int levels, const size_t*)
     {
         // subtables not supported
@@ -264,16 +349,34 @@ public:
 
     // Schema changes which don't involve a change in the schema version are
     // allowed
-    bool add_search_index(size_t) { return true; }
-    bool remove_search_index(size_t) { return true; }
+    bool add_search_index(size_t) { mark_schema_changed(m_current_table); return true; }
+    bool remove_search_index(size_t) { mark_schema_changed(m_current_table); return true; }
 
     // Additive changes and reorderings are supported
-    bool insert_group_level_table(size_t, size_t, StringData) { return true; }
-    bool insert_column(size_t, DataType, StringData, bool) { return true; }
-    bool insert_link_column(size_t, DataType, StringData, size_t, size_t) { return true; }
-    bool set_link_type(size_t, LinkType) { return true; }
-    bool move_column(size_t, size_t) { return true; }
-    bool move_group_level_table(size_t, size_t) { return true; }
+    bool insert_group_level_table(size_t ndx, size_t, StringData)
+    {
+        if (m_schema_changes) {
+            adjust_ge(*m_schema_changes, ndx);
+            mark_schema_changed(ndx);
+        }
+        return true;
+    }
+    bool insert_column(size_t, DataType, StringData, bool) { mark_schema_changed(m_current_table); return true; }
+    bool insert_link_column(size_t, DataType, StringData, size_t target_table_ndx, size_t)
+    {
+        // The target table gains a backlink column as well
+        mark_schema_changed(m_current_table);
+        mark_schema_changed(target_table_ndx);
+        return true;
+    }
+    bool set_link_type(size_t, LinkType) { mark_schema_changed(m_current_table); return true; }
+    bool move_column(size_t, size_t) { mark_schema_changed(m_current_table); return true; }
+    bool move_group_level_table(size_t from, size_t to)
+    {
+        if (m_schema_changes)
+            adjust_for_move(*m_schema_changes, from, to);
+        return true;
+    }
 
     // Non-schema changes are all allowed
     void parse_complete() { }
@@ -297,9 +400,47 @@ public:
 // A transaction log handler that just validates that all operations made are
 // ones supported by the object store
 struct TransactLogValidator : public TransactLogValidationMixin, public MarkDirtyMixin<TransactLogValidator> {
+    using TransactLogValidationMixin::TransactLogValidationMixin;
     void mark_dirty(size_t, size_t) { }
 };
 
+// Records which group-level tables a span of the transact log touches, as a
+// CommitMetadata modified-table bitmask
+struct ModifiedTableObserver : public TransactLogValidationMixin, public MarkDirtyMixin<ModifiedTableObserver> {
+    ModifiedTableObserver(uint64_t& mask) : m_mask(mask) { }
+    void mark_dirty(size_t, size_t) { }
+
+    bool select_table(size_t group_level_ndx, int levels, const size_t* path) noexcept
+    {
+        TransactLogValidationMixin::select_table(group_level_ndx, levels, path);
+        m_mask |= _impl::CommitMetadata::table_bit(group_level_ndx);
+        return true;
+    }
+
+    bool insert_link_column(size_t col, DataType type, StringData name, size_t target_table_ndx, size_t backlink_col)
+    {
+        // The target table gains a backlink column as well
+        m_mask |= _impl::CommitMetadata::table_bit(target_table_ndx);
+        return TransactLogValidationMixin::insert_link_column(col, type, name, target_table_ndx, backlink_col);
+    }
+
+    // Adding or reordering tables shifts the indices the mask's bits are
+    // built from, so nothing can be proven about commits which do so
+    bool insert_group_level_table(size_t ndx, size_t num_tables, StringData name)
+    {
+        m_mask = ~0ULL;
+        return TransactLogValidationMixin::insert_group_level_table(ndx, num_tables, name);
+    }
+    bool move_group_level_table(size_t from, size_t to)
+    {
+        m_mask = ~0ULL;
+        return TransactLogValidationMixin::move_group_level_table(from, to);
+    }
+
+private:
+    uint64_t& m_mask;
+};
+
 // Move the value at container[from] to container[to], shifting everything in
 // between, or do nothing if either are out of bounds
 template<typename Container>
@@ -364,32 +505,72 @@ class TransactLogObserver : public TransactLogValidationMixin, public MarkDirtyM
     _impl::TransactionChangeInfo& m_info;
     _impl::CollectionChangeBuilder* m_active = nullptr;
 
-    _impl::CollectionChangeBuilder* get_change()
+    // Interest in the currently selected table, derived once per select_table
+    // instruction rather than rechecked for every row instruction. Commits
+    // typically touch far more tables than are being observed, and with this
+    // every instruction for an unobserved table reduces to a null check with
+    // no vector probes or scans of the observed-list array.
+    _impl::CollectionChangeBuilder* m_active_table = nullptr;
+    bool m_need_move_info = false;
+    bool m_need_column_info = false;
+    bool m_observing_lists_in_table = false;
+
+    _impl::CollectionChangeBuilder* get_change() const noexcept
     {
-        auto tbl_ndx = current_table();
-        if (!m_info.track_all && (tbl_ndx >= m_info.table_modifications_needed.size() || !m_info.table_modifications_needed[tbl_ndx]))
-            return nullptr;
-        if (m_info.tables.size() <= tbl_ndx) {
-            m_info.tables.resize(std::max(m_info.tables.size() * 2, tbl_ndx + 1));
-        }
-        return &m_info.tables[tbl_ndx];
+        return m_active_table;
     }
 
-    bool need_move_info() const
+    bool need_move_info() const noexcept
     {
-        auto tbl_ndx = current_table();
-        return m_info.track_all || (tbl_ndx < m_info.table_moves_needed.size() && m_info.table_moves_needed[tbl_ndx]);
+        return m_need_move_info;
     }
 
+    bool need_column_info() const noexcept
+    {
+        return m_need_column_info;
+    }
+
+    // Recompute the cached interest state for the current table. Must be
+    // called again whenever something which feeds into it changes, i.e. after
+    // instructions which reorder m_info.tables or renumber the list entries.
+    void update_selected_table()
+    {
+        auto tbl_ndx = current_table();
+        if (!m_info.track_all && (tbl_ndx >= m_info.table_modifications_needed.size() || !m_info.table_modifications_needed[tbl_ndx]))
+            m_active_table = nullptr;
+        else {
+            if (m_info.tables.size() <= tbl_ndx) {
+                m_info.tables.resize(std::max(m_info.tables.size() * 2, tbl_ndx + 1));
+            }
+            m_active_table = &m_info.tables[tbl_ndx];
+        }
+        m_need_move_info = m_info.track_all || (tbl_ndx < m_info.table_moves_needed.size() && m_info.table_moves_needed[tbl_ndx]);
+        m_need_column_info = m_info.track_all || (tbl_ndx < m_info.table_columns_needed.size() && m_info.table_columns_needed[tbl_ndx]);
+        m_observing_lists_in_table = std::any_of(begin(m_info.lists), end(m_info.lists),
+                                                 [&](auto const& list) { return list.table_ndx == tbl_ndx; });
+    }
 
 public:
-    TransactLogObserver(_impl::TransactionChangeInfo& info)
-    : m_info(info) { }
+    // m_info is not safe to read here as KVOTransactLogObserver hands its
+    // adapter to this constructor before the adapter itself is constructed.
+    // The interest state is instead computed at the first select_table, which
+    // the log format guarantees precedes any table-scoped instruction.
+    TransactLogObserver(_impl::TransactionChangeInfo& info, std::vector<size_t>* schema_changes = nullptr)
+    : TransactLogValidationMixin(schema_changes)
+    , m_info(info) { }
+
+    // Not noexcept as growing m_info.tables can throw
+    bool select_table(size_t group_level_ndx, int levels, const size_t* path)
+    {
+        TransactLogValidationMixin::select_table(group_level_ndx, levels, path);
+        update_selected_table();
+        return true;
+    }
 
     void mark_dirty(size_t row, size_t col)
     {
         if (auto change = get_change())
-            change->modify(row, col);
+            change->modify(row, need_column_info() ? col : IndexSet::npos);
     }
 
     void parse_complete()
@@ -466,13 +647,22 @@ public:
         return true;
     }
 
-    bool insert_empty_rows(size_t row_ndx, size_t num_rows_to_insert, size_t, bool)
+    bool insert_empty_rows(size_t row_ndx, size_t num_rows_to_insert, size_t prior_num_rows, bool)
     {
-        if (auto change = get_change())
-            change->insert(row_ndx, num_rows_to_insert, need_move_info());
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table() && list.row_ndx >= row_ndx)
-                list.row_ndx += num_rows_to_insert;
+        if (auto change = get_change()) {
+            // Rows added at the end of the table (the typical commit shape)
+            // can't shift any previously tracked index, so the general
+            // insertion logic can be skipped
+            if (row_ndx == prior_num_rows)
+                change->append(row_ndx, num_rows_to_insert, need_move_info());
+            else
+                change->insert(row_ndx, num_rows_to_insert, need_move_info());
+        }
+        if (m_observing_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table() && list.row_ndx >= row_ndx)
+                    list.row_ndx += num_rows_to_insert;
+            }
         }
         return true;
     }
@@ -487,18 +677,20 @@ public:
         REALM_ASSERT(unordered);
         size_t last_row = prior_num_rows - 1;
 
-        for (size_t i = 0; i < m_info.lists.size(); ++i) {
-            auto& list = m_info.lists[i];
-            if (list.table_ndx != current_table())
-                continue;
-            if (list.row_ndx == row_ndx) {
-                if (i + 1 < m_info.lists.size())
-                    m_info.lists[i] = std::move(m_info.lists.back());
-                m_info.lists.pop_back();
-                continue;
+        if (m_observing_lists_in_table) {
+            for (size_t i = 0; i < m_info.lists.size(); ++i) {
+                auto& list = m_info.lists[i];
+                if (list.table_ndx != current_table())
+                    continue;
+                if (list.row_ndx == row_ndx) {
+                    if (i + 1 < m_info.lists.size())
+                        m_info.lists[i] = std::move(m_info.lists.back());
+                    m_info.lists.pop_back();
+                    continue;
+                }
+                if (list.row_ndx == last_row)
+                    list.row_ndx = row_ndx;
             }
-            if (list.row_ndx == last_row)
-                list.row_ndx = row_ndx;
         }
 
         if (auto change = get_change())
@@ -508,12 +700,14 @@ public:
 
     bool swap_rows(size_t row_ndx_1, size_t row_ndx_2) {
         REALM_ASSERT(row_ndx_1 < row_ndx_2);
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table()) {
-                if (list.row_ndx == row_ndx_1)
-                    list.row_ndx = row_ndx_2;
-                else if (list.row_ndx == row_ndx_2)
-                    list.row_ndx = row_ndx_1;
+        if (m_observing_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table()) {
+                    if (list.row_ndx == row_ndx_1)
+                        list.row_ndx = row_ndx_2;
+                    else if (list.row_ndx == row_ndx_2)
+                        list.row_ndx = row_ndx_1;
+                }
             }
         }
         if (auto change = get_change())
@@ -523,9 +717,11 @@ public:
 
     bool merge_rows(size_t from, size_t to)
     {
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table() && list.row_ndx == from)
-                list.row_ndx = to;
+        if (m_observing_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table() && list.row_ndx == from)
+                    list.row_ndx = to;
+            }
         }
         if (auto change = get_change())
             change->subsume(from, to, need_move_info());
@@ -534,22 +730,28 @@ public:
 
     bool clear_table()
     {
-        auto tbl_ndx = current_table();
-        auto it = remove_if(begin(m_info.lists), end(m_info.lists),
-                            [&](auto const& lv) { return lv.table_ndx == tbl_ndx; });
-        m_info.lists.erase(it, end(m_info.lists));
+        if (m_observing_lists_in_table) {
+            auto tbl_ndx = current_table();
+            auto it = remove_if(begin(m_info.lists), end(m_info.lists),
+                                [&](auto const& lv) { return lv.table_ndx == tbl_ndx; });
+            m_info.lists.erase(it, end(m_info.lists));
+            m_observing_lists_in_table = false;
+        }
         if (auto change = get_change())
             change->clear(std::numeric_limits<size_t>::max());
         return true;
     }
 
-    bool insert_column(size_t ndx, DataType, StringData, bool)
+    bool insert_column(size_t ndx, DataType type, StringData name, bool nullable)
     {
+        TransactLogValidationMixin::insert_column(ndx, type, name, nullable);
         if (auto change = get_change())
             change->insert_column(ndx);
-        for (auto& list : m_info.lists) {
-            if (list.table_ndx == current_table() && list.col_ndx >= ndx)
-                ++list.col_ndx;
+        if (m_observing_lists_in_table) {
+            for (auto& list : m_info.lists) {
+                if (list.table_ndx == current_table() && list.col_ndx >= ndx)
+                    ++list.col_ndx;
+            }
         }
         if (m_info.column_indices.size() <= current_table())
             m_info.column_indices.resize(current_table() + 1);
@@ -568,8 +770,9 @@ public:
         }
     }
 
-    bool insert_group_level_table(size_t ndx, size_t, StringData)
+    bool insert_group_level_table(size_t ndx, size_t num_tables, StringData name)
     {
+        TransactLogValidationMixin::insert_group_level_table(ndx, num_tables, name);
         for (auto& list : m_info.lists) {
             if (list.table_ndx >= ndx)
                 ++list.table_ndx;
@@ -579,11 +782,15 @@ public:
         insert_empty_at(m_info.tables, ndx);
         insert_empty_at(m_info.table_moves_needed, ndx);
         insert_empty_at(m_info.table_modifications_needed, ndx);
+        // Inserting into m_info.tables may have invalidated the cached
+        // pointer into it
+        update_selected_table();
         return true;
     }
 
     bool move_column(size_t from, size_t to)
     {
+        TransactLogValidationMixin::move_column(from, to);
         if (auto change = get_change())
             change->move_column(from, to);
         for (auto& list : m_info.lists) {
@@ -599,6 +806,7 @@ public:
 
     bool move_group_level_table(size_t from, size_t to)
     {
+        TransactLogValidationMixin::move_group_level_table(from, to);
         for (auto& list : m_info.lists)
             adjust_for_move(list.table_ndx, from, to);
 
@@ -607,10 +815,17 @@ public:
         rotate(m_info.tables, from, to);
         rotate(m_info.table_modifications_needed, from, to);
         rotate(m_info.table_moves_needed, from, to);
+        // The move shuffles which entry of m_info.tables (and which interest
+        // flags) the current table corresponds to
+        update_selected_table();
         return true;
     }
 
-    bool insert_link_column(size_t ndx, DataType type, StringData name, size_t, size_t) { return insert_column(ndx, type, name, false); }
+    bool insert_link_column(size_t ndx, DataType type, StringData name, size_t target_table_ndx, size_t backlink_col_ndx)
+    {
+        TransactLogValidationMixin::insert_link_column(ndx, type, name, target_table_ndx, backlink_col_ndx);
+        return insert_column(ndx, type, name, false);
+    }
 };
 
 class KVOTransactLogObserver : public TransactLogObserver {
@@ -622,8 +837,9 @@ public:
     KVOTransactLogObserver(std::vector<BindingContext::ObserverState>& observers,
                      BindingContext* context,
                      _impl::NotifierPackage& notifiers,
-                     SharedGroup& sg)
-    : TransactLogObserver(m_adapter)
+                     SharedGroup& sg,
+                     std::vector<size_t>* schema_changes = nullptr)
+    : TransactLogObserver(m_adapter, schema_changes)
     , m_adapter(observers, context)
     , m_notifiers(notifiers)
     , m_sg(sg)
@@ -648,12 +864,13 @@ public:
 
 template<typename Func>
 void advance_with_notifications(BindingContext* context, const std::unique_ptr<SharedGroup>& sg, Func&& func,
-                                _impl::NotifierPackage& notifiers)
+                                _impl::NotifierPackage& notifiers,
+                                std::vector<size_t>* schema_changed_tables = nullptr)
 {
     auto old_version = sg->get_version_of_current_transaction();
     std::vector<BindingContext::ObserverState> observers;
     if (context) {
-        observers = context->get_observed_rows();
+        observers = context->observed_rows();
     }
 
     // Advancing to the latest version with notifiers requires using the full
@@ -661,7 +878,7 @@ void advance_with_notifications(BindingContext* context, const std::unique_ptr<S
     // version we're going to before we actually advance to that version
     if (observers.empty() && (!notifiers || notifiers.version())) {
         notifiers.before_advance();
-        func(TransactLogValidator());
+        func(TransactLogValidator(schema_changed_tables));
         auto new_version = sg->get_version_of_current_transaction();
         if (context && old_version != new_version)
             context->did_change({}, {});
@@ -676,7 +893,7 @@ void advance_with_notifications(BindingContext* context, const std::unique_ptr<S
         return;
     }
 
-    func(KVOTransactLogObserver(observers, context, notifiers, *sg));
+    func(KVOTransactLogObserver(observers, context, notifiers, *sg, schema_changed_tables));
     notifiers.package_and_wait(sg->get_version_of_current_transaction().version); // is a no-op if parse_complete() was called
     notifiers.deliver(*sg);
     notifiers.after_advance();
@@ -688,16 +905,17 @@ namespace realm {
 namespace _impl {
 
 namespace transaction {
-void advance(SharedGroup& sg, BindingContext*, VersionID version)
+void advance(SharedGroup& sg, BindingContext*, VersionID version, std::vector<size_t>* schema_changed_tables)
 {
-    LangBindHelper::advance_read(sg, TransactLogValidator(), version);
+    LangBindHelper::advance_read(sg, TransactLogValidator(schema_changed_tables), version);
 }
 
-void advance(const std::unique_ptr<SharedGroup>& sg, BindingContext* context, NotifierPackage& notifiers)
+void advance(const std::unique_ptr<SharedGroup>& sg, BindingContext* context, NotifierPackage& notifiers,
+             std::vector<size_t>* schema_changed_tables)
 {
     advance_with_notifications(context, sg, [&](auto&&... args) {
         LangBindHelper::advance_read(*sg, std::move(args)..., notifiers.version().value_or(VersionID{}));
-    }, notifiers);
+    }, notifiers, schema_changed_tables);
 }
 
 void begin_without_validation(SharedGroup& sg)
@@ -705,11 +923,12 @@ void begin_without_validation(SharedGroup& sg)
     LangBindHelper::promote_to_write(sg);
 }
 
-void begin(const std::unique_ptr<SharedGroup>& sg, BindingContext* context, NotifierPackage& notifiers)
+void begin(const std::unique_ptr<SharedGroup>& sg, BindingContext* context, NotifierPackage& notifiers,
+           std::vector<size_t>* schema_changed_tables)
 {
     advance_with_notifications(context, sg, [&](auto&&... args) {
         LangBindHelper::promote_to_write(*sg, std::move(args)...);
-    }, notifiers);
+    }, notifiers, schema_changed_tables);
 }
 
 void commit(SharedGroup& sg)
@@ -717,11 +936,16 @@ void commit(SharedGroup& sg)
     LangBindHelper::commit_and_continue_as_read(sg);
 }
 
-void cancel(SharedGroup& sg, BindingContext* context)
+void cancel(SharedGroup& sg, BindingContext* context, std::vector<size_t>* schema_changed_tables)
 {
+    // The rolled-back changes are not useful for incrementally updating the
+    // schema, so just discard any stale information
+    if (schema_changed_tables)
+        schema_changed_tables->clear();
+
     std::vector<BindingContext::ObserverState> observers;
     if (context) {
-        observers = context->get_observed_rows();
+        observers = context->observed_rows();
     }
     if (observers.empty()) {
         LangBindHelper::rollback_and_continue_as_read(sg);
@@ -732,12 +956,18 @@ void cancel(SharedGroup& sg, BindingContext* context)
     LangBindHelper::rollback_and_continue_as_read(sg, KVOTransactLogObserver(observers, context, notifiers, sg));
 }
 
+void advance(SharedGroup& sg, uint64_t& modified_table_mask, VersionID version)
+{
+    LangBindHelper::advance_read(sg, ModifiedTableObserver(modified_table_mask), version);
+}
+
 void advance(SharedGroup& sg, TransactionChangeInfo& info, VersionID version)
 {
     if (!info.track_all && info.table_modifications_needed.empty() && info.lists.empty()) {
         LangBindHelper::advance_read(sg, version);
     }
     else {
+        util::trace::Scope trace_scope(util::trace::Event::transact_log_parse, &sg);
         LangBindHelper::advance_read(sg, TransactLogObserver(info), version);
     }
 
@@ -23,6 +23,7 @@
 #include <realm/version_id.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace realm {
 class BindingContext;
@@ -35,13 +36,20 @@ struct TransactionChangeInfo;
 namespace transaction {
 // Advance the read transaction version, with change notifications sent to delegate
 // Must not be called from within a write transaction.
-void advance(const std::unique_ptr<SharedGroup>& sg, BindingContext* binding_context, NotifierPackage&);
-void advance(SharedGroup& sg, BindingContext* binding_context, VersionID);
+// If `schema_changed_tables` is non-null it is replaced with the group-level
+// indices of the tables whose schema was changed by the transactions
+// advanced over, which the schema change notification handler can use to
+// rebuild only the ObjectSchemas which actually changed.
+void advance(const std::unique_ptr<SharedGroup>& sg, BindingContext* binding_context, NotifierPackage&,
+             std::vector<size_t>* schema_changed_tables = nullptr);
+void advance(SharedGroup& sg, BindingContext* binding_context, VersionID,
+             std::vector<size_t>* schema_changed_tables = nullptr);
 
 // Begin a write transaction
 // If the read transaction version is not up to date, will first advance to the
 // most recent read transaction and sent notifications to delegate
-void begin(const std::unique_ptr<SharedGroup>& sg, BindingContext* binding_context, NotifierPackage&);
+void begin(const std::unique_ptr<SharedGroup>& sg, BindingContext* binding_context, NotifierPackage&,
+           std::vector<size_t>* schema_changed_tables = nullptr);
 void begin_without_validation(SharedGroup& sg);
 
 // Commit a write transaction
@@ -49,10 +57,17 @@ void commit(SharedGroup& sg);
 
 // Cancel a write transaction and roll back all changes, with change notifications
 // for reverting to the old values sent to delegate
-void cancel(SharedGroup& sg, BindingContext* binding_context);
+void cancel(SharedGroup& sg, BindingContext* binding_context,
+            std::vector<size_t>* schema_changed_tables = nullptr);
 
 // Advance the read transaction version, with change information gathered in info
 void advance(SharedGroup& sg, TransactionChangeInfo& info, VersionID version=VersionID{});
+
+// Advance the read transaction version, recording which group-level tables
+// the transactions advanced over modified as a CommitMetadata-style bitmask.
+// The mask is conservative: commits which changed the set of tables itself
+// set every bit, as the indices the bits are built from shift.
+void advance(SharedGroup& sg, uint64_t& modified_table_mask, VersionID version=VersionID{});
 } // namespace transaction
 } // namespace _impl
 } // namespace realm
@@ -21,29 +21,88 @@
 #include "shared_realm.hpp"
 #include "util/event_loop_signal.hpp"
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 using namespace realm;
 using namespace realm::_impl;
 
+// Shared by every WeakRealmNotifier bound to the same execution context.
+// Notifications enqueue the target Realm on the payload queue and the drain
+// walks all of them in one event-loop callback, so a commit burst costs one
+// wakeup per thread regardless of how many Realm instances are cached on it.
+class WeakRealmNotifier::Batcher {
+public:
+    // Get the batcher for the given execution context, creating it if there
+    // isn't one. Must be called on the context's thread, as creating it
+    // creates the underlying signal.
+    static std::shared_ptr<Batcher> get_shared(AnyExecutionContextID const& execution_context);
+
+    void notify(std::weak_ptr<Realm> const& realm)
+    {
+        m_signal.notify(realm);
+    }
+
+private:
+    struct Drain {
+        void operator()(std::vector<std::weak_ptr<Realm>>&& realms) const
+        {
+            // Back-to-back commits can enqueue the same Realm several times
+            // before the event loop gets to run; only notify each one once
+            std::vector<Realm*> notified;
+            for (auto& weak_realm : realms) {
+                if (auto realm = weak_realm.lock()) {
+                    if (std::find(notified.begin(), notified.end(), realm.get()) != notified.end())
+                        continue;
+                    notified.push_back(realm.get());
+                    realm->notify();
+                }
+            }
+        }
+    };
+
+    util::PayloadEventLoopSignal<std::weak_ptr<Realm>, Drain> m_signal{Drain{}};
+};
+
+std::shared_ptr<WeakRealmNotifier::Batcher>
+WeakRealmNotifier::Batcher::get_shared(AnyExecutionContextID const& execution_context)
+{
+    static std::mutex s_mutex;
+    static std::vector<std::pair<AnyExecutionContextID, std::weak_ptr<Batcher>>> s_batchers;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::shared_ptr<Batcher> batcher;
+    for (size_t i = 0; i < s_batchers.size(); ++i) {
+        if (auto existing = s_batchers[i].second.lock()) {
+            if (s_batchers[i].first == execution_context)
+                batcher = std::move(existing);
+        }
+        else {
+            // Prune contexts which no longer have any live Realm instances
+            s_batchers.erase(s_batchers.begin() + i);
+            --i;
+        }
+    }
+    if (!batcher) {
+        batcher = std::make_shared<Batcher>();
+        s_batchers.emplace_back(execution_context, batcher);
+    }
+    return batcher;
+}
 
 WeakRealmNotifier::WeakRealmNotifier(const std::shared_ptr<Realm>& realm, bool cache)
 : m_realm(realm)
 , m_execution_context(realm->config().execution_context)
 , m_realm_key(realm.get())
 , m_cache(cache)
-, m_signal(std::make_shared<util::EventLoopSignal<Callback>>(Callback{realm}))
+, m_batcher(Batcher::get_shared(m_execution_context))
 {
 }
 
 WeakRealmNotifier::~WeakRealmNotifier() = default;
 
-void WeakRealmNotifier::Callback::operator()() const
-{
-    if (auto realm = weak_realm.lock()) {
-        realm->notify();
-    }
-}
-
 void WeakRealmNotifier::notify()
 {
-    m_signal->notify();
+    m_batcher->notify(m_realm);
 }
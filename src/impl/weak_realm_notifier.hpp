@@ -27,10 +27,6 @@
 namespace realm {
 class Realm;
 
-namespace util {
-template<typename> class EventLoopSignal;
-}
-
 namespace _impl {
 // WeakRealmNotifier stores a weak reference to a Realm instance, along with all of
 // the information about a Realm that needs to be accessed from other threads.
@@ -65,11 +61,11 @@ private:
     void* m_realm_key;
     bool m_cache = false;
 
-    struct Callback {
-        const std::weak_ptr<Realm> weak_realm;
-        void operator()() const;
-    };
-    std::shared_ptr<util::EventLoopSignal<Callback>> m_signal;
+    // One signal shared by every WeakRealmNotifier bound to the same
+    // execution context, so that a commit burst produces a single event-loop
+    // wakeup per thread rather than one per live Realm instance
+    class Batcher;
+    std::shared_ptr<Batcher> m_batcher;
 };
 
 } // namespace _impl
@@ -20,21 +20,35 @@
 
 #include "impl/realm_coordinator.hpp"
 
+#include <realm/util/assert.hpp>
+
 #include <algorithm>
+#include <chrono>
 #include <codecvt>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 using namespace realm;
 using namespace realm::_impl;
 
-static HANDLE CreateNotificationEvent(std::string realm_path)
+static std::wstring ObjectNamespaceName(std::string realm_path, wchar_t const* suffix)
 {
     // replace backslashes because they're significant in object namespace names
     std::replace(realm_path.begin(), realm_path.end(), '\\', '/');
 
     std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    std::wstring path(L"Local\\" + converter.from_bytes(realm_path));
+    return L"Local\\" + converter.from_bytes(realm_path) + suffix;
+}
 
-    HANDLE event = CreateEventEx(nullptr, path.c_str(), CREATE_EVENT_MANUAL_RESET, SYNCHRONIZE | EVENT_MODIFY_STATE);
+static HANDLE CreateNotificationEvent(std::string const& realm_path)
+{
+    std::wstring name = ObjectNamespaceName(realm_path, L"");
+
+    HANDLE event = CreateEventEx(nullptr, name.c_str(), CREATE_EVENT_MANUAL_RESET, SYNCHRONIZE | EVENT_MODIFY_STATE);
     if (event == nullptr) {
         throw std::system_error(GetLastError(), std::system_category());
     }
@@ -42,44 +56,225 @@ static HANDLE CreateNotificationEvent(std::string realm_path)
     return event;
 }
 
+// Shared dispatch state for every ExternalCommitHelper in the process. The
+// per-Realm commit events are registered with the OS thread pool, whose wait
+// threads each service many handles, and the resulting wakeups are funnelled
+// into one work queue drained by a fixed set of worker threads. This mirrors
+// the epoll backend's design and replaces the thread-per-Realm listener.
+class ExternalCommitHelper::DaemonThread {
+public:
+    DaemonThread();
+    ~DaemonThread();
+
+    void add_commit_helper(ExternalCommitHelper* helper);
+    void remove_commit_helper(ExternalCommitHelper* helper);
+
+    static DaemonThread& shared();
+
+    static void CALLBACK wait_callback(PTP_CALLBACK_INSTANCE, void* context, PTP_WAIT wait, TP_WAIT_RESULT);
+
+private:
+    void on_event(ExternalCommitHelper* helper, PTP_WAIT wait);
+    void work();
+
+    // Protects m_helpers, the work queue and the helpers' dispatch flags
+    std::mutex m_mutex;
+    std::vector<ExternalCommitHelper*> m_helpers;
+    // Helpers with an unconsumed wakeup, waiting for a worker to call
+    // on_change() for them
+    std::deque<ExternalCommitHelper*> m_work_queue;
+    std::condition_variable m_work_cv;
+    // Signalled whenever a worker finishes a helper's on_change(), so that
+    // remove_commit_helper() can wait for in-flight work
+    std::condition_variable m_work_done_cv;
+    bool m_shutdown = false;
+    // Worker threads which the on_change() calls are dispatched to, so that
+    // one slow Realm does not delay notifications for every other Realm in
+    // the process
+    std::vector<std::thread> m_workers;
+    // Worker thread ids, for checking unexpected dead locks
+    std::vector<std::thread::id> m_thread_ids;
+};
+
+ExternalCommitHelper::DaemonThread::DaemonThread()
+{
+    // A handful of workers is enough: the work is mostly waiting on the
+    // notifier SharedGroup, and per-helper serialization caps the usable
+    // parallelism at the number of distinct Realms with pending commits
+    unsigned worker_count = std::thread::hardware_concurrency();
+    worker_count = worker_count == 0 ? 2 : std::min(worker_count, 4u);
+    for (unsigned i = 0; i < worker_count; ++i) {
+        m_workers.emplace_back([=] { work(); });
+        m_thread_ids.push_back(m_workers.back().get_id());
+    }
+}
+
+ExternalCommitHelper::DaemonThread::~DaemonThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ExternalCommitHelper::DaemonThread& ExternalCommitHelper::DaemonThread::shared()
+{
+    static DaemonThread daemon_thread;
+    return daemon_thread;
+}
+
+void CALLBACK ExternalCommitHelper::DaemonThread::wait_callback(PTP_CALLBACK_INSTANCE, void* context,
+                                                                PTP_WAIT wait, TP_WAIT_RESULT)
+{
+    shared().on_event(static_cast<ExternalCommitHelper*>(context), wait);
+}
+
+void ExternalCommitHelper::DaemonThread::on_event(ExternalCommitHelper* helper, PTP_WAIT wait)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (std::find(m_helpers.begin(), m_helpers.end(), helper) == m_helpers.end()) {
+        // remove_commit_helper() ran between the event firing and this
+        // callback taking the lock. The helper is going away, so don't touch
+        // it and don't re-register the wait.
+        return;
+    }
+
+    if (helper->m_work_running) {
+        // A worker is inside this helper's on_change(); make it run once more
+        // when it's done rather than calling it concurrently
+        helper->m_work_pending = true;
+    }
+    else if (!helper->m_work_queued) {
+        helper->m_work_queued = true;
+        m_work_queue.push_back(helper);
+        m_work_cv.notify_one();
+    }
+
+    // Thread pool waits are one-shot, so re-register for the next commit
+    SetThreadpoolWait(wait, helper->m_event, nullptr);
+}
+
+void ExternalCommitHelper::DaemonThread::add_commit_helper(ExternalCommitHelper* helper)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_helpers.push_back(helper);
+    SetThreadpoolWait(helper->m_wait, helper->m_event, nullptr);
+}
+
+void ExternalCommitHelper::DaemonThread::remove_commit_helper(ExternalCommitHelper* helper)
+{
+    // Called in a worker thread, dead lock will happen.
+    REALM_ASSERT(std::find(m_thread_ids.begin(), m_thread_ids.end(),
+                           std::this_thread::get_id()) == m_thread_ids.end());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_helpers.erase(std::remove(m_helpers.begin(), m_helpers.end(), helper), m_helpers.end());
+
+    // Pull the helper out of the work queue and wait for any in-flight
+    // on_change() to return, as the helper is about to be destroyed
+    m_work_queue.erase(std::remove(m_work_queue.begin(), m_work_queue.end(), helper), m_work_queue.end());
+    helper->m_work_queued = false;
+    helper->m_work_pending = false;
+    m_work_done_cv.wait(lock, [&] { return !helper->m_work_running; });
+}
+
+void ExternalCommitHelper::DaemonThread::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_work_cv.wait(lock, [&] { return m_shutdown || !m_work_queue.empty(); });
+        if (m_shutdown) {
+            return;
+        }
+
+        ExternalCommitHelper* helper = m_work_queue.front();
+        m_work_queue.pop_front();
+        helper->m_work_queued = false;
+        helper->m_work_running = true;
+
+        lock.unlock();
+        // Consume the commit timestamp, if the committing process wrote one,
+        // and report the time from that commit to this dispatch
+        if (helper->m_commit_time) {
+            if (int64_t ns = helper->m_commit_time->exchange(0, std::memory_order_acq_rel)) {
+                auto latency = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::nanoseconds(ns);
+                helper->m_parent.record_commit_notification_latency(latency);
+            }
+        }
+        helper->m_parent.on_change();
+        lock.lock();
+
+        helper->m_work_running = false;
+        if (helper->m_work_pending) {
+            helper->m_work_pending = false;
+            helper->m_work_queued = true;
+            m_work_queue.push_back(helper);
+            m_work_cv.notify_one();
+        }
+        m_work_done_cv.notify_all();
+    }
+}
+
 ExternalCommitHelper::ExternalCommitHelper(RealmCoordinator& parent)
 : m_parent(parent)
 , m_event(CreateNotificationEvent(parent.get_path()))
-, m_close_mutex(CreateMutexEx(nullptr, nullptr, CREATE_MUTEX_INITIAL_OWNER, SYNCHRONIZE | MUTEX_MODIFY_STATE))
+, m_wait(CreateThreadpoolWait(&DaemonThread::wait_callback, this, nullptr))
 {
-    m_thread = std::async(std::launch::async, [this]() { listen(); });
+    if (m_wait == nullptr) {
+        DWORD err = GetLastError();
+        CloseHandle(m_event);
+        throw std::system_error(err, std::system_category());
+    }
+
+    // Pagefile-backed named shared memory which carries the timestamp of the
+    // most recent commit when commit latency stats are enabled. If setting
+    // it up fails the stats are simply unavailable.
+    m_latency_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                           sizeof(std::atomic<int64_t>),
+                                           ObjectNamespaceName(parent.get_path(), L".lat").c_str());
+    if (m_latency_mapping != nullptr) {
+        m_commit_time = static_cast<std::atomic<int64_t>*>(
+            MapViewOfFile(m_latency_mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(std::atomic<int64_t>)));
+    }
+
+    DaemonThread::shared().add_commit_helper(this);
 }
 
 ExternalCommitHelper::~ExternalCommitHelper()
 {
-    ReleaseMutex(m_close_mutex);
-    m_thread.wait();
+    DaemonThread::shared().remove_commit_helper(this);
+
+    // Cancel the registered wait and drain any callback which has already
+    // started; after this no thread pool thread can touch this helper. A
+    // callback which slipped in between remove_commit_helper() and the
+    // cancellation sees that the helper is unregistered and does nothing.
+    SetThreadpoolWait(m_wait, nullptr, nullptr);
+    WaitForThreadpoolWaitCallbacks(m_wait, TRUE);
+    CloseThreadpoolWait(m_wait);
+
+    if (m_commit_time) {
+        UnmapViewOfFile(m_commit_time);
+    }
+    if (m_latency_mapping) {
+        CloseHandle(m_latency_mapping);
+    }
 
     CloseHandle(m_event);
-    CloseHandle(m_close_mutex);
 }
 
 void ExternalCommitHelper::notify_others()
 {
+    if (m_commit_time && RealmCoordinator::commit_latency_stats_enabled()) {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+        m_commit_time->store(ns, std::memory_order_release);
+    }
     SetEvent(m_event);
     std::this_thread::yield();
     ResetEvent(m_event);
 }
-
-void ExternalCommitHelper::listen()
-{
-    std::array<HANDLE, 2> handles{ m_event, m_close_mutex };
-    while (true) {
-        DWORD wait_result = WaitForMultipleObjectsEx(handles.size(), handles.data(), false, INFINITE, false);
-        switch (wait_result) {
-        case WAIT_OBJECT_0: // event signaled 
-            m_parent.on_change();
-            continue;
-        case WAIT_OBJECT_0 + 1: // mutex released
-            return; // exit the loop
-        case WAIT_FAILED:
-            throw std::system_error(GetLastError(), std::system_category());
-        }
-    }
-    REALM_UNREACHABLE();
-}
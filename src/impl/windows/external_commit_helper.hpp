@@ -18,7 +18,8 @@
 
 #include <realm/group_shared.hpp>
 
-#include <future>
+#include <atomic>
+#include <cstdint>
 #include <windows.h>
 
 namespace realm {
@@ -35,17 +36,36 @@ public:
     void notify_others();
 
 private:
-    void listen();
+    class DaemonThread;
 
     RealmCoordinator& m_parent;
 
-    // The listener thread
-    std::future<void> m_thread;
-
+    // Manual-reset event named after the Realm path, signalled by whichever
+    // process commits to the Realm
     HANDLE m_event;
-    HANDLE m_close_mutex;
+
+    // Thread pool wait registration for m_event. The thread pool multiplexes
+    // every registered wait onto a small shared set of wait threads, so
+    // opening more Realms does not consume more threads or run into the
+    // 64-handle WaitForMultipleObjects limit.
+    PTP_WAIT m_wait;
+
+    // Named shared-memory block carrying the steady-clock time of the most
+    // recent commit in nanoseconds, shared with the other processes which
+    // have the Realm open, or null if setting it up failed. Only written
+    // when commit latency stats are enabled (see
+    // RealmCoordinator::set_commit_latency_stats_enabled()).
+    HANDLE m_latency_mapping = nullptr;
+    std::atomic<int64_t>* m_commit_time = nullptr;
+
+    // Dispatch state guarded by the DaemonThread's mutex. A helper is in the
+    // work queue at most once and its on_change() calls never overlap;
+    // `m_work_pending` records a wakeup which arrived while a worker was
+    // already inside on_change() so that it runs once more afterwards.
+    bool m_work_queued = false;
+    bool m_work_running = false;
+    bool m_work_pending = false;
 };
 
 } // namespace _impl
 } // namespace realm
-
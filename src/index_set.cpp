@@ -21,6 +21,7 @@
 #include <realm/util/assert.hpp>
 
 #include <algorithm>
+#include <cstdint>
 
 using namespace realm;
 using namespace realm::_impl;
@@ -80,7 +81,9 @@ void ChunkedRangeVector::push_back(value_type value)
         range.end = value.second;
     }
     else {
-        m_data.push_back({{std::move(value)}, value.first, value.second, value.second - value.first});
+        auto data = take_spare();
+        data.push_back(value);
+        m_data.push_back({std::move(data), value.first, value.second, value.second - value.first});
     }
     verify();
 }
@@ -111,9 +114,11 @@ ChunkedRangeVector::iterator ChunkedRangeVector::ensure_space(iterator pos)
     auto offset = pos.offset();
 
     // Split the chunk in half to make space for the new insertion
+    auto spare = take_spare();
     auto new_pos = m_data.insert(pos.m_outer + 1, Chunk{});
     auto prev = new_pos - 1;
     auto to_move = max_size / 2;
+    new_pos->data = std::move(spare);
     new_pos->data.reserve(to_move);
     new_pos->data.assign(prev->data.end() - to_move, prev->data.end());
     prev->data.resize(prev->data.size() - to_move);
@@ -149,6 +154,7 @@ ChunkedRangeVector::iterator ChunkedRangeVector::erase(iterator pos) noexcept
     chunk.data.erase(chunk.data.begin() + offset);
 
     if (chunk.data.size() == 0) {
+        stash_spare(std::move(chunk.data));
         pos.m_outer = m_data.erase(pos.m_outer);
         pos.m_end = m_data.end();
         pos.m_inner = pos.m_outer == m_data.end() ? nullptr : &pos.m_outer->data.front();
@@ -241,7 +247,7 @@ void ChunkedRangeVectorBuilder::push_back(std::pair<size_t, size_t> range)
         chunk.end = chunk.data.back().second;
         ++m_outer_pos;
         if (m_outer_pos >= m_data.size())
-            m_data.push_back({{range}, range.first, 0, 1});
+            m_data.push_back({{range}, range.first, 0, range.second - range.first});
         else {
             auto& chunk = m_data[m_outer_pos];
             chunk.data.push_back(range);
@@ -262,6 +268,32 @@ std::vector<ChunkedRangeVector::Chunk> ChunkedRangeVectorBuilder::finalize()
     }
     return std::move(m_data);
 }
+
+// Number of ranges at which merging two sets via a dense bitmap becomes
+// cheaper than inserting into the chunked range vector one index at a time
+const size_t bitmap_merge_threshold = 64;
+
+size_t range_count(std::vector<ChunkedRangeVector::Chunk> const& data)
+{
+    size_t count = 0;
+    for (auto& chunk : data)
+        count += chunk.data.size();
+    return count;
+}
+
+void set_bitmap_range(std::vector<uint64_t>& bitmap, size_t begin, size_t end)
+{
+    size_t first_word = begin / 64, last_word = (end - 1) / 64;
+    uint64_t first_mask = ~uint64_t(0) << (begin % 64);
+    uint64_t last_mask = ~uint64_t(0) >> (63 - (end - 1) % 64);
+    if (first_word == last_word) {
+        bitmap[first_word] |= first_mask & last_mask;
+        return;
+    }
+    bitmap[first_word] |= first_mask;
+    std::fill(bitmap.begin() + first_word + 1, bitmap.begin() + last_word, ~uint64_t(0));
+    bitmap[last_word] |= last_mask;
+}
 }
 
 IndexSet::IndexSet(std::initializer_list<size_t> values)
@@ -327,8 +359,10 @@ IndexSet::iterator IndexSet::find(size_t index) noexcept
 
 IndexSet::iterator IndexSet::find(size_t index, iterator begin) noexcept
 {
-    auto it = std::find_if(begin.outer(), m_data.end(),
-                           [&](auto const& lft) { return lft.end > index; });
+    // The chunks are ordered, so binary search over their end bounds rather
+    // than touching every chunk header
+    auto it = std::lower_bound(begin.outer(), m_data.end(), index,
+                               [](auto const& chunk, size_t index) { return chunk.end <= index; });
     if (it == m_data.end())
         return end();
     if (index < it->begin)
@@ -350,12 +384,134 @@ void IndexSet::add(size_t index)
 
 void IndexSet::add(IndexSet const& other)
 {
+    if (other.empty())
+        return;
+    if (empty()) {
+        *this = other;
+        return;
+    }
+    if (do_add_bitmap(other))
+        return;
+
     auto it = begin();
     for (size_t index : other.as_indexes()) {
         it = do_add(find(index, it), index);
     }
 }
 
+bool IndexSet::do_add_bitmap(IndexSet const& other)
+{
+    size_t ranges = range_count(m_data) + range_count(other.m_data);
+    if (ranges < bitmap_merge_threshold)
+        return false;
+
+    size_t span_begin = std::min(m_data.front().begin, other.m_data.front().begin);
+    size_t span_end = std::max(m_data.back().end, other.m_data.back().end);
+    size_t span = span_end - span_begin;
+
+    // If the ranges are spread thinly over the span most of the bitmap's
+    // words would be empty and iterating over them would dominate, so fall
+    // back to incremental insertion for sparse sets
+    if (span / 64 > ranges * 4)
+        return false;
+
+    std::vector<uint64_t> bitmap((span + 63) / 64, 0);
+    for (auto range : *this)
+        set_bitmap_range(bitmap, range.first - span_begin, range.second - span_begin);
+    for (auto range : other)
+        set_bitmap_range(bitmap, range.first - span_begin, range.second - span_begin);
+
+    ChunkedRangeVectorBuilder builder(*this);
+    size_t run_start = npos;
+    for (size_t i = 0; i < bitmap.size(); ++i) {
+        uint64_t word = bitmap[i];
+        if (word == ~uint64_t(0)) {
+            if (run_start == npos)
+                run_start = i * 64;
+            continue;
+        }
+        if (word == 0) {
+            if (run_start != npos) {
+                builder.push_back({span_begin + run_start, span_begin + i * 64});
+                run_start = npos;
+            }
+            continue;
+        }
+        for (size_t bit = 0; bit < 64; ++bit) {
+            bool set = word & (uint64_t(1) << bit);
+            if (set && run_start == npos) {
+                run_start = i * 64 + bit;
+            }
+            else if (!set && run_start != npos) {
+                builder.push_back({span_begin + run_start, span_begin + i * 64 + bit});
+                run_start = npos;
+            }
+        }
+    }
+    if (run_start != npos)
+        builder.push_back({span_begin + run_start, span_begin + span});
+
+    m_data = builder.finalize();
+    verify();
+    return true;
+}
+
+void IndexSet::add_sorted(std::vector<size_t> const& sorted)
+{
+    if (sorted.empty())
+        return;
+    REALM_ASSERT_DEBUG(std::is_sorted(sorted.begin(), sorted.end()));
+
+    // Rebuilding the chunks is linear in the size of the existing set, so for
+    // a batch which is tiny in comparison the per-index binary searches of the
+    // incremental path are cheaper
+    if (!empty() && sorted.size() * 8 < range_count(m_data)) {
+        auto pos = begin();
+        for (size_t index : sorted)
+            pos = do_add(find(index, pos), index);
+        return;
+    }
+
+    ChunkedRangeVectorBuilder builder(*this);
+    auto it = cbegin(), end = cend();
+    size_t i = 0;
+
+    // Pull the next run of consecutive indices from the batch as a range
+    auto next_batch_range = [&] {
+        size_t range_begin = sorted[i], range_end = range_begin + 1;
+        for (++i; i < sorted.size() && sorted[i] <= range_end; ++i)
+            range_end = std::max(range_end, sorted[i] + 1);
+        return value_type{range_begin, range_end};
+    };
+
+    bool have_pending = false;
+    value_type pending;
+    while (it != end || i < sorted.size()) {
+        value_type next;
+        if (it == end)
+            next = next_batch_range();
+        else if (i == sorted.size() || it->first <= sorted[i])
+            next = *it++;
+        else
+            next = next_batch_range();
+
+        if (!have_pending) {
+            pending = next;
+            have_pending = true;
+        }
+        else if (next.first <= pending.second)
+            pending.second = std::max(pending.second, next.second);
+        else {
+            builder.push_back(pending);
+            pending = next;
+        }
+    }
+    builder.push_back(pending);
+
+    m_data = builder.finalize();
+    verify();
+}
+
 size_t IndexSet::add_shifted(size_t index)
 {
     iterator it = begin(), end = this->end();
@@ -442,8 +598,7 @@ void IndexSet::insert_at(size_t index, size_t count)
         else {
             pos.shift(count);
         }
-        for (auto it = std::next(pos); it != end; ++it)
-            it.shift(count);
+        shift_until_end_by(std::next(pos), ptrdiff_t(count));
     }
     if (!in_existing) {
         for (size_t i = 0; i < count; ++i)
@@ -484,6 +639,35 @@ void IndexSet::insert_at(IndexSet const& positions)
     m_data = builder.finalize();
 }
 
+void IndexSet::shift_until_end_by(iterator pos, ptrdiff_t shift)
+{
+    if (pos == end() || shift == 0)
+        return;
+
+    // Shift the rest of the chunk containing `pos` element by element, then
+    // bulk-adjust each following chunk: every range in the later chunks moves
+    // by the same distance, so they can be updated with a single tight pass
+    // over the stored pairs (which the compiler can vectorize) plus the
+    // chunk's cached bounds, rather than a bounds check per range.
+    auto& chunk = *pos.outer();
+    for (size_t i = pos.offset(); i < chunk.data.size(); ++i) {
+        chunk.data[i].first += shift;
+        chunk.data[i].second += shift;
+    }
+    if (pos.offset() == 0)
+        chunk.begin += shift;
+    chunk.end += shift;
+
+    for (auto outer = std::next(pos.outer()); outer != m_data.end(); ++outer) {
+        for (auto& range : outer->data) {
+            range.first += shift;
+            range.second += shift;
+        }
+        outer->begin += shift;
+        outer->end += shift;
+    }
+}
+
 void IndexSet::shift_for_insert_at(size_t index, size_t count)
 {
     REALM_ASSERT(count > 0);
@@ -492,8 +676,7 @@ void IndexSet::shift_for_insert_at(size_t index, size_t count)
     if (it == end())
         return;
 
-    for (auto pos = it, end = this->end(); pos != end; ++pos)
-        pos.shift(count);
+    shift_until_end_by(it, ptrdiff_t(count));
 
     // If the range contained the insertion point, split the range and move
     // the part of it before the insertion point back
@@ -610,8 +793,7 @@ void IndexSet::do_erase(iterator it, size_t index)
         it = erase(it);
     }
 
-    for (; it != end(); ++it)
-        it.shift(-1);
+    shift_until_end_by(it, -1);
 }
 
 IndexSet::iterator IndexSet::do_remove(iterator it, size_t begin, size_t end)
@@ -672,6 +854,8 @@ size_t IndexSet::unshift(size_t index) const noexcept
 
 void IndexSet::clear() noexcept
 {
+    if (!m_data.empty())
+        stash_spare(std::move(m_data.back().data));
     m_data.clear();
 }
 
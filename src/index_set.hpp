@@ -120,6 +120,27 @@ struct ChunkedRangeVector {
     iterator ensure_space(iterator pos);
 
     void verify() const noexcept;
+
+protected:
+    // Chunk storage is recycled between erasures and insertions so that
+    // alternating mutations in the diff hot path don't hit the allocator for
+    // every chunk. The spare is always kept empty (but with its capacity
+    // intact) so that copying the vector doesn't copy or allocate anything.
+    std::vector<value_type> m_spare;
+
+    std::vector<value_type> take_spare() noexcept
+    {
+        std::vector<value_type> ret;
+        ret.swap(m_spare);
+        return ret;
+    }
+    void stash_spare(std::vector<value_type>&& data) noexcept
+    {
+        if (data.capacity() > m_spare.capacity()) {
+            m_spare = std::move(data);
+            m_spare.clear();
+        }
+    }
 };
 } // namespace _impl
 
@@ -146,7 +167,15 @@ public:
 
     // Add an index to the set, doing nothing if it's already present
     void add(size_t index);
+    // Add each of the indices in `is` to the set. When both sets are highly
+    // fragmented this switches to merging via a dense bitmap over the
+    // combined span rather than inserting into the range vector one index
+    // at a time.
     void add(IndexSet const& is);
+    // Add a batch of indices which are already in ascending order (duplicates
+    // are allowed), merging them in a single pass over the chunks rather than
+    // searching for the insertion position of each index separately
+    void add_sorted(std::vector<size_t> const& sorted);
 
     // Add an index which has had all of the ranges in the set before it removed
     // Returns the unshifted index
@@ -234,6 +263,43 @@ public:
 
     IndexIteratableAdaptor as_indexes() const noexcept { return *this; }
 
+    // Call `fn` with each range in the set in ascending order. This walks
+    // each chunk's storage directly and so avoids the chunked iterator's
+    // end-of-chunk check on every increment, which adds up for consumers
+    // which walk every changeset they're handed.
+    template<typename Fn>
+    void for_each_range(Fn&& fn) const
+    {
+        for (auto const& chunk : m_data) {
+            for (auto const& range : chunk.data)
+                fn(range);
+        }
+    }
+
+    // A contiguous view over the ranges in a single-chunk set
+    struct RangeSpan {
+        const value_type* begin_ptr = nullptr;
+        const value_type* end_ptr = nullptr;
+
+        const value_type* begin() const noexcept { return begin_ptr; }
+        const value_type* end() const noexcept { return end_ptr; }
+        size_t size() const noexcept { return end_ptr - begin_ptr; }
+    };
+
+    // True when all of the ranges are stored in a single contiguous chunk,
+    // which is the case for every set with fewer ranges than the chunk size
+    bool is_single_chunk() const noexcept { return m_data.size() <= 1; }
+
+    // Flat view over the ranges. Valid (and empty) for an empty set;
+    // otherwise only valid when is_single_chunk().
+    RangeSpan as_span() const noexcept
+    {
+        if (m_data.empty())
+            return {};
+        auto& data = m_data.front().data;
+        return {data.data(), data.data() + data.size()};
+    }
+
 private:
     // Find the range which contains the index, or the first one after it if
     // none do
@@ -243,6 +309,11 @@ private:
     // applicable
     // returns inserted position
     iterator do_add(iterator pos, size_t index);
+    // Merge `other` into the set by ORing both sets into a bitmap and then
+    // rebuilding the range vector from it. Returns false without doing
+    // anything if the sets are not fragmented and dense enough for this to
+    // be faster than incremental insertion.
+    bool do_add_bitmap(IndexSet const& other);
     void do_erase(iterator it, size_t index);
     iterator do_remove(iterator it, size_t index, size_t count);
 
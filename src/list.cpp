@@ -25,6 +25,7 @@
 #include "schema.hpp"
 #include "shared_realm.hpp"
 #include "util/format.hpp"
+#include "util/pool_allocator.hpp"
 
 #include <realm/link_view.hpp>
 
@@ -117,6 +118,38 @@ size_t List::get_unchecked(size_t row_ndx) const noexcept
     return m_link_view->get(row_ndx).get_index();
 }
 
+RowExpr List::iterator::operator*() const
+{
+    return m_link_view->get(m_ndx);
+}
+
+List::iterator List::begin() const
+{
+    verify_attached();
+    return iterator(m_link_view.get(), 0);
+}
+
+List::iterator List::end() const
+{
+    verify_attached();
+    return iterator(m_link_view.get(), m_link_view->size());
+}
+
+std::vector<RowExpr> List::get_range(size_t begin, size_t end) const
+{
+    verify_attached();
+    std::vector<RowExpr> rows;
+    if (begin >= end)
+        return rows;
+    size_t size = m_link_view->size();
+    if (end > size)
+        throw OutOfBoundsIndexException{end - 1, size};
+    rows.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i)
+        rows.push_back(m_link_view->get(i));
+    return rows;
+}
+
 size_t List::find(ConstRow const& row) const
 {
     verify_attached();
@@ -141,6 +174,21 @@ void List::insert(size_t row_ndx, size_t target_row_ndx)
     m_link_view->insert(row_ndx, target_row_ndx);
 }
 
+void List::add_all(std::vector<size_t> const& target_row_ndxs)
+{
+    verify_in_transaction();
+    for (auto target_row_ndx : target_row_ndxs)
+        m_link_view->add(target_row_ndx);
+}
+
+void List::insert_all(size_t row_ndx, std::vector<size_t> const& target_row_ndxs)
+{
+    verify_in_transaction();
+    verify_valid_row(row_ndx, true);
+    for (auto target_row_ndx : target_row_ndxs)
+        m_link_view->insert(row_ndx++, target_row_ndx);
+}
+
 void List::move(size_t source_ndx, size_t dest_ndx)
 {
     verify_in_transaction();
@@ -192,7 +240,11 @@ Results List::sort(SortDescriptor order)
 Results List::filter(Query q)
 {
     verify_attached();
-    return Results(m_realm, m_link_view, get_query().and_query(std::move(q)));
+    // and_query() returns a reference to its receiver, so combine into a
+    // local and move that rather than deep-copying the combined query
+    auto query = get_query();
+    query.and_query(std::move(q));
+    return Results(m_realm, m_link_view, std::move(query));
 }
 
 Results List::snapshot() const
@@ -234,14 +286,42 @@ size_t hash<realm::List>::operator()(realm::List const& list) const
 }
 }
 
-NotificationToken List::add_notification_callback(CollectionChangeCallback cb) &
+NotificationToken List::add_notification_callback(CollectionChangeCallback cb,
+                                                  std::chrono::milliseconds minimum_interval,
+                                                  util::Optional<std::vector<size_t>> observed_columns) &
+{
+    verify_attached();
+    if (!m_notifier) {
+        m_notifier = util::make_pooled_shared<ListNotifier>(m_link_view, m_realm);
+        RealmCoordinator::register_notifier(m_notifier);
+    }
+    return {m_notifier, m_notifier->add_callback(std::move(cb), minimum_interval,
+                                                 std::move(observed_columns))};
+}
+
+size_t List::add_derived_property(std::vector<size_t> columns,
+                                  _impl::CollectionNotifier::DerivedFunction compute)
 {
     verify_attached();
     if (!m_notifier) {
-        m_notifier = std::make_shared<ListNotifier>(m_link_view, m_realm);
+        m_notifier = util::make_pooled_shared<ListNotifier>(m_link_view, m_realm);
         RealmCoordinator::register_notifier(m_notifier);
     }
-    return {m_notifier, m_notifier->add_callback(std::move(cb))};
+    return m_notifier->add_derived_property(std::move(columns), std::move(compute));
+}
+
+void List::remove_derived_property(size_t token)
+{
+    REALM_ASSERT(m_notifier);
+    m_notifier->remove_derived_property(token);
+}
+
+util::Any List::get_derived_value(size_t token, size_t row_ndx)
+{
+    verify_attached();
+    verify_valid_row(row_ndx);
+    return m_notifier->get_derived_value(token, m_link_view->get_target_table(),
+                                         m_link_view->get(row_ndx).get_index());
 }
 
 List::OutOfBoundsIndexException::OutOfBoundsIndexException(size_t r, size_t c)
@@ -26,7 +26,9 @@
 #include <realm/row.hpp>
 
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <vector>
 
 namespace realm {
 using RowExpr = BasicRowExpr<Table>;
@@ -36,6 +38,7 @@ class Query;
 class Realm;
 class Results;
 class SortDescriptor;
+class ThreadSafeReferenceBundle;
 template <typename T> class ThreadSafeReference;
 
 namespace _impl {
@@ -67,8 +70,27 @@ public:
     size_t get_unchecked(size_t row_ndx) const noexcept;
     size_t find(ConstRow const& row) const;
 
+    // Get row accessors for the elements in [begin, end), validating the List
+    // once for the whole batch rather than once per element. Returns an empty
+    // vector if begin >= end.
+    // Throws OutOfBoundsIndexException if end > size()
+    std::vector<RowExpr> get_range(size_t begin, size_t end) const;
+
+    // Random-access iterators over the row accessors of this List,
+    // validating the List once when the iterator is created rather than
+    // once per element. Modifying the List invalidates its iterators.
+    class iterator;
+    iterator begin() const;
+    iterator end() const;
+
     void add(size_t target_row_ndx);
     void insert(size_t list_ndx, size_t target_row_ndx);
+
+    // Add each of the target rows to the end of the list, or insert them
+    // starting at the given position, validating once for the whole batch
+    void add_all(std::vector<size_t> const& target_row_ndxs);
+    void insert_all(size_t list_ndx, std::vector<size_t> const& target_row_ndxs);
+
     void move(size_t source_ndx, size_t dest_ndx);
     void remove(size_t list_ndx);
     void remove_all();
@@ -95,7 +117,26 @@ public:
 
     bool operator==(List const& rgt) const noexcept;
 
-    NotificationToken add_notification_callback(CollectionChangeCallback cb) &;
+    // If `minimum_interval` is non-zero, at most one notification is delivered
+    // to the callback per interval, with intervening changes coalesced into a
+    // single changeset covering everything since the last delivery.
+    // If `observed_columns` is engaged, modifications to the target rows only
+    // produce a notification when they touch one of the given columns of the
+    // target table; insertions, removals and reorderings of the list are
+    // always delivered, as are modifications to rows reached through links
+    NotificationToken add_notification_callback(CollectionChangeCallback cb,
+                                                std::chrono::milliseconds minimum_interval = std::chrono::milliseconds::zero(),
+                                                util::Optional<std::vector<size_t>> observed_columns = util::none) &;
+
+    // Register a derived display property computed by `compute` from the
+    // given columns of the target rows; see Results::add_derived_property()
+    size_t add_derived_property(std::vector<size_t> columns,
+                                _impl::CollectionNotifier::DerivedFunction compute);
+    void remove_derived_property(size_t token);
+
+    // Get the derived value for the row at the given index of this List,
+    // computing it on the calling thread if the cache has no value for it
+    util::Any get_derived_value(size_t token, size_t row_ndx);
 
     // These are implemented in object_accessor.hpp
     template <typename ValueType, typename ContextType>
@@ -123,6 +164,7 @@ public:
 
 private:
     friend ThreadSafeReference<List>;
+    friend ThreadSafeReferenceBundle;
 
     std::shared_ptr<Realm> m_realm;
     mutable const ObjectSchema* m_object_schema = nullptr;
@@ -133,6 +175,48 @@ private:
 
     friend struct std::hash<List>;
 };
+
+class List::iterator {
+public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = RowExpr;
+    using pointer = void;
+    using reference = RowExpr;
+    using iterator_category = std::random_access_iterator_tag;
+
+    iterator() = default;
+
+    RowExpr operator*() const;
+    RowExpr operator[](difference_type n) const { return *(*this + n); }
+
+    iterator& operator++() { ++m_ndx; return *this; }
+    iterator operator++(int) { auto old = *this; ++m_ndx; return old; }
+    iterator& operator--() { --m_ndx; return *this; }
+    iterator operator--(int) { auto old = *this; --m_ndx; return old; }
+    iterator& operator+=(difference_type n) { m_ndx += n; return *this; }
+    iterator& operator-=(difference_type n) { m_ndx -= n; return *this; }
+    friend iterator operator+(iterator it, difference_type n) { it += n; return it; }
+    friend iterator operator+(difference_type n, iterator it) { it += n; return it; }
+    friend iterator operator-(iterator it, difference_type n) { it -= n; return it; }
+    friend difference_type operator-(iterator const& a, iterator const& b)
+    {
+        return difference_type(a.m_ndx) - difference_type(b.m_ndx);
+    }
+
+    friend bool operator==(iterator const& a, iterator const& b) { return a.m_ndx == b.m_ndx; }
+    friend bool operator!=(iterator const& a, iterator const& b) { return a.m_ndx != b.m_ndx; }
+    friend bool operator<(iterator const& a, iterator const& b) { return a.m_ndx < b.m_ndx; }
+    friend bool operator>(iterator const& a, iterator const& b) { return a.m_ndx > b.m_ndx; }
+    friend bool operator<=(iterator const& a, iterator const& b) { return a.m_ndx <= b.m_ndx; }
+    friend bool operator>=(iterator const& a, iterator const& b) { return a.m_ndx >= b.m_ndx; }
+
+private:
+    friend class List;
+    iterator(LinkView* link_view, size_t ndx) : m_link_view(link_view), m_ndx(ndx) { }
+
+    LinkView* m_link_view = nullptr;
+    size_t m_ndx = 0;
+};
 } // namespace realm
 
 namespace std {
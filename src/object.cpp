@@ -21,7 +21,12 @@
 #include "impl/object_notifier.hpp"
 #include "impl/realm_coordinator.hpp"
 #include "object_schema.hpp"
+#include "object_store.hpp"
+#include "schema.hpp"
 #include "util/format.hpp"
+#include "util/pool_allocator.hpp"
+
+#include <realm/table.hpp>
 
 using namespace realm;
 
@@ -62,13 +67,61 @@ Object::Object(Object&&) = default;
 Object& Object::operator=(Object const&) = default;
 Object& Object::operator=(Object&&) = default;
 
-NotificationToken Object::add_notification_callback(CollectionChangeCallback callback) &
+NotificationToken Object::add_notification_callback(CollectionChangeCallback callback,
+                                                    std::chrono::milliseconds minimum_interval,
+                                                    util::Optional<std::vector<size_t>> observed_columns) &
 {
     if (!m_notifier) {
-        m_notifier = std::make_shared<_impl::ObjectNotifier>(m_row, m_realm);
+        m_notifier = util::make_pooled_shared<_impl::ObjectNotifier>(m_row, m_realm);
         _impl::RealmCoordinator::register_notifier(m_notifier);
     }
-    return {m_notifier, m_notifier->add_callback(std::move(callback))};
+    return {m_notifier, m_notifier->add_callback(std::move(callback), minimum_interval,
+                                                 std::move(observed_columns))};
+}
+
+std::pair<BinaryData, Realm::VersionPin> Object::get_unowned_binary(std::string const& prop_name)
+{
+    verify_attached();
+    auto& property = property_for_name(prop_name);
+    if (property.type != PropertyType::Data) {
+        throw std::logic_error(util::format("Cannot read property '%1.%2' of type %3 as binary data",
+                                            m_object_schema->name, property.name,
+                                            string_for_property_type(property.type)));
+    }
+    return {m_row.get_binary(property.table_column), m_realm->pin_version()};
+}
+
+Object::CachedLinkAccessor* Object::cached_link_accessor(Property const& property) const
+{
+    // Links can be reassigned mid-write without the version advancing, so
+    // the cache can only be trusted within a stable read transaction
+    if (m_realm->is_in_transaction())
+        return nullptr;
+    auto version = m_realm->current_transaction_version();
+    if (!version)
+        return nullptr;
+    if (!m_link_accessor_version || m_link_accessor_version->version != version->version) {
+        m_link_accessors.clear();
+        m_link_accessor_version = version;
+    }
+    for (auto& entry : m_link_accessors) {
+        if (entry.column == property.table_column)
+            return &entry;
+    }
+
+    m_link_accessors.emplace_back();
+    auto& entry = m_link_accessors.back();
+    entry.column = property.table_column;
+    if (property.type == PropertyType::Array) {
+        // Holding the LinkView keeps core's accessor alive, so later
+        // accesses share it rather than each constructing a fresh one
+        entry.link_view = m_row.get_linklist(property.table_column);
+    }
+    else {
+        entry.target_schema = &*m_realm->schema().find(property.object_type);
+        entry.target_table = ObjectStore::table_for_object_schema(m_realm->read_group(), *entry.target_schema);
+    }
+    return &entry;
 }
 
 void Object::verify_attached() const
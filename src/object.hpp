@@ -22,7 +22,13 @@
 #include "impl/collection_notifier.hpp"
 #include "shared_realm.hpp"
 
+#include <realm/binary_data.hpp>
+#include <realm/link_view_fwd.hpp>
 #include <realm/row.hpp>
+#include <realm/table_ref.hpp>
+
+#include <utility>
+#include <vector>
 
 namespace realm {
 class ObjectSchema;
@@ -52,12 +58,32 @@ public:
     template<typename ValueType, typename ContextType>
     ValueType get_property_value(ContextType ctx, std::string prop_name);
 
+    // Read a binary property without copying the data out of the Realm file.
+    // The returned BinaryData is unowned: the version it was read from is
+    // kept valid by the returned pin token, and the data must not be used
+    // after the token is destroyed.
+    // Throws InvalidPropertyException for properties which do not exist and
+    // std::logic_error for ones which are not of binary type.
+    std::pair<BinaryData, Realm::VersionPin> get_unowned_binary(std::string const& prop_name);
+
     // create an Object from a native representation
     template<typename ValueType, typename ContextType>
     static Object create(ContextType ctx, SharedRealm realm,
                          const ObjectSchema &object_schema, ValueType value,
                          bool try_update);
 
+    // create a batch of objects of the same type in one pass, resolving the
+    // table once, adding all of the rows up front, and writing the property
+    // values a column at a time. If `created` is non-null it is set to the
+    // positions within `values` which created a new object rather than
+    // updating an existing one.
+    template<typename ValueType, typename ContextType>
+    static std::vector<Object> create_bulk(ContextType ctx, SharedRealm realm,
+                                           const ObjectSchema &object_schema,
+                                           std::vector<ValueType>& values,
+                                           bool try_update,
+                                           IndexSet* created = nullptr);
+
     template<typename ValueType, typename ContextType>
     static Object get_for_primary_key(ContextType ctx, SharedRealm realm,
                                       const ObjectSchema &object_schema,
@@ -69,7 +95,14 @@ public:
 
     bool is_valid() const { return m_row.is_attached(); }
 
-    NotificationToken add_notification_callback(CollectionChangeCallback callback) &;
+    // If `minimum_interval` is non-zero, at most one notification is delivered
+    // to the callback per interval, with intervening changes coalesced into a
+    // single changeset covering everything since the last delivery.
+    // If `observed_columns` is engaged, only modifications to the given
+    // columns of the object's table produce a notification
+    NotificationToken add_notification_callback(CollectionChangeCallback callback,
+                                                std::chrono::milliseconds minimum_interval = std::chrono::milliseconds::zero(),
+                                                util::Optional<std::vector<size_t>> observed_columns = util::none) &;
 
 private:
     SharedRealm m_realm;
@@ -77,9 +110,28 @@ private:
     Row m_row;
     _impl::CollectionNotifier::Handle<_impl::ObjectNotifier> m_notifier;
 
+    // Cached per-column state for link-property accessors. Traversing the
+    // same link from this Object repeatedly (e.g. `message.sender.name` in a
+    // render pass) otherwise pays for the schema and table lookups on every
+    // access. Entries are only valid at the version they were created at,
+    // and writes bypass the cache entirely, as links can change
+    // mid-transaction without the version advancing.
+    struct CachedLinkAccessor {
+        size_t column;
+        const ObjectSchema* target_schema = nullptr; // object links
+        TableRef target_table;                       // object links
+        LinkViewRef link_view;                       // arrays
+    };
+    mutable std::vector<CachedLinkAccessor> m_link_accessors;
+    mutable util::Optional<VersionID> m_link_accessor_version;
+
+    // Get the cached accessor state for a link or array property, populating
+    // it if needed. Returns null when the cache cannot be used (within a
+    // write transaction, or with no read transaction active).
+    CachedLinkAccessor* cached_link_accessor(Property const& property) const;
 
     template<typename ValueType, typename ContextType>
-    void set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update, bool is_default=false);
+    void set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update, bool is_default=false, bool is_fresh_row=false);
     template<typename ValueType, typename ContextType>
     ValueType get_property_value_impl(ContextType ctx, const Property &property);
 
@@ -87,6 +139,13 @@ private:
     static size_t get_for_primary_key_impl(ContextType ctx, Table const& table,
                                            const Property &primary_prop, ValueType primary_value);
 
+    // the shared body of create() and create_bulk(), which takes the already
+    // resolved table so that batch creation only looks it up once
+    template<typename ValueType, typename ContextType>
+    static Object create_one(ContextType ctx, SharedRealm const& realm,
+                             const ObjectSchema &object_schema, ValueType& value,
+                             bool try_update, TableRef const& table, bool& created);
+
     void verify_attached() const;
     Property const& property_for_name(std::string const& prop_name) const;
 };
@@ -33,6 +33,7 @@
 #include <realm/util/assert.hpp>
 #include <realm/table_view.hpp>
 
+#include <cmath>
 #include <string>
 
 namespace realm {
@@ -42,8 +43,8 @@ namespace realm {
 template<typename ValueType, typename ContextType>
 class NativeAccessor {
 public:
-    static bool dict_has_value_for_key(ContextType ctx, ValueType dict, const std::string &prop_name);
-    static ValueType dict_value_for_key(ContextType ctx, ValueType dict, const std::string &prop_name);
+    static bool dict_has_value_for_key(ContextType ctx, ValueType& dict, const std::string &prop_name);
+    static ValueType dict_value_for_key(ContextType ctx, ValueType& dict, const std::string &prop_name);
 
     static bool has_default_value_for_property(ContextType ctx, Realm *realm, const ObjectSchema &object_schema, const std::string &prop_name);
     static ValueType default_value_for_property(ContextType ctx, Realm *realm, const ObjectSchema &object_schema, const std::string &prop_name);
@@ -110,8 +111,15 @@ ValueType Object::get_property_value(ContextType ctx, std::string prop_name)
     return get_property_value_impl<ValueType>(ctx, property_for_name(prop_name));
 }
 
+// A row created by add_empty_row() has every column initialized to its
+// default value, so when populating a row created earlier in the same call
+// (`is_fresh_row`), writes which would store that same value again are
+// skipped rather than emitting a redundant transact-log instruction for
+// each one. The callers gate this on the Realm not being synchronized, as
+// sync derives conflict-resolution ordering from the individual
+// instructions and so the redundant writes are meaningful there.
 template <typename ValueType, typename ContextType>
-void Object::set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update, bool is_default)
+void Object::set_property_value_impl(ContextType ctx, const Property &property, ValueType value, bool try_update, bool is_default, bool is_fresh_row)
 {
     using Accessor = NativeAccessor<ValueType, ContextType>;
 
@@ -120,36 +128,57 @@ void Object::set_property_value_impl(ContextType ctx, const Property &property,
     size_t row = m_row.get_index();
     if (property.is_nullable && Accessor::is_null(ctx, value)) {
         if (property.type == PropertyType::Object) {
-            if (!is_default)
+            if (!is_default && !is_fresh_row)
                 table.nullify_link(column, row);
         }
-        else {
+        else if (!is_fresh_row) {
             table.set_null(column, row, is_default);
         }
         return;
     }
 
+    // Nullable columns are initialized to null rather than to the zero-like
+    // value of their type, so the elision below only applies to non-nullable
+    // columns
+    is_fresh_row = is_fresh_row && !property.is_nullable;
+
     switch (property.type) {
-        case PropertyType::Bool:
-            table.set_bool(column, row, Accessor::to_bool(ctx, value), is_default);
+        case PropertyType::Bool: {
+            auto v = Accessor::to_bool(ctx, value);
+            if (v || !is_fresh_row)
+                table.set_bool(column, row, v, is_default);
             break;
-        case PropertyType::Int:
-            table.set_int(column, row, Accessor::to_long(ctx, value), is_default);
+        }
+        case PropertyType::Int: {
+            auto v = Accessor::to_long(ctx, value);
+            if (v != 0 || !is_fresh_row)
+                table.set_int(column, row, v, is_default);
             break;
-        case PropertyType::Float:
-            table.set_float(column, row, Accessor::to_float(ctx, value), is_default);
+        }
+        case PropertyType::Float: {
+            auto v = Accessor::to_float(ctx, value);
+            // A negative zero compares equal to the stored positive zero but
+            // would read back with the sign lost if not written
+            if (v != 0.f || std::signbit(v) || !is_fresh_row)
+                table.set_float(column, row, v, is_default);
             break;
-        case PropertyType::Double:
-            table.set_double(column, row, Accessor::to_double(ctx, value), is_default);
+        }
+        case PropertyType::Double: {
+            auto v = Accessor::to_double(ctx, value);
+            if (v != 0. || std::signbit(v) || !is_fresh_row)
+                table.set_double(column, row, v, is_default);
             break;
+        }
         case PropertyType::String: {
             auto str = Accessor::to_string(ctx, value);
-            table.set_string(column, row, str, is_default);
+            if (!str.empty() || !is_fresh_row)
+                table.set_string(column, row, str, is_default);
             break;
         }
         case PropertyType::Data: {
             auto data = Accessor::to_binary(ctx, value);
-            table.set_binary(column, row, BinaryData(data), is_default);
+            if (!data.empty() || !is_fresh_row)
+                table.set_binary(column, row, BinaryData(data), is_default);
             break;
         }
         case PropertyType::Any:
@@ -164,7 +193,9 @@ void Object::set_property_value_impl(ContextType ctx, const Property &property,
         }
         case PropertyType::Array: {
             LinkViewRef link_view = m_row.get_linklist(column);
-            link_view->clear();
+            // A fresh row's list is always already empty
+            if (!is_fresh_row)
+                link_view->clear();
             if (!Accessor::is_null(ctx, value)) {
                 size_t count = Accessor::list_size(ctx, value);
                 for (size_t i = 0; i < count; i++) {
@@ -209,16 +240,22 @@ ValueType Object::get_property_value_impl(ContextType ctx, const Property &prope
         case PropertyType::Date:
             return Accessor::from_timestamp(ctx, m_row.get_timestamp(column));
         case PropertyType::Object: {
+            if (auto cached = cached_link_accessor(property)) {
+                return Accessor::from_object(ctx, Object(m_realm, *cached->target_schema,
+                                                         cached->target_table->get(m_row.get_link(column))));
+            }
             auto linkObjectSchema = m_realm->schema().find(property.object_type);
-            TableRef table = ObjectStore::table_for_object_type(m_realm->read_group(), linkObjectSchema->name);
+            TableRef table = ObjectStore::table_for_object_schema(m_realm->read_group(), *linkObjectSchema);
             return Accessor::from_object(ctx, Object(m_realm, *linkObjectSchema, table->get(m_row.get_link(column))));
         }
         case PropertyType::Array:
+            if (auto cached = cached_link_accessor(property))
+                return Accessor::from_list(ctx, List(m_realm, cached->link_view));
             return Accessor::from_list(ctx, List(m_realm, m_row.get_linklist(column)));
         case PropertyType::LinkingObjects: {
             auto target_object_schema = m_realm->schema().find(property.object_type);
             auto link_property = target_object_schema->property_for_name(property.link_origin_property_name);
-            TableRef table = ObjectStore::table_for_object_type(m_realm->read_group(), target_object_schema->name);
+            TableRef table = ObjectStore::table_for_object_schema(m_realm->read_group(), *target_object_schema);
             auto tv = m_row.get_table()->get_backlink_view(m_row.get_index(), table.get(), link_property->table_column);
             return Accessor::from_results(ctx, Results(m_realm, std::move(tv)));
         }
@@ -230,15 +267,22 @@ template<typename ValueType, typename ContextType>
 Object Object::create(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType value, bool try_update)
 {
     realm->verify_in_write();
+    realm::TableRef table = ObjectStore::table_for_object_schema(realm->read_group(), object_schema);
+    bool created = false;
+    return create_one(ctx, realm, object_schema, value, try_update, table, created);
+}
 
+template<typename ValueType, typename ContextType>
+Object Object::create_one(ContextType ctx, SharedRealm const& realm, const ObjectSchema &object_schema,
+                          ValueType& value, bool try_update, TableRef const& table, bool& created)
+{
     using Accessor = NativeAccessor<ValueType, ContextType>;
 
     // get or create our accessor
-    bool created = false;
+    created = false;
 
     // try to get existing row if updating
     size_t row_index = realm::not_found;
-    realm::TableRef table = ObjectStore::table_for_object_type(realm->read_group(), object_schema.name);
 
     if (auto primary_prop = object_schema.primary_key_property()) {
         // search for existing object based on primary key type
@@ -267,20 +311,21 @@ Object Object::create(ContextType ctx, SharedRealm realm, const ObjectSchema &ob
     }
 
     // populate
+    bool fresh_row = created && !realm->config().sync_config;
     Object object(realm, object_schema, table->get(row_index));
     for (const Property& prop : object_schema.persisted_properties) {
         if (prop.is_primary)
             continue;
 
         if (Accessor::dict_has_value_for_key(ctx, value, prop.name)) {
-            object.set_property_value_impl(ctx, prop, Accessor::dict_value_for_key(ctx, value, prop.name), try_update);
+            object.set_property_value_impl(ctx, prop, Accessor::dict_value_for_key(ctx, value, prop.name), try_update, false, fresh_row);
         }
         else if (created) {
             if (Accessor::has_default_value_for_property(ctx, realm.get(), object_schema, prop.name)) {
-                object.set_property_value_impl(ctx, prop, Accessor::default_value_for_property(ctx, realm.get(), object_schema, prop.name), try_update, true);
+                object.set_property_value_impl(ctx, prop, Accessor::default_value_for_property(ctx, realm.get(), object_schema, prop.name), try_update, true, fresh_row);
             }
             else if (prop.is_nullable || prop.type == PropertyType::Array) {
-                object.set_property_value_impl(ctx, prop, Accessor::null_value(ctx), try_update);
+                object.set_property_value_impl(ctx, prop, Accessor::null_value(ctx), try_update, false, fresh_row);
             }
             else {
                 throw MissingPropertyValueException(object_schema.name, prop.name);
@@ -290,6 +335,65 @@ Object Object::create(ContextType ctx, SharedRealm realm, const ObjectSchema &ob
     return object;
 }
 
+template<typename ValueType, typename ContextType>
+std::vector<Object> Object::create_bulk(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema,
+                                        std::vector<ValueType>& values, bool try_update, IndexSet* created)
+{
+    realm->verify_in_write();
+
+    using Accessor = NativeAccessor<ValueType, ContextType>;
+
+    std::vector<Object> objects;
+    objects.reserve(values.size());
+    if (created)
+        *created = {};
+
+    realm::TableRef table = ObjectStore::table_for_object_schema(realm->read_group(), object_schema);
+
+    // Each object with a primary key needs its own index probe before a row
+    // can be added or updated, but the table resolution and write-state
+    // checks are hoisted out of the loop
+    if (object_schema.primary_key_property()) {
+        bool row_created = false;
+        for (size_t i = 0; i < values.size(); ++i) {
+            objects.push_back(create_one(ctx, realm, object_schema, values[i], try_update, table, row_created));
+            if (created && row_created)
+                created->add(i);
+        }
+        return objects;
+    }
+
+    if (created)
+        created->set(values.size());
+    size_t first_row = table->add_empty_row(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        objects.push_back(Object(realm, object_schema, table->get(first_row + i)));
+
+    bool fresh_row = !realm->config().sync_config;
+
+    // Populate column-major so that each column's leaves are filled in one
+    // pass rather than being cycled through once per object
+    for (const Property& prop : object_schema.persisted_properties) {
+        for (size_t i = 0; i < values.size(); ++i) {
+            auto& value = values[i];
+            auto& object = objects[i];
+            if (Accessor::dict_has_value_for_key(ctx, value, prop.name)) {
+                object.set_property_value_impl(ctx, prop, Accessor::dict_value_for_key(ctx, value, prop.name), try_update, false, fresh_row);
+            }
+            else if (Accessor::has_default_value_for_property(ctx, realm.get(), object_schema, prop.name)) {
+                object.set_property_value_impl(ctx, prop, Accessor::default_value_for_property(ctx, realm.get(), object_schema, prop.name), try_update, true, fresh_row);
+            }
+            else if (prop.is_nullable || prop.type == PropertyType::Array) {
+                object.set_property_value_impl(ctx, prop, Accessor::null_value(ctx), try_update, false, fresh_row);
+            }
+            else {
+                throw MissingPropertyValueException(object_schema.name, prop.name);
+            }
+        }
+    }
+    return objects;
+}
+
 template<typename ValueType, typename ContextType>
 Object Object::get_for_primary_key(ContextType ctx, SharedRealm realm, const ObjectSchema &object_schema, ValueType primary_value)
 {
@@ -298,7 +402,7 @@ Object Object::get_for_primary_key(ContextType ctx, SharedRealm realm, const Obj
         throw MissingPrimaryKeyException(object_schema.name);
     }
 
-    auto table = ObjectStore::table_for_object_type(realm->read_group(), object_schema.name);
+    auto table = ObjectStore::table_for_object_schema(realm->read_group(), object_schema);
     auto row_index = get_for_primary_key_impl(ctx, *table, *primary_prop, primary_value);
 
     return Object(realm, object_schema, row_index == realm::not_found ? Row() : table->get(row_index));
@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "object_ingest_sink.hpp"
+
+#include "object.hpp"
+#include "object_schema.hpp"
+#include "object_store.hpp"
+#include "property.hpp"
+#include "util/format.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+
+ObjectIngestSink::ObjectIngestSink(SharedRealm realm, ObjectSchema const& object_schema,
+                                   size_t rows_per_transaction)
+: m_realm(std::move(realm))
+, m_object_schema(&object_schema)
+, m_rows_per_transaction(rows_per_transaction)
+, m_owns_transaction(!m_realm->is_in_transaction())
+{
+    m_realm->verify_thread();
+    m_table = ObjectStore::table_for_object_schema(m_realm->read_group(), object_schema);
+    m_properties_set.resize(object_schema.persisted_properties.size());
+}
+
+ObjectIngestSink::~ObjectIngestSink()
+{
+    if (m_owns_transaction && m_realm && m_realm->is_in_transaction()) {
+        try {
+            m_realm->cancel_transaction();
+        }
+        catch (...) {
+        }
+    }
+}
+
+void ObjectIngestSink::begin_object()
+{
+    if (m_in_object)
+        throw std::logic_error("Cannot begin an object while another object is being ingested.");
+    if (m_owns_transaction && !m_realm->is_in_transaction())
+        m_realm->begin_transaction();
+    else
+        m_realm->verify_in_write();
+    m_row = m_table->add_empty_row();
+    std::fill(m_properties_set.begin(), m_properties_set.end(), false);
+    m_property = nullptr;
+    m_in_object = true;
+}
+
+void ObjectIngestSink::key(StringData property_name)
+{
+    if (!m_in_object)
+        throw std::logic_error("Cannot select a property outside of an object.");
+    auto prop = m_object_schema->property_for_name(property_name);
+    if (!prop)
+        throw InvalidPropertyException(m_object_schema->name, property_name);
+    if (prop->type == PropertyType::Object || prop->type == PropertyType::Array || prop->type == PropertyType::LinkingObjects)
+        throw std::logic_error(util::format("Streaming ingest does not support property '%1.%2' of type '%3'.",
+                                            m_object_schema->name, prop->name,
+                                            Property::string_for_property_type(prop->type)));
+    m_property = prop;
+}
+
+Property const& ObjectIngestSink::selected_property() const
+{
+    if (!m_property)
+        throw std::logic_error("Cannot set a value before selecting a property.");
+    return *m_property;
+}
+
+void ObjectIngestSink::property_written()
+{
+    m_properties_set[m_object_schema->property_index(*m_property)] = true;
+    m_property = nullptr;
+}
+
+void ObjectIngestSink::throw_type_mismatch(Property const& property, const char* value_type) const
+{
+    throw std::logic_error(util::format("Invalid %1 value for property '%2.%3' of type '%4'.",
+                                        value_type, m_object_schema->name, property.name,
+                                        Property::string_for_property_type(property.type)));
+}
+
+void ObjectIngestSink::value(bool v)
+{
+    auto& property = selected_property();
+    if (property.type != PropertyType::Bool)
+        throw_type_mismatch(property, "boolean");
+    m_table->set_bool(property.table_column, m_row, v);
+    property_written();
+}
+
+void ObjectIngestSink::value(int64_t v)
+{
+    auto& property = selected_property();
+    switch (property.type) {
+        case PropertyType::Int:
+            if (property.is_primary) {
+                size_t existing = m_table->find_first_int(property.table_column, v);
+                if (existing != not_found && existing != m_row)
+                    throw std::logic_error(util::format("Attempting to create an object of type '%1' with an existing primary key value.",
+                                                        m_object_schema->name));
+                m_table->set_int_unique(property.table_column, m_row, v);
+            }
+            else {
+                m_table->set_int(property.table_column, m_row, v);
+            }
+            break;
+        case PropertyType::Float:
+            m_table->set_float(property.table_column, m_row, static_cast<float>(v));
+            break;
+        case PropertyType::Double:
+            m_table->set_double(property.table_column, m_row, static_cast<double>(v));
+            break;
+        default:
+            throw_type_mismatch(property, "numeric");
+    }
+    property_written();
+}
+
+void ObjectIngestSink::value(double v)
+{
+    auto& property = selected_property();
+    switch (property.type) {
+        case PropertyType::Float:
+            m_table->set_float(property.table_column, m_row, static_cast<float>(v));
+            break;
+        case PropertyType::Double:
+            m_table->set_double(property.table_column, m_row, v);
+            break;
+        default:
+            throw_type_mismatch(property, "numeric");
+    }
+    property_written();
+}
+
+void ObjectIngestSink::value(StringData v)
+{
+    auto& property = selected_property();
+    switch (property.type) {
+        case PropertyType::String:
+            if (property.is_primary) {
+                size_t existing = m_table->find_first_string(property.table_column, v);
+                if (existing != not_found && existing != m_row)
+                    throw std::logic_error(util::format("Attempting to create an object of type '%1' with an existing primary key value.",
+                                                        m_object_schema->name));
+                m_table->set_string_unique(property.table_column, m_row, v);
+            }
+            else {
+                m_table->set_string(property.table_column, m_row, v);
+            }
+            break;
+        case PropertyType::Data:
+            m_table->set_binary(property.table_column, m_row, BinaryData(v.data(), v.size()));
+            break;
+        default:
+            throw_type_mismatch(property, "string");
+    }
+    property_written();
+}
+
+void ObjectIngestSink::value(Timestamp v)
+{
+    auto& property = selected_property();
+    if (property.type != PropertyType::Date)
+        throw_type_mismatch(property, "date");
+    m_table->set_timestamp(property.table_column, m_row, v);
+    property_written();
+}
+
+void ObjectIngestSink::value_null()
+{
+    auto& property = selected_property();
+    if (!property.is_nullable)
+        throw_type_mismatch(property, "null");
+    m_table->set_null(property.table_column, m_row);
+    property_written();
+}
+
+void ObjectIngestSink::end_object()
+{
+    if (!m_in_object)
+        throw std::logic_error("Cannot end an object without beginning one.");
+    if (m_property)
+        throw std::logic_error("Cannot end an object with a property selected but not set.");
+
+    // Properties which were never set are left with the defaults produced by
+    // add_empty_row(), which are null for nullable columns and empty for
+    // lists, but a required scalar property with no value is an error just
+    // as it is in Object::create()
+    auto& props = m_object_schema->persisted_properties;
+    for (size_t i = 0; i < props.size(); ++i) {
+        if (m_properties_set[i])
+            continue;
+        auto& prop = props[i];
+        if (!prop.is_nullable && prop.type != PropertyType::Array)
+            throw MissingPropertyValueException(m_object_schema->name, prop.name);
+    }
+
+    m_in_object = false;
+    ++m_objects_ingested;
+    if (m_owns_transaction && ++m_rows_in_transaction >= m_rows_per_transaction) {
+        m_realm->commit_transaction();
+        m_rows_in_transaction = 0;
+    }
+}
+
+void ObjectIngestSink::complete()
+{
+    if (m_in_object)
+        throw std::logic_error("Cannot complete an ingest in the middle of an object.");
+    if (m_owns_transaction && m_realm->is_in_transaction()) {
+        m_realm->commit_transaction();
+        m_rows_in_transaction = 0;
+    }
+}
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_OBJECT_INGEST_SINK_HPP
+#define REALM_OBJECT_INGEST_SINK_HPP
+
+#include "shared_realm.hpp"
+
+#include <realm/string_data.hpp>
+#include <realm/table_ref.hpp>
+#include <realm/timestamp.hpp>
+
+#include <vector>
+
+namespace realm {
+class ObjectSchema;
+struct Property;
+
+// Streaming ingest of objects of a single type. A parser (a JSON SAX
+// handler or similar) pushes one token at a time and each value is written
+// directly to its table column using the ObjectSchema layout, so no
+// intermediate per-object dictionary is ever built. Rows are committed in
+// bounded batches, keeping memory use flat for arbitrarily large imports.
+//
+// Only scalar properties are supported; link and list properties have to go
+// through Object::create. Typical usage:
+//
+//     ObjectIngestSink sink(realm, object_schema);
+//     for each incoming object:
+//         sink.begin_object();
+//         for each field: sink.key(name); sink.value(v);
+//         sink.end_object();
+//     sink.complete();
+class ObjectIngestSink {
+public:
+    // The sink begins and commits its own write transactions, with at most
+    // `rows_per_transaction` objects per commit. If the Realm is already in
+    // a write transaction the sink writes into it and leaves committing to
+    // the caller.
+    ObjectIngestSink(SharedRealm realm, ObjectSchema const& object_schema,
+                     size_t rows_per_transaction = 1000);
+
+    // Destroying the sink without calling complete() cancels the write
+    // transaction it had open, discarding any not-yet-committed objects
+    ~ObjectIngestSink();
+
+    ObjectIngestSink(ObjectIngestSink const&) = delete;
+    ObjectIngestSink& operator=(ObjectIngestSink const&) = delete;
+
+    // Begin ingesting a new object, adding its row to the table
+    void begin_object();
+
+    // Select the property which the next value() call will set
+    // Throws InvalidPropertyException for unknown property names, and
+    // std::logic_error for link and list properties
+    void key(StringData property_name);
+
+    // Set the selected property of the current object. The value must match
+    // the property's type (numeric values are converted between the numeric
+    // column types); a mismatch throws std::logic_error.
+    void value(bool v);
+    void value(int64_t v);
+    void value(double v);
+    void value(StringData v);
+    void value(const char* v) { value(StringData(v)); }
+    void value(Timestamp v);
+    void value_null();
+
+    // Finish the current object
+    // Throws MissingPropertyValueException if a required property was not set
+    void end_object();
+
+    // Commit any objects not yet committed. The sink can be reused for
+    // further objects afterwards.
+    void complete();
+
+    size_t objects_ingested() const noexcept { return m_objects_ingested; }
+
+private:
+    SharedRealm m_realm;
+    const ObjectSchema* m_object_schema;
+    TableRef m_table;
+    size_t m_rows_per_transaction;
+    bool m_owns_transaction;
+
+    // State for the object currently being ingested
+    bool m_in_object = false;
+    size_t m_row = -1;
+    const Property* m_property = nullptr;
+    std::vector<bool> m_properties_set;
+
+    size_t m_rows_in_transaction = 0;
+    size_t m_objects_ingested = 0;
+
+    Property const& selected_property() const;
+    void property_written();
+    [[noreturn]] void throw_type_mismatch(Property const& property, const char* value_type) const;
+};
+
+} // namespace realm
+
+#endif // REALM_OBJECT_INGEST_SINK_HPP
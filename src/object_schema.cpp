@@ -95,22 +95,41 @@ ObjectSchema::ObjectSchema(Group const& group, StringData name, size_t index) :
     set_primary_key_property();
 }
 
+void ObjectSchema::rebuild_property_index() const {
+    m_property_index.clear();
+    m_property_index.reserve(persisted_properties.size() + computed_properties.size());
+    // emplace() does not overwrite, so persisted properties take precedence
+    // over computed ones with the same name, as with the old linear scan
+    for (size_t i = 0; i < persisted_properties.size(); ++i)
+        m_property_index.emplace(persisted_properties[i].name, i);
+    for (size_t i = 0; i < computed_properties.size(); ++i)
+        m_property_index.emplace(computed_properties[i].name, persisted_properties.size() + i);
+}
+
 Property *ObjectSchema::property_for_name(StringData name) {
-    for (auto& prop : persisted_properties) {
-        if (StringData(prop.name) == name) {
-            return &prop;
-        }
-    }
-    for (auto& prop : computed_properties) {
-        if (StringData(prop.name) == name) {
-            return &prop;
-        }
-    }
-    return nullptr;
+    return const_cast<Property *>(const_cast<const ObjectSchema *>(this)->property_for_name(name));
 }
 
 const Property *ObjectSchema::property_for_name(StringData name) const {
-    return const_cast<ObjectSchema *>(this)->property_for_name(name);
+    if (m_property_index.size() != persisted_properties.size() + computed_properties.size())
+        rebuild_property_index();
+    auto it = m_property_index.find(std::string(name));
+    if (it == m_property_index.end())
+        return nullptr;
+    return &property_at(it->second);
+}
+
+size_t ObjectSchema::property_index(Property const& property) const noexcept {
+    if (&property >= persisted_properties.data()
+        && &property < persisted_properties.data() + persisted_properties.size())
+        return &property - persisted_properties.data();
+    return persisted_properties.size() + (&property - computed_properties.data());
+}
+
+Property const& ObjectSchema::property_at(size_t index) const noexcept {
+    return index < persisted_properties.size()
+         ? persisted_properties[index]
+         : computed_properties[index - persisted_properties.size()];
 }
 
 bool ObjectSchema::property_is_computed(Property const& property) const {
@@ -22,6 +22,7 @@
 #include <realm/string_data.hpp>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace realm {
@@ -49,6 +50,14 @@ public:
 
     Property *property_for_name(StringData name);
     const Property *property_for_name(StringData name) const;
+
+    // Get the position of a property within the schema, or the property at a
+    // given position. Positions are stable for the lifetime of the schema
+    // (persisted properties first, then computed), so callers which look up
+    // the same property for many objects can cache the index instead of
+    // repeating the name lookup.
+    size_t property_index(Property const& property) const noexcept;
+    Property const& property_at(size_t index) const noexcept;
     Property *primary_key_property() {
         return property_for_name(primary_key);
     }
@@ -62,6 +71,20 @@ public:
     friend bool operator==(ObjectSchema const& a, ObjectSchema const& b);
 
 private:
+    friend class ObjectStore;
+
+    // Index from property name to position, built on first lookup and
+    // rebuilt if the property vectors have since grown or shrunk. The
+    // properties themselves are not renamed after construction, so matching
+    // sizes means the index is current.
+    mutable std::unordered_map<std::string, size_t> m_property_index;
+
+    // Index in the Group of this type's table, cached by
+    // ObjectStore::table_for_object_schema(). Validated against the group
+    // on each use, so it never needs explicit invalidation.
+    mutable size_t m_table_index = size_t(-1);
+
+    void rebuild_property_index() const;
     void set_primary_key_property();
 };
 }
@@ -28,7 +28,9 @@
 #include <realm/table_view.hpp>
 #include <realm/util/assert.hpp>
 
+#include <algorithm>
 #include <string.h>
+#include <unordered_map>
 
 using namespace realm;
 
@@ -38,6 +40,7 @@ namespace {
 const char * const c_metadataTableName = "metadata";
 const char * const c_versionColumnName = "version";
 const size_t c_versionColumnIndex = 0;
+const char * const c_schemaHashColumnName = "schema_hash";
 
 const char * const c_primaryKeyTableName = "pk";
 const char * const c_primaryKeyObjectClassColumnName = "pk_table";
@@ -77,6 +80,16 @@ void set_schema_version(Group& group, uint64_t version) {
     table->set_int(c_versionColumnIndex, c_zeroRowIndex, version);
 }
 
+void set_schema_content_hash(Group& group, uint64_t hash) {
+    TableRef table = group.get_or_add_table(c_metadataTableName);
+    size_t col = table->get_column_index(c_schemaHashColumnName);
+    if (col == not_found) {
+        // files written before content hashes were stored lack the column
+        col = table->add_column(type_Int, c_schemaHashColumnName);
+    }
+    table->set_int(col, c_zeroRowIndex, int64_t(hash));
+}
+
 template<typename Group>
 auto table_for_object_schema(Group& group, ObjectSchema const& object_schema)
 {
@@ -96,15 +109,32 @@ void add_index(Table& table, size_t col)
     }
 }
 
-void insert_column(Group& group, Table& table, Property const& property, size_t col_ndx)
+// Cache of object type name to table accessor used when creating many
+// tables at once, so that each link column doesn't have to look its target
+// table up in the group by name again
+using CreatedTables = std::unordered_map<std::string, TableRef>;
+
+TableRef get_or_add_table_for_object_type(Group& group, std::string const& object_type,
+                                          CreatedTables* created_tables)
+{
+    if (!created_tables)
+        return group.get_or_add_table(ObjectStore::table_name_for_object_type(object_type));
+
+    auto& table = (*created_tables)[object_type];
+    if (!table)
+        table = group.get_or_add_table(ObjectStore::table_name_for_object_type(object_type));
+    return table;
+}
+
+void insert_column(Group& group, Table& table, Property const& property, size_t col_ndx,
+                   CreatedTables* created_tables = nullptr)
 {
     // Cannot directly insert a LinkingObjects column (a computed property).
     // LinkingObjects must be an artifact of an existing link column.
     REALM_ASSERT(property.type != PropertyType::LinkingObjects);
 
     if (property.type == PropertyType::Object || property.type == PropertyType::Array) {
-        auto target_name = ObjectStore::table_name_for_object_type(property.object_type);
-        TableRef link_table = group.get_or_add_table(target_name);
+        TableRef link_table = get_or_add_table_for_object_type(group, property.object_type, created_tables);
         table.insert_column_link(col_ndx, DataType(property.type), property.name, *link_table);
     }
     else {
@@ -114,9 +144,10 @@ void insert_column(Group& group, Table& table, Property const& property, size_t
     }
 }
 
-void add_column(Group& group, Table& table, Property const& property)
+void add_column(Group& group, Table& table, Property const& property,
+                CreatedTables* created_tables = nullptr)
 {
-    insert_column(group, table, property, table.get_column_count());
+    insert_column(group, table, property, table.get_column_count(), created_tables);
 }
 
 void replace_column(Group& group, Table& table, Property const& old_property, Property const& new_property)
@@ -125,16 +156,16 @@ void replace_column(Group& group, Table& table, Property const& old_property, Pr
     table.remove_column(old_property.table_column + 1);
 }
 
-TableRef create_table(Group& group, ObjectSchema const& object_schema)
+TableRef create_table(Group& group, ObjectSchema const& object_schema,
+                      CreatedTables* created_tables = nullptr)
 {
-    auto name = ObjectStore::table_name_for_object_type(object_schema.name);
-    auto table = group.get_or_add_table(name);
+    auto table = get_or_add_table_for_object_type(group, object_schema.name, created_tables);
     if (table->get_column_count() > 0) {
         return table;
     }
 
     for (auto const& prop : object_schema.persisted_properties) {
-        add_column(group, *table, prop);
+        add_column(group, *table, prop, created_tables);
     }
 
     ObjectStore::set_primary_key_for_object(group, object_schema.name, object_schema.primary_key);
@@ -227,6 +258,18 @@ uint64_t ObjectStore::get_schema_version(Group const& group) {
     return table->get_int(c_versionColumnIndex, c_zeroRowIndex);
 }
 
+util::Optional<uint64_t> ObjectStore::get_schema_content_hash(Group const& group) {
+    ConstTableRef table = group.get_table(c_metadataTableName);
+    if (!table || table->size() == 0) {
+        return util::none;
+    }
+    size_t col = table->get_column_index(c_schemaHashColumnName);
+    if (col == not_found) {
+        return util::none;
+    }
+    return uint64_t(table->get_int(col, c_zeroRowIndex));
+}
+
 StringData ObjectStore::get_primary_key_for_object(Group const& group, StringData object_type) {
     ConstTableRef table = group.get_table(c_primaryKeyTableName);
     if (!table) {
@@ -281,6 +324,28 @@ ConstTableRef ObjectStore::table_for_object_type(Group const& group, StringData
     return group.get_table(name);
 }
 
+TableRef ObjectStore::table_for_object_schema(Group& group, ObjectSchema const& object_schema) {
+    size_t index = object_schema.m_table_index;
+    if (index < group.size()
+        && object_type_for_table_name(group.get_table_name(index)) == object_schema.name) {
+        return group.get_table(index);
+    }
+    auto table = table_for_object_type(group, object_schema.name);
+    object_schema.m_table_index = table ? table->get_index_in_group() : realm::not_found;
+    return table;
+}
+
+ConstTableRef ObjectStore::table_for_object_schema(Group const& group, ObjectSchema const& object_schema) {
+    size_t index = object_schema.m_table_index;
+    if (index < group.size()
+        && object_type_for_table_name(group.get_table_name(index)) == object_schema.name) {
+        return group.get_table(index);
+    }
+    auto table = table_for_object_type(group, object_schema.name);
+    object_schema.m_table_index = table ? table->get_index_in_group() : realm::not_found;
+    return table;
+}
+
 namespace {
 struct SchemaDifferenceExplainer {
     std::vector<ObjectSchemaValidationException> errors;
@@ -491,7 +556,22 @@ static void create_initial_tables(Group& group, std::vector<SchemaChange> const&
         Group& group;
         TableHelper table;
 
-        void operator()(AddTable op) { create_table(group, *op.object); }
+        // All of the tables which have been created or looked up so far.
+        // Creating a table is independent of every other table, but creating
+        // a link column requires an accessor for its target table, so all of
+        // the tables are created in a first pass and remembered here to keep
+        // the column-creation pass from repeating the by-name table lookup
+        // for every link in the schema.
+        CreatedTables created_tables;
+
+        void create_empty_table(AddTable op)
+        {
+            get_or_add_table_for_object_type(group, op.object->name, &created_tables);
+        }
+        template<typename T>
+        void create_empty_table(T) { }
+
+        void operator()(AddTable op) { create_table(group, *op.object, &created_tables); }
 
         // Note that in normal operation none of these will be hit, as if we're
         // creating the initial tables there shouldn't be anything to update.
@@ -512,6 +592,9 @@ static void create_initial_tables(Group& group, std::vector<SchemaChange> const&
         }
     } applier{group};
 
+    for (auto& change : changes) {
+        change.visit([&](auto op) { applier.create_empty_table(op); });
+    }
     for (auto& change : changes) {
         change.visit(applier);
     }
@@ -618,6 +701,7 @@ void ObjectStore::apply_schema_changes(Group& group, uint64_t schema_version,
     if (schema_version == ObjectStore::NotVersioned) {
         create_initial_tables(group, changes);
         set_schema_version(group, target_schema_version);
+        set_schema_content_hash(group, target_schema.content_hash());
         set_schema_columns(group, target_schema);
         return;
     }
@@ -630,6 +714,7 @@ void ObjectStore::apply_schema_changes(Group& group, uint64_t schema_version,
             set_schema_version(group, target_schema_version);
         }
 
+        set_schema_content_hash(group, target_schema.content_hash());
         set_schema_columns(group, target_schema);
         return;
     }
@@ -642,11 +727,13 @@ void ObjectStore::apply_schema_changes(Group& group, uint64_t schema_version,
         validate_primary_column_uniqueness(group);
         set_schema_columns(group, target_schema);
         set_schema_version(group, target_schema_version);
+        set_schema_content_hash(group, target_schema.content_hash());
         return;
     }
 
     if (schema_version == target_schema_version) {
         apply_non_migration_changes(group, changes);
+        set_schema_content_hash(group, target_schema.content_hash());
         set_schema_columns(group, target_schema);
         return;
     }
@@ -667,6 +754,7 @@ void ObjectStore::apply_schema_changes(Group& group, uint64_t schema_version,
     }
 
     set_schema_version(group, target_schema_version);
+    set_schema_content_hash(group, target_schema.content_hash());
     set_schema_columns(group, target_schema);
 }
 
@@ -682,6 +770,27 @@ Schema ObjectStore::schema_from_group(Group const& group) {
     return schema;
 }
 
+Schema ObjectStore::schema_from_group(Group const& group, Schema const& previous,
+                                      std::vector<size_t> const& changed_tables) {
+    std::vector<ObjectSchema> schema;
+    schema.reserve(group.size());
+    for (size_t i = 0; i < group.size(); i++) {
+        auto object_type = object_type_for_table_name(group.get_table_name(i));
+        if (!object_type.size())
+            continue;
+        // Only read the spec of tables which the transact log reported
+        // changes for; unchanged tables can't have had their columns
+        // touched, so their old ObjectSchemas are still valid
+        bool changed = std::find(begin(changed_tables), end(changed_tables), i) != end(changed_tables);
+        auto existing = changed ? previous.end() : previous.find(object_type);
+        if (existing != previous.end())
+            schema.push_back(*existing);
+        else
+            schema.emplace_back(group, object_type, i);
+    }
+    return schema;
+}
+
 void ObjectStore::set_schema_columns(Group const& group, Schema& schema)
 {
     for (auto& object_schema : schema) {
@@ -22,6 +22,7 @@
 #include "property.hpp"
 
 #include <realm/table_ref.hpp>
+#include <realm/util/optional.hpp>
 
 #include <functional>
 #include <string>
@@ -29,6 +30,7 @@
 
 namespace realm {
 class Group;
+class ObjectSchema;
 class Schema;
 class SchemaChange;
 class StringData;
@@ -53,6 +55,11 @@ public:
     // FIXME remove this after integrating OS's migration related logic into Realm java
     static void set_schema_version(Group& group, uint64_t version);
 
+    // get the content hash of the schema which was last applied to the group,
+    // or none if the file was last written by a version which predates the
+    // stored hash
+    static util::Optional<uint64_t> get_schema_content_hash(Group const& group);
+
     // check if all of the changes in the list can be applied automatically, or
     // throw if any of them require a schema version bump and migration function
     static void verify_no_migration_required(std::vector<SchemaChange> const& changes);
@@ -89,9 +96,28 @@ public:
     static realm::TableRef table_for_object_type(Group& group, StringData object_type);
     static realm::ConstTableRef table_for_object_type(Group const& group, StringData object_type);
 
+    // get the table for an object type, using (and maintaining) the table
+    // index cached in the ObjectSchema so that repeated resolution of the
+    // same type needs no name building or group-level name lookup. The
+    // cached index is validated against the group before use, so stale
+    // entries after a schema change just fall back to the name lookup. Each
+    // Realm instance holds its own copy of its schema and therefore its own
+    // cache.
+    static realm::TableRef table_for_object_schema(Group& group, ObjectSchema const& object_schema);
+    static realm::ConstTableRef table_for_object_schema(Group const& group, ObjectSchema const& object_schema);
+
     // get existing Schema from a group
     static Schema schema_from_group(Group const& group);
 
+    // get existing Schema from a group, reusing the ObjectSchemas from
+    // `previous` for all tables other than the ones named in
+    // `changed_tables`. `previous` must be the group's complete schema as of
+    // some older version, and `changed_tables` the group-level indices of
+    // every table whose schema changed between that version and the current
+    // one (as reported by the transact log).
+    static Schema schema_from_group(Group const& group, Schema const& previous,
+                                    std::vector<size_t> const& changed_tables);
+
     static void set_schema_columns(Group const& group, Schema& schema);
 
     // deletes the table for the given type
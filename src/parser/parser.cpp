@@ -19,6 +19,9 @@
 #include "parser.hpp"
 
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 #include <pegtl.hh>
 #include <pegtl/analyze.hh>
@@ -81,8 +84,10 @@ struct gt : one< '>' > {};
 struct contains : string_token_t("contains") {};
 struct begins : string_token_t("beginswith") {};
 struct ends : string_token_t("endswith") {};
+struct matches : string_token_t("matches") {};
+struct text_matches : seq< string_token_t("text"), plus< blank >, matches > {};
 
-struct string_oper : seq< sor< contains, begins, ends>, star< blank >, opt< case_insensitive > > {};
+struct string_oper : seq< sor< contains, begins, ends, text_matches >, star< blank >, opt< case_insensitive > > {};
 struct symbolic_oper : sor< eq, noteq, lteq, lt, gteq, gt > {};
 
 // predicates
@@ -273,6 +278,7 @@ OPERATOR_ACTION(lt, Predicate::Operator::LessThan)
 OPERATOR_ACTION(begins, Predicate::Operator::BeginsWith)
 OPERATOR_ACTION(ends, Predicate::Operator::EndsWith)
 OPERATOR_ACTION(contains, Predicate::Operator::Contains)
+OPERATOR_ACTION(matches, Predicate::Operator::TextMatches)
 
 template<> struct action< case_insensitive >
 {
@@ -345,6 +351,69 @@ Predicate parse(const std::string &query)
     return out_predicate;
 }
 
+namespace {
+// A thread-safe LRU cache of parsed predicate ASTs. Predicates are immutable
+// once parsed, so the cached entries can be shared between callers (and
+// threads) freely.
+class PredicateCache {
+public:
+    std::shared_ptr<const Predicate> fetch(const std::string& query)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(query);
+        if (it == m_entries.end()) {
+            return nullptr;
+        }
+        m_lru.splice(m_lru.begin(), m_lru, it->second.position);
+        return it->second.predicate;
+    }
+
+    void store(const std::string& query, std::shared_ptr<const Predicate> predicate)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.count(query)) {
+            // another thread parsed the same query first
+            return;
+        }
+        m_lru.push_front(query);
+        m_entries.insert({query, {std::move(predicate), m_lru.begin()}});
+        if (m_entries.size() > max_entries) {
+            m_entries.erase(m_lru.back());
+            m_lru.pop_back();
+        }
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Predicate> predicate;
+        std::list<std::string>::iterator position;
+    };
+
+    // Bindings tend to issue a few dozen distinct predicate strings, so this
+    // is sized to comfortably hold all of them while keeping the worst-case
+    // memory use of pathological callers bounded
+    static constexpr size_t max_entries = 256;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    // Cached query strings ordered from most to least recently used
+    std::list<std::string> m_lru;
+};
+
+constexpr size_t PredicateCache::max_entries;
+} // anonymous namespace
+
+std::shared_ptr<const Predicate> parse_cached(const std::string &query)
+{
+    static PredicateCache s_cache;
+    if (auto predicate = s_cache.fetch(query)) {
+        return predicate;
+    }
+    auto predicate = std::make_shared<const Predicate>(parse(query));
+    s_cache.store(query, predicate);
+    return predicate;
+}
+
 void analyze_grammar()
 {
     analyze<pred>();
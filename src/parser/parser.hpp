@@ -19,6 +19,7 @@
 #ifndef REALM_PARSER_HPP
 #define REALM_PARSER_HPP
 
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -55,7 +56,8 @@ struct Predicate
         GreaterThanOrEqual,
         BeginsWith,
         EndsWith,
-        Contains
+        Contains,
+        TextMatches
     };
     
     enum class OperatorOption
@@ -86,6 +88,12 @@ struct Predicate
 
 Predicate parse(const std::string &query);
 
+// Same as parse(), but backed by a small LRU cache of parsed ASTs keyed by the
+// query string, so that repeatedly parsing the same predicate (e.g. the same
+// query issued with different argument values) skips the grammar entirely.
+// The returned Predicate is shared and must not be modified.
+std::shared_ptr<const Predicate> parse_cached(const std::string &query);
+
 void analyze_grammar();
 bool test_grammar();
 }
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "predicate_serializer.hpp"
+
+#include <cstring>
+
+namespace realm {
+namespace parser {
+namespace {
+
+// Bump this whenever the encoding below changes in any way. deserialize()
+// refuses data with a different version rather than guessing.
+const char s_format_version = 1;
+
+// Enum values are encoded as single bytes. The encoded values are part of the
+// format, so reordering the enums in parser.hpp does not invalidate
+// serialized predicates as long as these limits stay correct.
+const uint8_t s_max_predicate_type = uint8_t(Predicate::Type::False);
+const uint8_t s_max_operator = uint8_t(Predicate::Operator::TextMatches);
+const uint8_t s_max_operator_option = uint8_t(Predicate::OperatorOption::CaseInsensitive);
+const uint8_t s_max_expression_type = uint8_t(Expression::Type::Null);
+
+void append_byte(std::vector<char> &out, uint8_t value)
+{
+    out.push_back(char(value));
+}
+
+// Sizes are encoded as base-128 varints, least significant group first, with
+// the high bit of each byte indicating that more bytes follow
+void append_varint(std::vector<char> &out, size_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(char(uint8_t(value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(char(uint8_t(value)));
+}
+
+void append_expression(std::vector<char> &out, const Expression &expr)
+{
+    append_byte(out, uint8_t(expr.type));
+    append_varint(out, expr.s.size());
+    out.insert(out.end(), expr.s.begin(), expr.s.end());
+}
+
+void append_predicate(std::vector<char> &out, const Predicate &pred)
+{
+    append_byte(out, uint8_t(pred.type));
+    append_byte(out, pred.negate ? 1 : 0);
+    if (pred.type == Predicate::Type::Comparison) {
+        append_byte(out, uint8_t(pred.cmpr.op));
+        append_byte(out, uint8_t(pred.cmpr.option));
+        append_expression(out, pred.cmpr.expr[0]);
+        append_expression(out, pred.cmpr.expr[1]);
+        return;
+    }
+    append_varint(out, pred.cpnd.sub_predicates.size());
+    for (auto &sub : pred.cpnd.sub_predicates) {
+        append_predicate(out, sub);
+    }
+}
+
+struct Reader {
+    const char *pos;
+    const char *end;
+
+    uint8_t read_byte()
+    {
+        if (pos == end) {
+            throw SerializedPredicateError("Serialized predicate is truncated.");
+        }
+        return uint8_t(*pos++);
+    }
+
+    uint8_t read_byte_max(uint8_t max, const char *what)
+    {
+        uint8_t value = read_byte();
+        if (value > max) {
+            throw SerializedPredicateError(std::string("Serialized predicate has an invalid ") + what + ".");
+        }
+        return value;
+    }
+
+    size_t read_varint()
+    {
+        size_t value = 0;
+        for (int shift = 0; shift < int(sizeof(size_t) * 8); shift += 7) {
+            uint8_t byte = read_byte();
+            value |= size_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw SerializedPredicateError("Serialized predicate has an invalid length.");
+    }
+
+    std::string read_string()
+    {
+        size_t size = read_varint();
+        if (size_t(end - pos) < size) {
+            throw SerializedPredicateError("Serialized predicate is truncated.");
+        }
+        std::string value(pos, size);
+        pos += size;
+        return value;
+    }
+};
+
+Expression read_expression(Reader &reader)
+{
+    auto type = Expression::Type(reader.read_byte_max(s_max_expression_type, "expression type"));
+    return Expression(type, reader.read_string());
+}
+
+Predicate read_predicate(Reader &reader)
+{
+    auto type = Predicate::Type(reader.read_byte_max(s_max_predicate_type, "predicate type"));
+    bool negate = reader.read_byte() != 0;
+    Predicate pred(type, negate);
+    if (type == Predicate::Type::Comparison) {
+        pred.cmpr.op = Predicate::Operator(reader.read_byte_max(s_max_operator, "operator"));
+        pred.cmpr.option = Predicate::OperatorOption(reader.read_byte_max(s_max_operator_option, "operator option"));
+        pred.cmpr.expr[0] = read_expression(reader);
+        pred.cmpr.expr[1] = read_expression(reader);
+        return pred;
+    }
+    size_t count = reader.read_varint();
+    // Each sub-predicate takes at least two bytes, so anything claiming more
+    // than that is corrupt; checking up front bounds the reserve() below
+    if (count > size_t(reader.end - reader.pos) / 2) {
+        throw SerializedPredicateError("Serialized predicate is truncated.");
+    }
+    pred.cpnd.sub_predicates.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        pred.cpnd.sub_predicates.push_back(read_predicate(reader));
+    }
+    return pred;
+}
+} // anonymous namespace
+
+std::vector<char> serialize(const Predicate &predicate)
+{
+    std::vector<char> out;
+    out.push_back(s_format_version);
+    append_predicate(out, predicate);
+    return out;
+}
+
+Predicate deserialize(const char *data, size_t size)
+{
+    Reader reader{data, data + size};
+    if (reader.read_byte() != uint8_t(s_format_version)) {
+        throw SerializedPredicateError("Serialized predicate has an unsupported format version.");
+    }
+    Predicate pred = read_predicate(reader);
+    if (reader.pos != reader.end) {
+        throw SerializedPredicateError("Serialized predicate has trailing data.");
+    }
+    return pred;
+}
+
+} // namespace parser
+} // namespace realm
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_PREDICATE_SERIALIZER_HPP
+#define REALM_PREDICATE_SERIALIZER_HPP
+
+#include "parser.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace realm {
+namespace parser {
+
+// A compact versioned byte representation of a parsed Predicate AST.
+//
+// Predicates for a fixed query set can be parsed once at build time (or on
+// first use) and shipped as bytes, so that loading them at runtime does not
+// involve the grammar at all. serialize() and deserialize() deliberately live
+// in a separate translation unit from parse() so that binaries which only
+// ever load precompiled predicates do not have to link the PEGTL-based
+// parser.
+//
+// The format is a single version byte followed by the predicate tree;
+// deserialize() rejects data with an unknown version or any structural
+// corruption by throwing SerializedPredicateError. The format is not
+// guaranteed to be stable across versions of this library: bumping the
+// version byte invalidates previously serialized predicates, which must then
+// be regenerated from the query strings.
+std::vector<char> serialize(const Predicate &predicate);
+Predicate deserialize(const char *data, size_t size);
+inline Predicate deserialize(const std::vector<char> &data)
+{
+    return deserialize(data.data(), data.size());
+}
+
+struct SerializedPredicateError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+} // namespace parser
+} // namespace realm
+
+#endif // REALM_PREDICATE_SERIALIZER_HPP
@@ -21,12 +21,16 @@
 
 #include "object_store.hpp"
 #include "schema.hpp"
+#include "text_index.hpp"
+#include "util/ascii_search.hpp"
 #include "util/compiler.hpp"
 #include "util/format.hpp"
 
 #include <realm.hpp>
 #include <realm/query_expression.hpp>
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <sstream>
 
 using namespace realm;
@@ -79,6 +83,74 @@ struct FalseExpression : realm::Expression {
     }
 };
 
+// Matches a fixed ascending set of rows; used to apply the result of a
+// TextTokenIndex lookup as a query clause
+struct RowSetExpression : realm::Expression {
+    std::vector<size_t> rows;
+
+    RowSetExpression(std::vector<size_t> r) : rows(std::move(r)) {}
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        auto it = std::lower_bound(rows.begin(), rows.end(), start);
+        if (it != rows.end() && *it < end)
+            return *it;
+        return realm::not_found;
+    }
+    void set_base_table(const Table*) override {}
+    const Table* get_base_table() const override { return nullptr; }
+    void verify_column() const override {}
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new RowSetExpression(*this));
+    }
+};
+
+// Case-insensitive search over a string column of the query's table with a
+// pure-ASCII needle. Replaces core's per-character case-mapped comparison for
+// CONTAINS[c]-style predicates: the needle is folded to lower-case once at
+// construction and rows are matched with the word-at-a-time ASCII kernel,
+// which for an ASCII needle accepts exactly the same strings.
+struct AsciiCaseSearchExpression : realm::Expression {
+    enum class Mode { BeginsWith, EndsWith, Contains };
+
+    const Table* table = nullptr;
+    size_t column;
+    std::string needle;
+    Mode mode;
+
+    AsciiCaseSearchExpression(size_t column, std::string needle, Mode mode)
+    : column(column), needle(std::move(needle)), mode(mode)
+    {
+        util::ascii_tolower(this->needle);
+    }
+
+    size_t find_first(size_t start, size_t end) const override
+    {
+        for (size_t row = start; row < end; ++row) {
+            if (matches(table->get_string(column, row)))
+                return row;
+        }
+        return realm::not_found;
+    }
+    bool matches(StringData value) const
+    {
+        switch (mode) {
+            case Mode::BeginsWith: return util::ascii_begins_with_ins(value, needle);
+            case Mode::EndsWith: return util::ascii_ends_with_ins(value, needle);
+            case Mode::Contains: return util::ascii_contains_ins(value, needle);
+        }
+        REALM_UNREACHABLE();
+    }
+    void set_base_table(const Table* t) override { table = t; }
+    const Table* get_base_table() const override { return table; }
+    void verify_column() const override {}
+    std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const override
+    {
+        return std::unique_ptr<Expression>(new AsciiCaseSearchExpression(*this));
+    }
+};
+
 using KeyPath = std::vector<std::string>;
 KeyPath key_path_from_string(const std::string &s) {
     std::stringstream ss(s);
@@ -90,29 +162,51 @@ KeyPath key_path_from_string(const std::string &s) {
     return key_path;
 }
 
+using KeyPathCache = std::unordered_map<std::string, ResolvedKeyPath>;
+
+ResolvedKeyPath resolve_key_path(const Schema &schema, Schema::const_iterator desc, const std::string &key_path_string)
+{
+    ResolvedKeyPath resolved;
+    KeyPath key_path = key_path_from_string(key_path_string);
+    for (size_t index = 0; index < key_path.size(); index++) {
+        if (resolved.property) {
+            precondition(resolved.property->type == PropertyType::Object || resolved.property->type == PropertyType::Array,
+                         util::format("Property '%1' is not a link in object of type '%2'", key_path[index], desc->name));
+            resolved.link_columns.push_back(resolved.property->table_column);
+
+        }
+        resolved.property = desc->property_for_name(key_path[index]);
+        precondition(resolved.property != nullptr,
+                     util::format("No property '%1' on object of type '%2'", key_path[index], desc->name));
+
+        if (resolved.property->object_type.size()) {
+            desc = schema.find(resolved.property->object_type);
+        }
+    }
+    return resolved;
+}
+
 struct PropertyExpression
 {
     const Property *prop = nullptr;
     std::vector<size_t> indexes;
     std::function<Table *()> table_getter;
 
-    PropertyExpression(Query &query, const Schema &schema, Schema::const_iterator desc, const std::string &key_path_string)
+    PropertyExpression(Query &query, const Schema &schema, Schema::const_iterator desc,
+                       const std::string &key_path_string, KeyPathCache *key_paths = nullptr)
     {
-        KeyPath key_path = key_path_from_string(key_path_string);
-        for (size_t index = 0; index < key_path.size(); index++) {
-            if (prop) {
-                precondition(prop->type == PropertyType::Object || prop->type == PropertyType::Array,
-                             util::format("Property '%1' is not a link in object of type '%2'", key_path[index], desc->name));
-                indexes.push_back(prop->table_column);
-
-            }
-            prop = desc->property_for_name(key_path[index]);
-            precondition(prop != nullptr,
-                         util::format("No property '%1' on object of type '%2'", key_path[index], desc->name));
-
-            if (prop->object_type.size()) {
-                desc = schema.find(prop->object_type);
+        if (key_paths) {
+            auto it = key_paths->find(key_path_string);
+            if (it == key_paths->end()) {
+                it = key_paths->emplace(key_path_string, resolve_key_path(schema, desc, key_path_string)).first;
             }
+            prop = it->second.property;
+            indexes = it->second.link_columns;
+        }
+        else {
+            ResolvedKeyPath resolved = resolve_key_path(schema, desc, key_path_string);
+            prop = resolved.property;
+            indexes = std::move(resolved.link_columns);
         }
 
         table_getter = [&] {
@@ -174,8 +268,32 @@ void add_bool_constraint_to_query(Query &query, Predicate::Operator operatorType
 void add_string_constraint_to_query(Query &query,
                                     Predicate::Comparison cmp,
                                     Columns<String> &&column,
-                                    std::string &&value) {
+                                    std::string &&value,
+                                    const PropertyExpression *expr = nullptr) {
     bool case_sensitive = (cmp.option != Predicate::OperatorOption::CaseInsensitive);
+    if (!case_sensitive && expr && expr->indexes.empty() && !value.empty() && util::is_ascii(value)) {
+        // Case-insensitive substring search with an ASCII needle over a
+        // column of the query's own table can bypass core's per-character
+        // case-mapped comparison in favour of the word-at-a-time ASCII kernel
+        using Mode = AsciiCaseSearchExpression::Mode;
+        auto add = [&](Mode mode) {
+            query.and_query(std::unique_ptr<realm::Expression>(
+                new AsciiCaseSearchExpression(expr->prop->table_column, std::move(value), mode)));
+        };
+        switch (cmp.op) {
+            case Predicate::Operator::BeginsWith:
+                add(Mode::BeginsWith);
+                return;
+            case Predicate::Operator::EndsWith:
+                add(Mode::EndsWith);
+                return;
+            case Predicate::Operator::Contains:
+                add(Mode::Contains);
+                return;
+            default:
+                break;
+        }
+    }
     switch (cmp.op) {
         case Predicate::Operator::BeginsWith:
             query.and_query(column.begins_with(value, case_sensitive));
@@ -200,7 +318,8 @@ void add_string_constraint_to_query(Query &query,
 void add_string_constraint_to_query(realm::Query &query,
                                     Predicate::Comparison cmp,
                                     std::string &&value,
-                                    Columns<String> &&column) {
+                                    Columns<String> &&column,
+                                    const PropertyExpression * = nullptr) {
     bool case_sensitive = (cmp.option != Predicate::OperatorOption::CaseInsensitive);
     switch (cmp.op) {
         case Predicate::Operator::Equal:
@@ -387,47 +506,76 @@ auto value_of_type_for_query(TableGetter&& tables, Value&& value, Arguments &arg
     return helper::convert(tables, value, args);
 }
 
+// Clause construction for each property type, dispatched through a flat
+// table indexed by the numeric value of PropertyType rather than nested
+// switches. Null entries are types which cannot appear in comparisons.
+template <typename A, typename B>
+struct ComparisonHandlers {
+    using Handler = void (*)(Query &, const Predicate::Comparison &, const PropertyExpression &, A &, B &, Arguments &);
+
+    template <typename RealmType>
+    static void numeric(Query &query, const Predicate::Comparison &cmp, const PropertyExpression &expr, A &lhs, B &rhs, Arguments &args)
+    {
+        add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<RealmType>(expr.table_getter, lhs, args),
+                                                       value_of_type_for_query<RealmType>(expr.table_getter, rhs, args));
+    }
+
+    static void boolean(Query &query, const Predicate::Comparison &cmp, const PropertyExpression &expr, A &lhs, B &rhs, Arguments &args)
+    {
+        add_bool_constraint_to_query(query, cmp.op, value_of_type_for_query<bool>(expr.table_getter, lhs, args),
+                                                    value_of_type_for_query<bool>(expr.table_getter, rhs, args));
+    }
+
+    static void string(Query &query, const Predicate::Comparison &cmp, const PropertyExpression &expr, A &lhs, B &rhs, Arguments &args)
+    {
+        add_string_constraint_to_query(query, cmp, value_of_type_for_query<String>(expr.table_getter, lhs, args),
+                                                   value_of_type_for_query<String>(expr.table_getter, rhs, args), &expr);
+    }
+
+    static void binary(Query &query, const Predicate::Comparison &cmp, const PropertyExpression &expr, A &lhs, B &rhs, Arguments &args)
+    {
+        add_binary_constraint_to_query(query, cmp.op, value_of_type_for_query<Binary>(expr.table_getter, lhs, args),
+                                                      value_of_type_for_query<Binary>(expr.table_getter, rhs, args));
+    }
+
+    static void link(Query &query, const Predicate::Comparison &cmp, const PropertyExpression &expr, A &lhs, B &rhs, Arguments &args)
+    {
+        add_link_constraint_to_query(query, cmp.op, expr, link_argument(lhs, rhs, args));
+    }
+
+    static const Handler table[14];
+};
+
+template <typename A, typename B>
+const typename ComparisonHandlers<A, B>::Handler ComparisonHandlers<A, B>::table[14] = {
+    &ComparisonHandlers::numeric<Int>,       // Int = 0
+    &ComparisonHandlers::boolean,            // Bool = 1
+    &ComparisonHandlers::string,             // String = 2
+    nullptr,
+    &ComparisonHandlers::binary,             // Data = 4
+    nullptr,
+    nullptr,                                 // Any = 6
+    nullptr,
+    &ComparisonHandlers::numeric<Timestamp>, // Date = 8
+    &ComparisonHandlers::numeric<Float>,     // Float = 9
+    &ComparisonHandlers::numeric<Double>,    // Double = 10
+    nullptr,
+    &ComparisonHandlers::link,               // Object = 12
+    &ComparisonHandlers::link,               // Array = 13
+};
+
 template <typename A, typename B>
 void do_add_comparison_to_query(Query &query, Predicate::Comparison cmp,
                                 const PropertyExpression &expr, A &lhs, B &rhs, Arguments &args)
 {
+    using Handlers = ComparisonHandlers<A, B>;
     auto type = expr.prop->type;
-    switch (type) {
-        case PropertyType::Bool:
-            add_bool_constraint_to_query(query, cmp.op, value_of_type_for_query<bool>(expr.table_getter, lhs, args),
-                                                        value_of_type_for_query<bool>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::Date:
-            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Timestamp>(expr.table_getter, lhs, args),
-                                                           value_of_type_for_query<Timestamp>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::Double:
-            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Double>(expr.table_getter, lhs, args),
-                                                           value_of_type_for_query<Double>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::Float:
-            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Float>(expr.table_getter, lhs, args),
-                                                           value_of_type_for_query<Float>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::Int:
-            add_numeric_constraint_to_query(query, cmp.op, value_of_type_for_query<Int>(expr.table_getter, lhs, args),
-                                                           value_of_type_for_query<Int>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::String:
-            add_string_constraint_to_query(query, cmp, value_of_type_for_query<String>(expr.table_getter, lhs, args),
-                                                       value_of_type_for_query<String>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::Data:
-            add_binary_constraint_to_query(query, cmp.op, value_of_type_for_query<Binary>(expr.table_getter, lhs, args),
-                                                          value_of_type_for_query<Binary>(expr.table_getter, rhs, args));
-            break;
-        case PropertyType::Object:
-        case PropertyType::Array:
-            add_link_constraint_to_query(query, cmp.op, expr, link_argument(lhs, rhs, args));
-            break;
-        default:
-            throw std::logic_error(util::format("Object type '%1' not supported", string_for_property_type(type)));
+    auto index = size_t(type);
+    typename Handlers::Handler handler = index < 14 ? Handlers::table[index] : nullptr;
+    if (!handler) {
+        throw std::logic_error(util::format("Object type '%1' not supported", string_for_property_type(type)));
     }
+    handler(query, cmp, expr, lhs, rhs, args);
 }
   
 template<typename T>
@@ -479,39 +627,39 @@ void do_add_null_comparison_to_query<Link>(Query &query, Predicate::Operator op,
     }
 }
 
+void throw_null_list_comparison(Query &, Predicate::Operator, const PropertyExpression &)
+{
+    throw std::logic_error("Comparing Lists to 'null' is not supported");
+}
+
+// Flat dispatch table for null comparisons, indexed like ComparisonHandlers
+using NullComparisonHandler = void (*)(Query &, Predicate::Operator, const PropertyExpression &);
+const NullComparisonHandler s_null_comparison_handlers[14] = {
+    &do_add_null_comparison_to_query<Int>,       // Int = 0
+    &do_add_null_comparison_to_query<bool>,      // Bool = 1
+    &do_add_null_comparison_to_query<String>,    // String = 2
+    nullptr,
+    &do_add_null_comparison_to_query<Binary>,    // Data = 4
+    nullptr,
+    nullptr,                                     // Any = 6
+    nullptr,
+    &do_add_null_comparison_to_query<Timestamp>, // Date = 8
+    &do_add_null_comparison_to_query<Float>,     // Float = 9
+    &do_add_null_comparison_to_query<Double>,    // Double = 10
+    nullptr,
+    &do_add_null_comparison_to_query<Link>,      // Object = 12
+    &throw_null_list_comparison,                 // Array = 13
+};
+
 void do_add_null_comparison_to_query(Query &query, Predicate::Comparison cmp, const PropertyExpression &expr)
 {
     auto type = expr.prop->type;
-    switch (type) {
-        case realm::PropertyType::Bool:
-            do_add_null_comparison_to_query<bool>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Date:
-            do_add_null_comparison_to_query<Timestamp>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Double:
-            do_add_null_comparison_to_query<Double>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Float:
-            do_add_null_comparison_to_query<Float>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Int:
-            do_add_null_comparison_to_query<Int>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::String:
-            do_add_null_comparison_to_query<String>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Data:
-            do_add_null_comparison_to_query<Binary>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Object:
-            do_add_null_comparison_to_query<Link>(query, cmp.op, expr);
-            break;
-        case realm::PropertyType::Array:
-            throw std::logic_error("Comparing Lists to 'null' is not supported");
-        default:
-            throw std::logic_error(util::format("Object type '%1' not supported", string_for_property_type(type)));
+    auto index = size_t(type);
+    NullComparisonHandler handler = index < 14 ? s_null_comparison_handlers[index] : nullptr;
+    if (!handler) {
+        throw std::logic_error(util::format("Object type '%1' not supported", string_for_property_type(type)));
     }
+    handler(query, cmp.op, expr);
 }
     
 bool expression_is_null(const parser::Expression &expr, Arguments &args) {
@@ -524,13 +672,37 @@ bool expression_is_null(const parser::Expression &expr, Arguments &args) {
     return false;
 }
 
-void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &args, const Schema &schema, const std::string &type)
+void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &args, const Schema &schema,
+                             const std::string &type, KeyPathCache *key_paths,
+                             const TextIndexMap *text_indexes)
 {
     const Predicate::Comparison &cmpr = pred.cmpr;
     auto t0 = cmpr.expr[0].type, t1 = cmpr.expr[1].type;
     auto object_schema = schema.find(type);
+    if (cmpr.op == Predicate::Operator::TextMatches) {
+        precondition(t0 == parser::Expression::Type::KeyPath && t1 != parser::Expression::Type::KeyPath,
+                     "TEXT MATCHES requires a key path on the left and a value on the right");
+        PropertyExpression expr(query, schema, object_schema, cmpr.expr[0].s, key_paths);
+        precondition(expr.prop->type == PropertyType::String,
+                     "TEXT MATCHES is only supported for string properties");
+        precondition(expr.indexes.empty(), "KeyPath queries not supported for TEXT MATCHES.");
+
+        const TextTokenIndex *index = nullptr;
+        if (text_indexes) {
+            auto it = text_indexes->find(cmpr.expr[0].s);
+            if (it != text_indexes->end()) {
+                index = it->second;
+            }
+        }
+        precondition(index != nullptr,
+                     util::format("No text index registered for key path '%1'", cmpr.expr[0].s));
+
+        std::string value = value_of_type_for_query<String>(expr.table_getter, cmpr.expr[1], args);
+        query.and_query(std::unique_ptr<realm::Expression>(new RowSetExpression(index->rows_matching(value))));
+        return;
+    }
     if (t0 == parser::Expression::Type::KeyPath && t1 != parser::Expression::Type::KeyPath) {
-        PropertyExpression expr(query, schema, object_schema, cmpr.expr[0].s);
+        PropertyExpression expr(query, schema, object_schema, cmpr.expr[0].s, key_paths);
         if (expression_is_null(cmpr.expr[1], args)) {
             do_add_null_comparison_to_query(query, cmpr, expr);
         }
@@ -539,7 +711,7 @@ void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &arg
         }
     }
     else if (t0 != parser::Expression::Type::KeyPath && t1 == parser::Expression::Type::KeyPath) {
-        PropertyExpression expr(query, schema, object_schema, cmpr.expr[1].s);
+        PropertyExpression expr(query, schema, object_schema, cmpr.expr[1].s, key_paths);
         if (expression_is_null(cmpr.expr[0], args)) {
             do_add_null_comparison_to_query(query, cmpr, expr);
         }
@@ -552,7 +724,9 @@ void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &arg
     }
 }
 
-void update_query_with_predicate(Query &query, const Predicate &pred, Arguments &arguments, const Schema &schema, const std::string &type)
+void update_query_with_predicate(Query &query, const Predicate &pred, Arguments &arguments, const Schema &schema,
+                                 const std::string &type, KeyPathCache *key_paths = nullptr,
+                                 const TextIndexMap *text_indexes = nullptr)
 {
     if (pred.negate) {
         query.Not();
@@ -562,7 +736,7 @@ void update_query_with_predicate(Query &query, const Predicate &pred, Arguments
         case Predicate::Type::And:
             query.group();
             for (auto &sub : pred.cpnd.sub_predicates) {
-                update_query_with_predicate(query, sub, arguments, schema, type);
+                update_query_with_predicate(query, sub, arguments, schema, type, key_paths, text_indexes);
             }
             if (!pred.cpnd.sub_predicates.size()) {
                 query.and_query(std::unique_ptr<realm::Expression>(new TrueExpression));
@@ -574,7 +748,7 @@ void update_query_with_predicate(Query &query, const Predicate &pred, Arguments
             query.group();
             for (auto &sub : pred.cpnd.sub_predicates) {
                 query.Or();
-                update_query_with_predicate(query, sub, arguments, schema, type);
+                update_query_with_predicate(query, sub, arguments, schema, type, key_paths, text_indexes);
             }
             if (!pred.cpnd.sub_predicates.size()) {
                 query.and_query(std::unique_ptr<realm::Expression>(new FalseExpression));
@@ -583,7 +757,7 @@ void update_query_with_predicate(Query &query, const Predicate &pred, Arguments
             break;
 
         case Predicate::Type::Comparison: {
-            add_comparison_to_query(query, pred, arguments, schema, type);
+            add_comparison_to_query(query, pred, arguments, schema, type, key_paths, text_indexes);
             break;
         }
         case Predicate::Type::True:
@@ -598,14 +772,154 @@ void update_query_with_predicate(Query &query, const Predicate &pred, Arguments
             throw std::logic_error("Invalid predicate type");
     }
 }
+
+const char *operator_description(Predicate::Operator op)
+{
+    switch (op) {
+        case Predicate::Operator::Equal: return "==";
+        case Predicate::Operator::NotEqual: return "!=";
+        case Predicate::Operator::LessThan: return "<";
+        case Predicate::Operator::LessThanOrEqual: return "<=";
+        case Predicate::Operator::GreaterThan: return ">";
+        case Predicate::Operator::GreaterThanOrEqual: return ">=";
+        case Predicate::Operator::BeginsWith: return "BEGINSWITH";
+        case Predicate::Operator::EndsWith: return "ENDSWITH";
+        case Predicate::Operator::Contains: return "CONTAINS";
+        case Predicate::Operator::TextMatches: return "TEXT MATCHES";
+        default: return "<none>";
+    }
+}
+
+std::string expression_description(const parser::Expression &expr)
+{
+    switch (expr.type) {
+        case parser::Expression::Type::Argument: return "$" + expr.s;
+        case parser::Expression::Type::String: return "'" + expr.s + "'";
+        case parser::Expression::Type::True: return "true";
+        case parser::Expression::Type::False: return "false";
+        case parser::Expression::Type::Null: return "null";
+        default: return expr.s;
+    }
+}
+
+void collect_comparisons(const Predicate &pred, std::vector<const Predicate *> &out)
+{
+    if (pred.type == Predicate::Type::Comparison) {
+        out.push_back(&pred);
+        return;
+    }
+    for (auto &sub : pred.cpnd.sub_predicates) {
+        collect_comparisons(sub, out);
+    }
+}
+
+void resolve_predicate_key_paths(const Predicate &pred, const Schema &schema, Schema::const_iterator desc,
+                                 KeyPathCache &key_paths)
+{
+    if (pred.type == Predicate::Type::Comparison) {
+        for (auto &expr : pred.cmpr.expr) {
+            if (expr.type == parser::Expression::Type::KeyPath && !key_paths.count(expr.s)) {
+                key_paths.emplace(expr.s, resolve_key_path(schema, desc, expr.s));
+            }
+        }
+        return;
+    }
+    for (auto &sub : pred.cpnd.sub_predicates) {
+        resolve_predicate_key_paths(sub, schema, desc, key_paths);
+    }
+}
 } // anonymous namespace
 
 namespace realm {
 namespace query_builder {
 
-void apply_predicate(Query &query, const Predicate &predicate, Arguments &arguments, const Schema &schema, const std::string &objectType)
+void apply_predicate(Query &query, const Predicate &predicate, Arguments &arguments, const Schema &schema,
+                     const std::string &objectType, const TextIndexMap *text_indexes)
+{
+    // A predicate frequently compares the same key path in several clauses;
+    // resolve each distinct path through the schema only once per build
+    KeyPathCache key_paths;
+    update_query_with_predicate(query, predicate, arguments, schema, objectType, &key_paths, text_indexes);
+
+    // Test the constructed query in core
+    std::string validateMessage = query.validate();
+    precondition(validateMessage.empty(), validateMessage.c_str());
+}
+
+ExplainInfo explain_query(Query query, const Predicate &predicate, Arguments &arguments,
+                          const Schema &schema, const std::string &objectType)
+{
+    auto table = query.get_table();
+    auto object_schema = schema.find(objectType);
+    precondition(object_schema != schema.end(),
+                 util::format("Object type '%1' not found in schema", objectType));
+
+    ExplainInfo info;
+    info.table_rows = table->size();
+
+    KeyPathCache key_paths;
+    std::vector<const Predicate *> comparisons;
+    collect_comparisons(predicate, comparisons);
+    for (auto pred : comparisons) {
+        const Predicate::Comparison &cmpr = pred->cmpr;
+        ClauseInfo clause;
+        clause.description = expression_description(cmpr.expr[0])
+                           + " " + operator_description(cmpr.op)
+                           + (cmpr.option == Predicate::OperatorOption::CaseInsensitive ? "[c] " : " ")
+                           + expression_description(cmpr.expr[1]);
+
+        auto t0 = cmpr.expr[0].type, t1 = cmpr.expr[1].type;
+        bool has_key_path = t0 == parser::Expression::Type::KeyPath || t1 == parser::Expression::Type::KeyPath;
+        if (has_key_path) {
+            auto &key_path = t0 == parser::Expression::Type::KeyPath ? cmpr.expr[0].s : cmpr.expr[1].s;
+            clause.key_path = key_path;
+            auto it = key_paths.find(key_path);
+            if (it == key_paths.end()) {
+                it = key_paths.emplace(key_path, resolve_key_path(schema, object_schema, key_path)).first;
+            }
+            clause.has_search_index = it->second.property->requires_index();
+            // Core only consults the index for equality comparisons, and
+            // never across a link chain
+            clause.uses_search_index = clause.has_search_index
+                                    && it->second.link_columns.empty()
+                                    && cmpr.op == Predicate::Operator::Equal
+                                    && (t0 == parser::Expression::Type::KeyPath) != (t1 == parser::Expression::Type::KeyPath);
+        }
+
+        Query clause_query = table->where();
+        update_query_with_predicate(clause_query, *pred, arguments, schema, objectType, &key_paths);
+
+        auto start = std::chrono::steady_clock::now();
+        clause.matching_rows = clause_query.count();
+        clause.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        clause.estimated_rows_scanned = clause.uses_search_index ? clause.matching_rows : info.table_rows;
+
+        info.clauses.push_back(std::move(clause));
+    }
+
+    Query full_query = table->where();
+    update_query_with_predicate(full_query, predicate, arguments, schema, objectType, &key_paths);
+    auto start = std::chrono::steady_clock::now();
+    info.matching_rows = full_query.count();
+    info.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return info;
+}
+
+PreparedQuery::PreparedQuery(std::shared_ptr<const parser::Predicate> predicate,
+                             const Schema &schema, std::string object_type)
+: m_predicate(std::move(predicate))
+, m_schema(&schema)
+, m_object_type(std::move(object_type))
+{
+    auto object_schema = schema.find(m_object_type);
+    precondition(object_schema != schema.end(),
+                 util::format("Object type '%1' not found in schema", m_object_type));
+    resolve_predicate_key_paths(*m_predicate, schema, object_schema, m_key_paths);
+}
+
+void PreparedQuery::apply(Query &query, Arguments &arguments) const
 {
-    update_query_with_predicate(query, predicate, arguments, schema, objectType);
+    update_query_with_predicate(query, *m_predicate, arguments, *m_schema, m_object_type, &m_key_paths);
 
     // Test the constructed query in core
     std::string validateMessage = query.validate();
@@ -22,15 +22,103 @@
 #include "parser.hpp"
 #include "object_accessor.hpp"
 
+#include <unordered_map>
+
 namespace realm {
 class Query;
 class Schema;
+class TextTokenIndex;
 
 namespace query_builder {
 class Arguments;
 
+// Text indexes available to TEXT MATCHES clauses, keyed by the key path of
+// the indexed string property. A TEXT MATCHES clause is evaluated against
+// the rows matching at build time, so queries must be rebuilt after the
+// index is updated.
+using TextIndexMap = std::unordered_map<std::string, const TextTokenIndex *>;
+
 void apply_predicate(Query &query, const parser::Predicate &predicate, Arguments &arguments,
-                     const Schema &schema, const std::string &objectType);
+                     const Schema &schema, const std::string &objectType,
+                     const TextIndexMap *text_indexes = nullptr);
+
+// The schema resolution of a single key path within a predicate: the property
+// it terminates at and the link columns traversed to reach it
+struct ResolvedKeyPath {
+    const Property *property = nullptr;
+    std::vector<size_t> link_columns;
+};
+
+// A parsed predicate prepared for repeated execution against a single object
+// type. Most of the cost of apply_predicate() outside of parsing is resolving
+// key paths through the schema; preparing a predicate resolves them once so
+// that each apply() just assembles the Query with the current argument
+// values. Core bakes argument values into the Query nodes, so the Query
+// itself still has to be rebuilt per execution.
+class PreparedQuery {
+  public:
+    // Resolves the predicate's key paths, throwing if any of them do not
+    // exist in the schema. Both the predicate and the schema must outlive the
+    // PreparedQuery.
+    PreparedQuery(std::shared_ptr<const parser::Predicate> predicate,
+                  const Schema &schema, std::string object_type);
+
+    // Add the prepared predicate to the given query, which must be a query on
+    // the object type the predicate was prepared against, with the given
+    // argument values.
+    void apply(Query &query, Arguments &arguments) const;
+
+    const std::string &object_type() const noexcept { return m_object_type; }
+
+  private:
+    std::shared_ptr<const parser::Predicate> m_predicate;
+    const Schema *m_schema;
+    std::string m_object_type;
+    // Fully populated at construction and only read afterwards; mutable
+    // because it shares the lazily-populated cache type used by
+    // apply_predicate() internally
+    mutable std::unordered_map<std::string, ResolvedKeyPath> m_key_paths;
+};
+
+// A report on a single comparison clause of a predicate, produced by
+// explain_query()
+struct ClauseInfo {
+    // The clause in predicate syntax, e.g. "age > $0"
+    std::string description;
+    // The key path the clause compares, if any
+    std::string key_path;
+    // Whether the property the key path terminates at has a search index
+    bool has_search_index = false;
+    // Whether core will actually use that index for this clause: equality
+    // comparisons on an unlinked indexed property
+    bool uses_search_index = false;
+    // Rows core has to visit to evaluate this clause alone: the matching rows
+    // when the index is used, the whole table otherwise
+    size_t estimated_rows_scanned = 0;
+    // Rows matching this clause alone
+    size_t matching_rows = 0;
+    // Measured time to evaluate this clause alone
+    double seconds = 0;
+};
+
+struct ExplainInfo {
+    size_t table_rows = 0;
+    // Rows matching the complete predicate, and the time taken to run it
+    size_t matching_rows = 0;
+    double seconds = 0;
+    // Per-clause reports, in the order core evaluates the clauses (the order
+    // they appear in the predicate). A clause with a large
+    // estimated_rows_scanned and a long time is the table-scan culprit.
+    std::vector<ClauseInfo> clauses;
+};
+
+// Evaluate each comparison clause of the predicate separately against the
+// query's table (typically obtained from Results::get_query()) and report
+// index usage, row counts and timings for each. This actually runs the
+// clauses, so it is a debugging facility rather than something to call on a
+// hot path.
+ExplainInfo explain_query(Query query, const parser::Predicate &predicate, Arguments &arguments,
+                          const Schema &schema, const std::string &objectType);
 
 class Arguments {
   public:
@@ -25,8 +25,14 @@
 #include "schema.hpp"
 #include "util/compiler.hpp"
 #include "util/format.hpp"
+#include "util/pool_allocator.hpp"
 
+#include <realm/link_view.hpp>
+
+#include <algorithm>
 #include <stdexcept>
+#include <unordered_set>
+#include <utility>
 
 using namespace realm;
 
@@ -52,11 +58,11 @@ Results::Results(SharedRealm r, Table& table)
 
 Results::Results(SharedRealm r, LinkViewRef lv, util::Optional<Query> q, SortDescriptor s)
 : m_realm(std::move(r))
-, m_link_view(lv)
+, m_link_view(std::move(lv))
 , m_sort(std::move(s))
 , m_mode(Mode::LinkView)
 {
-    m_table.reset(&lv->get_target_table());
+    m_table.reset(&m_link_view->get_target_table());
     if (q) {
         m_query = std::move(*q);
         m_mode = Mode::Query;
@@ -81,15 +87,22 @@ Results::Results(Results&& other)
 , m_object_schema(std::move(other.m_object_schema))
 , m_query(std::move(other.m_query))
 , m_table_view(std::move(other.m_table_view))
+, m_shared_view(std::move(other.m_shared_view))
 , m_link_view(std::move(other.m_link_view))
 , m_table(std::move(other.m_table))
 , m_sort(std::move(other.m_sort))
 , m_distinct(std::move(other.m_distinct))
+, m_sort_columns(std::move(other.m_sort_columns))
 , m_notifier(std::move(other.m_notifier))
 , m_mode(other.m_mode)
 , m_update_policy(other.m_update_policy)
+, m_limit(other.m_limit)
 , m_has_used_table_view(other.m_has_used_table_view)
 , m_wants_background_updates(other.m_wants_background_updates)
+, m_view_index_map(std::move(other.m_view_index_map))
+, m_view_index_map_version(other.m_view_index_map_version)
+, m_view_index_map_valid(other.m_view_index_map_valid)
+, m_view_confirmed_version(other.m_view_confirmed_version)
 {
     if (m_notifier) {
         m_notifier->target_results_moved(other, *this);
@@ -128,6 +141,12 @@ void Results::validate_write() const
         throw InvalidTransactionException("Must be in a write transaction");
 }
 
+void Results::validate_limit_supported(const char* operation) const
+{
+    if (m_limit != npos && (m_sort || m_distinct))
+        throw UnimplementedOperationException(util::format("Cannot %1 a sorted and limited Results", operation));
+}
+
 size_t Results::size()
 {
     validate_read();
@@ -135,16 +154,31 @@ size_t Results::size()
         case Mode::Empty:    return 0;
         case Mode::Table:    return m_table->size();
         case Mode::LinkView: return m_link_view->size();
-        case Mode::Query:
+        case Mode::Query: {
             m_query.sync_view_if_needed();
-            if (!m_distinct)
-                return m_query.count();
-            REALM_FALLTHROUGH;
+            if (m_distinct)
+                break;
+            // Counting the matches doesn't require building a view, and as
+            // with the aggregates the result is cached per transaction
+            // version since size() is typically polled (e.g. for badge
+            // counts) far more often than the data actually changes
+            util::Optional<VersionID> version;
+            if (m_realm && !m_realm->is_in_transaction())
+                version = m_realm->current_transaction_version();
+            if (version && m_cached_size && *version == m_cached_size_version)
+                return *m_cached_size;
+            size_t count = m_query.count(0, size_t(-1), m_limit);
+            if (version) {
+                m_cached_size = count;
+                m_cached_size_version = *version;
+            }
+            return count;
+        }
         case Mode::TableView:
-            update_tableview();
-            return m_table_view.size();
+            break;
     }
-    REALM_UNREACHABLE();
+    update_tableview();
+    return std::min(table_view().size(), m_limit);
 }
 
 const ObjectSchema& Results::get_object_schema() const
@@ -190,16 +224,121 @@ RowExpr Results::get(size_t row_ndx)
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            if (row_ndx >= m_table_view.size())
+            if (row_ndx >= table_view().size() || row_ndx >= m_limit)
                 break;
-            if (m_update_policy == UpdatePolicy::Never && !m_table_view.is_row_attached(row_ndx))
+            if (m_update_policy == UpdatePolicy::Never && !table_view().is_row_attached(row_ndx))
                 return {};
-            return m_table_view.get(row_ndx);
+            return table_view().get(row_ndx);
     }
 
     throw OutOfBoundsIndexException{row_ndx, size()};
 }
 
+Results::iterator::iterator(Results& results, size_t ndx)
+: m_ndx(ndx)
+{
+    results.validate_read();
+    switch (results.m_mode) {
+        case Mode::Empty:
+            break;
+        case Mode::Table:
+            m_table = results.m_table.get();
+            m_source = Source::Table;
+            break;
+        case Mode::LinkView:
+            if (results.update_linkview()) {
+                m_link_view = results.m_link_view.get();
+                m_source = Source::LinkView;
+                break;
+            }
+            REALM_FALLTHROUGH;
+        case Mode::Query:
+        case Mode::TableView:
+            results.update_tableview();
+            m_table_view = &results.table_view();
+            m_source = Source::TableView;
+            break;
+    }
+}
+
+RowExpr Results::iterator::operator*() const
+{
+    switch (m_source) {
+        case Source::None:
+            break;
+        case Source::Table:
+            return m_table->get(m_ndx);
+        case Source::LinkView:
+            return m_link_view->get(m_ndx);
+        case Source::TableView:
+            // Rows in a snapshot may have been detached since it was taken
+            if (!m_table_view->is_row_attached(m_ndx))
+                return {};
+            return m_table_view->get(m_ndx);
+    }
+    return {};
+}
+
+Results::iterator Results::begin()
+{
+    return iterator(*this, 0);
+}
+
+Results::iterator Results::end()
+{
+    // size() resolves the same view as the iterator and applies the limit,
+    // so every index below it is valid to dereference
+    return iterator(*this, size());
+}
+
+std::vector<RowExpr> Results::get_range(size_t begin, size_t end)
+{
+    validate_read();
+
+    std::vector<RowExpr> rows;
+    if (begin >= end)
+        return rows;
+    rows.reserve(end - begin);
+
+    switch (m_mode) {
+        case Mode::Empty:
+            break;
+        case Mode::Table:
+            if (end <= m_table->size()) {
+                for (size_t i = begin; i < end; ++i)
+                    rows.push_back(m_table->get(i));
+                return rows;
+            }
+            break;
+        case Mode::LinkView:
+            if (update_linkview()) {
+                if (end <= m_link_view->size()) {
+                    for (size_t i = begin; i < end; ++i)
+                        rows.push_back(m_link_view->get(i));
+                    return rows;
+                }
+                break;
+            }
+            REALM_FALLTHROUGH;
+        case Mode::Query:
+        case Mode::TableView: {
+            update_tableview();
+            auto& tv = table_view();
+            if (end > std::min(tv.size(), m_limit))
+                break;
+            for (size_t i = begin; i < end; ++i) {
+                if (m_update_policy == UpdatePolicy::Never && !tv.is_row_attached(i))
+                    rows.push_back(RowExpr());
+                else
+                    rows.push_back(tv.get(i));
+            }
+            return rows;
+        }
+    }
+
+    throw OutOfBoundsIndexException{end - 1, size()};
+}
+
 util::Optional<RowExpr> Results::first()
 {
     validate_read();
@@ -213,13 +352,24 @@ util::Optional<RowExpr> Results::first()
                 return m_link_view->size() == 0 ? util::none : util::make_optional(m_link_view->get(0));
             REALM_FALLTHROUGH;
         case Mode::Query:
+            // Finding the first match does not require the full set of
+            // matches unless a sort or distinct needs to examine them all,
+            // or the query's own result order differs from table order
+            if (!m_sort && !m_distinct && m_query.produces_results_in_table_order()) {
+                if (m_limit == 0)
+                    return util::none;
+                m_query.sync_view_if_needed();
+                size_t row = m_query.find();
+                return row == not_found ? util::none : util::make_optional(m_table->get(row));
+            }
+            REALM_FALLTHROUGH;
         case Mode::TableView:
             update_tableview();
-            if (m_table_view.size() == 0)
+            if (table_view().size() == 0 || m_limit == 0)
                 return util::none;
-            else if (m_update_policy == UpdatePolicy::Never && !m_table_view.is_row_attached(0))
+            else if (m_update_policy == UpdatePolicy::Never && !table_view().is_row_attached(0))
                 return RowExpr();
-            return m_table_view.front();
+            return table_view().front();
     }
     REALM_UNREACHABLE();
 }
@@ -237,14 +387,42 @@ util::Optional<RowExpr> Results::last()
                 return m_link_view->size() == 0 ? util::none : util::make_optional(m_link_view->get(m_link_view->size() - 1));
             REALM_FALLTHROUGH;
         case Mode::Query:
-        case Mode::TableView:
+            // Emulate the reverse find which core lacks by running the query
+            // forwards over chunks taken from the back of the table, so that
+            // only the tail behind the last match is scanned rather than
+            // every match materialized. A limited Results still needs the
+            // full count to know which row is last within the window, and a
+            // sort or distinct needs every match.
+            if (!m_sort && !m_distinct && m_limit == npos && m_query.produces_results_in_table_order()) {
+                m_query.sync_view_if_needed();
+                constexpr size_t chunk_size = 1024;
+                size_t end = m_table->size();
+                while (end > 0) {
+                    size_t begin = end < chunk_size ? 0 : end - chunk_size;
+                    // Matches at or past `end` were ruled out by the
+                    // previous iterations, so the checks against it are
+                    // just belt and braces
+                    size_t row = m_query.find(begin);
+                    if (row != not_found && row < end) {
+                        size_t last = row;
+                        while ((row = m_query.find(last + 1)) != not_found && row < end)
+                            last = row;
+                        return util::make_optional(m_table->get(last));
+                    }
+                    end = begin;
+                }
+                return util::none;
+            }
+            REALM_FALLTHROUGH;
+        case Mode::TableView: {
             update_tableview();
-            auto s = m_table_view.size();
+            auto s = std::min(table_view().size(), m_limit);
             if (s == 0)
                 return util::none;
-            else if (m_update_policy == UpdatePolicy::Never && !m_table_view.is_row_attached(s - 1))
+            else if (m_update_policy == UpdatePolicy::Never && !table_view().is_row_attached(s - 1))
                 return RowExpr();
-            return m_table_view.back();
+            return table_view().get(s - 1);
+        }
     }
     REALM_UNREACHABLE();
 }
@@ -262,6 +440,72 @@ bool Results::update_linkview()
     return true;
 }
 
+void Results::read_ahead(TableView& view) const
+{
+    auto& config = m_realm->config();
+    if (config.encryption_key.empty() || config.encryption_read_ahead_rows == 0)
+        return;
+
+    // Encrypted files are decrypted one page at a time on first access, and
+    // running the query only touched the pages holding the searched columns.
+    // Reading one value per column pulls in the leaves which the accessors
+    // are about to fault one value at a time, while the B+-tree metadata
+    // needed to find them is still in the decrypted page cache.
+    auto& table = *m_table;
+    size_t row_count = std::min(view.size(), config.encryption_read_ahead_rows);
+    size_t column_count = table.get_column_count();
+    for (size_t i = 0; i < row_count; ++i) {
+        size_t row = view.get_source_ndx(i);
+        for (size_t col = 0; col < column_count; ++col) {
+            switch (table.get_column_type(col)) {
+                case type_Int:
+                    if (!table.is_nullable(col) || !table.is_null(col, row))
+                        table.get_int(col, row);
+                    break;
+                case type_Bool:
+                    if (!table.is_nullable(col) || !table.is_null(col, row))
+                        table.get_bool(col, row);
+                    break;
+                case type_Float:
+                    if (!table.is_nullable(col) || !table.is_null(col, row))
+                        table.get_float(col, row);
+                    break;
+                case type_Double:
+                    if (!table.is_nullable(col) || !table.is_null(col, row))
+                        table.get_double(col, row);
+                    break;
+                case type_OldDateTime:
+                    if (!table.is_nullable(col) || !table.is_null(col, row))
+                        table.get_olddatetime(col, row);
+                    break;
+                case type_String:
+                    table.get_string(col, row);
+                    break;
+                case type_Binary:
+                    table.get_binary(col, row);
+                    break;
+                case type_Timestamp:
+                    table.get_timestamp(col, row);
+                    break;
+                case type_Link:
+                    // Reads the same leaf entry as get_link() would, without
+                    // needing a null check first
+                    table.is_null(col, row);
+                    break;
+                case type_LinkList:
+                    table.get_link_count(col, row);
+                    break;
+                case type_Table:
+                    table.get_subtable_size(col, row);
+                    break;
+                case type_Mixed:
+                    table.get_mixed(col, row);
+                    break;
+            }
+        }
+    }
+}
+
 void Results::update_tableview(bool wants_notifications)
 {
     if (m_update_policy == UpdatePolicy::Never) {
@@ -276,24 +520,89 @@ void Results::update_tableview(bool wants_notifications)
             return;
         case Mode::Query:
             m_query.sync_view_if_needed();
-            m_table_view = m_query.find_all();
+            // When there is no sort or distinct the limit can be pushed down
+            // into the query, which can then stop running once it has found
+            // the first m_limit matching rows. A sorted limit has to examine
+            // every matching row, so it is instead applied by the accessors.
+            if (m_limit != npos && !m_sort && !m_distinct)
+                m_table_view = m_query.find_all(0, size_t(-1), m_limit);
+            else
+                m_table_view = m_query.find_all();
             if (m_sort) {
                 m_table_view.sort(m_sort);
             }
             if (m_distinct) {
                 m_table_view.distinct(m_distinct);
             }
+            read_ahead(m_table_view);
             m_mode = Mode::TableView;
+            m_view_index_map_valid = false;
             REALM_FALLTHROUGH;
-        case Mode::TableView:
+        case Mode::TableView: {
             if (wants_notifications && !m_notifier && !m_realm->is_in_transaction() && m_realm->can_deliver_notifications()) {
-                m_notifier = std::make_shared<_impl::ResultsNotifier>(*this);
+                m_notifier = util::make_pooled_shared<_impl::ResultsNotifier>(*this);
                 _impl::RealmCoordinator::register_notifier(m_notifier);
             }
             m_has_used_table_view = true;
-            m_table_view.sync_if_needed();
+            // Syncing would change the view out from under any snapshots
+            // sharing it, so take a private copy first
+            if (m_shared_view && !m_shared_view->is_in_sync())
+                unshare_view();
+            // Syncing against uncommitted changes produces a view which
+            // does not survive a rollback, so any confirmation from the
+            // notifier stops applying once that has happened
+            if (m_realm->is_in_transaction())
+                m_view_confirmed_version = util::none;
+            else if (m_view_confirmed_version) {
+                // The notifier has confirmed that the view's contents are
+                // already correct for this version, so syncing (which would
+                // rerun the query here) is unnecessary
+                auto current_version = m_realm->current_transaction_version();
+                if (current_version && *current_version == *m_view_confirmed_version)
+                    break;
+            }
+            auto version = table_view().sync_if_needed();
+            if (version != m_view_index_map_version) {
+                m_view_index_map_valid = false;
+                m_view_index_map_version = version;
+            }
             break;
+        }
+    }
+}
+
+void Results::unshare_view() const
+{
+    if (!m_shared_view)
+        return;
+    // If all of the snapshots sharing the view are gone it can simply be
+    // taken back, and otherwise it is left to them and copied
+    if (m_shared_view.use_count() == 1)
+        m_table_view = std::move(*m_shared_view);
+    else
+        m_table_view = *m_shared_view;
+    m_shared_view = nullptr;
+}
+
+void Results::patch_view_index_map(IndexSet const& deletions, IndexSet const& insertions)
+{
+    if (!m_view_index_map_valid)
+        return;
+
+    // Remove deleted rows and shift the remaining entries to their new
+    // positions. Moves are included in both deletions and insertions, so
+    // they do not need separate handling.
+    for (auto it = m_view_index_map.begin(); it != m_view_index_map.end();) {
+        if (deletions.contains(it->second)) {
+            it = m_view_index_map.erase(it);
+            continue;
+        }
+        it->second = insertions.shift(deletions.unshift(it->second));
+        ++it;
     }
+
+    for (auto ndx : insertions.as_indexes())
+        m_view_index_map[table_view().get_source_ndx(ndx)] = ndx;
 }
 
 size_t Results::index_of(Row const& row)
@@ -327,11 +636,50 @@ size_t Results::index_of(size_t row_ndx)
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            return m_table_view.find_by_source_ndx(row_ndx);
+            // Limited Results are capped at sizes where a linear scan is
+            // cheap, and the map would not line up with the visible window
+            if (m_limit != npos) {
+                auto ndx = table_view().find_by_source_ndx(row_ndx);
+                return ndx < m_limit ? ndx : not_found;
+            }
+            if (!m_view_index_map_valid) {
+                m_view_index_map.clear();
+                size_t count = table_view().size();
+                m_view_index_map.reserve(count);
+                for (size_t i = 0; i < count; ++i)
+                    m_view_index_map[table_view().get_source_ndx(i)] = i;
+                m_view_index_map_valid = true;
+            }
+            auto it = m_view_index_map.find(row_ndx);
+            return it == m_view_index_map.end() ? not_found : it->second;
     }
     REALM_UNREACHABLE();
 }
 
+namespace {
+// The maximum/minimum methods on Query bury the return-index out-param
+// behind a different set of defaulted arguments than the ones on Table and
+// TableView, so paper over the difference
+template<typename T>
+auto do_maximum_int(T& t, size_t column, size_t* return_ndx) { return t.maximum_int(column, return_ndx); }
+auto do_maximum_int(Query& q, size_t column, size_t* return_ndx) { return q.maximum_int(column, nullptr, 0, size_t(-1), size_t(-1), return_ndx); }
+template<typename T>
+auto do_minimum_int(T& t, size_t column, size_t* return_ndx) { return t.minimum_int(column, return_ndx); }
+auto do_minimum_int(Query& q, size_t column, size_t* return_ndx) { return q.minimum_int(column, nullptr, 0, size_t(-1), size_t(-1), return_ndx); }
+template<typename T>
+auto do_maximum_float(T& t, size_t column, size_t* return_ndx) { return t.maximum_float(column, return_ndx); }
+auto do_maximum_float(Query& q, size_t column, size_t* return_ndx) { return q.maximum_float(column, nullptr, 0, size_t(-1), size_t(-1), return_ndx); }
+template<typename T>
+auto do_minimum_float(T& t, size_t column, size_t* return_ndx) { return t.minimum_float(column, return_ndx); }
+auto do_minimum_float(Query& q, size_t column, size_t* return_ndx) { return q.minimum_float(column, nullptr, 0, size_t(-1), size_t(-1), return_ndx); }
+template<typename T>
+auto do_maximum_double(T& t, size_t column, size_t* return_ndx) { return t.maximum_double(column, return_ndx); }
+auto do_maximum_double(Query& q, size_t column, size_t* return_ndx) { return q.maximum_double(column, nullptr, 0, size_t(-1), size_t(-1), return_ndx); }
+template<typename T>
+auto do_minimum_double(T& t, size_t column, size_t* return_ndx) { return t.minimum_double(column, return_ndx); }
+auto do_minimum_double(Query& q, size_t column, size_t* return_ndx) { return q.minimum_double(column, nullptr, 0, size_t(-1), size_t(-1), return_ndx); }
+} // anonymous namespace
+
 template<typename Int, typename Float, typename Double, typename Timestamp>
 util::Optional<Mixed> Results::aggregate(size_t column,
                                          const char* name,
@@ -339,6 +687,7 @@ util::Optional<Mixed> Results::aggregate(size_t column,
                                          Double agg_double, Timestamp agg_timestamp)
 {
     validate_read();
+    validate_limit_supported("aggregate");
     if (!m_table)
         return none;
     if (column > m_table->get_column_count())
@@ -355,9 +704,16 @@ util::Optional<Mixed> Results::aggregate(size_t column,
                 m_mode = Mode::Query;
                 REALM_FALLTHROUGH;
             case Mode::Query:
+                // Aggregating over the query itself traverses the column
+                // data for the matching rows directly, without materializing
+                // a TableView and dereferencing each row through it. Distinct
+                // and limit are applied to the view, so those still need one.
+                if (!m_distinct && m_limit == npos)
+                    return util::Optional<Mixed>(getter(m_query));
+                REALM_FALLTHROUGH;
             case Mode::TableView:
                 this->update_tableview();
-                return util::Optional<Mixed>(getter(m_table_view));
+                return util::Optional<Mixed>(getter(table_view()));
         }
 
         REALM_UNREACHABLE();
@@ -374,51 +730,229 @@ util::Optional<Mixed> Results::aggregate(size_t column,
     }
 }
 
+template<typename Fn>
+util::Optional<Mixed> Results::use_aggregate_cache(size_t column, AggregateFunc func, Fn&& compute)
+{
+    // Within a write transaction the data can change without the version
+    // changing, so skip the cache entirely
+    if (!m_realm || m_realm->is_in_transaction())
+        return compute();
+    auto version = m_realm->current_transaction_version();
+    if (!version)
+        return compute();
+
+    if (!(*version == m_aggregate_cache_version)) {
+        m_aggregate_cache.clear();
+        m_aggregate_cache_version = *version;
+    }
+
+    size_t key = column * 4 + static_cast<size_t>(func);
+    auto it = m_aggregate_cache.find(key);
+    if (it != m_aggregate_cache.end())
+        return it->second;
+
+    auto value = compute();
+    m_aggregate_cache[key] = value;
+    return value;
+}
+
 util::Optional<Mixed> Results::max(size_t column)
 {
-    size_t return_ndx = npos;
-    auto results = aggregate(column, "max",
-                             [&](auto const& table) { return table.maximum_int(column, &return_ndx); },
-                             [&](auto const& table) { return table.maximum_float(column, &return_ndx); },
-                             [&](auto const& table) { return table.maximum_double(column, &return_ndx); },
-                             [&](auto const& table) { return table.maximum_timestamp(column, &return_ndx); });
-    return return_ndx == npos ? none : results;
+    return use_aggregate_cache(column, AggregateFunc::Max, [&]() -> util::Optional<Mixed> {
+        size_t return_ndx = npos;
+        auto results = aggregate(column, "max",
+                                 [&](auto& table) { return do_maximum_int(table, column, &return_ndx); },
+                                 [&](auto& table) { return do_maximum_float(table, column, &return_ndx); },
+                                 [&](auto& table) { return do_maximum_double(table, column, &return_ndx); },
+                                 [&](auto& table) { return table.maximum_timestamp(column, &return_ndx); });
+        return return_ndx == npos ? none : results;
+    });
 }
 
 util::Optional<Mixed> Results::min(size_t column)
 {
-    size_t return_ndx = npos;
-    auto results = aggregate(column, "min",
-                             [&](auto const& table) { return table.minimum_int(column, &return_ndx); },
-                             [&](auto const& table) { return table.minimum_float(column, &return_ndx); },
-                             [&](auto const& table) { return table.minimum_double(column, &return_ndx); },
-                             [&](auto const& table) { return table.minimum_timestamp(column, &return_ndx); });
-    return return_ndx == npos ? none : results;
+    return use_aggregate_cache(column, AggregateFunc::Min, [&]() -> util::Optional<Mixed> {
+        size_t return_ndx = npos;
+        auto results = aggregate(column, "min",
+                                 [&](auto& table) { return do_minimum_int(table, column, &return_ndx); },
+                                 [&](auto& table) { return do_minimum_float(table, column, &return_ndx); },
+                                 [&](auto& table) { return do_minimum_double(table, column, &return_ndx); },
+                                 [&](auto& table) { return table.minimum_timestamp(column, &return_ndx); });
+        return return_ndx == npos ? none : results;
+    });
 }
 
 util::Optional<Mixed> Results::sum(size_t column)
 {
-    return aggregate(column, "sum",
-                     [=](auto const& table) { return table.sum_int(column); },
-                     [=](auto const& table) { return table.sum_float(column); },
-                     [=](auto const& table) { return table.sum_double(column); },
-                     [=](auto const&) -> util::None { throw UnsupportedColumnTypeException{column, m_table.get(), "sum"}; });
+    return use_aggregate_cache(column, AggregateFunc::Sum, [&] {
+        return aggregate(column, "sum",
+                         [=](auto& table) { return table.sum_int(column); },
+                         [=](auto& table) { return table.sum_float(column); },
+                         [=](auto& table) { return table.sum_double(column); },
+                         [=](auto&) -> util::None { throw UnsupportedColumnTypeException{column, m_table.get(), "sum"}; });
+    });
 }
 
 util::Optional<Mixed> Results::average(size_t column)
 {
-    // Initial value to make gcc happy
-    size_t value_count = 0;
-    auto results = aggregate(column, "average",
-                             [&](auto const& table) { return table.average_int(column, &value_count); },
-                             [&](auto const& table) { return table.average_float(column, &value_count); },
-                             [&](auto const& table) { return table.average_double(column, &value_count); },
-                             [&](auto const&) -> util::None { throw UnsupportedColumnTypeException{column, m_table.get(), "average"}; });
-    return value_count == 0 ? none : results;
+    return use_aggregate_cache(column, AggregateFunc::Avg, [&]() -> util::Optional<Mixed> {
+        // Initial value to make gcc happy
+        size_t value_count = 0;
+        auto results = aggregate(column, "average",
+                                 [&](auto& table) { return table.average_int(column, &value_count); },
+                                 [&](auto& table) { return table.average_float(column, &value_count); },
+                                 [&](auto& table) { return table.average_double(column, &value_count); },
+                                 [&](auto&) -> util::None { throw UnsupportedColumnTypeException{column, m_table.get(), "average"}; });
+        return value_count == 0 ? none : results;
+    });
+}
+
+namespace {
+struct DistinctStringHash {
+    size_t operator()(StringData value) const noexcept
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < value.size(); ++i)
+            hash = (hash ^ static_cast<unsigned char>(value[i])) * 1099511628211ULL;
+        return size_t(hash);
+    }
+};
+
+struct DistinctTimestampHash {
+    size_t operator()(Timestamp value) const noexcept
+    {
+        return size_t(value.get_seconds()) ^ (size_t(value.get_nanoseconds()) << 1);
+    }
+};
+
+// Tracks which values have been seen already, appending each new one to the
+// output in the order they were first encountered
+template<typename T, typename Hash = std::hash<T>>
+struct DistinctCollector {
+    std::unordered_set<T, Hash> seen;
+    std::vector<Mixed>& values;
+
+    void operator()(T value)
+    {
+        if (seen.insert(value).second)
+            values.push_back(Mixed(value));
+    }
+};
+} // anonymous namespace
+
+std::vector<Mixed> Results::distinct_values(size_t column)
+{
+    validate_read();
+    if (!m_table)
+        return {};
+    if (column >= m_table->get_column_count())
+        throw OutOfBoundsIndexException{column, m_table->get_column_count()};
+
+    auto for_each = [&](auto&& func) {
+        switch (m_mode) {
+            case Mode::Empty:
+                return;
+            case Mode::Table: {
+                // With a search index each distinct value can be produced
+                // directly from the index rather than by scanning the column
+                if (m_table->has_search_index(column)) {
+                    auto view = m_table->get_distinct_view(column);
+                    size_t count = view.size();
+                    for (size_t i = 0; i < count; ++i)
+                        func(view.get_source_ndx(i));
+                    return;
+                }
+                size_t count = m_table->size();
+                for (size_t i = 0; i < count; ++i)
+                    func(i);
+                return;
+            }
+            case Mode::LinkView:
+                if (update_linkview()) {
+                    size_t count = m_link_view->size();
+                    for (size_t i = 0; i < count; ++i)
+                        func(m_link_view->get(i).get_index());
+                    return;
+                }
+                REALM_FALLTHROUGH;
+            case Mode::Query:
+                // Distinct and limit are applied to the view, so they still
+                // need one; a plain (possibly sorted) query can stream its
+                // matches directly since the set of values is unaffected by
+                // the order the rows are visited in
+                if (m_update_policy == UpdatePolicy::Auto && !m_distinct && m_limit == npos) {
+                    m_query.sync_view_if_needed();
+                    for (size_t row = m_query.find(); row != not_found; row = m_query.find(row + 1))
+                        func(row);
+                    return;
+                }
+                REALM_FALLTHROUGH;
+            case Mode::TableView: {
+                update_tableview();
+                auto& view = table_view();
+                size_t count = view.size();
+                for (size_t i = 0; i < count; ++i) {
+                    if (view.is_row_attached(i))
+                        func(view.get_source_ndx(i));
+                }
+                return;
+            }
+        }
+    };
+
+    std::vector<Mixed> values;
+    bool check_null = m_table->is_nullable(column);
+    auto collect = [&](auto& collector, auto&& getter) {
+        for_each([&](size_t row) {
+            if (check_null && m_table->is_null(column, row))
+                return;
+            collector(getter(row));
+        });
+    };
+
+    switch (m_table->get_column_type(column)) {
+        case type_Int: {
+            DistinctCollector<int64_t> collector{{}, values};
+            collect(collector, [&](size_t row) { return m_table->get_int(column, row); });
+            break;
+        }
+        case type_Bool: {
+            DistinctCollector<bool> collector{{}, values};
+            collect(collector, [&](size_t row) { return m_table->get_bool(column, row); });
+            break;
+        }
+        case type_Float: {
+            DistinctCollector<float> collector{{}, values};
+            collect(collector, [&](size_t row) { return m_table->get_float(column, row); });
+            break;
+        }
+        case type_Double: {
+            DistinctCollector<double> collector{{}, values};
+            collect(collector, [&](size_t row) { return m_table->get_double(column, row); });
+            break;
+        }
+        case type_String: {
+            DistinctCollector<StringData, DistinctStringHash> collector{{}, values};
+            collect(collector, [&](size_t row) { return m_table->get_string(column, row); });
+            break;
+        }
+        case type_Timestamp: {
+            DistinctCollector<Timestamp, DistinctTimestampHash> collector{{}, values};
+            collect(collector, [&](size_t row) { return m_table->get_timestamp(column, row); });
+            break;
+        }
+        default:
+            throw UnsupportedColumnTypeException{column, m_table.get(), "distinct_values"};
+    }
+    return values;
 }
 
 void Results::clear()
 {
+    // Clearing a limited Results would only delete the rows in the window,
+    // after which the query would refill it from the remaining matches
+    if (m_limit != npos)
+        throw UnimplementedOperationException("Cannot clear a limited Results");
     switch (m_mode) {
         case Mode::Empty:
             return;
@@ -435,11 +969,24 @@ void Results::clear()
 
             switch (m_update_policy) {
                 case UpdatePolicy::Auto:
+                    // If the view covers every row in the table, clearing the
+                    // table instead emits a single clear instruction rather
+                    // than one move_last_over per row, which the change
+                    // checkers can also handle in O(1). The rows backing any
+                    // snapshots sharing the view are deleted either way, so
+                    // there's no need to unshare first.
+                    if (m_table_view.size() == m_table->size()) {
+                        m_table->clear();
+                        break;
+                    }
+                    // Clearing the view would empty it out from under any
+                    // snapshots sharing it
+                    unshare_view();
                     m_table_view.clear(RemoveMode::unordered);
                     break;
                 case UpdatePolicy::Never: {
                     // Copy the TableView because a frozen Results shouldn't let its size() change.
-                    TableView copy(m_table_view);
+                    TableView copy(table_view());
                     copy.clear(RemoveMode::unordered);
                     break;
                 }
@@ -462,7 +1009,7 @@ Query Results::get_query() const
         case Mode::TableView: {
             // A TableView has an associated Query if it was produced by Query::find_all. This is indicated
             // by TableView::get_query returning a Query with a non-null table.
-            Query query = m_table_view.get_query();
+            Query query = table_view().get_query();
             if (query.get_table()) {
                 return query;
             }
@@ -470,9 +1017,11 @@ Query Results::get_query() const
             // The TableView has no associated query so create one with no conditions that is restricted
             // to the rows in the TableView.
             if (m_update_policy == UpdatePolicy::Auto) {
-                m_table_view.sync_if_needed();
+                if (m_shared_view && !m_shared_view->is_in_sync())
+                    unshare_view();
+                table_view().sync_if_needed();
             }
-            return Query(*m_table, std::unique_ptr<TableViewBase>(new TableView(m_table_view)));
+            return Query(*m_table, std::unique_ptr<TableViewBase>(new TableView(table_view())));
         }
         case Mode::LinkView:
             return m_table->where(m_link_view);
@@ -485,6 +1034,7 @@ Query Results::get_query() const
 TableView Results::get_tableview()
 {
     validate_read();
+    validate_limit_supported("get a TableView for");
     switch (m_mode) {
         case Mode::Empty:
             return {};
@@ -495,21 +1045,81 @@ TableView Results::get_tableview()
         case Mode::Query:
         case Mode::TableView:
             update_tableview();
-            return m_table_view;
+            return table_view();
         case Mode::Table:
             return m_table->where().find_all();
     }
     REALM_UNREACHABLE();
 }
 
+const TableView* Results::evaluated_table_view() const noexcept
+{
+    // Limited Results materialize a truncated view which would not round-trip
+    // through a query, and snapshots deliberately hold stale views
+    if (m_mode != Mode::TableView || m_update_policy != UpdatePolicy::Auto || m_limit != npos)
+        return nullptr;
+    auto& view = table_view();
+    if (!view.is_attached() || !view.is_in_sync())
+        return nullptr;
+    return &view;
+}
+
 Results Results::sort(realm::SortDescriptor&& sort) const
 {
+    if (m_limit != npos)
+        throw UnimplementedOperationException("Cannot sort a limited Results; limit() must be applied last");
     return Results(m_realm, get_query(), std::move(sort), m_distinct);
 }
 
+Results Results::sort(std::vector<std::pair<std::string, bool>> const& keypaths) const
+{
+    if (m_limit != npos)
+        throw UnimplementedOperationException("Cannot sort a limited Results; limit() must be applied last");
+    auto& object_schema = get_object_schema();
+    std::vector<std::vector<size_t>> columns;
+    std::vector<bool> ascending;
+    std::vector<size_t> sort_columns;
+    columns.reserve(keypaths.size());
+    ascending.reserve(keypaths.size());
+    sort_columns.reserve(keypaths.size());
+    for (auto& keypath : keypaths) {
+        auto prop = object_schema.property_for_name(keypath.first);
+        if (!prop)
+            throw std::invalid_argument(util::format("Cannot sort on property '%1.%2': property does not exist",
+                                                     object_schema.name, keypath.first));
+        if (object_schema.property_is_computed(*prop))
+            throw std::invalid_argument(util::format("Cannot sort on property '%1.%2': it is computed and has no column",
+                                                     object_schema.name, keypath.first));
+        columns.push_back({prop->table_column});
+        ascending.push_back(keypath.second);
+        sort_columns.push_back(prop->table_column);
+    }
+    auto query = get_query();
+    SortDescriptor sort(*query.get_table(), std::move(columns), std::move(ascending));
+    Results ret(m_realm, std::move(query), std::move(sort), m_distinct);
+    ret.m_sort_columns = std::move(sort_columns);
+    return ret;
+}
+
 Results Results::filter(Query&& q) const
 {
-    return Results(m_realm, get_query().and_query(std::move(q)), m_sort, m_distinct);
+    if (m_limit != npos)
+        throw UnimplementedOperationException("Cannot filter a limited Results; limit() must be applied last");
+    // and_query() returns a reference to its receiver, so combine into a
+    // local and move that rather than deep-copying the combined query
+    auto query = get_query();
+    query.and_query(std::move(q));
+    return Results(m_realm, std::move(query), m_sort, m_distinct);
+}
+
+Results Results::limit(size_t max_count) const
+{
+    validate_read();
+    if (m_mode == Mode::Empty)
+        return *this;
+    Results ret(m_realm, get_query(), m_sort, m_distinct);
+    ret.m_limit = std::min(max_count, m_limit);
+    return ret;
 }
 
 
@@ -519,15 +1129,28 @@ Results Results::filter(Query&& q) const
 // - https://github.com/realm/realm-core/issues/2332
 Results Results::distinct(realm::SortDescriptor&& uniqueness)
 {
-    auto tv = get_tableview();
-    tv.distinct(uniqueness);
-    return Results(m_realm, std::move(tv), m_sort, std::move(uniqueness));
+    if (m_limit != npos)
+        throw UnimplementedOperationException("Cannot make a limited Results distinct; limit() must be applied last");
+    // As with filter() and sort(), the distinct condition is just recorded
+    // here and applied by update_tableview() when a view is first needed, so
+    // chains of filter/sort/distinct do no table work until they are read from
+    return Results(m_realm, get_query(), m_sort, std::move(uniqueness));
 }
 
 Results Results::snapshot() const &
 {
     validate_read();
 
+    // Rather than copying the view up front, move it into shared storage so
+    // that the snapshot and the live Results share the row buffer. The live
+    // side materializes a private copy only when it next needs to change the
+    // view (and then only if a snapshot is still alive), so taking a snapshot
+    // and iterating over it doesn't copy anything at all.
+    if (m_mode == Mode::Query || m_mode == Mode::TableView) {
+        const_cast<Results*>(this)->update_tableview(false);
+        if (!m_shared_view)
+            m_shared_view = std::make_shared<TableView>(std::move(m_table_view));
+    }
     return Results(*this).snapshot();
 }
 
@@ -571,7 +1194,7 @@ void Results::prepare_async()
     }
 
     m_wants_background_updates = true;
-    m_notifier = std::make_shared<_impl::ResultsNotifier>(*this);
+    m_notifier = util::make_pooled_shared<_impl::ResultsNotifier>(*this);
     _impl::RealmCoordinator::register_notifier(m_notifier);
 }
 
@@ -582,10 +1205,48 @@ NotificationToken Results::async(std::function<void (std::exception_ptr)> target
     return {m_notifier, m_notifier->add_callback(wrap)};
 }
 
-NotificationToken Results::add_notification_callback(CollectionChangeCallback cb) &
+NotificationToken Results::add_notification_callback(CollectionChangeCallback cb,
+                                                     std::chrono::milliseconds minimum_interval,
+                                                     util::Optional<std::vector<size_t>> observed_columns) &
 {
     prepare_async();
-    return {m_notifier, m_notifier->add_callback(std::move(cb))};
+    return {m_notifier, m_notifier->add_callback(std::move(cb), minimum_interval,
+                                                 std::move(observed_columns))};
+}
+
+size_t Results::add_derived_property(std::vector<size_t> columns,
+                                     _impl::CollectionNotifier::DerivedFunction compute)
+{
+    prepare_async();
+    return m_notifier->add_derived_property(std::move(columns), std::move(compute));
+}
+
+void Results::remove_derived_property(size_t token)
+{
+    REALM_ASSERT(m_notifier);
+    m_notifier->remove_derived_property(token);
+}
+
+util::Any Results::get_derived_value(size_t token, size_t row_ndx)
+{
+    REALM_ASSERT(m_notifier);
+    return m_notifier->get_derived_value(token, *m_table, get(row_ndx).get_index());
+}
+
+NotificationToken Results::evaluate_async(std::function<void (std::exception_ptr)> target)
+{
+    prepare_async();
+    // The notifier hands the TableView over to this Results before invoking
+    // callbacks, so by the time `target` runs the view is installed and
+    // accessors will not rerun the query. The callback registration outlives
+    // the first call, so later deliveries have to be filtered out here.
+    auto delivered = std::make_shared<bool>(false);
+    auto wrap = [target, delivered](CollectionChangeSet, std::exception_ptr e) {
+        if (std::exchange(*delivered, true))
+            return;
+        target(e);
+    };
+    return {m_notifier, m_notifier->add_callback(std::move(wrap))};
 }
 
 bool Results::is_in_table_order() const
@@ -599,12 +1260,13 @@ bool Results::is_in_table_order() const
         case Mode::Query:
             return m_query.produces_results_in_table_order() && !m_sort;
         case Mode::TableView:
-            return m_table_view.is_in_table_order();
+            return table_view().is_in_table_order();
     }
     REALM_UNREACHABLE(); // keep gcc happy
 }
 
-void Results::Internal::set_table_view(Results& results, realm::TableView &&tv)
+void Results::Internal::set_table_view(Results& results, realm::TableView &&tv,
+                                       CollectionChangeSet const& changes)
 {
     REALM_ASSERT(results.m_update_policy != UpdatePolicy::Never);
     // If the previous TableView was never actually used, then stop generating
@@ -613,11 +1275,24 @@ void Results::Internal::set_table_view(Results& results, realm::TableView &&tv)
         results.m_wants_background_updates = results.m_has_used_table_view;
     }
 
+    // The old view is left to any snapshots sharing it
+    results.m_shared_view = nullptr;
     results.m_table_view = std::move(tv);
     results.m_mode = Mode::TableView;
     results.m_has_used_table_view = false;
     REALM_ASSERT(results.m_table_view.is_in_sync());
     REALM_ASSERT(results.m_table_view.is_attached());
+
+    // The delivered view is exactly the old view with `changes` applied, so
+    // the row index map can be patched rather than rebuilt from scratch
+    results.patch_view_index_map(changes.deletions, changes.insertions);
+    results.m_view_index_map_version = results.m_table_view.sync_if_needed();
+}
+
+void Results::Internal::confirm_view_version(Results& results, VersionID version)
+{
+    if (results.m_mode == Mode::TableView)
+        results.m_view_confirmed_version = version;
 }
 
 Results::OutOfBoundsIndexException::OutOfBoundsIndexException(size_t r, size_t c)
@@ -23,8 +23,16 @@
 #include "shared_realm.hpp"
 #include "impl/collection_notifier.hpp"
 
+#include <realm/mixed.hpp>
 #include <realm/table_view.hpp>
 #include <realm/util/optional.hpp>
+#include <realm/version_id.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace realm {
 template<typename T> class BasicRowExpr;
@@ -73,6 +81,13 @@ public:
     // Get a tableview containing the same rows as this Results
     TableView get_tableview();
 
+    // Get the already-materialized TableView if there is one which is in
+    // sync with the current version, without evaluating the query. Returns
+    // null when nothing usable has been materialized, in which case the
+    // query must be used instead. Used to hand evaluated results over to
+    // another thread rather than rerunning the query there.
+    const TableView* evaluated_table_view() const noexcept;
+
     // Get the object type which will be returned by get()
     StringData get_object_type() const noexcept;
 
@@ -87,6 +102,22 @@ public:
     // Throws OutOfBoundsIndexException if index >= size()
     RowExpr get(size_t index);
 
+    // Get row accessors for all of the rows in [begin, end), paying the cost
+    // of validating the Realm and syncing the view once for the whole batch
+    // rather than once per row. Returns an empty vector if begin >= end.
+    // Throws OutOfBoundsIndexException if end > size()
+    std::vector<RowExpr> get_range(size_t begin, size_t end);
+
+    // Random-access iterators over the row accessors of this Results. The
+    // backing view is resolved once when an iterator is created, and
+    // advancing and dereferencing it afterwards performs none of the
+    // validation and view syncing which get() does per call, so range-for
+    // over a Results touches only the view itself.
+    // Modifying or refreshing the Results invalidates its iterators.
+    class iterator;
+    iterator begin();
+    iterator end();
+
     // Get a row accessor for the first/last row, or none if the results are empty
     // More efficient than calling size()+get()
     util::Optional<RowExpr> first();
@@ -107,6 +138,28 @@ public:
     Results filter(Query&& q) const;
     Results sort(SortDescriptor&& sort) const;
 
+    // Create a new Results sorted by the named properties of the object type,
+    // each ascending or not. Unlike passing a prebuilt SortDescriptor this
+    // records which columns the sort reads, which lets the background
+    // notifier skip re-sorting when a commit does not modify any of them.
+    // Throws std::invalid_argument for properties which do not exist or are
+    // computed (and so have no column to sort on).
+    Results sort(std::vector<std::pair<std::string, bool>> const& keypaths) const;
+
+    // Get the root-table columns which the applied sort order reads, if
+    // known. Empty when there is no sort or it was supplied as a prebuilt
+    // SortDescriptor, whose columns cannot be inspected.
+    std::vector<size_t> const& get_sort_columns() const noexcept { return m_sort_columns; }
+
+    // Create a new Results limited to the first max_count rows, after any
+    // applied sort or distinct. Must be the last operation applied: calling
+    // sort(), filter() or distinct() on a limited Results throws
+    // UnimplementedOperationException
+    Results limit(size_t max_count) const;
+
+    // Get the maximum number of rows this Results can contain, or npos if unlimited
+    size_t get_limit() const noexcept { return m_limit; }
+
     // Create a new Results by removing duplicates
     // FIXME: The current implementation of distinct() breaks the Results API.
     // This is tracked by the following issues:
@@ -128,6 +181,16 @@ public:
     util::Optional<Mixed> average(size_t column);
     util::Optional<Mixed> sum(size_t column);
 
+    // Get the distinct values of the given column, in order of first
+    // appearance, without materializing a sorted TableView. Uses the
+    // column's search index when one is present and the Results is backed
+    // by an unfiltered table. Null values are not included, and string
+    // values point into the Realm file and so are valid only for the
+    // duration of the current read transaction.
+    // Throws UnsupportedColumnTypeException for link, list, table and mixed columns
+    // Throws OutOfBoundsIndexException for an out-of-bounds column
+    std::vector<Mixed> distinct_values(size_t column);
+
     enum class Mode {
         Empty, // Backed by nothing (for missing tables)
         Table, // Backed directly by a Table
@@ -177,11 +240,46 @@ public:
         UnsupportedColumnTypeException(size_t column, const Table* table, const char* operation);
     };
 
+    // The requested operation is not supported on a Results restricted by limit()
+    struct UnimplementedOperationException : public std::logic_error {
+        UnimplementedOperationException(std::string msg) : std::logic_error(std::move(msg)) {}
+    };
+
     // Create an async query from this Results
     // The query will be run on a background thread and delivered to the callback,
     // and then rerun after each commit (if needed) and redelivered if it changed
     NotificationToken async(std::function<void (std::exception_ptr)> target);
-    NotificationToken add_notification_callback(CollectionChangeCallback cb) &;
+    // If `minimum_interval` is non-zero, at most one notification is delivered
+    // to the callback per interval, with intervening changes coalesced into a
+    // single changeset covering everything since the last delivery.
+    // If `observed_columns` is engaged, modifications to the matching rows
+    // only produce a notification when they touch one of the given columns of
+    // the query's table; rows entering or leaving the results are always
+    // delivered, as are modifications to rows reached through links
+    NotificationToken add_notification_callback(CollectionChangeCallback cb,
+                                                std::chrono::milliseconds minimum_interval = std::chrono::milliseconds::zero(),
+                                                util::Optional<std::vector<size_t>> observed_columns = util::none) &;
+
+    // Run the initial query and sort on the background worker rather than
+    // blocking the calling thread the first time the Results is accessed,
+    // invoking `target` on this thread once the resulting TableView has been
+    // handed over. `target` is called at most once; destroying the returned
+    // token afterwards (or before delivery, to cancel) stops background
+    // updates while leaving the delivered view in place.
+    NotificationToken evaluate_async(std::function<void (std::exception_ptr)> target);
+
+    // Register a derived display property computed by `compute` from the
+    // given columns of the matching rows. The background notifier keeps the
+    // cached values up to date, recomputing only the rows whose dependency
+    // columns were modified before each change notification is delivered.
+    // Returns a token for get_derived_value() and remove_derived_property().
+    size_t add_derived_property(std::vector<size_t> columns,
+                                _impl::CollectionNotifier::DerivedFunction compute);
+    void remove_derived_property(size_t token);
+
+    // Get the derived value for the row at the given index of this Results,
+    // computing it on the calling thread if the cache has no value for it
+    util::Any get_derived_value(size_t token, size_t row_ndx);
 
     bool wants_background_updates() const { return m_wants_background_updates; }
 
@@ -192,7 +290,9 @@ public:
     // to any other privates or letting anyone else do so
     class Internal {
         friend class _impl::ResultsNotifier;
-        static void set_table_view(Results& results, TableView&& tv);
+        static void set_table_view(Results& results, TableView&& tv,
+                                   CollectionChangeSet const& changes);
+        static void confirm_view_version(Results& results, VersionID version);
     };
     
 private:
@@ -204,35 +304,148 @@ private:
     SharedRealm m_realm;
     mutable const ObjectSchema *m_object_schema = nullptr;
     Query m_query;
-    TableView m_table_view;
+    mutable TableView m_table_view;
+    // A view whose row buffer is shared between a live Results and snapshots
+    // of it. When set it holds the current view and m_table_view is unused;
+    // the live side materializes a private copy only when it next needs to
+    // advance the view, making snapshot-then-iterate free of any copying.
+    mutable std::shared_ptr<TableView> m_shared_view;
     LinkViewRef m_link_view;
     TableRef m_table;
     SortDescriptor m_sort;
     SortDescriptor m_distinct;
+    std::vector<size_t> m_sort_columns;
 
     _impl::CollectionNotifier::Handle<_impl::ResultsNotifier> m_notifier;
 
     Mode m_mode = Mode::Empty;
     UpdatePolicy m_update_policy = UpdatePolicy::Auto;
+    size_t m_limit = npos;
     bool m_has_used_table_view = false;
     bool m_wants_background_updates = true;
 
+    // Lazily-built map from source row index to index in the view, making
+    // repeated index_of() calls O(1) rather than a linear scan each. It is
+    // invalidated whenever the view changes out from under it, and patched
+    // incrementally from the changeset when the notifier delivers a new view.
+    // Not used for limited Results, whose windows are small enough to scan.
+    std::unordered_map<size_t, size_t> m_view_index_map;
+    uint_fast64_t m_view_index_map_version = -1;
+    bool m_view_index_map_valid = false;
+
+    // Version at which the notifier last confirmed that the view's contents
+    // match the current query results, letting update_tableview() skip
+    // syncing the view (and thereby rerunning the query on this thread when
+    // the notifier skipped delivering an unchanged view). A confirmation
+    // for any other version is simply never used, so it only needs to be
+    // explicitly reset when the view is synced against uncommitted changes.
+    util::Optional<VersionID> m_view_confirmed_version;
+
+    // Cache of aggregate results for the current read transaction version,
+    // keyed on column and aggregate function. Aggregates are commonly polled
+    // far more often than the data changes, and the underlying data cannot
+    // change without the version changing outside of write transactions (in
+    // which the cache is bypassed entirely).
+    std::unordered_map<size_t, util::Optional<Mixed>> m_aggregate_cache;
+    VersionID m_aggregate_cache_version;
+
+    // Cached result of size() for query-backed Results, maintained under the
+    // same rules as the aggregate cache
+    util::Optional<size_t> m_cached_size;
+    VersionID m_cached_size_version;
+
     void update_tableview(bool wants_notifications = true);
     bool update_linkview();
 
+    // Touch the column leaves for the leading rows of a freshly materialized
+    // view so that on encrypted Realms the pages they live on are decrypted
+    // ahead of the accessors reading individual values
+    void read_ahead(TableView& view) const;
+
+    // Update m_view_index_map to reflect the given changes to the view,
+    // avoiding a full rebuild on the next index_of() call
+    void patch_view_index_map(IndexSet const& deletions, IndexSet const& insertions);
+
+    // The current view, which may be shared with snapshots
+    TableView& table_view() const noexcept { return m_shared_view ? *m_shared_view : m_table_view; }
+
+    // Take back exclusive ownership of the view before changing it, leaving
+    // the shared one to any snapshots which still hold a reference to it
+    void unshare_view() const;
+
     void validate_read() const;
     void validate_write() const;
 
+    // Throw UnimplementedOperationException if the limit could not be pushed
+    // down into the TableView, i.e. if the Results is both limited and
+    // sorted or distinct
+    void validate_limit_supported(const char* operation) const;
+
     void prepare_async();
 
+    enum class AggregateFunc : size_t { Min, Max, Sum, Avg };
+
     template<typename Int, typename Float, typename Double, typename Timestamp>
     util::Optional<Mixed> aggregate(size_t column,
                                     const char* name,
                                     Int agg_int, Float agg_float,
                                     Double agg_double, Timestamp agg_timestamp);
 
+    // Return the cached result for the given aggregate if there is one for
+    // the current read transaction version, and otherwise compute it with
+    // `compute` and add it to the cache
+    template<typename Fn>
+    util::Optional<Mixed> use_aggregate_cache(size_t column, AggregateFunc func, Fn&& compute);
+
     void set_table_view(TableView&& tv);
 };
+
+class Results::iterator {
+public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = RowExpr;
+    using pointer = void;
+    using reference = RowExpr;
+    using iterator_category = std::random_access_iterator_tag;
+
+    iterator() = default;
+
+    RowExpr operator*() const;
+    RowExpr operator[](difference_type n) const { return *(*this + n); }
+
+    iterator& operator++() { ++m_ndx; return *this; }
+    iterator operator++(int) { auto old = *this; ++m_ndx; return old; }
+    iterator& operator--() { --m_ndx; return *this; }
+    iterator operator--(int) { auto old = *this; --m_ndx; return old; }
+    iterator& operator+=(difference_type n) { m_ndx += n; return *this; }
+    iterator& operator-=(difference_type n) { m_ndx -= n; return *this; }
+    friend iterator operator+(iterator it, difference_type n) { it += n; return it; }
+    friend iterator operator+(difference_type n, iterator it) { it += n; return it; }
+    friend iterator operator-(iterator it, difference_type n) { it -= n; return it; }
+    friend difference_type operator-(iterator const& a, iterator const& b)
+    {
+        return difference_type(a.m_ndx) - difference_type(b.m_ndx);
+    }
+
+    friend bool operator==(iterator const& a, iterator const& b) { return a.m_ndx == b.m_ndx; }
+    friend bool operator!=(iterator const& a, iterator const& b) { return a.m_ndx != b.m_ndx; }
+    friend bool operator<(iterator const& a, iterator const& b) { return a.m_ndx < b.m_ndx; }
+    friend bool operator>(iterator const& a, iterator const& b) { return a.m_ndx > b.m_ndx; }
+    friend bool operator<=(iterator const& a, iterator const& b) { return a.m_ndx <= b.m_ndx; }
+    friend bool operator>=(iterator const& a, iterator const& b) { return a.m_ndx >= b.m_ndx; }
+
+private:
+    friend class Results;
+    iterator(Results& results, size_t ndx);
+
+    enum class Source : char { None, Table, LinkView, TableView };
+
+    Table* m_table = nullptr;
+    TableView* m_table_view = nullptr;
+    LinkView* m_link_view = nullptr;
+    size_t m_ndx = 0;
+    Source m_source = Source::None;
+};
 }
 
 #endif /* REALM_RESULTS_HPP */
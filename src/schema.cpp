@@ -18,6 +18,7 @@
 
 #include "schema.hpp"
 
+#include "frozen_schema.hpp"
 #include "object_schema.hpp"
 #include "object_store.hpp"
 #include "object_schema.hpp"
@@ -78,6 +79,15 @@ Schema::const_iterator Schema::find(ObjectSchema const& object) const noexcept
 
 void Schema::validate() const
 {
+    if (m_statically_validated) {
+        // The compiler has already checked the schema's structure and a
+        // statically defined schema is never mutated, so just make sure the
+        // caches validate() normally rebuilds are populated.
+        content_hash();
+        frozen();
+        return;
+    }
+
     std::vector<ObjectSchemaValidationException> exceptions;
     for (auto const& object : *this) {
         object.validate(*this, exceptions);
@@ -86,6 +96,78 @@ void Schema::validate() const
     if (exceptions.size()) {
         throw SchemaValidationException(exceptions);
     }
+
+    // Every freshly validated schema is about to be compared against the
+    // file's schema, so this is a convenient time to compute the hash which
+    // lets that comparison be skipped entirely when nothing has changed.
+    // Recompute rather than reusing the cache in case the schema was mutated
+    // since the last validation.
+    m_content_hash = 0;
+    content_hash();
+    m_frozen = nullptr;
+    frozen();
+}
+
+std::shared_ptr<FrozenSchema const> Schema::frozen() const
+{
+    if (!m_frozen)
+        m_frozen = std::make_shared<FrozenSchema const>(*this);
+    return m_frozen;
+}
+
+namespace {
+// 64-bit FNV-1a
+struct SchemaHasher {
+    uint64_t value = 14695981039346656037ULL;
+
+    void append(StringData data)
+    {
+        for (size_t i = 0; i < data.size(); ++i)
+            append_byte(data[i]);
+        // Include the length so that adjacent strings can't be confused
+        // with a single longer one
+        append(uint64_t(data.size()));
+    }
+
+    void append(uint64_t data)
+    {
+        for (int i = 0; i < 8; ++i)
+            append_byte(char(data >> (i * 8)));
+    }
+
+    void append_byte(char byte)
+    {
+        value = (value ^ static_cast<unsigned char>(byte)) * 1099511628211ULL;
+    }
+};
+} // anonymous namespace
+
+uint64_t Schema::content_hash() const noexcept
+{
+    if (m_content_hash)
+        return m_content_hash;
+
+    SchemaHasher hasher;
+    auto append_property = [&](Property const& property) {
+        hasher.append(property.name);
+        hasher.append(uint64_t(property.type));
+        hasher.append(property.object_type);
+        hasher.append(property.link_origin_property_name);
+        hasher.append(uint64_t(property.is_primary << 2 | property.is_indexed << 1 | int(property.is_nullable)));
+    };
+    for (auto const& object : *this) {
+        hasher.append(object.name);
+        hasher.append(object.primary_key);
+        hasher.append(uint64_t(object.persisted_properties.size()));
+        for (auto const& property : object.persisted_properties)
+            append_property(property);
+        for (auto const& property : object.computed_properties)
+            append_property(property);
+    }
+
+    // Zero is reserved to mean that the hash has not yet been computed
+    m_content_hash = hasher.value ? hasher.value : 1;
+    return m_content_hash;
 }
 
 namespace {
@@ -206,6 +288,10 @@ void Schema::copy_table_columns_from(realm::Schema const& other)
             }
         }
     });
+
+    // The frozen form includes the table columns, so any existing snapshot
+    // is now stale
+    m_frozen = nullptr;
 }
 
 namespace realm {
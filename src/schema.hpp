@@ -19,17 +19,27 @@
 #ifndef REALM_SCHEMA_HPP
 #define REALM_SCHEMA_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "util/compiler.hpp"
 
 namespace realm {
+class FrozenSchema;
 class ObjectSchema;
 class SchemaChange;
 class StringData;
 struct Property;
 
+class Schema;
+
+namespace static_schema {
+struct SchemaDefinition;
+Schema realize(SchemaDefinition const&);
+}
+
 class Schema : private std::vector<ObjectSchema> {
 private:
     using base = std::vector<ObjectSchema>;
@@ -54,12 +64,32 @@ public:
     const_iterator find(ObjectSchema const& object) const noexcept;
 
     // Verify that this schema is internally consistent (i.e. all properties are
-    // valid, links link to types that actually exist, etc.)
+    // valid, links link to types that actually exist, etc.). For a schema
+    // realized from a compile-time definition (see static_schema.hpp) the
+    // compiler has already performed these checks, and this only ensures the
+    // caches it would otherwise build eagerly are populated.
     void validate() const;
 
     // Get the changes which must be applied to this schema to produce the passed-in schema
     std::vector<SchemaChange> compare(Schema const&) const;
 
+    // Get a hash of the schema's content, covering everything compare()
+    // examines other than the table column indices. Two schemas with the same
+    // content hash are (barring a hash collision) identical. Computed the
+    // first time it is requested (validate() does so eagerly) and cached, so
+    // the schema must not be mutated afterwards other than to update the
+    // table column indices.
+    uint64_t content_hash() const noexcept;
+
+    // Get the immutable arena-packed form of this schema for use on hot read
+    // paths. Built the first time it is requested (validate() does so
+    // eagerly) and then shared, including between copies of the Schema, so
+    // as with content_hash() the schema must not be mutated afterwards other
+    // than via copy_table_columns_from(), which produces a fresh snapshot.
+    // The returned snapshot remains valid after the Schema is destroyed for
+    // as long as the pointer is retained.
+    std::shared_ptr<FrozenSchema const> frozen() const;
+
     void copy_table_columns_from(Schema const&);
 
     friend bool operator==(Schema const&, Schema const&);
@@ -73,6 +103,19 @@ public:
     using base::size;
 
 private:
+    // Cached result of content_hash(), with zero meaning "not yet computed"
+    mutable uint64_t m_content_hash = 0;
+
+    // Cached result of frozen(), built on first request
+    mutable std::shared_ptr<FrozenSchema const> m_frozen;
+
+    // Whether this schema's structure was already verified during constant
+    // evaluation (see static_schema.hpp), letting validate() skip the
+    // per-object checks
+    bool m_statically_validated = false;
+
+    friend Schema static_schema::realize(static_schema::SchemaDefinition const&);
+
     template<typename T, typename U, typename Func>
     static void zip_matching(T&& a, U&& b, Func&& func);
 };
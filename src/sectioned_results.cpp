@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "sectioned_results.hpp"
+
+#include "shared_realm.hpp"
+
+#include <map>
+#include <set>
+
+using namespace realm;
+
+SectionedResults::SectionedResults(Results results, SameSectionCallback same_section)
+: m_state(std::make_shared<State>())
+{
+    m_state->results = std::move(results);
+    m_state->same_section = std::move(same_section);
+}
+
+void SectionedResults::State::rebuild_sections()
+{
+    offsets.clear();
+    size_t size = results.size();
+    if (size != 0) {
+        offsets.push_back(0);
+        for (size_t i = 1; i < size; ++i) {
+            if (!same_section(results.get(i - 1), results.get(i)))
+                offsets.push_back(i);
+        }
+    }
+}
+
+void SectionedResults::State::ensure_sections()
+{
+    auto realm = results.get_realm();
+    // Within a write transaction the data can change without the version
+    // changing, so the sections have to be rebuilt on each access, and the
+    // result cannot be used as the base for an incremental update
+    if (!realm || realm->is_in_transaction()) {
+        rebuild_sections();
+        valid = false;
+        diff_base_valid = false;
+        return;
+    }
+
+    auto current = realm->current_transaction_version();
+    if (valid && current && *current == version)
+        return;
+
+    rebuild_sections();
+    valid = true;
+    diff_base_valid = false;
+    if (current)
+        version = *current;
+}
+
+SectionedResults::SectionedChangeSet SectionedResults::State::apply(CollectionChangeSet changes)
+{
+    SectionedChangeSet ret;
+    auto current = results.get_realm()->current_transaction_version();
+
+    // If another callback registered on the same Results has already applied
+    // this delivery's changeset the sections are already up to date, and the
+    // section-level changes computed for it can be reused
+    if (diff_base_valid && current && *current == version) {
+        if (!changes.empty() && last_changes_version == *current) {
+            ret.section_deletions = last_section_deletions;
+            ret.section_insertions = last_section_insertions;
+        }
+        ret.rows = std::move(changes);
+        return ret;
+    }
+
+    // Without a valid base to diff against (the initial notification, or
+    // after the sections were rebuilt mid-write), rebuild from scratch and
+    // report every section as removed and re-added
+    if (!diff_base_valid) {
+        size_t old_count = delivered_section_count;
+        rebuild_sections();
+        if (!changes.empty()) {
+            for (size_t i = 0; i < old_count; ++i)
+                ret.section_deletions.add(i);
+            for (size_t i = 0; i < offsets.size(); ++i)
+                ret.section_insertions.add(i);
+        }
+    }
+    else {
+        size_t new_size = results.size();
+        auto new_position = [&](size_t old_ndx) {
+            return changes.insertions.shift(changes.deletions.unshift(old_ndx));
+        };
+
+        // The section boundary has to be re-evaluated around every inserted
+        // row, every modified row, and the gap left by every deleted row.
+        // Moves are included in both deletions and insertions, so they need
+        // no separate handling.
+        std::set<size_t> dirty;
+        for (auto ndx : changes.insertions.as_indexes()) {
+            dirty.insert(ndx);
+            dirty.insert(ndx + 1);
+        }
+        for (auto ndx : changes.deletions.as_indexes())
+            dirty.insert(changes.insertions.shift(ndx - changes.deletions.count(0, ndx)));
+        for (auto ndx : changes.modifications.as_indexes()) {
+            if (changes.deletions.contains(ndx))
+                continue;
+            auto pos = new_position(ndx);
+            dirty.insert(pos);
+            dirty.insert(pos + 1);
+        }
+
+        // Carry over the boundaries of sections whose first row still
+        // exists, translated to the row's new position. A section is
+        // identified by the row which begins it, so a section whose first
+        // row went away is reported as removed even if later rows remain.
+        std::map<size_t, util::Optional<size_t>> boundaries;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            if (!changes.deletions.contains(offsets[i]))
+                boundaries[new_position(offsets[i])] = i;
+        }
+
+        for (auto pos : dirty) {
+            if (pos == 0 || pos >= new_size)
+                continue;
+            bool is_boundary = !same_section(results.get(pos - 1), results.get(pos));
+            auto it = boundaries.find(pos);
+            if (is_boundary) {
+                if (it == boundaries.end())
+                    boundaries.emplace(pos, util::none);
+            }
+            else if (it != boundaries.end())
+                boundaries.erase(it);
+        }
+
+        // The first row always begins a section
+        if (new_size != 0 && (boundaries.empty() || boundaries.begin()->first != 0))
+            boundaries.emplace(0, util::none);
+
+        std::vector<size_t> new_offsets;
+        new_offsets.reserve(boundaries.size());
+        size_t next_old_section = 0, new_section = 0;
+        for (auto& boundary : boundaries) {
+            if (boundary.second) {
+                while (next_old_section < *boundary.second)
+                    ret.section_deletions.add(next_old_section++);
+                ++next_old_section;
+            }
+            else {
+                ret.section_insertions.add(new_section);
+            }
+            new_offsets.push_back(boundary.first);
+            ++new_section;
+        }
+        while (next_old_section < offsets.size())
+            ret.section_deletions.add(next_old_section++);
+
+        offsets = std::move(new_offsets);
+    }
+
+    valid = true;
+    diff_base_valid = true;
+    delivered_section_count = offsets.size();
+    if (current) {
+        version = *current;
+        last_changes_version = *current;
+    }
+    last_section_deletions = ret.section_deletions;
+    last_section_insertions = ret.section_insertions;
+
+    ret.rows = std::move(changes);
+    return ret;
+}
+
+size_t SectionedResults::section_count()
+{
+    m_state->ensure_sections();
+    return m_state->offsets.size();
+}
+
+void SectionedResults::validate_section(size_t section)
+{
+    if (section >= m_state->offsets.size())
+        throw Results::OutOfBoundsIndexException{section, m_state->offsets.size()};
+}
+
+size_t SectionedResults::section_begin(size_t section)
+{
+    m_state->ensure_sections();
+    validate_section(section);
+    return m_state->offsets[section];
+}
+
+size_t SectionedResults::section_size(size_t section)
+{
+    m_state->ensure_sections();
+    validate_section(section);
+    auto& offsets = m_state->offsets;
+    size_t end = section + 1 < offsets.size() ? offsets[section + 1] : m_state->results.size();
+    return end - offsets[section];
+}
+
+RowExpr SectionedResults::get(size_t section, size_t row)
+{
+    size_t size = section_size(section);
+    if (row >= size)
+        throw Results::OutOfBoundsIndexException{row, size};
+    return m_state->results.get(m_state->offsets[section] + row);
+}
+
+NotificationToken SectionedResults::add_notification_callback(std::function<void (SectionedChangeSet, std::exception_ptr)> callback)
+{
+    auto state = m_state;
+    return m_state->results.add_notification_callback(
+        [state, callback = std::move(callback)](CollectionChangeSet changes, std::exception_ptr err) {
+            if (err) {
+                callback({}, err);
+                return;
+            }
+            callback(state->apply(std::move(changes)), nullptr);
+        });
+}
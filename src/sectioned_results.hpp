@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_SECTIONED_RESULTS_HPP
+#define REALM_SECTIONED_RESULTS_HPP
+
+#include "results.hpp"
+
+#include <functional>
+
+namespace realm {
+
+// Groups the rows of a Results into contiguous sections, such as the
+// by-date or by-first-letter groupings used to drive sectioned table views.
+//
+// The underlying Results is expected to be sorted so that the rows of each
+// section are adjacent. Section boundaries are discovered with a
+// user-supplied callback which reports whether two adjacent rows belong to
+// the same section, and once built they are maintained incrementally from
+// the changesets produced by the Results notifier, so the per-update cost
+// scales with the size of the change rather than the size of the collection.
+class SectionedResults {
+public:
+    // Check whether two adjacent rows of the Results belong to the same section
+    using SameSectionCallback = std::function<bool(RowExpr, RowExpr)>;
+
+    struct SectionedChangeSet {
+        // The row-level changes, with indices relative to the Results as a whole
+        CollectionChangeSet rows;
+
+        // Indices of sections removed from the old list of sections. A
+        // section is considered removed if the row which began it no longer
+        // does, so a section whose first row was deleted is reported as a
+        // deletion plus an insertion even if it has other rows left.
+        IndexSet section_deletions;
+
+        // Indices of sections added to the new list of sections
+        IndexSet section_insertions;
+    };
+
+    SectionedResults() : SectionedResults(Results(), nullptr) { }
+    SectionedResults(Results results, SameSectionCallback same_section);
+
+    // SectionedResults is copyable and movable, and all copies share the
+    // same section state
+    SectionedResults(SectionedResults const&) = default;
+    SectionedResults(SectionedResults&&) = default;
+    SectionedResults& operator=(SectionedResults const&) = default;
+    SectionedResults& operator=(SectionedResults&&) = default;
+
+    // Get the underlying Results
+    Results& results() { return m_state->results; }
+
+    // Get the number of sections
+    size_t section_count();
+
+    // Get the number of rows in the given section
+    // Throws OutOfBoundsIndexException if section >= section_count()
+    size_t section_size(size_t section);
+
+    // Get the index in the underlying Results of the first row of the given section
+    // Throws OutOfBoundsIndexException if section >= section_count()
+    size_t section_begin(size_t section);
+
+    // Get the row accessor for the given row of the given section
+    // Throws OutOfBoundsIndexException if the section or row is out of bounds
+    RowExpr get(size_t section, size_t row);
+
+    // Register a callback to be invoked after each change to the underlying
+    // Results, with both the row-level changes and the resulting
+    // section-level insertions and deletions
+    NotificationToken add_notification_callback(std::function<void (SectionedChangeSet, std::exception_ptr)> callback);
+
+private:
+    // The section state, shared between copies of the SectionedResults and
+    // the registered notification callbacks
+    struct State {
+        Results results;
+        SameSectionCallback same_section;
+
+        // Index in `results` of the first row of each section, in ascending
+        // order. Never empty while valid unless the results are empty.
+        std::vector<size_t> offsets;
+
+        // Whether `offsets` describes the state of `results` as of `version`
+        bool valid = false;
+        // Whether `offsets` can be used as the base for an incremental
+        // update, i.e. it describes the state the next delivered changeset
+        // starts from. Cleared when the sections are rebuilt out-of-band.
+        bool diff_base_valid = false;
+        VersionID version;
+
+        // The section count and section-level changes from the most recent
+        // delivery, reused when several callbacks see the same changeset
+        size_t delivered_section_count = 0;
+        VersionID last_changes_version;
+        IndexSet last_section_deletions;
+        IndexSet last_section_insertions;
+
+        void ensure_sections();
+        void rebuild_sections();
+        SectionedChangeSet apply(CollectionChangeSet changes);
+    };
+    std::shared_ptr<State> m_state;
+
+    void validate_section(size_t section);
+};
+
+} // namespace realm
+
+#endif // REALM_SECTIONED_RESULTS_HPP
@@ -33,6 +33,7 @@
 
 #include "util/compiler.hpp"
 #include "util/format.hpp"
+#include "util/tracing.hpp"
 
 #include <realm/history.hpp>
 #include <realm/util/scope_exit.hpp>
@@ -148,8 +149,15 @@ void Realm::open_with_config(const Config& config,
             }
 
             SharedGroupOptions options;
-            options.durability = config.in_memory ? SharedGroupOptions::Durability::MemOnly :
-                                                    SharedGroupOptions::Durability::Full;
+            if (config.in_memory)
+                options.durability = SharedGroupOptions::Durability::MemOnly;
+            else if (config.group_commit_enabled()) {
+                // Individual commits skip their sync; the coordinator
+                // batches them into periodic syncs instead
+                options.durability = SharedGroupOptions::Durability::Unsafe;
+            }
+            else
+                options.durability = SharedGroupOptions::Durability::Full;
             options.encryption_key = config.encryption_key.data();
             options.allow_file_format_upgrade = !config.disable_format_upgrade &&
                                                 config.schema_mode != SchemaMode::ResetFile;
@@ -224,6 +232,12 @@ SharedRealm Realm::get_shared_realm(Config config)
     return coordinator->get_realm(std::move(config));
 }
 
+void Realm::get_shared_realm_async(Config config, std::function<void(SharedRealm, std::exception_ptr)> callback)
+{
+    auto coordinator = RealmCoordinator::get_coordinator(config.path);
+    coordinator->get_realm_async(std::move(config), std::move(callback));
+}
+
 void Realm::set_schema(Schema const& reference, Schema schema)
 {
     m_dynamic_schema = false;
@@ -240,12 +254,29 @@ void Realm::read_schema_from_group_if_needed()
     if (m_schema_transaction_version == current_version)
         return;
 
+    // If the coordinator's schema cache covers both the version we last read
+    // the schema at and the version we're now at then no schema change
+    // occurred in between, and rereading the schema from the Group would just
+    // reproduce what we already have.
+    if (m_coordinator && m_schema_transaction_version != uint64_t(-1)
+        && m_coordinator->schema_unchanged_between(m_schema_transaction_version, current_version)) {
+        m_schema_transaction_version = current_version;
+        return;
+    }
+
     m_schema_transaction_version = current_version;
     m_schema_version = ObjectStore::get_schema_version(group);
-    auto schema = ObjectStore::schema_from_group(group);
-    if (m_coordinator)
-        m_coordinator->cache_schema(schema, m_schema_version,
-                                    m_schema_transaction_version);
+
+    // Reading the schema version alone is cheap, and with it the coordinator
+    // can check whether the schema persisted by a previous run of the app is
+    // still valid for the file and skip walking the Group's tables entirely
+    Schema schema;
+    if (!m_coordinator || !m_coordinator->load_cached_schema(current_version, m_schema_version, schema)) {
+        schema = ObjectStore::schema_from_group(group);
+        if (m_coordinator)
+            m_coordinator->cache_schema(schema, m_schema_version,
+                                        m_schema_transaction_version);
+    }
 
     if (m_dynamic_schema) {
         m_schema = std::move(schema);
@@ -378,6 +409,21 @@ void Realm::update_schema(Schema schema, uint64_t version,
 {
     schema.validate();
 
+    // If the requested schema is unchanged from the one which was last
+    // applied to the file we can skip building and comparing the file's
+    // schema entirely, which is the common case when opening an existing
+    // file. The content hash does not cover column indices, so those still
+    // need to be read from the file.
+    if (version == m_schema_version) {
+        auto stored_hash = ObjectStore::get_schema_content_hash(read_group());
+        if (stored_hash && *stored_hash == schema.content_hash()) {
+            ObjectStore::set_schema_columns(read_group(), schema);
+            m_schema = std::move(schema);
+            m_dynamic_schema = false;
+            return;
+        }
+    }
+
     Schema actual_schema = get_full_schema();
     std::vector<SchemaChange> required_changes = actual_schema.compare(schema);
 
@@ -388,7 +434,9 @@ void Realm::update_schema(Schema schema, uint64_t version,
     // Either the schema version has changed or we need to do non-migration changes
 
     if (!in_transaction) {
+        auto wait_start = std::chrono::steady_clock::now();
         transaction::begin_without_validation(*m_shared_group);
+        m_coordinator->did_begin_write(std::chrono::steady_clock::now() - wait_start);
 
         // Beginning the write transaction may have advanced the version and left
         // us with nothing to do if someone else initialized the schema on disk
@@ -454,8 +502,20 @@ void Realm::add_schema_change_handler()
     if (m_config.read_only())
         return;
     m_group->set_schema_change_notification_handler([&] {
-        m_new_schema = ObjectStore::schema_from_group(read_group());
         m_schema_version = ObjectStore::get_schema_version(read_group());
+        // If the transact log parser recorded which tables changed and the
+        // coordinator still has the schema for the version we advanced from,
+        // only the changed tables' ObjectSchemas need to be re-read from the
+        // group. Otherwise fall back to reading the complete schema.
+        Schema previous;
+        if (!m_schema_changed_tables.empty() && m_coordinator
+            && m_coordinator->get_cached_schema_for_version(m_schema_transaction_version, previous)) {
+            m_new_schema = ObjectStore::schema_from_group(read_group(), previous, m_schema_changed_tables);
+        }
+        else {
+            m_new_schema = ObjectStore::schema_from_group(read_group());
+        }
+        m_schema_changed_tables.clear();
         if (m_dynamic_schema)
             m_schema = *m_new_schema;
         else
@@ -477,6 +537,7 @@ void Realm::cache_new_schema()
     }
     m_schema_transaction_version = new_version;
     m_new_schema = util::none;
+    m_schema_changed_tables.clear();
 }
 
 static void check_read_write(Realm *realm)
@@ -484,10 +545,21 @@ static void check_read_write(Realm *realm)
     if (realm->config().read_only()) {
         throw InvalidTransactionException("Can't perform transactions on read-only Realms.");
     }
+    if (realm->is_frozen()) {
+        throw InvalidTransactionException("Can't perform transactions on a frozen Realm.");
+    }
 }
 
 void Realm::verify_thread() const
 {
+    // Frozen Realms never change, so they may be used from any thread
+    if (m_frozen)
+        return;
+
+    // A scoped read performed the check once on entry
+    if (m_scoped_read_depth)
+        return;
+
     if (!m_execution_context.contains<std::thread::id>())
         return;
 
@@ -510,6 +582,70 @@ void Realm::verify_open() const
     }
 }
 
+Realm::ScopedRead::ScopedRead(Realm& realm)
+: m_realm(realm)
+{
+    realm.verify_thread();
+    // Pin the version by making sure a read transaction is open before the
+    // per-call checks start being skipped
+    realm.read_group();
+    ++realm.m_scoped_read_depth;
+}
+
+Realm::ScopedRead::~ScopedRead()
+{
+    --m_realm.m_scoped_read_depth;
+}
+
+Realm::VersionPin::VersionPin(std::shared_ptr<Realm> realm, VersionID version)
+: m_realm(std::move(realm))
+, m_version(version)
+{
+}
+
+Realm::VersionPin::VersionPin(VersionPin&& other) noexcept
+: m_realm(std::move(other.m_realm))
+, m_version(other.m_version)
+{
+}
+
+Realm::VersionPin& Realm::VersionPin::operator=(VersionPin&& other) noexcept
+{
+    if (this != &other) {
+        if (m_realm && !m_realm->is_closed())
+            m_realm->m_shared_group->unpin_version(m_version);
+        m_realm = std::move(other.m_realm);
+        m_version = other.m_version;
+    }
+    return *this;
+}
+
+Realm::VersionPin::~VersionPin()
+{
+    if (m_realm && !m_realm->is_closed())
+        m_realm->m_shared_group->unpin_version(m_version);
+}
+
+Realm::VersionPin Realm::pin_version()
+{
+    verify_thread();
+    verify_open();
+    if (!m_shared_group)
+        return {};
+    if (is_in_transaction()) {
+        throw InvalidTransactionException("Cannot pin a version during a write transaction.");
+    }
+    read_group();
+    return VersionPin(shared_from_this(), m_shared_group->pin_version());
+}
+
+util::Optional<VersionID> Realm::current_transaction_version() const
+{
+    if (!m_shared_group || !m_group)
+        return none;
+    return m_shared_group->get_version_of_current_transaction();
+}
+
 bool Realm::is_in_transaction() const noexcept
 {
     if (!m_shared_group) {
@@ -523,6 +659,9 @@ void Realm::begin_transaction()
     check_read_write(this);
     verify_thread();
 
+    if (m_scoped_read_depth) {
+        throw InvalidTransactionException("Cannot begin a write transaction inside a scoped read");
+    }
     if (is_in_transaction()) {
         throw InvalidTransactionException("The Realm is already in a write transaction");
     }
@@ -537,7 +676,10 @@ void Realm::begin_transaction()
     // state, but that's unavoidable.
     if (m_is_sending_notifications) {
         _impl::NotifierPackage notifiers;
-        transaction::begin(m_shared_group, m_binding_context.get(), notifiers);
+        auto wait_start = std::chrono::steady_clock::now();
+        transaction::begin(m_shared_group, m_binding_context.get(), notifiers, &m_schema_changed_tables);
+        if (!is_closed() && is_in_transaction())
+            m_coordinator->did_begin_write(std::chrono::steady_clock::now() - wait_start);
         return;
     }
 
@@ -564,6 +706,67 @@ void Realm::commit_transaction()
     cache_new_schema();
 }
 
+void Realm::flush()
+{
+    verify_thread();
+    verify_open();
+    if (m_coordinator)
+        m_coordinator->sync_pending_commits();
+}
+
+void Realm::async_begin_transaction(std::function<void(std::shared_ptr<Realm>)> callback)
+{
+    check_read_write(this);
+    verify_open();
+    m_coordinator->queue_async_write(std::move(callback));
+}
+
+void Realm::async_commit(std::function<void(std::exception_ptr)> completion)
+{
+    std::exception_ptr error;
+    try {
+        commit_transaction();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    if (completion)
+        completion(error);
+    else if (error)
+        std::rethrow_exception(error);
+}
+
+void Realm::update_schema_async(Schema schema, uint64_t version,
+                                MigrationFunction migration_function,
+                                std::function<void(std::exception_ptr)> completion)
+{
+    verify_thread();
+    verify_open();
+    check_read_write(this);
+
+    // The migration is just a normal write transaction performed on the
+    // async-write thread's Realm instance, so it acquires the write lock
+    // without blocking this thread, readers continue against their current
+    // snapshot while it runs, and the commit publishes the new schema
+    // atomically
+    m_coordinator->queue_async_write([schema = std::move(schema), version,
+                                      migration_function = std::move(migration_function),
+                                      completion = std::move(completion)](std::shared_ptr<Realm> realm) mutable {
+        std::exception_ptr error;
+        try {
+            realm->update_schema(std::move(schema), version, std::move(migration_function), true);
+            realm->commit_transaction();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        if (realm->is_in_transaction())
+            realm->cancel_transaction();
+        if (completion)
+            completion(error);
+    });
+}
+
 void Realm::cancel_transaction()
 {
     check_read_write(this);
@@ -573,7 +776,8 @@ void Realm::cancel_transaction()
         throw InvalidTransactionException("Can't cancel a non-existing write transaction");
     }
 
-    transaction::cancel(*m_shared_group, m_binding_context.get());
+    transaction::cancel(*m_shared_group, m_binding_context.get(), &m_schema_changed_tables);
+    m_coordinator->did_end_write();
 }
 
 void Realm::invalidate()
@@ -644,7 +848,7 @@ OwnedBinaryData Realm::write_copy()
 
 void Realm::notify()
 {
-    if (is_closed() || is_in_transaction()) {
+    if (is_closed() || is_in_transaction() || m_frozen) {
         return;
     }
 
@@ -677,7 +881,10 @@ void Realm::notify()
     m_is_sending_notifications = true;
     if (m_auto_refresh) {
         if (m_group) {
-            m_coordinator->advance_to_ready(*this);
+            {
+                util::trace::Scope trace_scope(util::trace::Event::realm_advance, this);
+                m_coordinator->advance_to_ready(*this);
+            }
             cache_new_schema();
         }
         else  {
@@ -691,8 +898,38 @@ void Realm::notify()
     }
 }
 
+SharedRealm Realm::freeze()
+{
+    verify_thread();
+    verify_open();
+
+    // Duplicate config for an uncached instance so that freezing doesn't
+    // affect (or get affected by) any cached Realm for this thread
+    Realm::Config config = *m_coordinator->get_config();
+    config.cache = false;
+    config.schema = util::none;
+    config.execution_context = util::none;
+    SharedRealm frozen = m_coordinator->get_realm(std::move(config));
+    frozen->m_frozen = true;
+    frozen->m_auto_refresh = false;
+    if (!m_config.read_only()) {
+        // Pin the new instance to this Realm's current version. Read-only
+        // Realms have no version to pin, but are immutable anyway.
+        read_group();
+        frozen->begin_read(m_shared_group->get_version_of_current_transaction());
+    }
+    if (!m_dynamic_schema)
+        frozen->set_schema_subset(m_schema);
+    return frozen;
+}
+
 bool Realm::refresh()
 {
+    // Frozen Realms are permanently pinned to their version
+    if (m_frozen) {
+        return false;
+    }
+
     verify_thread();
     check_read_write(this);
 
@@ -717,7 +954,11 @@ bool Realm::refresh()
         m_binding_context->before_notify();
     }
     if (m_group) {
-        bool version_changed = m_coordinator->advance_to_latest(*this);
+        bool version_changed;
+        {
+            util::trace::Scope trace_scope(util::trace::Event::realm_advance, this);
+            version_changed = m_coordinator->advance_to_latest(*this);
+        }
         cache_new_schema();
         return version_changed;
     }
@@ -765,6 +1006,28 @@ void Realm::close()
     m_coordinator = nullptr;
 }
 
+void Realm::close_async(std::function<void()> completion)
+{
+    if (!m_shared_group || !m_coordinator) {
+        // Read-only Realms have no transaction state to release, so there's
+        // nothing worth moving to a background thread
+        close();
+        if (completion)
+            completion();
+        return;
+    }
+
+    // Unregistering from the cache stays on this thread so that a subsequent
+    // get_shared_realm() can't be handed this closed instance; it's just
+    // removing an entry from a vector
+    auto coordinator = std::move(m_coordinator);
+    coordinator->unregister_realm(this);
+
+    m_group = nullptr;
+    m_binding_context = nullptr;
+    coordinator->close_async(std::move(m_history), std::move(m_shared_group), std::move(completion));
+}
+
 util::Optional<int> Realm::file_format_upgraded_from_version() const
 {
     if (upgrade_initial_version != upgrade_final_version) {
@@ -827,7 +1090,7 @@ T Realm::resolve_thread_safe_reference(ThreadSafeReference<T> reference)
         // If the reference's version is behind, advance it to our version
         if (reference_version < current_version) {
             // Duplicate config for uncached Realm so we don't advance the user's Realm
-            Realm::Config config = m_coordinator->get_config();
+            Realm::Config config = *m_coordinator->get_config();
             config.cache = false;
             config.schema = util::none;
             SharedRealm temporary_realm = m_coordinator->get_realm(config);
@@ -847,6 +1110,82 @@ template Object Realm::resolve_thread_safe_reference(ThreadSafeReference<Object>
 template List Realm::resolve_thread_safe_reference(ThreadSafeReference<List> reference);
 template Results Realm::resolve_thread_safe_reference(ThreadSafeReference<Results> reference);
 
+ThreadSafeReferenceBundle Realm::obtain_thread_safe_reference_bundle()
+{
+    verify_thread();
+    if (is_in_transaction()) {
+        throw InvalidTransactionException("Cannot obtain thread safe reference during a write transaction.");
+    }
+    // Pinning the version requires an active read transaction
+    read_group();
+    return ThreadSafeReferenceBundle(shared_from_this());
+}
+
+ResolvedReferenceBundle Realm::resolve_thread_safe_reference(ThreadSafeReferenceBundle reference)
+{
+    verify_thread();
+    if (is_in_transaction()) {
+        throw InvalidTransactionException("Cannot resolve thread safe reference during a write transaction.");
+    }
+    if (reference.is_invalidated()) {
+        throw std::logic_error("Cannot resolve thread safe reference more than once.");
+    }
+    if (!reference.has_same_config(*this)) {
+        throw MismatchedRealmException("Cannot resolve thread safe reference in Realm with different configuration "
+                                       "than the source Realm.");
+    }
+
+    // Any of the callbacks to user code below could drop the last remaining
+    // strong reference to `this`
+    auto retain_self = shared_from_this();
+
+    // Ensure we're on the same version as the reference
+    if (!m_group) {
+        // A read transaction doesn't yet exist, so create at the reference's version
+        begin_read(reference.m_version_id);
+    }
+    else {
+        // A read transaction does exist, but let's make sure that its version matches the reference's
+        auto current_version = m_shared_group->get_version_of_current_transaction();
+        VersionID reference_version(reference.m_version_id);
+
+        if (reference_version == current_version) {
+            return std::move(reference).import_into_realm(shared_from_this());
+        }
+
+        refresh();
+
+        current_version = m_shared_group->get_version_of_current_transaction();
+
+        // If the reference's version is behind, advance it to our version.
+        // Unlike resolving references one at a time, the whole bundle is
+        // imported into the temporary Realm and carried forward with a
+        // single advance.
+        if (reference_version < current_version) {
+            // Duplicate config for uncached Realm so we don't advance the user's Realm
+            Realm::Config config = *m_coordinator->get_config();
+            config.cache = false;
+            config.schema = util::none;
+            SharedRealm temporary_realm = m_coordinator->get_realm(config);
+            temporary_realm->begin_read(reference_version);
+
+            auto imported = std::move(reference).import_into_realm(temporary_realm);
+            transaction::advance(*temporary_realm->m_shared_group, nullptr, current_version);
+
+            ThreadSafeReferenceBundle advanced(temporary_realm);
+            for (auto& object : imported.objects)
+                advanced.add(object);
+            for (auto& list : imported.lists)
+                advanced.add(list);
+            for (auto& results : imported.results)
+                advanced.add(results);
+            reference = std::move(advanced);
+        }
+    }
+
+    return std::move(reference).import_into_realm(shared_from_this());
+}
+
 MismatchedConfigException::MismatchedConfigException(StringData message, StringData path)
 : std::logic_error(util::format(message.data(), path)) { }
 
@@ -29,6 +29,7 @@
 #include <realm/sync/client.hpp>
 #endif
 
+#include <functional>
 #include <memory>
 
 namespace realm {
@@ -41,6 +42,8 @@ class StringData;
 class Table;
 struct SyncConfig;
 class ThreadSafeReferenceBase;
+class ThreadSafeReferenceBundle;
+struct ResolvedReferenceBundle;
 template <typename T> class ThreadSafeReference;
 struct VersionID;
 template<typename Table> class BasicRow;
@@ -144,6 +147,34 @@ public:
         // User-supplied encryption key. Must be either empty or 64 bytes.
         std::vector<char> encryption_key;
 
+        // Maximum number of rows whose column leaves are eagerly touched
+        // when a query materializes a TableView on an encrypted Realm.
+        // Encrypted files are decrypted a page at a time on first access,
+        // so touching the leaves immediately after running the query
+        // decrypts each page once up front rather than on fault as the
+        // accessors read individual values. Zero disables read-ahead.
+        // Ignored when encryption_key is empty.
+        size_t encryption_read_ahead_rows = 256;
+
+        // How to warm the OS page cache for the file when it is first
+        // opened, so that the first queries after a process restart don't
+        // stall on page faults while the B-tree is walked cold. Coordinated
+        // per file, so concurrent opens don't duplicate the work. Ignored
+        // for in-memory Realms.
+        enum class WarmStrategy : uint8_t {
+            // Fault pages in on demand, as always
+            None,
+            // Tell the OS to start reading the file into the page cache in
+            // the background (posix_fadvise(WILLNEED); a no-op on Windows).
+            // Cheap, but only a hint and silently dropped under memory
+            // pressure.
+            Advise,
+            // Read the whole file sequentially on a background thread
+            // started at open. Heavier-handed, but reliably populates the
+            // page cache and sequential reads are the fastest way to do so.
+            Prefault,
+        };
+        WarmStrategy warm_strategy = WarmStrategy::None;
 
         bool in_memory = false;
         SchemaMode schema_mode = SchemaMode::Automatic;
@@ -186,6 +217,79 @@ public:
         // speeds up tests that don't need notifications.
         bool automatic_change_notifications = true;
 
+        // Maximum number of extra SharedGroups the background worker may keep
+        // open so that independent groups of notifiers can be run in
+        // parallel, each reading through its own Group accessors. Zero makes
+        // the worker run all notifiers serially on its own SharedGroup.
+        size_t notifier_shared_group_pool_size = 4;
+
+        // Run notification change computation on a worker pool shared by
+        // every open Realm file in the process rather than inline on this
+        // file's commit listener thread. With many busy files this bounds
+        // the number of threads doing notification work to the core count
+        // and keeps each file's commit listener responsive; runs for any
+        // single file are still strictly ordered relative to each other.
+        bool use_shared_notifier_pool = false;
+
+        // If non-zero, the maximum number of versions a newly registered
+        // notifier may lag behind the latest snapshot before the background
+        // worker stops computing fine-grained changesets for the span it
+        // missed and instead force-advances it straight to the latest
+        // version. Lagging notifiers pin old versions and force the Realm
+        // file to retain history, so under sustained write load this bounds
+        // file growth at the cost of the first notification for a laggard
+        // not reporting the changes made before it was able to run.
+        uint_fast64_t max_notifier_version_lag = 0;
+
+        // Report an observed object or collection as modified when an
+        // object it links to (directly or transitively) is modified, and
+        // not just when its own fields change. Disabling this skips the
+        // link-graph traversal which that requires, which can be a
+        // significant saving for Realms with no UI to keep in sync, such
+        // as ones used server-side.
+        bool compute_deep_change_info = true;
+
+        // When either of these is non-zero, individual commits no longer
+        // perform their own durable sync. Instead the coordinator syncs the
+        // file to disk once every group_commit_max_commits commits, or when
+        // a commit arrives more than group_commit_interval_ms milliseconds
+        // after the previous sync, whichever happens first; flush() syncs
+        // any pending commits immediately. This can improve throughput by
+        // an order of magnitude for workloads making many small commits, at
+        // the cost that a system crash loses the commits made since the
+        // last completed sync and may require discarding the file. Ignored
+        // for in-memory Realms. All Realm instances for a path must agree
+        // on whether group commit is in use.
+        uint_fast64_t group_commit_interval_ms = 0;
+        size_t group_commit_max_commits = 0;
+
+        bool group_commit_enabled() const
+        {
+            return !in_memory && (group_commit_interval_ms || group_commit_max_commits);
+        }
+
+        // Publish a small metadata record for each commit — the new version
+        // number plus a bitmask of the modified tables — in a sidecar file
+        // next to the Realm file. Reader processes compare the records
+        // against the tables their notifiers observe and skip parsing the
+        // transact log for commits which can't affect any of them, which
+        // can eliminate most of the per-commit work in read-mostly
+        // processes. Costs an extra pass over each commit's transact log in
+        // the writing process, and records are only published for commits
+        // made while this is enabled; readers parse normally for any commit
+        // without a record. Ignored for in-memory Realms.
+        bool publish_commit_metadata = false;
+
+        // When non-zero, a compaction policy is evaluated as the last Realm
+        // instance for the file in this process is closed: the file is
+        // compacted if it is larger than compact_on_close_bytes and less
+        // than compact_on_close_utilization of it is live data. Unlike
+        // should_compact_on_launch_function this covers long-running
+        // processes which rarely reopen their files. Compaction is skipped
+        // (without error) when another process has the file open.
+        uint64_t compact_on_close_bytes = 0;
+        double compact_on_close_utilization = 0.5;
+
         // The identifier of the abstract execution context in which this Realm will be used.
         // If unset, the current thread's identifier will be used to identify the execution context.
         util::Optional<AbstractExecutionContextID> execution_context;
@@ -203,11 +307,33 @@ public:
     // encryption key will raise an exception.
     static SharedRealm get_shared_realm(Config config);
 
+    // Open a Realm asynchronously. The file open, schema verification and
+    // any migration — and, for synchronized Realms, the initial download —
+    // are performed on a background thread, and the callback is then invoked
+    // on the calling thread's event loop with a Realm instance confined to
+    // the calling thread, or with the exception which prevented opening it.
+    // The calling thread must be running an event loop.
+    static void get_shared_realm_async(Config config,
+                                       std::function<void(SharedRealm, std::exception_ptr)> callback);
+
     // Updates a Realm to a given schema, using the Realm's pre-set schema mode.
     void update_schema(Schema schema, uint64_t version=0,
                        MigrationFunction migration_function=nullptr,
                        bool in_transaction=false);
 
+    // Perform update_schema() on a background thread rather than blocking
+    // the calling thread on the write lock for the duration of the migration.
+    //
+    // Readers (including this Realm) continue to see the pre-migration
+    // schema and data until the migration's write transaction commits, at
+    // which point the migrated file becomes visible atomically through the
+    // normal refresh/notification machinery. The completion handler is
+    // invoked on the background thread with any error thrown by the
+    // migration, or a null exception pointer if it succeeded.
+    void update_schema_async(Schema schema, uint64_t version=0,
+                             MigrationFunction migration_function=nullptr,
+                             std::function<void(std::exception_ptr)> completion=nullptr);
+
     // Set the schema used for this Realm, but do not update the file's schema
     // if it is not compatible (and instead throw an error).
     // Cannot be called multiple times on a single Realm instance or an instance
@@ -226,13 +352,106 @@ public:
     void commit_transaction();
     void cancel_transaction();
     bool is_in_transaction() const noexcept;
+
+    // Queue a write transaction to be performed on a background thread
+    // without blocking the calling thread on the write lock.
+    //
+    // The callback is invoked on the background thread with a Realm instance
+    // confined to that thread which has an active write transaction. The
+    // callback should perform its writes on that instance and finish by
+    // calling commit_transaction() or async_commit() on it; if the
+    // transaction is still active when the callback returns (including due
+    // to the callback throwing), it is rolled back. Writes queued for a
+    // single Realm file are performed in the order they were queued.
+    void async_begin_transaction(std::function<void(std::shared_ptr<Realm>)> callback);
+
+    // Commit the current write transaction, reporting any error which
+    // occurred while committing to the completion handler rather than
+    // throwing. The completion handler is invoked with a null exception
+    // pointer if the commit succeeded.
+    void async_commit(std::function<void(std::exception_ptr)> completion);
     bool is_in_read_transaction() const { return !!m_group; }
 
+    // Durably sync any commits which group commit (see
+    // Config::group_commit_interval_ms) has not yet synced to disk. Returns
+    // once everything committed before the call is durable. A no-op when
+    // group commit is not in use, as every commit is then synced
+    // individually.
+    void flush();
+
+    // The version of the current read transaction, or `none` if the Realm
+    // is not in a read transaction
+    util::Optional<VersionID> current_transaction_version() const;
+
+    // Marks a scope in which the Realm is only read from. The thread check
+    // is performed and the read version pinned once when the scope is
+    // entered, and accessor calls made inside it skip their per-call
+    // Realm validation. Beginning a write transaction inside the scope
+    // throws InvalidTransactionException. Scopes may be nested.
+    class ScopedRead {
+    public:
+        explicit ScopedRead(Realm& realm);
+        ~ScopedRead();
+
+        ScopedRead(ScopedRead const&) = delete;
+        ScopedRead& operator=(ScopedRead const&) = delete;
+
+    private:
+        Realm& m_realm;
+    };
+
+    // Perform a batch of reads within a single ScopedRead, paying the fixed
+    // costs once for the whole batch rather than once per accessor call.
+    // Returns whatever the callback returns.
+    template<typename Fn>
+    auto read(Fn&& fn) -> decltype(fn())
+    {
+        ScopedRead scope(*this);
+        return fn();
+    }
+
     bool refresh();
     void set_auto_refresh(bool auto_refresh) { m_auto_refresh = auto_refresh; }
     bool auto_refresh() const { return m_auto_refresh; }
     void notify();
 
+    // Get an immutable Realm instance pinned to this Realm's current version.
+    // The returned Realm never advances its read transaction, cannot write,
+    // and skips the thread-confinement checks, so objects read from it stay
+    // valid for as long as it is kept open regardless of which thread they
+    // are used from. Core's accessors are not safe for concurrent use,
+    // however, so each thread reading from the snapshot concurrently should
+    // be given its own frozen instance; calling freeze() on an already-frozen
+    // Realm is cheap, can be done from any thread, and pins the same version.
+    SharedRealm freeze();
+    bool is_frozen() const noexcept { return m_frozen; }
+
+    // Token which keeps the data of a read version valid after the Realm's
+    // read transaction has advanced past it, so that unowned values read
+    // from the Realm (such as BinaryData) can be used without copying them
+    // out of the file. Must be destroyed on the Realm's thread.
+    class VersionPin {
+    public:
+        VersionPin() noexcept = default;
+        VersionPin(VersionPin&&) noexcept;
+        VersionPin& operator=(VersionPin&&) noexcept;
+        ~VersionPin();
+
+    private:
+        friend class Realm;
+        VersionPin(std::shared_ptr<Realm> realm, VersionID version);
+
+        std::shared_ptr<Realm> m_realm;
+        VersionID m_version;
+    };
+
+    // Pin the current read version of this Realm, beginning a read
+    // transaction if one is not already active, and return a token which
+    // releases the pin when destroyed. Read-only Realms never invalidate
+    // data and so return an empty token.
+    // Throws InvalidTransactionException if called during a write transaction.
+    VersionPin pin_version();
+
     void invalidate();
     bool compact();
     void write_copy(StringData path, BinaryData encryption_key);
@@ -247,6 +466,13 @@ public:
     // Close this Realm and remove it from the cache. Continuing to use a
     // Realm after closing it will throw ClosedRealmException
     void close();
+
+    // Like close(), but the calling thread only pays for detaching this
+    // instance; releasing the transaction state (and, if this was the last
+    // open Realm for the file, tearing down the coordinator) happens on a
+    // background thread. The completion callback (if any) is invoked on that
+    // thread once the file has been fully released.
+    void close_async(std::function<void()> completion = nullptr);
     bool is_closed() const { return !m_read_only_group && !m_shared_group; }
 
     // returns the file format version upgraded from if an upgrade took place
@@ -267,6 +493,15 @@ public:
     template <typename T>
     T resolve_thread_safe_reference(ThreadSafeReference<T> reference);
 
+    // Construct an empty bundle of thread safe references. The bundle pins
+    // the current version once, and values added to it with add() share that
+    // single pin rather than each pinning the version themselves.
+    ThreadSafeReferenceBundle obtain_thread_safe_reference_bundle();
+
+    // Resolve every reference in the bundle, performing a single version
+    // reconciliation for the whole bundle rather than one per reference.
+    ResolvedReferenceBundle resolve_thread_safe_reference(ThreadSafeReferenceBundle reference);
+
     static SharedRealm make_shared_realm(Config config, std::shared_ptr<_impl::RealmCoordinator> coordinator = nullptr) {
         struct make_shared_enabler : public Realm {
             make_shared_enabler(Config config, std::shared_ptr<_impl::RealmCoordinator> coordinator)
@@ -296,6 +531,11 @@ public:
         // added, and coordinators need to be able to get themselves from a Realm
         static _impl::RealmCoordinator& get_coordinator(Realm& realm) { return *realm.m_coordinator; }
 
+        // RealmCoordinator passes this to the transact log parser when
+        // advancing the Realm's read transaction so that the schema change
+        // notification handler knows which tables actually changed
+        static std::vector<size_t>& get_schema_changed_tables(Realm& realm) { return realm.m_schema_changed_tables; }
+
         static void begin_read(Realm&, VersionID);
     };
 
@@ -312,6 +552,8 @@ private:
     Config m_config;
     AnyExecutionContextID m_execution_context;
     bool m_auto_refresh = true;
+    bool m_frozen = false;
+    unsigned int m_scoped_read_depth = 0;
 
     std::unique_ptr<Replication> m_history;
     std::unique_ptr<SharedGroup> m_shared_group;
@@ -324,6 +566,11 @@ private:
     util::Optional<Schema> m_new_schema;
     uint64_t m_schema_transaction_version = -1;
 
+    // Group-level indices of the tables whose schema was changed by the most
+    // recent advance of the read transaction, filled in by the transact log
+    // parser and consumed by the schema change notification handler
+    std::vector<size_t> m_schema_changed_tables;
+
     // FIXME: this should be a Dynamic schema mode instead, but only once
     // that's actually fully working
     bool m_dynamic_schema = true;
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "static_schema.hpp"
+
+#include "object_schema.hpp"
+#include "schema.hpp"
+
+using namespace realm;
+
+static realm::Property realize_property(static_schema::Property const& prop)
+{
+    realm::Property result;
+    result.name = prop.name;
+    result.type = prop.type;
+    result.object_type = prop.object_type;
+    result.link_origin_property_name = prop.link_origin_property_name;
+    result.is_primary = prop.is_primary;
+    result.is_indexed = prop.is_indexed;
+    result.is_nullable = prop.is_nullable;
+    return result;
+}
+
+Schema static_schema::realize(SchemaDefinition const& def)
+{
+    std::vector<ObjectSchema> types;
+    types.reserve(def.count);
+    for (size_t i = 0; i < def.count; ++i) {
+        ObjectType const& type = def.types[i];
+        ObjectSchema object;
+        object.name = type.name;
+        object.primary_key = type.primary_key;
+        object.persisted_properties.reserve(type.persisted_property_count);
+        for (size_t j = 0; j < type.persisted_property_count; ++j)
+            object.persisted_properties.push_back(realize_property(type.properties[j]));
+        object.computed_properties.reserve(type.property_count - type.persisted_property_count);
+        for (size_t j = type.persisted_property_count; j < type.property_count; ++j)
+            object.computed_properties.push_back(realize_property(type.properties[j]));
+        types.push_back(std::move(object));
+    }
+
+    Schema schema(std::move(types));
+    schema.m_statically_validated = true;
+    return schema;
+}
@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_STATIC_SCHEMA_HPP
+#define REALM_STATIC_SCHEMA_HPP
+
+#include "property.hpp"
+
+#include <cstddef>
+
+namespace realm {
+class Schema;
+
+// A constexpr DSL for schemas which are fixed at build time.
+//
+// A schema described with these types is validated by the compiler: the
+// checks Schema::validate() would perform at runtime run during constant
+// evaluation, so an invalid schema fails to compile (the diagnostic points
+// at the schema() call and quotes the reason string from the throw
+// expression it could not evaluate). realize() then converts the definition
+// into a regular Schema exactly once, and validate() on the result skips
+// the already-performed checks.
+//
+//     using namespace realm::static_schema;
+//     using realm::PropertyType;
+//     constexpr Property person_properties[] = {
+//         property("name", PropertyType::String, realm::Property::PrimaryKey::yes),
+//         property("age", PropertyType::Int),
+//         object("dog", "dog"),
+//     };
+//     constexpr Property dog_properties[] = {
+//         property("name", PropertyType::String),
+//         linking_objects("owners", "person", "dog"),
+//     };
+//     constexpr ObjectType types[] = {
+//         object_type("person", person_properties),
+//         object_type("dog", dog_properties),
+//     };
+//     constexpr SchemaDefinition def = schema(types);
+//
+//     realm->update_schema(realize(def), 1);
+//
+// The property and object-type arrays must have static storage duration, as
+// the definition refers to them rather than copying them.
+namespace static_schema {
+
+// Thrown (at compile time, normally) when a definition is invalid
+struct InvalidSchemaDefinition {
+    const char* reason;
+};
+
+// The compile-time analogue of realm::Property. All strings are pointers
+// to string literals; "" rather than null means none.
+struct Property {
+    const char* name;
+    PropertyType type;
+    const char* object_type;
+    const char* link_origin_property_name;
+    bool is_primary;
+    bool is_indexed;
+    bool is_nullable;
+};
+
+// The compile-time analogue of ObjectSchema. The properties are stored in
+// one array with the persisted ones first, as in FrozenSchema.
+struct ObjectType {
+    const char* name;
+    const char* primary_key;
+    const Property* properties;
+    size_t persisted_property_count;
+    size_t property_count;
+};
+
+// A complete schema definition, produced (and validated) by schema()
+struct SchemaDefinition {
+    const ObjectType* types;
+    size_t count;
+};
+
+// A non-link property, with the same options as realm::Property::make()
+constexpr Property property(const char* name, PropertyType type,
+                            realm::Property::PrimaryKey is_primary = realm::Property::PrimaryKey::no,
+                            realm::Property::Indexed is_indexed = realm::Property::Indexed::no,
+                            realm::Property::Nullable is_nullable = realm::Property::Nullable::no)
+{
+    return {name, type, "", "",
+            is_primary == realm::Property::PrimaryKey::yes,
+            is_indexed == realm::Property::Indexed::yes,
+            is_nullable == realm::Property::Nullable::yes};
+}
+
+// A link to a single object of the named type (always nullable, as links
+// are required to be)
+constexpr Property object(const char* name, const char* object_type)
+{
+    return {name, PropertyType::Object, object_type, "", false, false, true};
+}
+
+// An array of objects of the named type
+constexpr Property array(const char* name, const char* object_type)
+{
+    return {name, PropertyType::Array, object_type, "", false, false, false};
+}
+
+// The objects of the named type which link to this object via the named
+// link property on that type
+constexpr Property linking_objects(const char* name, const char* object_type,
+                                   const char* link_origin_property_name)
+{
+    return {name, PropertyType::LinkingObjects, object_type, link_origin_property_name,
+            false, false, false};
+}
+
+constexpr bool str_equal(const char* a, const char* b)
+{
+    size_t i = 0;
+    while (a[i] && a[i] == b[i])
+        ++i;
+    return a[i] == b[i];
+}
+
+constexpr bool str_empty(const char* str)
+{
+    return str[0] == '\0';
+}
+
+constexpr bool type_is_indexable(PropertyType type)
+{
+    return type == PropertyType::Int
+        || type == PropertyType::Bool
+        || type == PropertyType::Date
+        || type == PropertyType::String;
+}
+
+constexpr bool type_is_nullable(PropertyType type)
+{
+    return type == PropertyType::Int
+        || type == PropertyType::Bool
+        || type == PropertyType::Float
+        || type == PropertyType::Double
+        || type == PropertyType::Date
+        || type == PropertyType::String
+        || type == PropertyType::Data
+        || type == PropertyType::Object;
+}
+
+// An object type with the given properties. Linking objects properties must
+// come after all persisted ones; the primary key is the property marked
+// PrimaryKey::yes, if any.
+template<size_t N>
+constexpr ObjectType object_type(const char* name, const Property (&properties)[N])
+{
+    size_t persisted_count = 0;
+    while (persisted_count < N && properties[persisted_count].type != PropertyType::LinkingObjects)
+        ++persisted_count;
+    for (size_t i = persisted_count; i < N; ++i) {
+        if (properties[i].type != PropertyType::LinkingObjects)
+            throw InvalidSchemaDefinition{"linking objects properties must come after all persisted properties"};
+    }
+
+    const char* primary_key = "";
+    for (size_t i = 0; i < N; ++i) {
+        if (properties[i].is_primary)
+            primary_key = properties[i].name;
+    }
+    return {name, primary_key, properties, persisted_count, N};
+}
+
+constexpr const ObjectType* find_type(const ObjectType* types, size_t count, const char* name)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (str_equal(types[i].name, name))
+            return &types[i];
+    }
+    return nullptr;
+}
+
+constexpr const Property* find_property(ObjectType const& object, const char* name)
+{
+    for (size_t i = 0; i < object.property_count; ++i) {
+        if (str_equal(object.properties[i].name, name))
+            return &object.properties[i];
+    }
+    return nullptr;
+}
+
+// The checks performed by ObjectSchema::validate(), restated over the
+// compile-time representation
+constexpr void validate_property(const ObjectType* types, size_t count,
+                                 ObjectType const& object, Property const& prop)
+{
+    if (prop.is_nullable && !type_is_nullable(prop.type))
+        throw InvalidSchemaDefinition{"property of this type cannot be nullable"};
+    if (prop.type == PropertyType::Object && !prop.is_nullable)
+        throw InvalidSchemaDefinition{"object link property must be nullable"};
+
+    if (prop.is_primary && !type_is_indexable(prop.type))
+        throw InvalidSchemaDefinition{"property of this type cannot be made the primary key"};
+    if (prop.is_primary && !str_equal(object.primary_key, prop.name))
+        throw InvalidSchemaDefinition{"object type has multiple primary key properties"};
+    if (prop.is_indexed && !type_is_indexable(prop.type))
+        throw InvalidSchemaDefinition{"property of this type cannot be indexed"};
+
+    if (prop.type != PropertyType::LinkingObjects && !str_empty(prop.link_origin_property_name))
+        throw InvalidSchemaDefinition{"only linking objects properties can have an origin property name"};
+    if (prop.type == PropertyType::LinkingObjects && str_empty(prop.link_origin_property_name))
+        throw InvalidSchemaDefinition{"linking objects property must have an origin property name"};
+
+    if (prop.type != PropertyType::Object && prop.type != PropertyType::Array
+        && prop.type != PropertyType::LinkingObjects) {
+        if (!str_empty(prop.object_type))
+            throw InvalidSchemaDefinition{"only link properties can have an object type"};
+        return;
+    }
+
+    const ObjectType* target = find_type(types, count, prop.object_type);
+    if (!target)
+        throw InvalidSchemaDefinition{"link property has unknown object type"};
+    if (prop.type != PropertyType::LinkingObjects)
+        return;
+
+    const Property* origin = find_property(*target, prop.link_origin_property_name);
+    if (!origin)
+        throw InvalidSchemaDefinition{"origin property of linking objects property does not exist"};
+    if (origin->type != PropertyType::Object && origin->type != PropertyType::Array)
+        throw InvalidSchemaDefinition{"origin property of linking objects property is not a link"};
+    if (!str_equal(origin->object_type, object.name))
+        throw InvalidSchemaDefinition{"origin property of linking objects property links to a different type"};
+}
+
+constexpr void validate_object_type(const ObjectType* types, size_t count, ObjectType const& object)
+{
+    for (size_t i = 0; i < object.property_count; ++i) {
+        Property const& prop = object.properties[i];
+        if ((prop.type == PropertyType::LinkingObjects) != (i >= object.persisted_property_count))
+            throw InvalidSchemaDefinition{"linking objects properties must come after all persisted properties"};
+        for (size_t j = 0; j < i; ++j) {
+            if (str_equal(object.properties[j].name, prop.name))
+                throw InvalidSchemaDefinition{"object type has multiple properties with the same name"};
+        }
+        validate_property(types, count, object, prop);
+    }
+
+    if (!str_empty(object.primary_key)) {
+        const Property* primary = find_property(object, object.primary_key);
+        if (!primary || !primary->is_primary)
+            throw InvalidSchemaDefinition{"specified primary key property does not exist"};
+    }
+}
+
+// Validate a complete schema. Evaluating this in a constant expression
+// turns any validation failure into a compile error.
+constexpr SchemaDefinition schema(const ObjectType* types, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (str_equal(types[j].name, types[i].name))
+                throw InvalidSchemaDefinition{"schema has multiple object types with the same name"};
+        }
+        validate_object_type(types, count, types[i]);
+    }
+    return {types, count};
+}
+
+template<size_t N>
+constexpr SchemaDefinition schema(const ObjectType (&types)[N])
+{
+    return schema(types, N);
+}
+
+// Convert a definition to the runtime representation. The result compares
+// equal to the Schema built from equivalent initializer lists, but its
+// validate() skips the checks the compiler has already performed.
+Schema realize(SchemaDefinition const&);
+
+} // namespace static_schema
+} // namespace realm
+
+#endif /* REALM_STATIC_SCHEMA_HPP */
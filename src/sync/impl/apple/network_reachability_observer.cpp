@@ -20,11 +20,17 @@
 
 #if NETWORK_REACHABILITY_AVAILABLE
 
+#include <algorithm>
+
 using namespace realm;
 using namespace realm::_impl;
 
 namespace {
 
+// Upper bound on how far the settle delay may grow while the network is
+// flapping, as a multiple of the configured quiet period.
+constexpr int c_max_settle_multiplier = 8;
+
 NetworkReachabilityStatus reachability_status_for_flags(SCNetworkReachabilityFlags flags)
 {
     if (!(flags & kSCNetworkReachabilityFlagsReachable))
@@ -49,8 +55,11 @@ NetworkReachabilityStatus reachability_status_for_flags(SCNetworkReachabilityFla
 } // (anonymous namespace)
 
 NetworkReachabilityObserver::NetworkReachabilityObserver(util::Optional<std::string> hostname,
-                                                         std::function<void (const NetworkReachabilityStatus)> handler)
-: m_callback_queue(dispatch_queue_create("io.realm.sync.reachability", DISPATCH_QUEUE_SERIAL))
+                                                         std::function<void (const NetworkReachabilityStatus)> handler,
+                                                         std::chrono::milliseconds quiet_period)
+: m_debounce(std::make_shared<DebounceState>())
+, m_quiet_period(quiet_period)
+, m_callback_queue(dispatch_queue_create("io.realm.sync.reachability", DISPATCH_QUEUE_SERIAL))
 , m_change_handler(std::move(handler))
 {
     if (hostname) {
@@ -84,7 +93,8 @@ NetworkReachabilityStatus NetworkReachabilityObserver::reachability_status() con
 
 bool NetworkReachabilityObserver::start_observing()
 {
-    m_previous_status = reachability_status();
+    m_debounce->delivered_status = reachability_status();
+    m_debounce->pending_status = m_debounce->delivered_status;
 
     auto callback = [](SCNetworkReachabilityRef, SCNetworkReachabilityFlags, void* self) {
         static_cast<NetworkReachabilityObserver*>(self)->reachability_changed();
@@ -107,21 +117,54 @@ void NetworkReachabilityObserver::stop_observing()
     SystemConfiguration::shared().network_reachability_set_callback(m_reachability_ref.get(), nullptr, nullptr);
 
     // Wait for all previously-enqueued blocks to execute to guarantee that
-    // no callback will be called after returning from this method
-    dispatch_sync(m_callback_queue, ^{});
+    // no callback will be called after returning from this method, and
+    // invalidate any deferred debounced delivery which hasn't fired yet
+    dispatch_sync(m_callback_queue, ^{
+        m_debounce->generation++;
+        m_debounce->settling = false;
+    });
 }
 
 void NetworkReachabilityObserver::reachability_changed()
 {
     auto current_status = reachability_status();
+    auto state = m_debounce;
 
     // When observing reachability of the specific host the callback might be called
     // several times (because of DNS queries) with the same reachability flags while
     // the caller should be notified only when the reachability status is really changed.
-    if (current_status != m_previous_status) {
-        m_change_handler(current_status);
-        m_previous_status = current_status;
+    if (state->settling ? current_status == state->pending_status
+                        : current_status == state->delivered_status)
+        return;
+
+    // Rather than reacting to every flap, wait for the status to hold steady
+    // for the settle delay before delivering it. Each additional flap while
+    // waiting supersedes the previous delivery and doubles the delay, so a
+    // connection bouncing several times a second settles down to one
+    // notification once it stabilizes.
+    state->pending_status = current_status;
+    auto expected_generation = ++state->generation;
+    if (state->settling) {
+        state->settle_delay = std::min(state->settle_delay * 2, m_quiet_period * c_max_settle_multiplier);
     }
+    else {
+        state->settling = true;
+        state->settle_delay = m_quiet_period;
+    }
+
+    auto handler = m_change_handler;
+    auto delay_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(state->settle_delay).count();
+    // The block deliberately captures the shared state rather than `this`,
+    // as it may fire after the observer has been destroyed.
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay_ns), m_callback_queue, ^{
+        if (state->generation != expected_generation)
+            return; // superseded by a newer flap or by stop_observing()
+        state->settling = false;
+        if (state->pending_status != state->delivered_status) {
+            state->delivered_status = state->pending_status;
+            handler(state->delivered_status);
+        }
+    });
 }
 
 #endif
@@ -19,7 +19,9 @@
 #ifndef REALM_OS_NETWORK_REACHABILITY_OBSERVER_HPP
 #define REALM_OS_NETWORK_REACHABILITY_OBSERVER_HPP
 
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <string>
 
 #include <realm/util/cf_ptr.hpp>
@@ -42,8 +44,13 @@ enum NetworkReachabilityStatus {
 
 class NetworkReachabilityObserver {
 public:
+    // `quiet_period` controls the debouncing of reachability changes: a
+    // change is passed to `handler` only once it has remained stable for at
+    // least this long. Repeated flapping while waiting doubles the wait (up
+    // to a bound) before the network is trusted again.
     NetworkReachabilityObserver(util::Optional<std::string> hostname,
-                                std::function<void (const NetworkReachabilityStatus)> handler);
+                                std::function<void (const NetworkReachabilityStatus)> handler,
+                                std::chrono::milliseconds quiet_period = std::chrono::milliseconds(500));
 
     ~NetworkReachabilityObserver();
 
@@ -55,8 +62,24 @@ public:
 private:
     void reachability_changed();
 
+    // State for debouncing reachability flaps. A status change is delivered
+    // only once it has remained stable for the settle delay, which starts at
+    // the quiet period and doubles with each flap while settling (bounded),
+    // so a flaky connection doesn't thrash the reconnect logic several times
+    // a second. All fields are accessed only on m_callback_queue. The state
+    // is shared with the deferred delivery blocks, which may outlive the
+    // observer; bumping the generation invalidates them.
+    struct DebounceState {
+        uint64_t generation = 0;
+        bool settling = false;
+        NetworkReachabilityStatus delivered_status = NotReachable;
+        NetworkReachabilityStatus pending_status = NotReachable;
+        std::chrono::milliseconds settle_delay = std::chrono::milliseconds(0);
+    };
+
     util::CFPtr<SCNetworkReachabilityRef> m_reachability_ref;
-    NetworkReachabilityStatus m_previous_status;
+    std::shared_ptr<DebounceState> m_debounce;
+    std::chrono::milliseconds m_quiet_period;
     dispatch_queue_t m_callback_queue;
     std::function<void (const NetworkReachabilityStatus)> m_change_handler;
 };
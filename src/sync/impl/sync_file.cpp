@@ -271,6 +271,10 @@ void SyncFileManager::remove_user_directory(const std::string& user_identity) co
                                                       user_identity,
                                                       util::FilePathType::Directory);
     util::remove_nonempty_dir(user_path);
+    // The cached paths promise that the user directory exists, which is no
+    // longer the case.
+    std::lock_guard<std::mutex> lock(m_path_cache_mutex);
+    m_path_cache.erase(user_identity);
 }
 
 bool SyncFileManager::remove_realm(const std::string& absolute_path) const
@@ -332,8 +336,19 @@ std::string SyncFileManager::path(const std::string& user_identity, const std::s
     if (filename_is_reserved(user_identity) || filename_is_reserved(raw_realm_path)) {
         throw std::invalid_argument("A user or Realm can't have an identifier reserved by the filesystem.");
     }
+    {
+        std::lock_guard<std::mutex> lock(m_path_cache_mutex);
+        auto user_it = m_path_cache.find(user_identity);
+        if (user_it != m_path_cache.end()) {
+            auto it = user_it->second.find(raw_realm_path);
+            if (it != user_it->second.end())
+                return it->second;
+        }
+    }
     auto escaped = util::make_percent_encoded_string(raw_realm_path);
     auto realm_path = util::file_path_by_appending_component(user_directory(user_identity), escaped);
+    std::lock_guard<std::mutex> lock(m_path_cache_mutex);
+    m_path_cache[user_identity][raw_realm_path] = realm_path;
     return realm_path;
 }
 
@@ -19,7 +19,9 @@
 #ifndef REALM_OS_SYNC_FILE_HPP
 #define REALM_OS_SYNC_FILE_HPP
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace realm {
 
@@ -68,6 +70,7 @@ public:
     void remove_user_directory(const std::string& user_identity) const;       // throws
 
     /// Return the path for a given Realm, creating the user directory if it does not already exist.
+    /// The result is cached, so repeated resolutions for the same user and Realm are a map hit.
     std::string path(const std::string& user_identity, const std::string& raw_realm_path) const;
 
     /// Remove the Realm at a given path for a given user. Returns `true` if the remove operation fully succeeds.
@@ -99,6 +102,15 @@ public:
 private:
     std::string m_base_path;
 
+    // Resolved Realm paths, keyed by user identity and then by the raw
+    // (unescaped) Realm path. Percent-encoding the path and ensuring the
+    // user directory exists shows up in startup profiles when many sessions
+    // resolve paths at once, and the resolution is deterministic, so it only
+    // needs doing once. A user's entries are dropped when their directory is
+    // removed, since `path()` also guarantees that the directory exists.
+    mutable std::mutex m_path_cache_mutex;
+    mutable std::unordered_map<std::string, std::unordered_map<std::string, std::string>> m_path_cache;
+
     static constexpr const char c_sync_directory[] = "realm-object-server";
     static constexpr const char c_utility_directory[] = "io.realm.object-server-utility";
     static constexpr const char c_recovery_directory[] = "io.realm.object-server-recovered-realms";
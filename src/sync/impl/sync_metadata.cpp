@@ -136,19 +136,105 @@ SyncMetadataManager::SyncMetadataManager(std::string path,
     m_metadata_config = std::move(config);
 }
 
+SyncMetadataManager::~SyncMetadataManager()
+{
+    try {
+        flush_user_state();
+    }
+    catch (...) {
+        // Opening the metadata Realm can fail; the lost updates will be
+        // re-fetched on the next launch.
+    }
+}
+
 Realm::Config SyncMetadataManager::get_configuration() const
 {
     std::lock_guard<std::mutex> lock(m_metadata_lock);
     return m_metadata_config;
 }
 
+void SyncMetadataManager::cache_user_state(const std::string& identity,
+                                           util::Optional<std::string> server_url,
+                                           util::Optional<std::string> user_token) const
+{
+    bool needs_flush;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_state_lock);
+        auto& state = m_pending_user_state[identity];
+        state.has_state = true;
+        state.server_url = std::move(server_url);
+        state.user_token = std::move(user_token);
+        needs_flush = m_pending_user_state.size() >= c_max_pending_user_updates;
+    }
+    if (needs_flush) {
+        flush_user_state();
+    }
+}
+
+void SyncMetadataManager::cache_user_is_admin(const std::string& identity, bool is_admin) const
+{
+    std::lock_guard<std::mutex> lock(m_pending_state_lock);
+    m_pending_user_state[identity].is_admin = is_admin;
+}
+
+util::Optional<SyncMetadataManager::PendingUserState>
+SyncMetadataManager::cached_user_state(const std::string& identity) const
+{
+    std::lock_guard<std::mutex> lock(m_pending_state_lock);
+    auto it = m_pending_user_state.find(identity);
+    if (it == m_pending_user_state.end()) {
+        return none;
+    }
+    return it->second;
+}
+
+void SyncMetadataManager::discard_user_state(const std::string& identity) const
+{
+    std::lock_guard<std::mutex> lock(m_pending_state_lock);
+    m_pending_user_state.erase(identity);
+}
+
+void SyncMetadataManager::flush_user_state() const
+{
+    std::unordered_map<std::string, PendingUserState> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_state_lock);
+        if (m_pending_user_state.empty()) {
+            return;
+        }
+        pending.swap(m_pending_user_state);
+    }
+
+    SharedRealm realm = Realm::get_shared_realm(get_configuration());
+    TableRef table = ObjectStore::table_for_object_type(realm->read_group(), c_sync_userMetadata);
+    realm->begin_transaction();
+    for (auto& entry : pending) {
+        size_t row_idx = table->find_first_string(m_user_schema.idx_identity, entry.first);
+        if (row_idx == not_found) {
+            // The user was removed before the flush; nothing to persist.
+            continue;
+        }
+        auto& state = entry.second;
+        if (state.has_state) {
+            table->set_string(m_user_schema.idx_user_token, row_idx, *state.user_token);
+            table->set_string(m_user_schema.idx_auth_server_url, row_idx, *state.server_url);
+        }
+        if (state.is_admin) {
+            table->set_bool(m_user_schema.idx_user_is_admin, row_idx, *state.is_admin);
+        }
+    }
+    realm->commit_transaction();
+}
+
 SyncUserMetadataResults SyncMetadataManager::all_unmarked_users() const
 {
+    flush_user_state();
     return get_users(false);
 }
 
 SyncUserMetadataResults SyncMetadataManager::all_users_marked_for_removal() const
 {
+    flush_user_state();
     return get_users(true);
 }
 
@@ -172,6 +258,25 @@ SyncFileActionMetadataResults SyncMetadataManager::all_pending_actions() const
     return SyncFileActionMetadataResults(std::move(results), std::move(realm), m_file_action_schema);
 }
 
+void SyncMetadataManager::remove_file_actions(std::vector<SyncFileActionMetadata>& actions) const
+{
+    if (actions.empty()) {
+        return;
+    }
+    // All the actions share the Realm of the results they were vended from,
+    // so the entire batch can be removed within one write transaction.
+    SharedRealm realm = actions.front().m_realm;
+    realm->verify_thread();
+    realm->begin_transaction();
+    TableRef table = ObjectStore::table_for_object_type(realm->read_group(), c_sync_fileActionMetadata);
+    for (auto& action : actions) {
+        REALM_ASSERT(action.m_realm == realm);
+        table->move_last_over(action.m_row.get_index());
+        action.m_realm = nullptr;
+    }
+    realm->commit_transaction();
+}
+
 // MARK: - Sync user metadata
 
 SyncUserMetadata::SyncUserMetadata(Schema schema, SharedRealm realm, RowExpr row)
@@ -183,6 +288,7 @@ SyncUserMetadata::SyncUserMetadata(Schema schema, SharedRealm realm, RowExpr row
 
 SyncUserMetadata::SyncUserMetadata(const SyncMetadataManager& manager, std::string identity, bool make_if_absent)
 : m_schema(manager.m_user_schema)
+, m_manager(&manager)
 {
     // Open the Realm.
     m_realm = Realm::get_shared_realm(manager.get_configuration());
@@ -210,10 +316,12 @@ SyncUserMetadata::SyncUserMetadata(const SyncMetadataManager& manager, std::stri
     }
     m_row = table->get(row_idx);
     if (make_if_absent) {
-        // User existed in the table, but had been marked for deletion. Unmark it.
-        m_realm->begin_transaction();
-        table->set_bool(m_schema.idx_marked_for_removal, row_idx, false);
-        m_realm->commit_transaction();
+        // If the user existed in the table but had been marked for deletion, unmark it.
+        if (m_row.get_bool(m_schema.idx_marked_for_removal)) {
+            m_realm->begin_transaction();
+            table->set_bool(m_schema.idx_marked_for_removal, row_idx, false);
+            m_realm->commit_transaction();
+        }
         m_invalid = false;
     } else {
         m_invalid = m_row.get_bool(m_schema.idx_marked_for_removal);
@@ -237,6 +345,13 @@ bool SyncUserMetadata::is_admin() const
 {
     REALM_ASSERT(m_realm);
     m_realm->verify_thread();
+    if (m_manager) {
+        if (auto pending = m_manager->cached_user_state(identity())) {
+            if (pending->is_admin) {
+                return *pending->is_admin;
+            }
+        }
+    }
     return m_row.get_bool(m_schema.idx_user_is_admin);
 }
 
@@ -250,11 +365,25 @@ util::Optional<std::string> SyncUserMetadata::get_optional_string_field(size_t c
 
 util::Optional<std::string> SyncUserMetadata::server_url() const
 {
+    if (m_manager) {
+        if (auto pending = m_manager->cached_user_state(identity())) {
+            if (pending->has_state) {
+                return pending->server_url;
+            }
+        }
+    }
     return get_optional_string_field(m_schema.idx_auth_server_url);
 }
 
 util::Optional<std::string> SyncUserMetadata::user_token() const
 {
+    if (m_manager) {
+        if (auto pending = m_manager->cached_user_state(identity())) {
+            if (pending->has_state) {
+                return pending->user_token;
+            }
+        }
+    }
     return get_optional_string_field(m_schema.idx_user_token);
 }
 
@@ -265,6 +394,13 @@ void SyncUserMetadata::set_state(util::Optional<std::string> server_url, util::O
     }
     REALM_ASSERT_DEBUG(m_realm);
     m_realm->verify_thread();
+    if (m_manager) {
+        // Token refreshes are frequent and fan out across every logged-in
+        // user, so they go through the manager's cache and get persisted in
+        // batches rather than one write transaction each.
+        m_manager->cache_user_state(identity(), std::move(server_url), std::move(user_token));
+        return;
+    }
     m_realm->begin_transaction();
     m_row.set_string(m_schema.idx_user_token, *user_token);
     m_row.set_string(m_schema.idx_auth_server_url, *server_url);
@@ -278,6 +414,10 @@ void SyncUserMetadata::set_is_admin(bool is_admin)
     }
     REALM_ASSERT_DEBUG(m_realm);
     m_realm->verify_thread();
+    if (m_manager) {
+        m_manager->cache_user_is_admin(identity(), is_admin);
+        return;
+    }
     m_realm->begin_transaction();
     m_row.set_bool(m_schema.idx_user_is_admin, is_admin);
     m_realm->commit_transaction();
@@ -297,6 +437,10 @@ void SyncUserMetadata::mark_for_removal()
 void SyncUserMetadata::remove()
 {
     m_invalid = true;
+    if (m_manager) {
+        // Any unflushed state update is for a row which is about to go away
+        m_manager->discard_user_state(identity());
+    }
     m_realm->begin_transaction();
     TableRef table = ObjectStore::table_for_object_type(m_realm->read_group(), c_sync_userMetadata);
     table->move_last_over(m_row.get_index());
@@ -20,6 +20,7 @@
 #define REALM_OS_SYNC_METADATA_HPP
 
 #include <string>
+#include <unordered_map>
 
 #include <realm/row.hpp>
 #include <realm/table.hpp>
@@ -77,6 +78,9 @@ private:
     Schema m_schema;
     SharedRealm m_realm;
     Row m_row;
+    // Set when constructed through the manager; routes state updates through
+    // the manager's write-back cache instead of a write transaction each
+    const SyncMetadataManager* m_manager = nullptr;
 };
 
 class SyncFileActionMetadata {
@@ -123,6 +127,8 @@ public:
 
     SyncFileActionMetadata(Schema schema, SharedRealm realm, RowExpr row);
 private:
+    friend class SyncMetadataManager;
+
     Schema m_schema;
     SharedRealm m_realm;
     Row m_row;
@@ -171,6 +177,12 @@ public:
     // Return a Results object containing all pending actions.
     SyncFileActionMetadataResults all_pending_actions() const;
 
+    // Remove a batch of completed file actions within a single write
+    // transaction on the metadata Realm, rather than paying a commit per
+    // action. All the actions must have been vended by the same
+    // `all_pending_actions()` call. The actions are invalidated.
+    void remove_file_actions(std::vector<SyncFileActionMetadata>& actions) const;
+
     Realm::Config get_configuration() const;
 
     /// Construct the metadata manager.
@@ -181,15 +193,48 @@ public:
     SyncMetadataManager(std::string path,
                         bool should_encrypt,
                         util::Optional<std::vector<char>> encryption_key=none);
+    ~SyncMetadataManager();
+
+    /// Write all user state updates which are so far only in the in-memory
+    /// cache to the metadata Realm in a single write transaction. Updates are
+    /// flushed automatically once enough of them accumulate, before any of
+    /// the Results-returning queries above, and on destruction; a crash
+    /// before a flush loses only updates which would be re-fetched on the
+    /// next launch anyway (e.g. access tokens).
+    void flush_user_state() const;
 
 private:
     SyncUserMetadataResults get_users(bool marked) const;
 
+    // User state updates applied to the in-memory cache but not yet to the
+    // metadata Realm. Reads through SyncUserMetadata consult this first, so
+    // batching the writes is not observable through the metadata API.
+    struct PendingUserState {
+        bool has_state = false;
+        util::Optional<std::string> server_url;
+        util::Optional<std::string> user_token;
+        util::Optional<bool> is_admin;
+    };
+
+    void cache_user_state(const std::string& identity,
+                          util::Optional<std::string> server_url,
+                          util::Optional<std::string> user_token) const;
+    void cache_user_is_admin(const std::string& identity, bool is_admin) const;
+    util::Optional<PendingUserState> cached_user_state(const std::string& identity) const;
+    void discard_user_state(const std::string& identity) const;
+
+    // Flush after this many distinct users have pending updates, so a burst
+    // of token refreshes across many users shares a few write transactions
+    static const size_t c_max_pending_user_updates = 16;
+
     Realm::Config m_metadata_config;
 
     SyncUserMetadata::Schema m_user_schema;
     SyncFileActionMetadata::Schema m_file_action_schema;
     mutable std::mutex m_metadata_lock;
+
+    mutable std::mutex m_pending_state_lock;
+    mutable std::unordered_map<std::string, PendingUserState> m_pending_user_state;
 };
 
 }
@@ -24,6 +24,9 @@
 #include "sync/sync_session.hpp"
 #include "sync/sync_user.hpp"
 
+#include <atomic>
+#include <thread>
+
 using namespace realm;
 using namespace realm::_impl;
 
@@ -96,9 +99,10 @@ void SyncManager::configure_file_system(const std::string& base_file_path,
                 completed_actions.emplace_back(std::move(file_action));
             }
         }
-        for (auto& action : completed_actions) {
-            action.remove();
-        }
+        // After a mass logout there can be hundreds of completed actions, so
+        // they are removed in a single metadata transaction rather than one
+        // commit each.
+        m_metadata_manager->remove_file_actions(completed_actions);
         // Load persisted users into the users map.
         SyncUserMetadataResults users = m_metadata_manager->all_unmarked_users();
         for (size_t i = 0; i < users.size(); i++) {
@@ -137,13 +141,12 @@ void SyncManager::configure_file_system(const std::string& base_file_path,
             user.remove();
         }
     }
-    {
-        std::lock_guard<std::mutex> lock(m_user_mutex);
-        for (auto& user_data : users_to_add) {
-            auto user = std::make_shared<SyncUser>(user_data.user_token, user_data.identity, user_data.server_url);
-            user->set_is_admin(user_data.is_admin);
-            m_users.insert({ user_data.identity, std::move(user) });
-        }
+    for (auto& user_data : users_to_add) {
+        auto user = std::make_shared<SyncUser>(user_data.user_token, user_data.identity, user_data.server_url);
+        user->set_is_admin(user_data.is_admin);
+        m_users.update(user_data.identity, [&](auto& users) {
+            return users.insert({ user_data.identity, std::move(user) }).second;
+        });
     }
 }
 
@@ -194,11 +197,8 @@ void SyncManager::reset_for_testing()
     std::lock_guard<std::mutex> lock(m_file_system_mutex);
     m_file_manager = nullptr;
     m_metadata_manager = nullptr;
-    {
-        // Destroy all the users.
-        std::lock_guard<std::mutex> lock(m_user_mutex);
-        m_users.clear();
-    }
+    // Destroy all the users.
+    m_users.clear();
     {
         std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -206,26 +206,31 @@ void SyncManager::reset_for_testing()
         if (m_sync_client)
             m_sync_client->stop();
 
-        {
-            std::lock_guard<std::mutex> lock(m_session_mutex);
-
 #if REALM_ASSERTIONS_ENABLED
-            // Callers of `SyncManager::reset_for_testing` should ensure there are no active sessions
-            // prior to calling `reset_for_testing`.
-            auto no_active_sessions = std::none_of(m_sessions.begin(), m_sessions.end(), [](auto& element){
-                return element.second->existing_external_reference();
-            });
-            REALM_ASSERT(no_active_sessions);
+        // Callers of `SyncManager::reset_for_testing` should ensure there are no active sessions
+        // prior to calling `reset_for_testing`.
+        bool no_active_sessions = true;
+        m_sessions.for_each([&](auto&, auto& session) {
+            if (session->existing_external_reference())
+                no_active_sessions = false;
+        });
+        REALM_ASSERT(no_active_sessions);
 #endif
 
-            // Destroy any inactive sessions.
-            // FIXME: We shouldn't have any inactive sessions at this point! Sessions are expected to
-            // remain inactive until their final upload completes, at which point they are unregistered
-            // and destroyed. Our call to `sync::Client::stop` above aborts all uploads, so all sessions
-            // should have already been destroyed.
-            m_sessions.clear();
+        // Drop any access-token requests still queued with the binding, along
+        // with the strong references they hold to the waiting sessions.
+        {
+            std::lock_guard<std::mutex> token_lock(m_token_request_mutex);
+            m_token_requests.clear();
         }
 
+        // Destroy any inactive sessions.
+        // FIXME: We shouldn't have any inactive sessions at this point! Sessions are expected to
+        // remain inactive until their final upload completes, at which point they are unregistered
+        // and destroyed. Our call to `sync::Client::stop` above aborts all uploads, so all sessions
+        // should have already been destroyed.
+        m_sessions.clear();
+
         // Destroy the client now that we have no remaining sessions.
         m_sync_client = nullptr;
 
@@ -303,67 +308,61 @@ std::shared_ptr<SyncUser> SyncManager::get_user(const std::string& identity,
                                                 util::Optional<std::string> auth_server_url,
                                                 SyncUser::TokenType token_type)
 {
-    std::lock_guard<std::mutex> lock(m_user_mutex);
-    auto it = m_users.find(identity);
-    if (it == m_users.end()) {
-        // No existing user.
-        auto new_user = std::make_shared<SyncUser>(std::move(refresh_token), identity, auth_server_url, token_type);
-        m_users.insert({ identity, new_user });
-        return new_user;
-    } else {
-        auto user = it->second;
-        if (auth_server_url && *auth_server_url != user->server_url()) {
-            throw std::invalid_argument("Cannot retrieve an existing user specifying a different auth server.");
-        }
-        if (user->token_type() != token_type) {
-            throw std::invalid_argument("Cannot retrieve a user specifying a different token type.");
-        }
-        if (user->state() == SyncUser::State::Error) {
-            return nullptr;
+    return m_users.update(identity, [&](auto& users) -> std::shared_ptr<SyncUser> {
+        auto it = users.find(identity);
+        if (it == users.end()) {
+            // No existing user.
+            auto new_user = std::make_shared<SyncUser>(std::move(refresh_token), identity, auth_server_url, token_type);
+            users.insert({ identity, new_user });
+            return new_user;
+        } else {
+            auto user = it->second;
+            if (auth_server_url && *auth_server_url != user->server_url()) {
+                throw std::invalid_argument("Cannot retrieve an existing user specifying a different auth server.");
+            }
+            if (user->token_type() != token_type) {
+                throw std::invalid_argument("Cannot retrieve a user specifying a different token type.");
+            }
+            if (user->state() == SyncUser::State::Error) {
+                return nullptr;
+            }
+            user->update_refresh_token(std::move(refresh_token));
+            return user;
         }
-        user->update_refresh_token(std::move(refresh_token));
-        return user;
-    }
+    });
 }
 
 std::shared_ptr<SyncUser> SyncManager::get_existing_logged_in_user(const std::string& identity) const
 {
-    std::lock_guard<std::mutex> lock(m_user_mutex);
-    auto it = m_users.find(identity);
-    if (it == m_users.end()) {
-        return nullptr;
-    }
-    auto ptr = it->second;
-    return (ptr->state() == SyncUser::State::Active ? ptr : nullptr);
+    auto user = m_users.get(identity);
+    return (user && user->state() == SyncUser::State::Active ? user : nullptr);
 }
 
 std::vector<std::shared_ptr<SyncUser>> SyncManager::all_logged_in_users() const
 {
-    std::lock_guard<std::mutex> lock(m_user_mutex);
     std::vector<std::shared_ptr<SyncUser>> users;
     users.reserve(m_users.size());
-    for (auto& it : m_users) {
-        auto user = it.second;
+    m_users.for_each([&](auto&, auto& user) {
         if (user->state() == SyncUser::State::Active) {
-            users.emplace_back(std::move(user));
+            users.emplace_back(user);
         }
-    }
+    });
     return users;
 }
 
 std::shared_ptr<SyncUser> SyncManager::get_current_user() const
 {
-    std::lock_guard<std::mutex> lock(m_user_mutex);
-    
-    auto is_active_user = [](auto& el) { return el.second->state() == SyncUser::State::Active; };
-    auto it = std::find_if(m_users.begin(), m_users.end(), is_active_user);
-    if (it == m_users.end()) {
-        return nullptr;
-    }
-    if (std::find_if(std::next(it), m_users.end(), is_active_user) != m_users.end()) {
-        throw std::logic_error("Current user is not valid if more that one valid, logged-in user exists.");
-    }
-    return it->second;
+    std::shared_ptr<SyncUser> current_user;
+    m_users.for_each([&](auto&, auto& user) {
+        if (user->state() != SyncUser::State::Active) {
+            return;
+        }
+        if (current_user) {
+            throw std::logic_error("Current user is not valid if more that one valid, logged-in user exists.");
+        }
+        current_user = user;
+    });
+    return current_user;
 }
 
 std::string SyncManager::path_for_realm(const std::string& user_identity, const std::string& raw_realm_url) const
@@ -382,29 +381,24 @@ std::string SyncManager::recovery_directory_path() const
 
 std::shared_ptr<SyncSession> SyncManager::get_existing_active_session(const std::string& path) const
 {
-    std::lock_guard<std::mutex> lock(m_session_mutex);
-    if (auto session = get_existing_session_locked(path)) {
+    if (auto session = m_sessions.get(path)) {
         if (auto external_reference = session->existing_external_reference())
             return external_reference;
     }
     return nullptr;
 }
 
-std::shared_ptr<SyncSession> SyncManager::get_existing_session_locked(const std::string& path) const
-{
-    REALM_ASSERT(!m_session_mutex.try_lock());
-    auto it = m_sessions.find(path);
-    if (it == m_sessions.end()) {
-        return nullptr;
-    }
-    return it->second;
-}
-
 std::shared_ptr<SyncSession> SyncManager::get_existing_session(const std::string& path) const
 {
-    std::lock_guard<std::mutex> lock(m_session_mutex);
-    if (auto session = get_existing_session_locked(path)) {
-        return session->external_reference();
+    // `unregister_session()` only removes a session which has no external
+    // references, so once we've created one and verified that the session is
+    // still registered it can no longer go away underneath us. If we instead
+    // lost the race and the session was unregistered in between the two
+    // loads, drop our reference to the dying session and check again.
+    while (auto session = m_sessions.get(path)) {
+        auto external_reference = session->external_reference();
+        if (m_sessions.get(path) == session)
+            return external_reference;
     }
     return nullptr;
 }
@@ -413,37 +407,165 @@ std::shared_ptr<SyncSession> SyncManager::get_session(const std::string& path, c
 {
     auto& client = get_sync_client(); // Throws
 
-    std::lock_guard<std::mutex> lock(m_session_mutex);
-    if (auto session = get_existing_session_locked(path)) {
-        sync_config.user->register_session(session);
-        return session->external_reference();
+    // Fast path: the session already exists, and can be returned without
+    // taking any locks. See `get_existing_session()` for why the second
+    // lookup makes this safe against concurrent unregistration.
+    while (auto session = m_sessions.get(path)) {
+        auto external_reference = session->external_reference();
+        if (m_sessions.get(path) == session) {
+            sync_config.user->register_session(session);
+            return external_reference;
+        }
     }
 
-    std::shared_ptr<SyncSession> shared_session(new SyncSession(client, path, sync_config));
-    m_sessions[path] = shared_session;
+    return m_sessions.update(path, [&](auto& sessions) -> std::shared_ptr<SyncSession> {
+        auto it = sessions.find(path);
+        if (it != sessions.end()) {
+            sync_config.user->register_session(it->second);
+            return it->second->external_reference();
+        }
+
+        std::shared_ptr<SyncSession> shared_session(new SyncSession(client, path, sync_config));
+        sessions[path] = shared_session;
 
-    // Create the external reference immediately to ensure that the session will become
-    // inactive if an exception is thrown in the following code.
-    auto external_reference = shared_session->external_reference();
+        // Create the external reference immediately to ensure that the session will become
+        // inactive if an exception is thrown in the following code.
+        auto external_reference = shared_session->external_reference();
 
-    sync_config.user->register_session(shared_session);
+        sync_config.user->register_session(shared_session);
 
-    return external_reference;
+        return external_reference;
+    });
 }
 
-void SyncManager::unregister_session(const std::string& path)
+void SyncManager::revive_all_sessions()
+{
+    std::vector<std::shared_ptr<SyncSession>> sessions;
+    m_sessions.for_each([&](auto&, auto& session) {
+        sessions.push_back(session);
+    });
+    if (sessions.empty())
+        return;
+
+    // Each revival invokes the binding's bind handler, which typically makes
+    // a (possibly synchronous) network request for an access token. Run them
+    // on separate threads so the round trips overlap; sessions which don't
+    // need reviving return without invoking their handler at all.
+    std::vector<std::thread> revivals;
+    revivals.reserve(sessions.size());
+    for (auto& session : sessions) {
+        revivals.emplace_back([session] {
+            session->revive_if_needed();
+        });
+    }
+    for (auto& revival : revivals)
+        revival.join();
+}
+
+void SyncManager::wait_for_all_uploads(std::function<void(std::error_code)> callback)
+{
+    std::vector<std::shared_ptr<SyncSession>> sessions;
+    m_sessions.for_each([&](auto&, auto& session) {
+        sessions.push_back(session);
+    });
+
+    struct WaitState {
+        std::function<void(std::error_code)> callback;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> has_error;
+        std::error_code error;
+    };
+    auto state = std::make_shared<WaitState>();
+    state->callback = std::move(callback);
+    // Start the countdown one above the number of sessions so the callback
+    // cannot fire while registration is still in progress; the deficit is
+    // settled below once every session has been offered a handler.
+    state->remaining = sessions.size() + 1;
+    state->has_error = false;
+
+    size_t unregistered = 1;
+    for (auto& session : sessions) {
+        bool registered = session->wait_for_upload_completion([state](std::error_code error) {
+            // Only the first session to report an error stores it; storing
+            // happens before this session's decrement, so the error is
+            // visible to whichever session performs the final decrement.
+            if (error && !state->has_error.exchange(true))
+                state->error = error;
+            if (state->remaining.fetch_sub(1) == 1)
+                state->callback(state->error);
+        });
+        if (!registered)
+            ++unregistered;
+    }
+    if (state->remaining.fetch_sub(unregistered) == unregistered)
+        state->callback(state->error);
+}
+
+static std::string token_request_key(const SyncConfig& config)
 {
-    std::lock_guard<std::mutex> lock(m_session_mutex);
-    auto it = m_sessions.find(path);
-    REALM_ASSERT(it != m_sessions.end());
-
-    // If the session has an active external reference, leave it be. This will happen if the session
-    // moves to an inactive state while still externally reference, for instance, as a result of
-    // the session's user being logged out.
-    if (it->second->existing_external_reference())
+    // Distinct users, and the same user identity on distinct servers, hold
+    // distinct refresh tokens, so their requests can't be coalesced.
+    return config.user->identity() + '\0' + config.user->server_url();
+}
+
+void SyncManager::request_access_token(std::shared_ptr<SyncSession> session)
+{
+    auto& config = session->config();
+    if (!config.bind_session_handler)
         return;
+    {
+        std::lock_guard<std::mutex> lock(m_token_request_mutex);
+        auto& state = m_token_requests[token_request_key(config)];
+        if (state.in_flight) {
+            // The binding is already servicing a request for this user's
+            // credentials; queue this session behind it rather than asking
+            // for a redundant refresh.
+            state.waiting.push_back(std::move(session));
+            return;
+        }
+        state.in_flight = session.get();
+    }
+    // The handler may call straight back into the session (and from there
+    // into this manager), so it can't be invoked with the lock held.
+    config.bind_session_handler(session->path(), config, session);
+}
+
+void SyncManager::access_token_request_complete(SyncSession& session)
+{
+    std::vector<std::shared_ptr<SyncSession>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(m_token_request_mutex);
+        auto it = m_token_requests.find(token_request_key(session.config()));
+        if (it == m_token_requests.end() || it->second.in_flight != &session)
+            return;
+        waiting = std::move(it->second.waiting);
+        m_token_requests.erase(it);
+    }
+    // The binding has just finished refreshing this user's credentials, so
+    // the queued sessions can now all be bound without each triggering
+    // another refresh. Their per-path access tokens are independent, so fan
+    // them out rather than trickling them through one at a time.
+    for (auto& queued : waiting) {
+        auto& config = queued->config();
+        config.bind_session_handler(queued->path(), config, queued);
+    }
+}
+
+void SyncManager::unregister_session(const std::string& path)
+{
+    m_sessions.update(path, [&](auto& sessions) {
+        auto it = sessions.find(path);
+        REALM_ASSERT(it != sessions.end());
+
+        // If the session has an active external reference, leave it be. This will happen if the session
+        // moves to an inactive state while still externally reference, for instance, as a result of
+        // the session's user being logged out.
+        if (it->second->existing_external_reference())
+            return false;
 
-    m_sessions.erase(path);
+        sessions.erase(it);
+        return true;
+    });
 }
 
 SyncClient& SyncManager::get_sync_client() const
@@ -22,14 +22,17 @@
 #include "shared_realm.hpp"
 
 #include "sync_user.hpp"
+#include "util/atomic_shared_ptr.hpp"
 
 #include <realm/sync/client.hpp>
 #include <realm/util/logger.hpp>
 #include <realm/util/optional.hpp>
 
+#include <array>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace realm {
 
@@ -98,6 +101,23 @@ public:
     std::shared_ptr<SyncSession> get_existing_session(const std::string& path) const;
     std::shared_ptr<SyncSession> get_existing_active_session(const std::string& path) const;
 
+    // Ask every session registered with the manager to revive itself, as if
+    // `revive_if_needed()` had been called on each. The revivals run
+    // concurrently, so the bind handlers for many Realms opened at launch
+    // overlap instead of paying one access-token round trip per Realm. This
+    // method blocks until every bind handler has been invoked.
+    void revive_all_sessions();
+
+    // Register a callback that will be called once every session registered
+    // with the manager has finished uploading its pending changes. Completion
+    // is aggregated internally with a single countdown rather than requiring
+    // the caller to juggle one `wait_for_upload_completion()` callback per
+    // session. The callback is passed the first error reported by any
+    // session, or a default-constructed `std::error_code` on success, and is
+    // run on whatever thread the last session completes on — which is the
+    // calling thread if no session accepts a completion handler.
+    void wait_for_all_uploads(std::function<void(std::error_code)> callback);
+
     // If the metadata manager is configured, perform an update. Returns `true` iff the code was run.
     bool perform_metadata_update(std::function<void(const SyncMetadataManager&)> update_function) const;
 
@@ -128,11 +148,115 @@ public:
 private:
     using ReconnectMode = sync::Client::ReconnectMode;
 
+    // A string-keyed map sharded by a hash of the key, with each shard
+    // guarded by its own mutex. Mutations additionally publish an immutable
+    // snapshot of the shard's contents, so lookups of existing entries never
+    // take a lock at all. This trades a map copy on the (rare) registration
+    // and unregistration paths for contention-free lookups when sessions are
+    // created from many threads at once.
+    template<typename Value>
+    class ShardedMap {
+    public:
+        using Map = std::unordered_map<std::string, Value>;
+
+        // Look up `key` in its shard's current snapshot without locking.
+        // Returns a null pointer if the key is not present.
+        Value get(const std::string& key) const noexcept
+        {
+            if (auto map = shard_for(key).snapshot.load()) {
+                auto it = map->find(key);
+                if (it != map->end())
+                    return it->second;
+            }
+            return nullptr;
+        }
+
+        // Call `fn` with the map owning `key` while holding that shard's
+        // lock, then publish the updated map as the shard's new snapshot.
+        template<typename Fn>
+        auto update(const std::string& key, Fn&& fn)
+        {
+            auto& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto result = fn(shard.map);
+            shard.snapshot.exchange(std::make_shared<const Map>(shard.map));
+            return result;
+        }
+
+        // Call `fn` with each (key, value) pair. This iterates over each
+        // shard's snapshot, so entries added or removed concurrently may or
+        // may not be visited.
+        template<typename Fn>
+        void for_each(Fn&& fn) const
+        {
+            for (auto& shard : m_shards) {
+                if (auto map = shard.snapshot.load()) {
+                    for (auto& pair : *map)
+                        fn(pair.first, pair.second);
+                }
+            }
+        }
+
+        size_t size() const noexcept
+        {
+            size_t size = 0;
+            for (auto& shard : m_shards) {
+                if (auto map = shard.snapshot.load())
+                    size += map->size();
+            }
+            return size;
+        }
+
+        void clear()
+        {
+            for (auto& shard : m_shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.map.clear();
+                shard.snapshot.exchange(nullptr);
+            }
+        }
+
+    private:
+        struct Shard {
+            std::mutex mutex;
+            Map map;
+            util::AtomicSharedPtr<const Map> snapshot;
+        };
+        static constexpr size_t c_shard_count = 16;
+
+        Shard& shard_for(const std::string& key) noexcept
+        {
+            return m_shards[std::hash<std::string>()(key) % c_shard_count];
+        }
+        const Shard& shard_for(const std::string& key) const noexcept
+        {
+            return m_shards[std::hash<std::string>()(key) % c_shard_count];
+        }
+
+        std::array<Shard, c_shard_count> m_shards;
+    };
+
     // Stop tracking the session for the given path if it is inactive.
     // No-op if the session is either still active or in the active sessions list
     // due to someone holding a strong reference to it.
     void unregister_session(const std::string& path);
 
+    // Invoke `session`'s bind handler to ask the binding for an access token,
+    // coalescing bursts of requests for the same user: while a request for a
+    // given user and auth server is outstanding, further sessions are queued
+    // rather than each invoking their own handler, and are dispatched together
+    // once the outstanding request completes. When a user's credentials
+    // expire every one of their sessions discovers it at about the same time,
+    // and without the coalescing each of them would trigger a redundant
+    // refresh of the same refresh token.
+    void request_access_token(std::shared_ptr<SyncSession> session);
+
+    // Called by a session when its access-token request has concluded,
+    // whether because a token arrived, the session was logged out, or it
+    // errored out. Dispatches the bind handlers of any sessions queued behind
+    // the request. No-op for sessions with no outstanding request.
+    void access_token_request_complete(SyncSession& session);
+
     SyncManager() = default;
     SyncManager(const SyncManager&) = delete;
     SyncManager& operator=(const SyncManager&) = delete;
@@ -140,8 +264,6 @@ private:
     _impl::SyncClient& get_sync_client() const;
     std::unique_ptr<_impl::SyncClient> create_sync_client() const;
 
-    std::shared_ptr<SyncSession> get_existing_session_locked(const std::string& path) const;
-
     mutable std::mutex m_mutex;
 
     // FIXME: Should probably be util::Logger::Level::error
@@ -152,11 +274,8 @@ private:
 
     bool run_file_action(const SyncFileActionMetadata&);
 
-    // Protects m_users
-    mutable std::mutex m_user_mutex;
-
     // A map of user identities to (shared pointers to) SyncUser objects.
-    std::unordered_map<std::string, std::shared_ptr<SyncUser>> m_users;
+    ShardedMap<std::shared_ptr<SyncUser>> m_users;
 
     mutable std::unique_ptr<_impl::SyncClient> m_sync_client;
 
@@ -165,13 +284,21 @@ private:
     std::unique_ptr<SyncFileManager> m_file_manager;
     std::unique_ptr<SyncMetadataManager> m_metadata_manager;
 
-    // Protects m_sessions
-    mutable std::mutex m_session_mutex;
-
     // Map of sessions by path name.
     // Sessions remove themselves from this map by calling `unregister_session` once they're
     // inactive and have performed any necessary cleanup work.
-    std::unordered_map<std::string, std::shared_ptr<SyncSession>> m_sessions;
+    ShardedMap<std::shared_ptr<SyncSession>> m_sessions;
+
+    // Access-token requests currently being serviced by the binding, keyed by
+    // user identity and auth server. While a request for a key is in flight,
+    // sessions needing a token for the same key queue behind it rather than
+    // each invoking their bind handler.
+    struct TokenRequestState {
+        SyncSession* in_flight = nullptr;
+        std::vector<std::shared_ptr<SyncSession>> waiting;
+    };
+    mutable std::mutex m_token_request_mutex;
+    std::unordered_map<std::string, TokenRequestState> m_token_requests;
 };
 
 } // namespace realm
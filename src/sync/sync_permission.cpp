@@ -74,6 +74,18 @@ Permission PermissionResults::get(size_t index)
     };
 }
 
+PermissionResults PermissionResults::page(size_t limit, util::Optional<std::string> cursor) const
+{
+    auto table = ObjectStore::table_for_object_type(m_results.get_realm()->read_group(), "Permission");
+    size_t col_idx = table->get_descriptor()->get_column_index("path");
+    auto results = m_results;
+    if (cursor) {
+        results = results.filter(table->column<StringData>(col_idx) > StringData(*cursor));
+    }
+    results = results.sort(SortDescriptor(*table, {{col_idx}}, {true}));
+    return PermissionResults(results.limit(limit));
+}
+
 // MARK: - Permissions
 
 // A wrapper that stores a value and an associated notification token.
@@ -93,6 +93,23 @@ public:
         return m_results.async(std::move(target));
     }
 
+    // Run the query on a background thread and invoke `target` exactly once
+    // when the initial results are ready, without evaluating them on the
+    // calling thread.
+    NotificationToken evaluate_async(std::function<void(std::exception_ptr)> target)
+    {
+        return m_results.evaluate_async(std::move(target));
+    }
+
+    // Create a new instance representing a single page of this instance's
+    // permissions, ordered by Realm path. `limit` bounds the size of the
+    // page, and `cursor`, if given, is the path of the last permission of the
+    // previous page; only permissions for paths greater than it are included.
+    // Paired with `evaluate_async()`, this lets a permission screen render
+    // its first page in time proportional to the page size rather than the
+    // total number of grants.
+    PermissionResults page(size_t limit, util::Optional<std::string> cursor = util::none) const;
+
     // Create a new instance by further filtering this instance.
     PermissionResults filter(Query&& q) const
     {
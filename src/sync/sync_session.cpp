@@ -27,6 +27,8 @@
 #include <realm/sync/client.hpp>
 #include <realm/sync/protocol.hpp>
 
+#include <thread>
+
 
 using namespace realm;
 using namespace realm::_impl;
@@ -171,7 +173,7 @@ struct sync_session_states::WaitingForAccessToken : public SyncSession::State {
 
         session.advance_state(lock, active);
         if (session.m_deferred_close) {
-            session.m_state->close(lock, session);
+            session.m_state.load()->close(lock, session);
         }
     }
 
@@ -231,7 +233,10 @@ struct sync_session_states::Active : public SyncSession::State {
         session.advance_state(lock, waiting_for_access_token);
         std::shared_ptr<SyncSession> session_ptr = session.shared_from_this();
         lock.unlock();
-        session.m_config.bind_session_handler(session_ptr->m_realm_path, session_ptr->m_config, session_ptr);
+        // When a user's token expires every one of their sessions finds out
+        // at about the same time, so route the request through the manager,
+        // which coalesces concurrent requests for the same user.
+        SyncManager::shared().request_access_token(std::move(session_ptr));
         return false;
     }
 
@@ -339,7 +344,7 @@ struct sync_session_states::Inactive : public SyncSession::State {
     {
         session.create_sync_session();
         session.advance_state(lock, waiting_for_access_token);
-        session.m_state->refresh_access_token(lock, session, admin_token, server_url);
+        session.m_state.load()->refresh_access_token(lock, session, admin_token, server_url);
     }
 
     bool revive_if_needed(std::unique_lock<std::mutex>& lock, SyncSession& session) const override
@@ -402,7 +407,7 @@ void SyncSession::handle_error(SyncError error)
     {
         // See if the current state wishes to take responsibility for handling the error.
         std::unique_lock<std::mutex> lock(m_state_mutex);
-        if (m_state->handle_error(lock, *this, error)) {
+        if (m_state.load()->handle_error(lock, *this, error)) {
             return;
         }
     }
@@ -436,7 +441,7 @@ void SyncSession::handle_error(SyncError error)
                 std::unique_lock<std::mutex> lock(m_state_mutex);
                 // This isn't an error from the binding's point of view. If we're connected we'll
                 // simply ask the binding to log in again.
-                m_state->access_token_expired(lock, *this);
+                m_state.load()->access_token_expired(lock, *this);
                 return;
             }
             case ProtocolError::bad_authentication: {
@@ -449,6 +454,7 @@ void SyncSession::handle_error(SyncError error)
                 }
                 if (user_to_invalidate)
                     user_to_invalidate->invalidate();
+                SyncManager::shared().access_token_request_complete(*this);
                 break;
             }
             case ProtocolError::illegal_realm_path:
@@ -512,8 +518,13 @@ void SyncSession::handle_error(SyncError error)
         return;
     }
     if (should_invalidate_session) {
-        std::unique_lock<std::mutex> lock(m_state_mutex);
-        advance_state(lock, State::error);
+        {
+            std::unique_lock<std::mutex> lock(m_state_mutex);
+            advance_state(lock, State::error);
+        }
+        // An errored-out session is never going to deliver its access token,
+        // so release any sessions queued behind its request.
+        SyncManager::shared().access_token_request_complete(*this);
     }
     if (m_error_handler) {
         m_error_handler(shared_from_this(), std::move(error));
@@ -529,10 +540,28 @@ void SyncSession::handle_progress_update(uint64_t downloaded, uint64_t downloada
         m_current_progress = Progress{uploadable, downloadable, uploaded, downloaded};
         m_latest_progress_data_is_fresh = is_fresh;
 
+        // The sync client reports progress far more often than anyone
+        // watching a progress bar benefits from, and posting every report to
+        // the event loop gets expensive with several large transfers in
+        // flight. Reports arriving within the notification interval of the
+        // last delivered one are coalesced: we record the progress and skip
+        // the callbacks, and the next delivered report carries the latest
+        // values. Reports which leave no bytes outstanding or complete a
+        // non-streaming notifier are always delivered, so the final state of
+        // a transfer is never dropped.
+        auto now = std::chrono::steady_clock::now();
+        bool deliver = now - m_last_progress_notification >= m_progress_notification_interval
+                    || (downloaded >= downloadable && uploaded >= uploadable);
+        for (auto& pair : m_notifiers) {
+            pair.second.update(*m_current_progress, is_fresh);
+            deliver = deliver || pair.second.is_expired(*m_current_progress);
+        }
+        if (!deliver)
+            return;
+        m_last_progress_notification = now;
+
         for (auto it = m_notifiers.begin(); it != m_notifiers.end();) {
             auto& package = it->second;
-            package.update(*m_current_progress, is_fresh);
-
             bool should_delete = false;
             invocations.emplace_back(package.create_invocation(*m_current_progress, should_delete));
 
@@ -554,6 +583,17 @@ void SyncSession::NotifierPackage::update(const Progress& current_progress, bool
                                                                  : current_progress.uploadable;
 }
 
+// A notifier is expired if at least as many bytes have been transferred
+// as were originally considered transferrable.
+bool SyncSession::NotifierPackage::is_expired(const Progress& current_progress) const
+{
+    if (is_streaming || !captured_transferrable)
+        return false;
+    uint64_t transferred = direction == NotifierType::download ? current_progress.downloaded
+                                                               : current_progress.uploaded;
+    return transferred >= *captured_transferrable;
+}
+
 // PRECONDITION: `update()` must first be called on the same package.
 std::function<void()> SyncSession::NotifierPackage::create_invocation(const Progress& current_progress,
                                                                       bool& is_expired) const
@@ -574,9 +614,7 @@ std::function<void()> SyncSession::NotifierPackage::create_invocation(const Prog
     } else {
         transferrable = *captured_transferrable;
     }
-    // A notifier is expired if at least as many bytes have been transferred
-    // as were originally considered transferrable.
-    is_expired = !is_streaming && transferred >= *captured_transferrable;
+    is_expired = this->is_expired(current_progress);
     return [=, package=*this](){
         package.notifier(transferred, transferrable);
     };
@@ -588,7 +626,7 @@ void SyncSession::create_sync_session()
     sync::Session::Config session_config;
     session_config.changeset_cooker = m_config.transformer;
     session_config.encryption_key = m_config.realm_encryption_key;
-    m_session = std::make_unique<sync::Session>(m_client.client, m_realm_path, session_config);
+    m_session = std::make_shared<sync::Session>(m_client.client, m_realm_path, session_config);
 
     // The next time we get a token, call `bind()` instead of `refresh()`.
     m_session_has_been_bound = false;
@@ -642,37 +680,91 @@ void SyncSession::advance_state(std::unique_lock<std::mutex>& lock, const State&
     REALM_ASSERT(lock.owns_lock());
     REALM_ASSERT(&state != m_state);
     m_state = &state;
-    m_state->enter_state(lock, *this);
+    // Publish the session for the lock-free commit-notify fast path only
+    // while fully active; m_session is kept alive by any in-progress fast
+    // path even if the transition destroys it below
+    m_active_session.exchange(&state == &State::active ? m_session : nullptr);
+    m_state.load()->enter_state(lock, *this);
 }
 
 void SyncSession::nonsync_transact_notify(sync::Session::version_type version)
 {
+    // The sync client batches uploads internally, so nudging it for every
+    // commit of a bulk-ingest burst is pure overhead. The first commit in a
+    // burst is delivered immediately; commits arriving within the interval
+    // after a delivery just record the latest version, and a single deferred
+    // notification hands that version to the client once the interval
+    // expires. An isolated commit always takes the immediate path, so
+    // interactive workloads see no added upload latency.
+    static constexpr auto c_notify_interval = std::chrono::milliseconds(50);
+
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto last = m_last_transact_notify.load();
+    if (now - last >= std::chrono::steady_clock::duration(c_notify_interval).count()
+        && m_last_transact_notify.compare_exchange_strong(last, now)) {
+        deliver_nonsync_transact_notify(version);
+        return;
+    }
+
+    // Record the version for the deferred notification; commit versions
+    // only grow, so the largest one seen covers the whole burst
+    auto pending = m_pending_transact_version.load();
+    while (version > pending && !m_pending_transact_version.compare_exchange_weak(pending, version)) {
+    }
+
+    if (m_transact_notify_scheduled.exchange(true))
+        return;
+    std::thread([self = shared_from_this()] {
+        std::this_thread::sleep_for(c_notify_interval);
+        self->m_last_transact_notify = std::chrono::steady_clock::now().time_since_epoch().count();
+        self->m_transact_notify_scheduled = false;
+        if (auto version = self->m_pending_transact_version.exchange(0))
+            self->deliver_nonsync_transact_notify(version);
+    }).detach();
+}
+
+void SyncSession::deliver_nonsync_transact_notify(sync::Session::version_type version)
+{
+    // Fast path: when fully active the notification goes straight to the
+    // (internally thread-safe) sync session without serializing against
+    // token refreshes and other connection management on m_state_mutex.
+    if (auto session = m_active_session.load()) {
+        session->nonsync_transact_notify(version);
+        return;
+    }
     std::unique_lock<std::mutex> lock(m_state_mutex);
-    m_state->nonsync_transact_notify(lock, *this, version);
+    m_state.load()->nonsync_transact_notify(lock, *this, version);
 }
 
 void SyncSession::revive_if_needed()
 {
-    util::Optional<std::function<SyncBindSessionHandler>&> handler;
+    bool needs_token = false;
     {
         std::unique_lock<std::mutex> lock(m_state_mutex);
-        if (m_state->revive_if_needed(lock, *this))
-            handler = m_config.bind_session_handler;
+        needs_token = m_state.load()->revive_if_needed(lock, *this);
     }
-    if (handler)
-        handler.value()(m_realm_path, m_config, shared_from_this());
+    // Binding the session is routed through the manager so that reviving
+    // many of one user's sessions at once doesn't ask the binding to refresh
+    // the same credentials over and over.
+    if (needs_token)
+        SyncManager::shared().request_access_token(shared_from_this());
 }
 
 void SyncSession::log_out()
 {
-    std::unique_lock<std::mutex> lock(m_state_mutex);
-    m_state->log_out(lock, *this);
+    {
+        std::unique_lock<std::mutex> lock(m_state_mutex);
+        m_state.load()->log_out(lock, *this);
+    }
+    // A logged-out session is never going to deliver its access token, so
+    // release any sessions queued behind its request.
+    SyncManager::shared().access_token_request_complete(*this);
 }
 
 void SyncSession::close()
 {
     std::unique_lock<std::mutex> lock(m_state_mutex);
-    m_state->close(lock, *this);
+    m_state.load()->close(lock, *this);
 }
 
 void SyncSession::unregister(std::unique_lock<std::mutex>& lock)
@@ -687,13 +779,13 @@ void SyncSession::unregister(std::unique_lock<std::mutex>& lock)
 bool SyncSession::wait_for_upload_completion(std::function<void(std::error_code)> callback)
 {
     std::unique_lock<std::mutex> lock(m_state_mutex);
-    return m_state->wait_for_completion(*this, std::move(callback), &sync::Session::async_wait_for_upload_completion);
+    return m_state.load()->wait_for_completion(*this, std::move(callback), &sync::Session::async_wait_for_upload_completion);
 }
 
 bool SyncSession::wait_for_download_completion(std::function<void(std::error_code)> callback)
 {
     std::unique_lock<std::mutex> lock(m_state_mutex);
-    return m_state->wait_for_completion(*this, std::move(callback), &sync::Session::async_wait_for_download_completion);
+    return m_state.load()->wait_for_completion(*this, std::move(callback), &sync::Session::async_wait_for_download_completion);
 }
 
 uint64_t SyncSession::register_progress_notifier(std::function<SyncProgressNotifierCallback> notifier,
@@ -729,34 +821,48 @@ void SyncSession::unregister_progress_notifier(uint64_t token)
     m_notifiers.erase(token);
 }
 
+void SyncSession::set_progress_notification_interval(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lock(m_progress_notifier_mutex);
+    m_progress_notification_interval = interval;
+}
+
 void SyncSession::refresh_access_token(std::string access_token, util::Optional<std::string> server_url)
 {
-    std::unique_lock<std::mutex> lock(m_state_mutex);
-    if (!m_server_url && !server_url) {
-        // The first time this method is called, the server URL must be provided.
-        return;
+    {
+        std::unique_lock<std::mutex> lock(m_state_mutex);
+        if (!m_server_url && !server_url) {
+            // The first time this method is called, the server URL must be provided.
+            return;
+        }
+        m_state.load()->refresh_access_token(lock, *this, std::move(access_token), server_url);
     }
-    m_state->refresh_access_token(lock, *this, std::move(access_token), server_url);
+    // Completing this session's request may dispatch the bind handlers of
+    // sessions queued behind it in the manager, which must happen outside
+    // the state lock.
+    SyncManager::shared().access_token_request_complete(*this);
 }
 
 void SyncSession::bind_with_admin_token(std::string admin_token, std::string server_url)
 {
     std::unique_lock<std::mutex> lock(m_state_mutex);
-    m_state->bind_with_admin_token(lock, *this, admin_token, server_url);
+    m_state.load()->bind_with_admin_token(lock, *this, admin_token, server_url);
 }
 
 SyncSession::PublicState SyncSession::state() const
 {
-    std::unique_lock<std::mutex> lock(m_state_mutex);
-    if (m_state == &State::waiting_for_access_token) {
+    // The state pointer is atomic, and the answer is inherently stale the
+    // moment it is returned, so there is nothing for the lock to protect here
+    const State* state = m_state;
+    if (state == &State::waiting_for_access_token) {
         return PublicState::WaitingForAccessToken;
-    } else if (m_state == &State::active) {
+    } else if (state == &State::active) {
         return PublicState::Active;
-    } else if (m_state == &State::dying) {
+    } else if (state == &State::dying) {
         return PublicState::Dying;
-    } else if (m_state == &State::inactive) {
+    } else if (state == &State::inactive) {
         return PublicState::Inactive;
-    } else if (m_state == &State::error) {
+    } else if (state == &State::error) {
         return PublicState::Error;
     }
     REALM_UNREACHABLE();
@@ -808,5 +914,5 @@ void SyncSession::did_drop_external_reference()
     if (!m_external_reference.expired())
         return;
 
-    m_state->close(lock, *this);
+    m_state.load()->close(lock, *this);
 }
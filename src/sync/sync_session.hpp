@@ -23,7 +23,10 @@
 #include <realm/version_id.hpp>
 
 #include "sync_config.hpp"
+#include "util/atomic_shared_ptr.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <unordered_map>
 
@@ -108,6 +111,14 @@ public:
     // this method does nothing.
     void unregister_progress_notifier(uint64_t);
 
+    // Set the minimum amount of time between invocations of the progress
+    // notifier callbacks. Progress reports from the sync client arriving
+    // within the interval of the last delivered one are coalesced: they are
+    // skipped, and the next delivered report carries the latest values.
+    // Reports which complete a transfer are always delivered immediately, so
+    // the final state of a transfer is never dropped.
+    void set_progress_notification_interval(std::chrono::milliseconds interval);
+
     // If the sync session is currently `Dying`, ask it to stay alive instead.
     // If the sync session is currently `WaitingForAccessToken`, cancel any deferred close.
     // If the sync session is currently `Inactive`, recreate it. Otherwise, a no-op.
@@ -224,6 +235,7 @@ private:
     void set_sync_transact_callback(std::function<SyncSessionTransactCallback>);
     void set_error_handler(std::function<SyncSessionErrorHandler>);
     void nonsync_transact_notify(VersionID::version_type);
+    void deliver_nonsync_transact_notify(VersionID::version_type);
 
     void advance_state(std::unique_lock<std::mutex>& lock, const State&);
 
@@ -251,6 +263,7 @@ private:
         util::Optional<uint64_t> captured_transferrable;
 
         void update(const Progress&, bool);
+        bool is_expired(const Progress&) const;
         std::function<void()> create_invocation(const Progress&, bool&) const;
     };
 
@@ -258,6 +271,12 @@ private:
     uint64_t m_progress_notifier_token = 1;
     bool m_latest_progress_data_is_fresh;
 
+    // When the last coalesced progress notification was delivered, and the
+    // minimum amount of time which must pass before the next one is. Guarded
+    // by m_progress_notifier_mutex.
+    std::chrono::steady_clock::time_point m_last_progress_notification;
+    std::chrono::milliseconds m_progress_notification_interval = std::chrono::milliseconds(50);
+
     // Will be `none` until we've received the initial notification from sync.  Note that this
     // happens only once ever during the lifetime of a given `SyncSession`, since these values are
     // expected to semi-monotonically increase, and a lower-bounds estimate is still useful in the
@@ -271,7 +290,9 @@ private:
     mutable std::mutex m_state_mutex;
     mutable std::mutex m_progress_notifier_mutex;
 
-    const State* m_state = nullptr;
+    // Only written while holding m_state_mutex; atomic so that state() can
+    // read it without the lock
+    std::atomic<const State*> m_state{nullptr};
     size_t m_death_count = 0;
 
     SyncConfig m_config;
@@ -291,7 +312,21 @@ private:
     // The session might be destroyed if the `SyncSession` becomes inactive again (for example, if the
     // user owning the session logs out). It might be created anew if the session is revived (if a
     // logged-out user logs back in, the object store sync code will revive their sessions).
-    std::unique_ptr<sync::Session> m_session;
+    std::shared_ptr<sync::Session> m_session;
+
+    // Set to m_session whenever the session enters the Active state and
+    // cleared on any transition out of it, so that nonsync_transact_notify()
+    // (called on every local commit) can hand the notification straight to
+    // the fully-bound session without taking m_state_mutex.
+    util::AtomicSharedPtr<sync::Session> m_active_session;
+
+    // Commit-notification coalescing state: the steady_clock tick of the
+    // last notification handed to the client, the largest commit version
+    // recorded during the current suppression interval, and whether a
+    // deferred notification is already scheduled to deliver it.
+    std::atomic<std::chrono::steady_clock::rep> m_last_transact_notify{0};
+    std::atomic<VersionID::version_type> m_pending_transact_version{0};
+    std::atomic<bool> m_transact_notify_scheduled{false};
 
     // Whether or not the session object in `m_session` has been `bind()`ed before.
     // This determines how the `SyncSession` behaves when refreshing tokens.
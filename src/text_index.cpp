@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "text_index.hpp"
+
+#include "collection_notifications.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+using namespace realm;
+
+std::vector<std::string> TextTokenIndex::tokenize(StringData text)
+{
+    std::vector<std::string> tokens;
+    std::string current;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x80) {
+            current += char(c);
+        }
+        else if (std::isalnum(c)) {
+            current += char(std::tolower(c));
+        }
+        else if (!current.empty()) {
+            tokens.push_back(std::move(current));
+            current.clear();
+        }
+    }
+    if (!current.empty()) {
+        tokens.push_back(std::move(current));
+    }
+    return tokens;
+}
+
+TextTokenIndex::TextTokenIndex(Table const& table, size_t column)
+: m_column(column)
+{
+    size_t count = table.size();
+    m_row_ids.reserve(count);
+    for (size_t row = 0; row < count; ++row) {
+        m_row_ids.push_back(m_next_id++);
+        index_row(table, row);
+    }
+}
+
+void TextTokenIndex::index_row(Table const& table, size_t row)
+{
+    uint64_t id = m_row_ids[row];
+    auto tokens = tokenize(table.get_string(m_column, row));
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    for (auto& token : tokens) {
+        auto& ids = m_token_ids[token];
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+    }
+    m_id_tokens[id] = std::move(tokens);
+}
+
+void TextTokenIndex::deindex_id(uint64_t id)
+{
+    auto it = m_id_tokens.find(id);
+    if (it == m_id_tokens.end()) {
+        return;
+    }
+    for (auto& token : it->second) {
+        auto ids_it = m_token_ids.find(token);
+        auto& ids = ids_it->second;
+        ids.erase(std::lower_bound(ids.begin(), ids.end(), id));
+        if (ids.empty()) {
+            m_token_ids.erase(ids_it);
+        }
+    }
+    m_id_tokens.erase(it);
+}
+
+void TextTokenIndex::update(Table const& table, CollectionChangeSet const& changes)
+{
+    // Deletions are in the old row numbering; process them from highest to
+    // lowest so that the indices of the remaining rows stay valid. Moved rows
+    // appear as a deletion plus an insertion and get reindexed from their new
+    // position.
+    auto deleted = changes.deletions.as_indexes();
+    std::vector<size_t> removed(deleted.begin(), deleted.end());
+    for (auto it = removed.rbegin(); it != removed.rend(); ++it) {
+        deindex_id(m_row_ids[*it]);
+        m_row_ids.erase(m_row_ids.begin() + *it);
+    }
+
+    for (auto row : changes.insertions.as_indexes()) {
+        m_row_ids.insert(m_row_ids.begin() + row, m_next_id++);
+        index_row(table, row);
+    }
+
+    for (auto row : changes.modifications_new.as_indexes()) {
+        deindex_id(m_row_ids[row]);
+        index_row(table, row);
+    }
+
+    if (!removed.empty() || !changes.insertions.empty()) {
+        m_id_rows_stale = true;
+    }
+}
+
+std::vector<size_t> TextTokenIndex::rows_matching(StringData text) const
+{
+    auto tokens = tokenize(text);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+    if (tokens.empty()) {
+        return {};
+    }
+
+    // Gather the id list for each token, intersecting starting from the
+    // smallest list to keep the working set minimal
+    std::vector<const std::vector<uint64_t>*> lists;
+    lists.reserve(tokens.size());
+    for (auto& token : tokens) {
+        auto it = m_token_ids.find(token);
+        if (it == m_token_ids.end()) {
+            return {};
+        }
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](auto* a, auto* b) { return a->size() < b->size(); });
+
+    std::vector<uint64_t> ids = *lists.front();
+    std::vector<uint64_t> intersection;
+    for (size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+        intersection.clear();
+        std::set_intersection(ids.begin(), ids.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(intersection));
+        ids.swap(intersection);
+    }
+
+    if (m_id_rows_stale) {
+        m_id_rows.clear();
+        m_id_rows.reserve(m_row_ids.size());
+        for (size_t row = 0; row < m_row_ids.size(); ++row) {
+            m_id_rows.emplace(m_row_ids[row], row);
+        }
+        m_id_rows_stale = false;
+    }
+
+    std::vector<size_t> rows;
+    rows.reserve(ids.size());
+    for (auto id : ids) {
+        rows.push_back(m_id_rows.find(id)->second);
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_TEXT_INDEX_HPP
+#define REALM_TEXT_INDEX_HPP
+
+#include <realm/string_data.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace realm {
+class Table;
+struct CollectionChangeSet;
+
+// An in-memory inverted index over a string column, mapping word tokens to
+// the rows containing them. Word search via rows_matching() touches only the
+// rows containing the searched tokens, unlike a CONTAINS query which scans
+// the whole column.
+//
+// The index is built eagerly from the table at construction and kept up to
+// date by feeding it the change sets which the notifier machinery already
+// produces for the table (i.e. from a notification callback on a Results for
+// the table). It is not thread-safe; use it from the thread owning the
+// notification callback.
+class TextTokenIndex {
+public:
+    // Split `text` into the tokens the index stores: maximal runs of
+    // alphanumeric characters, lowercased. Bytes outside ASCII are treated as
+    // token characters so that UTF-8 words survive intact (without case
+    // folding).
+    static std::vector<std::string> tokenize(StringData text);
+
+    // Build the index over the given string column
+    TextTokenIndex(Table const& table, size_t column);
+
+    size_t column() const noexcept { return m_column; }
+
+    // Apply a change set observed for the indexed table, re-reading inserted
+    // and modified rows from the table. The change set must describe the
+    // transition to the table's current state.
+    void update(Table const& table, CollectionChangeSet const& changes);
+
+    // Get the rows containing every token of `text`, in ascending order
+    std::vector<size_t> rows_matching(StringData text) const;
+
+private:
+    size_t m_column;
+
+    // Rows move around underneath us (both explicitly and via move_last_over
+    // deletions), so the token map is keyed on stable per-row ids rather than
+    // row indices, with m_row_ids tracking the current position of each id
+    uint64_t m_next_id = 0;
+    std::vector<uint64_t> m_row_ids;
+    std::unordered_map<uint64_t, std::vector<std::string>> m_id_tokens;
+    // Ascending id vectors per token
+    std::unordered_map<std::string, std::vector<uint64_t>> m_token_ids;
+
+    // id -> row lookup, rebuilt lazily after structural changes
+    mutable std::unordered_map<uint64_t, size_t> m_id_rows;
+    mutable bool m_id_rows_stale = true;
+
+    void index_row(Table const& table, size_t row);
+    void deindex_id(uint64_t id);
+};
+
+} // namespace realm
+
+#endif // REALM_TEXT_INDEX_HPP
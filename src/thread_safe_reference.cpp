@@ -103,20 +103,93 @@ Object ThreadSafeReference<Object>::import_into_realm(SharedRealm realm) && {
 
 ThreadSafeReference<Results>::ThreadSafeReference(Results const& results)
 : ThreadSafeReferenceBase(results.get_realm())
-, m_query(get_source_shared_group().export_for_handover(results.get_query(), ConstSourcePayload::Copy))
-, m_sort_order([&]() {
-    SortDescriptor::HandoverPatch sort_order;
-    SortDescriptor::generate_patch(results.get_sort(), sort_order);
-    return sort_order;
-}())
-, m_distinct_descriptor([&]() {
-    SortDescriptor::HandoverPatch distinct_descriptor;
-    SortDescriptor::generate_patch(results.get_distinct(), distinct_descriptor);
-    return distinct_descriptor;
-}()){ }
+{
+    // When the results have already been evaluated, hand over the view
+    // itself so that resolving imports the rows rather than repaying the
+    // cost of the query on the destination thread
+    if (const TableView* view = results.evaluated_table_view())
+        m_table_view = get_source_shared_group().export_for_handover(*view, ConstSourcePayload::Copy);
+    else
+        m_query = get_source_shared_group().export_for_handover(results.get_query(), ConstSourcePayload::Copy);
+    SortDescriptor::generate_patch(results.get_sort(), m_sort_order);
+    SortDescriptor::generate_patch(results.get_distinct(), m_distinct_descriptor);
+}
+
+ThreadSafeReferenceBundle::ThreadSafeReferenceBundle(SharedRealm source_realm)
+: ThreadSafeReferenceBase(std::move(source_realm)) { }
+
+void ThreadSafeReferenceBundle::verify_source(SharedRealm const& realm) const {
+    if (is_invalidated())
+        throw std::logic_error("Cannot add to a thread safe reference bundle which has been resolved.");
+    if (realm != get_source_realm())
+        throw std::logic_error("Cannot add a value from a different Realm to a thread safe reference bundle.");
+}
+
+void ThreadSafeReferenceBundle::add(Object const& object) {
+    verify_source(object.realm());
+    m_objects.push_back({get_source_shared_group().export_for_handover(object.row()),
+                         object.get_object_schema().name});
+}
+
+void ThreadSafeReferenceBundle::add(List const& list) {
+    verify_source(list.get_realm());
+    m_lists.push_back(get_source_shared_group().export_linkview_for_handover(list.m_link_view));
+}
+
+void ThreadSafeReferenceBundle::add(Results const& results) {
+    verify_source(results.get_realm());
+    ResultsReference reference;
+    if (const TableView* view = results.evaluated_table_view())
+        reference.table_view = get_source_shared_group().export_for_handover(*view, ConstSourcePayload::Copy);
+    else
+        reference.query = get_source_shared_group().export_for_handover(results.get_query(), ConstSourcePayload::Copy);
+    SortDescriptor::generate_patch(results.get_sort(), reference.sort_order);
+    SortDescriptor::generate_patch(results.get_distinct(), reference.distinct_descriptor);
+    m_results.push_back(std::move(reference));
+}
+
+ResolvedReferenceBundle ThreadSafeReferenceBundle::import_into_realm(SharedRealm realm) && {
+    return invalidate_after_import<ResolvedReferenceBundle>(*realm, [&](SharedGroup& shared_group) {
+        ResolvedReferenceBundle resolved;
+        resolved.objects.reserve(m_objects.size());
+        for (auto& object : m_objects) {
+            Row row = *shared_group.import_from_handover(std::move(object.row));
+            auto object_schema = realm->schema().find(object.object_schema_name);
+            REALM_ASSERT_DEBUG(object_schema != realm->schema().end());
+            resolved.objects.emplace_back(realm, *object_schema, row);
+        }
+        resolved.lists.reserve(m_lists.size());
+        for (auto& link_view : m_lists)
+            resolved.lists.emplace_back(realm, shared_group.import_linkview_from_handover(std::move(link_view)));
+        resolved.results.reserve(m_results.size());
+        for (auto& reference : m_results) {
+            if (reference.table_view) {
+                TableView table_view = *shared_group.import_from_handover(std::move(reference.table_view));
+                Table& table = table_view.get_parent();
+                SortDescriptor sort = SortDescriptor::create_from_and_consume_patch(reference.sort_order, table);
+                SortDescriptor distinct = SortDescriptor::create_from_and_consume_patch(reference.distinct_descriptor, table);
+                resolved.results.emplace_back(realm, std::move(table_view), std::move(sort), std::move(distinct));
+                continue;
+            }
+            Query query = *shared_group.import_from_handover(std::move(reference.query));
+            Table& table = *query.get_table();
+            SortDescriptor sort = SortDescriptor::create_from_and_consume_patch(reference.sort_order, table);
+            SortDescriptor distinct = SortDescriptor::create_from_and_consume_patch(reference.distinct_descriptor, table);
+            resolved.results.emplace_back(realm, std::move(query), std::move(sort), std::move(distinct));
+        }
+        return resolved;
+    });
+}
 
 Results ThreadSafeReference<Results>::import_into_realm(SharedRealm realm) && {
     return invalidate_after_import<Results>(*realm, [&](SharedGroup& shared_group) {
+        if (m_table_view) {
+            TableView table_view = *shared_group.import_from_handover(std::move(m_table_view));
+            Table& table = table_view.get_parent();
+            SortDescriptor sort_descriptor = SortDescriptor::create_from_and_consume_patch(m_sort_order, table);
+            SortDescriptor distinct_descriptor = SortDescriptor::create_from_and_consume_patch(m_distinct_descriptor, table);
+            return Results(std::move(realm), std::move(table_view), std::move(sort_descriptor), std::move(distinct_descriptor));
+        }
         Query query = *shared_group.import_from_handover(std::move(m_query));
         Table& table = *query.get_table();
         SortDescriptor sort_descriptor = SortDescriptor::create_from_and_consume_patch(m_sort_order, table);
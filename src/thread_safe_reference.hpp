@@ -19,8 +19,15 @@
 #ifndef REALM_THREAD_SAFE_REFERENCE_HPP
 #define REALM_THREAD_SAFE_REFERENCE_HPP
 
+#include "list.hpp"
+#include "object.hpp"
+#include "results.hpp"
+
 #include <realm/group_shared.hpp>
 
+#include <string>
+#include <vector>
+
 namespace realm {
 class LinkView;
 class List;
@@ -49,6 +56,7 @@ protected:
     ThreadSafeReferenceBase(std::shared_ptr<Realm> source_realm);
 
     SharedGroup& get_source_shared_group() const;
+    std::shared_ptr<Realm> const& get_source_realm() const noexcept { return m_source_realm; }
 
     template <typename V, typename T>
     V invalidate_after_import(Realm& destination_realm, T construct_with_shared_group);
@@ -109,6 +117,10 @@ class ThreadSafeReference<Results>: public ThreadSafeReferenceBase {
 private:
     friend Realm;
 
+    // When the source Results had already materialized its view the
+    // evaluated rows are handed over directly and m_query is null;
+    // otherwise the query is handed over and rerun on resolve.
+    std::unique_ptr<SharedGroup::Handover<TableView>> m_table_view;
     std::unique_ptr<SharedGroup::Handover<Query>> m_query;
     SortDescriptor::HandoverPatch m_sort_order;
     SortDescriptor::HandoverPatch m_distinct_descriptor;
@@ -119,6 +131,55 @@ private:
     // Precondition: Realm and handover are on same version.
     Results import_into_realm(std::shared_ptr<Realm> realm) &&;
 };
+
+// The accessors produced by resolving a ThreadSafeReferenceBundle, each in
+// the order the corresponding references were added to the bundle
+struct ResolvedReferenceBundle {
+    std::vector<Object> objects;
+    std::vector<List> lists;
+    std::vector<Results> results;
+};
+
+// A bundle of references which are exported against a single pinned version
+// and resolved with a single version reconciliation, which is much cheaper
+// than a separate ThreadSafeReference per value when handing many accessors
+// to another thread at once. Created empty via
+// Realm::obtain_thread_safe_reference_bundle() and populated with add().
+class ThreadSafeReferenceBundle: public ThreadSafeReferenceBase {
+public:
+    // Add a reference to the bundle. The value must belong to the Realm the
+    // bundle was obtained from, and must be added on that Realm's thread
+    // before the bundle is handed off.
+    void add(Object const&);
+    void add(List const&);
+    void add(Results const&);
+
+private:
+    friend Realm;
+
+    struct ObjectReference {
+        std::unique_ptr<SharedGroup::Handover<Row>> row;
+        std::string object_schema_name;
+    };
+    struct ResultsReference {
+        std::unique_ptr<SharedGroup::Handover<TableView>> table_view;
+        std::unique_ptr<SharedGroup::Handover<Query>> query;
+        SortDescriptor::HandoverPatch sort_order;
+        SortDescriptor::HandoverPatch distinct_descriptor;
+    };
+
+    std::vector<ObjectReference> m_objects;
+    std::vector<std::unique_ptr<SharedGroup::Handover<LinkView>>> m_lists;
+    std::vector<ResultsReference> m_results;
+
+    // Precondition: The associated Realm is for the current thread and is not in a write transaction;.
+    ThreadSafeReferenceBundle(std::shared_ptr<Realm> source_realm);
+
+    void verify_source(std::shared_ptr<Realm> const& realm) const;
+
+    // Precondition: Realm and handover are on same version.
+    ResolvedReferenceBundle import_into_realm(std::shared_ptr<Realm> realm) &&;
+};
 }
 
 #endif /* REALM_THREAD_SAFE_REFERENCE_HPP */
@@ -19,77 +19,177 @@
 #ifndef REALM_OS_UTIL_ANY_HPP
 #define REALM_OS_UTIL_ANY_HPP
 
+#include <cstddef>
+#include <new>
 #include <typeinfo>
 #include <type_traits>
 #include <stdexcept>
+#include <utility>
 
 namespace realm {
 namespace util {
 
-// A naive implementation of C++17's std::any
-// This does not perform the small-object optimization or make any particular
-// attempt at being performant
+// An implementation of C++17's std::any
+// Values of at most two pointers in size which are nothrow-movable (covering
+// everything CppContext boxes on the accessor hot path: int64_t, double,
+// bool, Timestamp, row accessors) are stored inline rather than on the heap,
+// and stored types are identified by a per-type tag pointer rather than
+// typeid comparisons.
 class Any final {
 public:
     // Constructors
 
     Any() = default;
-    Any(Any&&) noexcept = default;
-    ~Any() = default;
-    Any& operator=(Any&&) noexcept = default;
+    ~Any() { reset(); }
+
+    Any(Any&& rhs) noexcept
+    {
+        if (rhs.m_vtable) {
+            rhs.m_vtable->move(rhs.m_storage, m_storage);
+            m_vtable = rhs.m_vtable;
+            rhs.m_vtable = nullptr;
+        }
+    }
+
+    Any& operator=(Any&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            reset();
+            if (rhs.m_vtable) {
+                rhs.m_vtable->move(rhs.m_storage, m_storage);
+                m_vtable = rhs.m_vtable;
+                rhs.m_vtable = nullptr;
+            }
+        }
+        return *this;
+    }
 
     Any(Any const& rhs)
-    : m_value(rhs.m_value ? rhs.m_value->copy() : nullptr)
     {
+        if (rhs.m_vtable) {
+            rhs.m_vtable->copy(rhs.m_storage, m_storage);
+            m_vtable = rhs.m_vtable;
+        }
     }
 
     template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, Any>::value>::type>
     Any(T&& value)
-    : m_value(std::make_unique<Value<typename std::decay<T>::type>>(std::forward<T>(value)))
     {
+        Handler<typename std::decay<T>::type>::create(m_storage, std::forward<T>(value));
+        m_vtable = vtable<typename std::decay<T>::type>();
     }
 
     Any& operator=(Any const& rhs)
     {
-        m_value = rhs.m_value ? rhs.m_value->copy() : nullptr;
+        Any(rhs).swap(*this);
         return *this;
     }
 
     template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, Any>::value>::type>
     Any& operator=(T&& value)
     {
-        m_value = std::make_unique<Value<typename std::decay<T>::type>>(std::forward<T>(value));
+        Any(std::forward<T>(value)).swap(*this);
         return *this;
     }
 
     // Modifiers
 
-    void reset() noexcept { m_value.reset(); }
-    void swap(Any& rhs) noexcept { std::swap(m_value, rhs.m_value); }
+    void reset() noexcept
+    {
+        if (m_vtable) {
+            m_vtable->destroy(m_storage);
+            m_vtable = nullptr;
+        }
+    }
+
+    void swap(Any& rhs) noexcept
+    {
+        Any tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
 
     // Observers
 
-    bool has_value() const noexcept { return m_value != nullptr; }
-    std::type_info const& type() const noexcept { return m_value ? m_value->type() : typeid(void); }
+    bool has_value() const noexcept { return m_vtable != nullptr; }
+    std::type_info const& type() const noexcept { return m_vtable ? m_vtable->type() : typeid(void); }
 
 private:
-    struct ValueBase {
-        virtual ~ValueBase() noexcept { }
-        virtual std::type_info const& type() const noexcept = 0;
-        virtual std::unique_ptr<ValueBase> copy() const = 0;
+    union Storage {
+        typename std::aligned_storage<2 * sizeof(void*), alignof(std::max_align_t)>::type buffer;
+        void* heap;
     };
+
     template<typename T>
-    struct Value : ValueBase {
-        T value;
-        template<typename U> Value(U&& v) : value(std::forward<U>(v)) { }
+    struct fits_inline : std::integral_constant<bool,
+        sizeof(T) <= sizeof(Storage::buffer)
+        && alignof(T) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible<T>::value> {};
 
-        std::type_info const& type() const noexcept override { return typeid(T); }
-        std::unique_ptr<ValueBase> copy() const override
+    template<typename T, bool = fits_inline<T>::value>
+    struct Handler;
+
+    template<typename T>
+    struct Handler<T, true> {
+        static T* get(Storage& storage) noexcept { return reinterpret_cast<T*>(&storage.buffer); }
+        template<typename U>
+        static void create(Storage& storage, U&& value) { new (&storage.buffer) T(std::forward<U>(value)); }
+        static void copy(Storage const& src, Storage& dst)
         {
-            return std::make_unique<Value<T>>(value);
+            new (&dst.buffer) T(*get(const_cast<Storage&>(src)));
         }
+        static void move(Storage& src, Storage& dst) noexcept
+        {
+            new (&dst.buffer) T(std::move(*get(src)));
+            get(src)->~T();
+        }
+        static void destroy(Storage& storage) noexcept { get(storage)->~T(); }
+    };
+
+    template<typename T>
+    struct Handler<T, false> {
+        static T* get(Storage& storage) noexcept { return static_cast<T*>(storage.heap); }
+        template<typename U>
+        static void create(Storage& storage, U&& value) { storage.heap = new T(std::forward<U>(value)); }
+        static void copy(Storage const& src, Storage& dst)
+        {
+            dst.heap = new T(*get(const_cast<Storage&>(src)));
+        }
+        static void move(Storage& src, Storage& dst) noexcept
+        {
+            dst.heap = src.heap;
+            src.heap = nullptr;
+        }
+        static void destroy(Storage& storage) noexcept { delete get(storage); }
     };
-    std::unique_ptr<ValueBase> m_value;
+
+    struct VTable {
+        std::type_info const& (*type)();
+        void (*copy)(Storage const& src, Storage& dst);
+        void (*move)(Storage& src, Storage& dst);
+        void (*destroy)(Storage& storage);
+    };
+
+    // The address of the vtable serves as the tag identifying the stored
+    // type: there is exactly one instance per type in a program, so two Anys
+    // hold the same type iff they hold the same vtable pointer
+    template<typename T>
+    static VTable const* vtable() noexcept
+    {
+        static const VTable table = {
+            &type_for<T>,
+            &Handler<T>::copy,
+            &Handler<T>::move,
+            &Handler<T>::destroy,
+        };
+        return &table;
+    }
+
+    template<typename T>
+    static std::type_info const& type_for() noexcept { return typeid(T); }
+
+    Storage m_storage;
+    VTable const* m_vtable = nullptr;
 
     template<typename T>
     friend const T* any_cast(const Any* operand) noexcept;
@@ -99,13 +199,13 @@ private:
     template<typename T>
     const T* cast() const noexcept
     {
-        return &static_cast<Value<T>*>(m_value.get())->value;
+        return m_vtable == vtable<T>() ? Handler<T>::get(const_cast<Storage&>(m_storage)) : nullptr;
     }
 
     template<typename T>
     T* cast() noexcept
     {
-        return &static_cast<Value<T>*>(m_value.get())->value;
+        return m_vtable == vtable<T>() ? Handler<T>::get(m_storage) : nullptr;
     }
 };
 
@@ -139,13 +239,13 @@ T any_cast(Any&& value)
 template<typename T>
 T* any_cast(Any* value) noexcept
 {
-    return value && value->type() == typeid(T) ? value->cast<T>() : nullptr;
+    return value ? value->cast<T>() : nullptr;
 }
 
 template<typename T>
 const T* any_cast(const Any* value) noexcept
 {
-    return value && value->type() == typeid(T) ? value->cast<T>() : nullptr;
+    return value ? value->cast<T>() : nullptr;
 }
 } // namespace util
 } // namespace realm
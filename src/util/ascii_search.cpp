@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "util/ascii_search.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace realm;
+
+namespace {
+constexpr uint64_t high_bits = 0x8080808080808080ULL;
+constexpr uint64_t low_bytes = 0x0101010101010101ULL;
+
+// Fold the ASCII upper-case bytes of an eight-byte chunk to lower-case. A
+// byte is folded iff it is in ['A', 'Z']; everything else, including UTF-8
+// lead and continuation bytes, passes through unchanged.
+uint64_t fold_word(uint64_t chunk) noexcept
+{
+    uint64_t low7 = chunk & ~high_bits;
+    // Per-byte high bit set iff the byte (sans its own high bit, which is
+    // checked separately) is >= 'A'. The addend is at most 0x3F per byte, so
+    // the sums cannot carry between bytes.
+    uint64_t ge_a = low7 + (0x80 - 'A') * low_bytes;
+    // ... and iff it is > 'Z'
+    uint64_t gt_z = low7 + (0x80 - 'Z' - 1) * low_bytes;
+    uint64_t is_upper = ge_a & ~gt_z & ~chunk & high_bits;
+    return chunk | (is_upper >> 2); // 0x80 >> 2 == 0x20, the ASCII case bit
+}
+
+char fold_byte(char c) noexcept
+{
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+// Compare needle.size() bytes at `data` against the pre-folded needle
+bool equal_folded(const char* data, StringData needle) noexcept
+{
+    for (size_t i = 0; i < needle.size(); ++i) {
+        if (fold_byte(data[i]) != needle[i])
+            return false;
+    }
+    return true;
+}
+} // anonymous namespace
+
+bool util::is_ascii(StringData text) noexcept
+{
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (static_cast<unsigned char>(text[i]) >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+void util::ascii_tolower(std::string& text) noexcept
+{
+    for (auto& c : text)
+        c = fold_byte(c);
+}
+
+bool util::ascii_contains_ins(StringData haystack, StringData needle) noexcept
+{
+    if (needle.size() > haystack.size())
+        return false;
+    const char* data = haystack.data();
+    size_t size = haystack.size();
+    size_t last_start = size - needle.size();
+
+    // Scan for candidate positions of the needle's first byte eight bytes at
+    // a time: fold each chunk, then locate bytes equal to the first needle
+    // byte with the zero-byte test on the xor of the two
+    uint64_t first = static_cast<unsigned char>(needle[0]) * low_bytes;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, data + i, 8);
+        uint64_t diff = fold_word(chunk) ^ first;
+        if ((diff - low_bytes) & ~diff & high_bits) {
+            // Some byte in [i, i + 8) matches; check each in-range position.
+            // Matches may extend past the chunk, but never past the string.
+            size_t end = std::min(i + 8, last_start + 1);
+            for (size_t j = i; j < end; ++j) {
+                if (fold_byte(data[j]) == needle[0] && equal_folded(data + j, needle))
+                    return true;
+            }
+        }
+    }
+    for (; i <= last_start; ++i) {
+        if (fold_byte(data[i]) == needle[0] && equal_folded(data + i, needle))
+            return true;
+    }
+    return false;
+}
+
+bool util::ascii_begins_with_ins(StringData haystack, StringData needle) noexcept
+{
+    return needle.size() <= haystack.size() && equal_folded(haystack.data(), needle);
+}
+
+bool util::ascii_ends_with_ins(StringData haystack, StringData needle) noexcept
+{
+    return needle.size() <= haystack.size()
+        && equal_folded(haystack.data() + haystack.size() - needle.size(), needle);
+}
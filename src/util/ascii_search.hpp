@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_UTIL_ASCII_SEARCH_HPP
+#define REALM_UTIL_ASCII_SEARCH_HPP
+
+#include <realm/string_data.hpp>
+
+#include <string>
+
+namespace realm {
+namespace util {
+
+// Case-insensitive string matching for pure-ASCII needles. Case folding is
+// bitwise (only the bytes 'A'-'Z' are folded) and the haystack is scanned a
+// machine word at a time rather than comparing case-mapped characters one at
+// a time. For an ASCII needle this accepts exactly the same strings as a
+// full case-mapped comparison, as a non-ASCII character never compares
+// case-insensitively equal to an ASCII one.
+
+// Check whether every byte of `text` is ASCII
+bool is_ascii(StringData text) noexcept;
+
+// Fold ASCII upper-case letters in `text` to lower-case in place
+void ascii_tolower(std::string& text) noexcept;
+
+// The needle passed to each of these must be non-empty, pure ASCII, and
+// already lower-cased (e.g. via ascii_tolower()). The haystack may be
+// arbitrary UTF-8 or null.
+bool ascii_contains_ins(StringData haystack, StringData needle) noexcept;
+bool ascii_begins_with_ins(StringData haystack, StringData needle) noexcept;
+bool ascii_ends_with_ins(StringData haystack, StringData needle) noexcept;
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_ASCII_SEARCH_HPP
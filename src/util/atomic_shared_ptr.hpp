@@ -20,8 +20,9 @@
 #define REALM_ATOMIC_SHARED_PTR_HPP
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <mutex>
 
 namespace realm {
 namespace _impl {
@@ -41,10 +42,9 @@ struct HasAtomicPtrOps<T, void_t<decltype(std::atomic_load(std::declval<T*>()))>
 
 namespace util {
 // A wrapper for std::shared_ptr that enables sharing a shared_ptr instance
-// (and not just a thing *pointed to* by a shared_ptr) between threads. Is
-// lock-free iff the underlying shared_ptr implementation supports atomic
-// operations. Currently the only implemented operation other than copy/move
-// construction/assignment is exchange().
+// (and not just a thing *pointed to* by a shared_ptr) between threads.
+// Lock-free: either the underlying shared_ptr implementation supports atomic
+// operations, or a split-reference-count implementation is used instead.
 template<typename T, bool = _impl::HasAtomicPtrOps<std::shared_ptr<T>>::value>
 class AtomicSharedPtr;
 
@@ -85,61 +85,111 @@ private:
     std::shared_ptr<T> m_ptr = nullptr;
 };
 
+// Fallback for toolchains whose shared_ptr lacks the atomic_* overloads
+// (e.g. older Android NDKs), using a split reference count rather than a
+// mutex. The shared_ptr is wrapped in a heap-allocated block published
+// through a single CAS-able {block, count} pair: the pair's count records
+// how many times the current block has been acquired by `load()`, and the
+// block's own counter records how many of those acquisitions have been
+// released again. Once the block has been unpublished by an `exchange()`,
+// whoever settles the balance between the two frees it. The pair is two
+// pointers wide, which is within the native CAS width on the (32-bit)
+// platforms which take this branch.
 template<typename T>
 class AtomicSharedPtr<T, false> {
 public:
     AtomicSharedPtr() = default;
-    AtomicSharedPtr(std::shared_ptr<T> ptr) : m_ptr(std::move(ptr)) { }
-
-    AtomicSharedPtr(AtomicSharedPtr const& ptr)
+    AtomicSharedPtr(std::shared_ptr<T> ptr)
     {
-        std::lock_guard<std::mutex> lock(ptr.m_mutex);
-        m_ptr = ptr.m_ptr;
+        if (ptr)
+            m_data = CountedPtr{new ControlBlock{std::move(ptr), {0}}, 1};
     }
-    AtomicSharedPtr(AtomicSharedPtr&& ptr)
+
+    AtomicSharedPtr(AtomicSharedPtr const& ptr) : AtomicSharedPtr(ptr.load()) { }
+    AtomicSharedPtr(AtomicSharedPtr&& ptr) : AtomicSharedPtr(ptr.exchange(nullptr)) { }
+
+    ~AtomicSharedPtr()
     {
-        std::lock_guard<std::mutex> lock(ptr.m_mutex);
-        m_ptr = std::move(ptr.m_ptr);
+        unpublish(m_data.load(std::memory_order_relaxed));
     }
 
     AtomicSharedPtr& operator=(AtomicSharedPtr const& ptr)
     {
         if (&ptr != this) {
-            // std::lock() ensures that these are locked in a consistent order
-            // to avoid deadlock
-            std::lock(m_mutex, ptr.m_mutex);
-            m_ptr = ptr.m_ptr;
-            m_mutex.unlock();
-            ptr.m_mutex.unlock();
+            exchange(ptr.load());
         }
         return *this;
     }
 
     AtomicSharedPtr& operator=(AtomicSharedPtr&& ptr)
     {
-        std::lock(m_mutex, ptr.m_mutex);
-        m_ptr = std::move(ptr.m_ptr);
-        m_mutex.unlock();
-        ptr.m_mutex.unlock();
+        exchange(ptr.exchange(nullptr));
         return *this;
     }
 
     std::shared_ptr<T> exchange(std::shared_ptr<T> ptr)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_ptr.swap(ptr);
-        return ptr;
+        CountedPtr new_data{nullptr, 1};
+        if (ptr)
+            new_data.block = new ControlBlock{std::move(ptr), {0}};
+        CountedPtr old = m_data.exchange(new_data);
+        if (!old.block)
+            return nullptr;
+        auto result = old.block->ptr;
+        unpublish(old);
+        return result;
     }
 
     std::shared_ptr<T> load() const noexcept
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_ptr;
+        CountedPtr old = m_data.load();
+        for (;;) {
+            if (!old.block)
+                return nullptr;
+            // Acquiring the block by bumping the published count (rather
+            // than a counter inside the block) is what makes dereferencing
+            // the block safe: a concurrent exchange() sees the acquisition
+            // and leaves the block alive until it's released below.
+            CountedPtr acquired{old.block, old.count + 1};
+            if (m_data.compare_exchange_weak(old, acquired))
+                break;
+        }
+        auto result = old.block->ptr;
+        if (old.block->released.fetch_add(1) == -1) {
+            // The block was unpublished and this was the last outstanding
+            // acquisition of it
+            delete old.block;
+        }
+        return result;
     }
 
 private:
-    mutable std::mutex m_mutex;
-    std::shared_ptr<T> m_ptr = nullptr;
+    struct ControlBlock {
+        std::shared_ptr<T> const ptr;
+        // Released acquisitions, minus the total acquisitions once the block
+        // has been unpublished; the balance settles at zero when the block
+        // is unpublished and every load() of it has returned.
+        std::atomic<std::ptrdiff_t> released;
+    };
+    struct CountedPtr {
+        ControlBlock* block;
+        // 1 for the block being published, plus one per load() which
+        // acquired it
+        std::uintptr_t count;
+    };
+
+    static void unpublish(CountedPtr data)
+    {
+        if (!data.block)
+            return;
+        auto acquisitions = static_cast<std::ptrdiff_t>(data.count - 1);
+        if (data.block->released.fetch_sub(acquisitions) == acquisitions) {
+            // Every acquisition had already been released
+            delete data.block;
+        }
+    }
+
+    mutable std::atomic<CountedPtr> m_data{CountedPtr{nullptr, 1}};
 };
 
 }
@@ -43,4 +43,103 @@
 #include "util/generic/event_loop_signal.hpp"
 #endif
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace realm {
+namespace util {
+
+// A variant of `EventLoopSignal` whose notifications carry a payload.
+//
+// Payloads may be enqueued from any thread with no external locking: the
+// queue is a lock-free multi-producer list, and the event loop drains
+// everything enqueued so far in a single callback invocation per wakeup.
+// Delivering a burst of N payloads from another thread therefore costs one
+// wakeup rather than N. The callback is passed the drained payloads in the
+// order they were enqueued.
+//
+// As with `EventLoopSignal`, the object must be constructed and destroyed on
+// the thread running the event loop, and the callback is invoked on that
+// thread.
+template<typename Payload, typename Callback>
+class PayloadEventLoopSignal {
+public:
+    PayloadEventLoopSignal(Callback&& callback)
+    : m_callback(std::move(callback))
+    , m_signal(DrainCallback{this})
+    { }
+
+    ~PayloadEventLoopSignal()
+    {
+        // Free any payloads enqueued after the last drain
+        auto node = m_head.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            auto next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    PayloadEventLoopSignal(PayloadEventLoopSignal&&) = delete;
+    PayloadEventLoopSignal& operator=(PayloadEventLoopSignal&&) = delete;
+    PayloadEventLoopSignal(PayloadEventLoopSignal const&) = delete;
+    PayloadEventLoopSignal& operator=(PayloadEventLoopSignal const&) = delete;
+
+    // Enqueue a payload and ensure the callback will be invoked on the event
+    // loop thread. May be called from any thread.
+    void notify(Payload payload)
+    {
+        auto node = new Node{std::move(payload), m_head.load(std::memory_order_relaxed)};
+        while (!m_head.compare_exchange_weak(node->next, node,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) { }
+        // The underlying signal coalesces wakeups, so a burst of
+        // notifications typically produces a single drain.
+        m_signal.notify();
+    }
+
+private:
+    struct Node {
+        Payload payload;
+        Node* next;
+    };
+
+    struct DrainCallback {
+        PayloadEventLoopSignal* signal;
+        void operator()() const { signal->drain(); }
+    };
+
+    void drain()
+    {
+        // The enqueue order makes the list most-recent-first; reverse it so
+        // payloads are delivered in the order they were enqueued.
+        Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+        Node* reversed = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+        if (!reversed)
+            return; // an earlier drain already consumed this wakeup's payloads
+        std::vector<Payload> payloads;
+        for (node = reversed; node;) {
+            payloads.push_back(std::move(node->payload));
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+        m_callback(std::move(payloads));
+    }
+
+    Callback m_callback;
+    std::atomic<Node*> m_head{nullptr};
+    EventLoopSignal<DrainCallback> m_signal;
+};
+
+} // namespace util
+} // namespace realm
+
 #endif // REALM_EVENT_LOOP_SIGNAL_HPP
@@ -18,52 +18,100 @@
 
 #include "util/format.hpp"
 
-#include <sstream>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include <realm/string_data.hpp>
 #include <realm/util/assert.hpp>
 
 namespace realm { namespace _impl {
+
+// Stack-first output buffer for format(): appends land in fixed storage, and
+// the heap is touched only by the final conversion to std::string — or while
+// formatting, if a message outgrows the stack buffer (diagnostic messages
+// rarely do).
+class FormatBuffer {
+public:
+    void append(const char* data, size_t size)
+    {
+        if (!m_overflowed && m_used + size <= sizeof(m_stack)) {
+            memcpy(m_stack + m_used, data, size);
+            m_used += size;
+            return;
+        }
+        if (!m_overflowed) {
+            m_overflow.reserve(2 * (m_used + size));
+            m_overflow.append(m_stack, m_used);
+            m_overflowed = true;
+        }
+        m_overflow.append(data, size);
+    }
+
+    void append(char value)
+    {
+        append(&value, 1);
+    }
+
+    std::string str()
+    {
+        return m_overflowed ? std::move(m_overflow) : std::string(m_stack, m_used);
+    }
+
+private:
+    char m_stack[512];
+    size_t m_used = 0;
+    std::string m_overflow;
+    bool m_overflowed = false;
+};
+
 Printable::Printable(StringData value) : m_type(Type::String), m_string(value.data()) { }
 
-void Printable::print(std::ostream& out) const
+void Printable::print(FormatBuffer& out) const
 {
+    char buffer[32];
     switch (m_type) {
         case Printable::Type::Bool:
-            out << (m_uint ? "true" : "false");
+            if (m_uint)
+                out.append("true", 4);
+            else
+                out.append("false", 5);
             break;
         case Printable::Type::Uint:
-            out << m_uint;
+            out.append(buffer, snprintf(buffer, sizeof(buffer), "%llu",
+                                        static_cast<unsigned long long>(m_uint)));
             break;
         case Printable::Type::Int:
-            out << m_int;
+            out.append(buffer, snprintf(buffer, sizeof(buffer), "%lld",
+                                        static_cast<long long>(m_int)));
             break;
         case Printable::Type::String:
-            out << m_string;
+            out.append(m_string, strlen(m_string));
             break;
     }
 }
 
 std::string format(const char* fmt, std::initializer_list<Printable> values)
 {
-    std::stringstream ss;
+    FormatBuffer out;
     while (*fmt) {
         auto next = strchr(fmt, '%');
 
         // emit the rest of the format string if there are no more percents
         if (!next) {
-            ss << fmt;
+            out.append(fmt, strlen(fmt));
             break;
         }
 
         // emit everything up to the next percent
-        ss.write(fmt, next - fmt);
+        out.append(fmt, next - fmt);
         ++next;
         REALM_ASSERT(*next);
 
         // %% produces a single escaped %
         if (*next == '%') {
-            ss << '%';
+            out.append('%');
             fmt = next + 1;
             continue;
         }
@@ -73,9 +121,9 @@ std::string format(const char* fmt, std::initializer_list<Printable> values)
         // the pointed-to string, but it lacks a const overload
         auto index = strtoul(next, const_cast<char**>(&fmt), 10) - 1;
         REALM_ASSERT(index < values.size());
-        (values.begin() + index)->print(ss);
+        (values.begin() + index)->print(out);
     }
-    return ss.str();
+    return out.str();
 }
 
 } // namespace _impl
@@ -20,7 +20,6 @@
 #define REALM_UTIL_FORMAT_HPP
 
 #include <cstdint>
-#include <iosfwd>
 #include <initializer_list>
 #include <string>
 
@@ -28,6 +27,8 @@ namespace realm {
 class StringData;
 
 namespace _impl {
+class FormatBuffer;
+
 class Printable {
 public:
     Printable(bool value) : m_type(Type::Bool), m_uint(value) { }
@@ -43,7 +44,7 @@ public:
     Printable(std::string const& value) : m_type(Type::String), m_string(value.c_str()) { }
     Printable(StringData value);
 
-    void print(std::ostream& out) const;
+    void print(FormatBuffer& out) const;
 
 private:
     enum class Type {
@@ -18,10 +18,108 @@
 
 #include "event_loop_signal.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 using namespace realm::util;
 
-GenericEventLoop (*realm::util::s_get_eventloop)() = [] { return GenericEventLoop(); };
+namespace {
+
+// The default delivery loop used when the embedder doesn't install its own
+// event loop via the function pointers below: a single lazily-started thread
+// which sleeps until a handler is posted and then runs it. Each call to
+// `s_get_eventloop` vends a handle, and releasing a handle cancels its queued
+// posts and waits for any post that is mid-execution, so a handler is never
+// run after the signal that posted it has been released.
+class DefaultEventLoop {
+public:
+    struct Handle { };
+
+    static DefaultEventLoop& shared()
+    {
+        // The singleton is heap-allocated so that the delivery thread never
+        // races against static destruction at process exit.
+        static DefaultEventLoop& loop = *new DefaultEventLoop;
+        return loop;
+    }
+
+    Handle* acquire()
+    {
+        return new Handle;
+    }
+
+    void post(Handle* handle, EventLoopPostHandler* handler, void* user_data)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back({handle, handler, user_data});
+        }
+        m_wakeup.notify_one();
+    }
+
+    void release(Handle* handle)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                                     [&](auto& task) { return task.handle == handle; }),
+                      m_queue.end());
+        // If one of this handle's handlers is currently executing, wait for
+        // it to finish — unless we're being released from within it
+        if (std::this_thread::get_id() != m_thread.get_id()) {
+            m_finished.wait(lock, [&] { return m_running != handle; });
+        }
+        delete handle;
+    }
+
+private:
+    struct Task {
+        Handle* handle;
+        EventLoopPostHandler* handler;
+        void* user_data;
+    };
+
+    DefaultEventLoop()
+    {
+        m_thread = std::thread([this] { run(); });
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wakeup.wait(lock, [&] { return !m_queue.empty(); });
+            Task task = m_queue.front();
+            m_queue.pop_front();
+            m_running = task.handle;
+            lock.unlock();
+            task.handler(task.user_data);
+            lock.lock();
+            m_running = nullptr;
+            m_finished.notify_all();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_finished;
+    std::deque<Task> m_queue;
+    Handle* m_running = nullptr;
+    std::thread m_thread;
+};
+
+} // (anonymous namespace)
+
+GenericEventLoop (*realm::util::s_get_eventloop)() = []() -> GenericEventLoop {
+    return DefaultEventLoop::shared().acquire();
+};
 
-void (*realm::util::s_post_on_eventloop)(GenericEventLoop, EventLoopPostHandler*, void* user_data) = [](GenericEventLoop, EventLoopPostHandler*, void*) { };
+void (*realm::util::s_post_on_eventloop)(GenericEventLoop, EventLoopPostHandler*, void* user_data) = [](GenericEventLoop eventloop, EventLoopPostHandler* handler, void* user_data) {
+    DefaultEventLoop::shared().post(static_cast<DefaultEventLoop::Handle*>(eventloop), handler, user_data);
+};
 
-void (*realm::util::s_release_eventloop)(GenericEventLoop) = [](GenericEventLoop) { };
+void (*realm::util::s_release_eventloop)(GenericEventLoop) = [](GenericEventLoop eventloop) {
+    DefaultEventLoop::shared().release(static_cast<DefaultEventLoop::Handle*>(eventloop));
+};
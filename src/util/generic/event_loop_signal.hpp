@@ -24,6 +24,11 @@ namespace util {
 using GenericEventLoop = void*;
 using EventLoopPostHandler = void(const void* user_data);
 
+// These default to a built-in delivery loop — a dedicated thread which runs
+// posted handlers in order — so notifications work out of the box. An
+// embedder which has its own event loop may replace them, and must then
+// guarantee that no handler posted through a loop runs after that loop has
+// been released.
 extern GenericEventLoop (*s_get_eventloop)();
 
 extern void (*s_post_on_eventloop)(GenericEventLoop, EventLoopPostHandler*, void* user_data);
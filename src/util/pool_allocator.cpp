@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "util/pool_allocator.hpp"
+
+#include <mutex>
+#include <new>
+
+using namespace realm::util;
+
+namespace {
+// Slabs are sized so that even the largest blocks are carved at least a
+// handful at a time
+constexpr size_t slab_size = 4096;
+constexpr size_t bucket_count = ObjectPool::max_block_size / ObjectPool::block_granularity;
+
+struct Bucket {
+    std::mutex mutex;
+    // Chain of free blocks, linked through their first word
+    void* free_list = nullptr;
+};
+
+Bucket& bucket_for(size_t index)
+{
+    // Heap-allocated and intentionally leaked so that objects freed during
+    // static destruction can still be returned to their bucket
+    static Bucket* buckets = new Bucket[bucket_count];
+    return buckets[index];
+}
+} // anonymous namespace
+
+constexpr size_t ObjectPool::max_block_size;
+constexpr size_t ObjectPool::block_granularity;
+
+void* ObjectPool::allocate(size_t size)
+{
+    if (size == 0)
+        size = 1;
+    if (size > max_block_size)
+        return ::operator new(size);
+
+    size_t index = (size - 1) / block_granularity;
+    size_t block_size = (index + 1) * block_granularity;
+    Bucket& bucket = bucket_for(index);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    if (!bucket.free_list) {
+        // Carve a fresh slab into blocks and chain them onto the free list.
+        // The slab comes from operator new and the block size is a multiple
+        // of the granularity, so every block is suitably aligned.
+        char* slab = static_cast<char*>(::operator new(slab_size));
+        for (size_t offset = 0; offset + block_size <= slab_size; offset += block_size) {
+            void* block = slab + offset;
+            *static_cast<void**>(block) = bucket.free_list;
+            bucket.free_list = block;
+        }
+    }
+    void* block = bucket.free_list;
+    bucket.free_list = *static_cast<void**>(block);
+    return block;
+}
+
+void ObjectPool::deallocate(void* ptr, size_t size) noexcept
+{
+    if (!ptr)
+        return;
+    if (size == 0)
+        size = 1;
+    if (size > max_block_size) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    Bucket& bucket = bucket_for((size - 1) / block_granularity);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    *static_cast<void**>(ptr) = bucket.free_list;
+    bucket.free_list = ptr;
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_OS_UTIL_POOL_ALLOCATOR_HPP
+#define REALM_OS_UTIL_POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace realm {
+namespace util {
+
+// A process-wide pool for the small, frequently recreated objects of the
+// notifier machinery. Blocks are carved out of page-sized slabs and recycled
+// through per-size free lists rather than being returned to the
+// general-purpose heap, so register/unregister churn of short-lived
+// notifiers does not fragment the heap. The slabs themselves are never
+// released; the pool's footprint is the high-water mark of concurrently
+// live objects.
+class ObjectPool {
+public:
+    // Size of the largest block served from the pool. Larger requests fall
+    // through to operator new.
+    static constexpr size_t max_block_size = 512;
+    // Block sizes are rounded up to a multiple of this, which also bounds
+    // the alignment the pool can provide
+    static constexpr size_t block_granularity = alignof(std::max_align_t);
+
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr, size_t size) noexcept;
+};
+
+// Standard allocator over ObjectPool, for use with std::allocate_shared
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template<typename U>
+    PoolAllocator(PoolAllocator<U> const&) noexcept { }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(ObjectPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        ObjectPool::deallocate(ptr, n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept { return true; }
+template<typename T, typename U>
+bool operator!=(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept { return false; }
+
+// Construct a shared_ptr<T> whose object and reference counts live in a
+// single block drawn from the pool
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled_shared(Args&&... args)
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types cannot be placed in the pool");
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_OS_UTIL_POOL_ALLOCATOR_HPP
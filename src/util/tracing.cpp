@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "util/tracing.hpp"
+
+#if REALM_ENABLE_TRACEPOINTS
+
+namespace realm {
+namespace util {
+namespace trace {
+namespace _detail {
+
+std::atomic<Callback> g_callback{nullptr};
+
+} // namespace _detail
+} // namespace trace
+} // namespace util
+} // namespace realm
+
+#endif // REALM_ENABLE_TRACEPOINTS
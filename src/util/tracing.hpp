@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_UTIL_TRACING_HPP
+#define REALM_UTIL_TRACING_HPP
+
+#include <cstdint>
+
+#if REALM_ENABLE_TRACEPOINTS
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace realm {
+namespace util {
+namespace trace {
+
+// Static tracepoints at the key transitions in the notification pipeline.
+// They are compiled out entirely unless REALM_ENABLE_TRACEPOINTS is defined
+// (cmake -DREALM_ENABLE_TRACEPOINTS=ON); when compiled in, each tracepoint is
+// a single relaxed-ish atomic load until a consumer is registered with
+// set_callback(). Bindings can forward the callback to platform tracing
+// facilities (USDT probes, os_signpost, ETW) as appropriate.
+
+// Which transition in the pipeline a tracepoint marks
+enum class Event : uint8_t {
+    // RealmCoordinator::on_change() began processing a commit notification.
+    // Instantaneous; subject is the RealmCoordinator.
+    coordinator_on_change,
+    // One notifier recalculated its changeset. Duration covers
+    // CollectionNotifier::run(); subject is the notifier.
+    notifier_run,
+    // One notifier converted its accumulated changes into the immutable
+    // changesets handed to callbacks. Duration covers package_for_delivery();
+    // subject is the notifier.
+    notifier_package,
+    // A Realm's read transaction was advanced by refresh() or notify().
+    // Duration covers the advance including KVO interleaving and callback
+    // delivery; subject is the Realm.
+    realm_advance,
+    // The transact logs for one version transition were parsed to produce
+    // change information. Subject is the SharedGroup being advanced.
+    transact_log_parse,
+};
+
+// Callback invoked each time a tracepoint is hit. `subject` identifies the
+// object the event concerns and is usable only as an opaque correlation key;
+// `duration_ns` is zero for instantaneous events. The callback runs on
+// whichever thread hit the tracepoint, including the coordinator's background
+// worker, and so must not block or call back into the object store.
+using Callback = void (*)(Event event, const void* subject, uint64_t duration_ns);
+
+#if REALM_ENABLE_TRACEPOINTS
+
+namespace _detail {
+extern std::atomic<Callback> g_callback;
+}
+
+// Install the process-wide tracepoint consumer, or remove it with nullptr.
+// Tracepoints hit concurrently with removal may still invoke the callback.
+inline void set_callback(Callback callback) noexcept
+{
+    _detail::g_callback.store(callback, std::memory_order_release);
+}
+
+// Record an instantaneous event
+inline void point(Event event, const void* subject) noexcept
+{
+    if (auto callback = _detail::g_callback.load(std::memory_order_acquire))
+        callback(event, subject, 0);
+}
+
+// Times the enclosing scope and reports it as `event` on destruction. The
+// clock is only read if a consumer was registered when the scope was entered.
+class Scope {
+public:
+    Scope(Event event, const void* subject) noexcept
+    : m_callback(_detail::g_callback.load(std::memory_order_acquire))
+    , m_event(event)
+    , m_subject(subject)
+    {
+        if (m_callback)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~Scope()
+    {
+        if (m_callback) {
+            auto duration = std::chrono::steady_clock::now() - m_start;
+            m_callback(m_event, m_subject,
+                       uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+        }
+    }
+
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+
+private:
+    Callback m_callback;
+    Event m_event;
+    const void* m_subject;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#else // REALM_ENABLE_TRACEPOINTS
+
+inline void set_callback(Callback) noexcept { }
+inline void point(Event, const void*) noexcept { }
+
+class Scope {
+public:
+    Scope(Event, const void*) noexcept { }
+};
+
+#endif // REALM_ENABLE_TRACEPOINTS
+
+} // namespace trace
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_TRACING_HPP
@@ -47,33 +47,60 @@ T create_and_seed_engine()
     return engine;
 }
 
-} // unnamed namespace
-
-namespace realm {
-namespace util {
-
-std::string uuid_string()
+// The engine is per-thread so that the entropy cost of seeding is paid once
+// per thread rather than guarded against concurrent access on every draw.
+std::mt19937& thread_engine()
 {
-    static auto engine = create_and_seed_engine<std::mt19937>();
+    thread_local auto engine = create_and_seed_engine<std::mt19937>();
+    return engine;
+}
 
+std::string make_uuid_string(std::mt19937& engine)
+{
     std::array<uint8_t, 16> uuid_bytes;
-    std::uniform_int_distribution<unsigned int> distribution(0, std::numeric_limits<uint8_t>::max());
-    std::generate(begin(uuid_bytes), end(uuid_bytes), [&] { return distribution(engine); });
+    // The engine produces uniformly distributed 32-bit words, so four draws
+    // fill the sixteen bytes without a distribution per byte.
+    for (size_t i = 0; i < uuid_bytes.size(); i += 4) {
+        auto word = static_cast<uint32_t>(engine());
+        uuid_bytes[i + 0] = uint8_t(word);
+        uuid_bytes[i + 1] = uint8_t(word >> 8);
+        uuid_bytes[i + 2] = uint8_t(word >> 16);
+        uuid_bytes[i + 3] = uint8_t(word >> 24);
+    }
 
     // Version 4 UUID.
     uuid_bytes[6] = (uuid_bytes[6] & 0x0f) | 0x40;
     // IETF variant.
     uuid_bytes[8] = (uuid_bytes[8] & 0x3f) | 0x80;
 
-    std::array<char, 36> uuid_formatted;
-    snprintf(uuid_formatted.data(), uuid_formatted.size() + 1,
+    // One extra byte for the terminating NUL which snprintf always writes
+    std::array<char, 37> uuid_formatted;
+    snprintf(uuid_formatted.data(), uuid_formatted.size(),
              "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
              uuid_bytes[0], uuid_bytes[1], uuid_bytes[2], uuid_bytes[3],
              uuid_bytes[4], uuid_bytes[5], uuid_bytes[6], uuid_bytes[7],
              uuid_bytes[8], uuid_bytes[9], uuid_bytes[10], uuid_bytes[11],
              uuid_bytes[12], uuid_bytes[13], uuid_bytes[14], uuid_bytes[15]);
 
-    return std::string(uuid_formatted.data(), uuid_formatted.size());
+    return std::string(uuid_formatted.data(), uuid_formatted.size() - 1);
+}
+
+} // unnamed namespace
+
+namespace realm {
+namespace util {
+
+std::string uuid_string()
+{
+    return make_uuid_string(thread_engine());
+}
+
+void uuid_strings(std::string* out, size_t count)
+{
+    // Look the engine up once for the whole batch
+    auto& engine = thread_engine();
+    for (size_t i = 0; i < count; ++i)
+        out[i] = make_uuid_string(engine);
 }
 
 } // namespace util
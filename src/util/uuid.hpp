@@ -19,6 +19,7 @@
 #ifndef REALM_OS_UTIL_UUID_HPP
 #define REALM_OS_UTIL_UUID_HPP
 
+#include <cstddef>
 #include <string>
 
 namespace realm {
@@ -27,6 +28,12 @@ namespace util {
 // Generate a random UUID and return its formatted string representation.
 std::string uuid_string();
 
+// Generate `count` random UUIDs, writing their formatted string
+// representations to the first `count` elements of `out`. Equivalent to
+// calling `uuid_string()` in a loop, but pays the per-call generator lookup
+// only once for the whole batch.
+void uuid_strings(std::string* out, std::size_t count);
+
 } // namespace util
 } // namespace realm
 
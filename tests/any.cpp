@@ -69,6 +69,17 @@ TEST_CASE("util::Any basic API") {
 		REQUIRE(util::any_cast<int>(second_any) == first_value);
 		REQUIRE(util::any_cast<bool>(first_any) == second_value);
 	}
+
+	SECTION("swap works across storage categories") {
+		// ints are stored inline while strings are too big and go on the heap
+		const int int_value = 15;
+		const std::string str_value = "a string which does not fit in the inline buffer";
+		auto int_any = util::Any(int_value);
+		auto str_any = util::Any(str_value);
+		int_any.swap(str_any);
+		REQUIRE(util::any_cast<int>(str_any) == int_value);
+		REQUIRE(util::any_cast<std::string>(int_any) == str_value);
+	}
 }
 
 TEST_CASE("util::Any wrapping types") {
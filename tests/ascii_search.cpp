@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+
+#include "util/ascii_search.hpp"
+
+#include <string>
+
+using namespace realm;
+
+TEST_CASE("ascii_search") {
+    SECTION("is_ascii") {
+        REQUIRE(util::is_ascii(""));
+        REQUIRE(util::is_ascii("hello, world 123"));
+        REQUIRE_FALSE(util::is_ascii("grün"));
+    }
+
+    SECTION("ascii_tolower folds only the letters") {
+        std::string s = "Hello, World! 123";
+        util::ascii_tolower(s);
+        REQUIRE(s == "hello, world! 123");
+
+        // The bytes adjacent to the letter ranges must pass through unchanged
+        s = "@[`{";
+        util::ascii_tolower(s);
+        REQUIRE(s == "@[`{");
+    }
+
+    SECTION("contains matches case-insensitively") {
+        REQUIRE(util::ascii_contains_ins("Hello World", "world"));
+        REQUIRE(util::ascii_contains_ins("HELLO", "ell"));
+        REQUIRE(util::ascii_contains_ins("hello", "hello"));
+        REQUIRE_FALSE(util::ascii_contains_ins("hello", "world"));
+        REQUIRE_FALSE(util::ascii_contains_ins("he", "hello"));
+        REQUIRE_FALSE(util::ascii_contains_ins(StringData(), "a"));
+    }
+
+    SECTION("'[' does not match '{'") {
+        // '[' is '{' without the case bit; folding must not touch it
+        REQUIRE_FALSE(util::ascii_contains_ins("[\\]^", "{"));
+        REQUIRE_FALSE(util::ascii_contains_ins("@", "`"));
+    }
+
+    SECTION("non-ASCII haystack characters never match") {
+        REQUIRE(util::ascii_contains_ins("grün", "gr"));
+        REQUIRE_FALSE(util::ascii_contains_ins("grün", "u"));
+        // 'K' (U+212A) does not fold to an ASCII 'k' here, and must not match
+        REQUIRE_FALSE(util::ascii_contains_ins("\xE2\x84\xAA", "k"));
+    }
+
+    SECTION("matches are found at every offset") {
+        // Exercise the chunked scan, the scalar tail, and matches straddling
+        // a chunk boundary by sliding a needle over a buffer longer than the
+        // eight-byte chunk size
+        std::string haystack(30, 'x');
+        for (size_t pos = 0; pos + 3 <= haystack.size(); ++pos) {
+            std::string h = haystack;
+            h[pos] = 'A';
+            h[pos + 1] = 'b';
+            h[pos + 2] = 'C';
+            REQUIRE(util::ascii_contains_ins(h, "abc"));
+            REQUIRE_FALSE(util::ascii_contains_ins(h, "abd"));
+        }
+    }
+
+    SECTION("first-byte candidates which do not start a match are skipped") {
+        REQUIRE(util::ascii_contains_ins("aaaaaaaaaaaaaaaab", "aab"));
+        REQUIRE_FALSE(util::ascii_contains_ins("aaaaaaaaaaaaaaaa", "aab"));
+    }
+
+    SECTION("begins_with and ends_with") {
+        REQUIRE(util::ascii_begins_with_ins("Hello", "he"));
+        REQUIRE_FALSE(util::ascii_begins_with_ins("Hello", "el"));
+        REQUIRE_FALSE(util::ascii_begins_with_ins("He", "hel"));
+        REQUIRE(util::ascii_ends_with_ins("HellO", "lo"));
+        REQUIRE_FALSE(util::ascii_ends_with_ins("Hello", "ll"));
+        REQUIRE_FALSE(util::ascii_ends_with_ins(StringData(), "a"));
+    }
+}
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+
+#include "util/index_helpers.hpp"
+#include "util/test_file.hpp"
+
+#include "awaitable.hpp"
+#include "list.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+
+#include <realm/group_shared.hpp>
+#include <realm/link_view.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace realm;
+
+namespace {
+// Stands in for the thunk a coroutine shim's await_suspend() would pass to
+// resume its coroutine_handle
+struct Consumer {
+    bool resumed = false;
+    static void resume(void* context)
+    {
+        static_cast<Consumer*>(context)->resumed = true;
+    }
+};
+} // anonymous namespace
+
+TEST_CASE("awaitable: next change") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.cache = false;
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+        {"origin", {
+            {"array", PropertyType::Array, "object"}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    Results results(r, table->where());
+
+    auto write = [&](auto&& fn) {
+        r->begin_transaction();
+        fn();
+        r->commit_transaction();
+    };
+
+    SECTION("completes with the initial notification") {
+        NextChangeAwaitable awaitable(results);
+        Consumer consumer;
+        REQUIRE_FALSE(awaitable.await_ready());
+        REQUIRE(awaitable.await_suspend(&Consumer::resume, &consumer));
+
+        advance_and_notify(*r);
+        REQUIRE(consumer.resumed);
+        auto change = awaitable.await_resume();
+        REQUIRE(change.insertions.empty());
+        REQUIRE_FALSE(awaitable.await_ready());
+    }
+
+    SECTION("completes with the changeset for the following write") {
+        NextChangeAwaitable awaitable(results);
+        advance_and_notify(*r);
+        awaitable.await_resume();
+
+        Consumer consumer;
+        REQUIRE(awaitable.await_suspend(&Consumer::resume, &consumer));
+        write([&] { table->add_empty_row(); });
+        advance_and_notify(*r);
+
+        REQUIRE(consumer.resumed);
+        auto change = awaitable.await_resume();
+        REQUIRE_INDICES(change.insertions, 0);
+    }
+
+    SECTION("a notification delivered before the await completes it immediately") {
+        NextChangeAwaitable awaitable(results);
+        advance_and_notify(*r);
+        awaitable.await_resume();
+
+        write([&] { table->add_empty_row(); });
+        advance_and_notify(*r);
+
+        Consumer consumer;
+        REQUIRE(awaitable.await_ready());
+        REQUIRE_FALSE(awaitable.await_suspend(&Consumer::resume, &consumer));
+        REQUIRE_INDICES(awaitable.await_resume().insertions, 0);
+    }
+
+    SECTION("only the most recent changeset is kept between awaits") {
+        NextChangeAwaitable awaitable(results);
+        advance_and_notify(*r);
+        awaitable.await_resume();
+
+        write([&] { table->add_empty_row(); });
+        advance_and_notify(*r);
+        write([&] { table->set_int(0, 0, 1); });
+        advance_and_notify(*r);
+
+        auto change = awaitable.await_resume();
+        REQUIRE(change.insertions.empty());
+        REQUIRE_INDICES(change.modifications, 0);
+    }
+
+    SECTION("can be awaited on a List") {
+        r->begin_transaction();
+        auto origin = r->read_group().get_table("class_origin");
+        origin->add_empty_row();
+        auto lv = origin->get_linklist(0, 0);
+        r->commit_transaction();
+
+        List list(r, lv);
+        NextChangeAwaitable awaitable(list);
+        Consumer consumer;
+        REQUIRE(awaitable.await_suspend(&Consumer::resume, &consumer));
+        advance_and_notify(*r);
+        REQUIRE(consumer.resumed);
+        awaitable.await_resume();
+    }
+}
+
+TEST_CASE("awaitable: async write") {
+    InMemoryTestFile config;
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    // The continuation is invoked on the background writer thread and must
+    // finish the write before returning, as a resumed coroutine would
+    struct WriteConsumer {
+        AsyncWriteAwaitable& awaitable;
+        std::atomic<bool> done{false};
+        static void resume(void* context)
+        {
+            auto self = static_cast<WriteConsumer*>(context);
+            auto realm = self->awaitable.await_resume();
+            realm->read_group().get_table("class_object")->add_empty_row();
+            realm->commit_transaction();
+            self->done = true;
+        }
+    };
+
+    SECTION("completes on the writer thread with an active write transaction") {
+        AsyncWriteAwaitable awaitable(*r);
+        WriteConsumer consumer{awaitable};
+        if (!awaitable.await_suspend(&WriteConsumer::resume, &consumer))
+            WriteConsumer::resume(&consumer);
+        while (!consumer.done)
+            std::this_thread::yield();
+
+        r->refresh();
+        REQUIRE(r->read_group().get_table("class_object")->size() == 1);
+    }
+
+    SECTION("dropping the awaitable before it completes discards the transaction") {
+        {
+            AsyncWriteAwaitable discarded(*r);
+        }
+
+        // Writes are performed in queue order, so once the second write's
+        // row is visible the discarded one has been rolled back
+        AsyncWriteAwaitable awaitable(*r);
+        WriteConsumer consumer{awaitable};
+        if (!awaitable.await_suspend(&WriteConsumer::resume, &consumer))
+            WriteConsumer::resume(&consumer);
+        while (!consumer.done)
+            std::this_thread::yield();
+
+        r->refresh();
+        REQUIRE(r->read_group().get_table("class_object")->size() == 1);
+    }
+}
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Benchmark for the collection diff engine (CollectionChangeBuilder's
+// calculate(), merge() and finalize()) over shapes seen in real apps, with
+// per-operation timing output so that regressions between releases show up
+// as numbers rather than bug reports. Not built by default; build the
+// `diff-benchmark` target explicitly.
+
+#include "impl/collection_change_builder.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using realm::IndexSet;
+using realm::util::Optional;
+using realm::_impl::CollectionChangeBuilder;
+
+namespace {
+// Accumulator which the benchmarked results are fed into so that the work
+// can't be optimized away
+volatile size_t sink;
+
+template<typename Fn>
+void benchmark(const char* name, const char* op, size_t reps, Fn&& fn)
+{
+    using namespace std::chrono;
+    fn(); // warm-up
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < reps; ++i)
+        fn();
+    auto total = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    printf("%-55s %-10s %12.1f us/op\n", name, op, total / 1000.0 / double(reps));
+}
+
+std::vector<size_t> iota_rows(size_t count, size_t start = 0)
+{
+    std::vector<size_t> rows(count);
+    std::iota(rows.begin(), rows.end(), start);
+    return rows;
+}
+} // anonymous namespace
+
+int main()
+{
+    std::mt19937 rng(39578430);
+    const size_t row_count = 100000;
+
+    // A large sorted Results where a commit modified scattered rows but the
+    // order and membership didn't change: the common "sync wrote some
+    // objects" shape
+    {
+        auto rows = iota_rows(row_count);
+        benchmark("sorted Results, scattered modifications (100k rows)", "calculate", 20, [&] {
+            auto change = CollectionChangeBuilder::calculate(rows, rows,
+                                                             [](size_t ndx) { return ndx % 100 == 0; },
+                                                             realm::util::none);
+            sink = sink + change.modifications.count();
+        });
+    }
+
+    // Bulk prepend: 10k new rows sort before everything previously in the
+    // Results, as with a descending sort on creation date
+    {
+        auto old_rows = iota_rows(row_count, 10000);
+        auto new_rows = iota_rows(row_count + 10000);
+        benchmark("sorted Results, bulk prepend (10k of 110k rows)", "calculate", 20, [&] {
+            auto change = CollectionChangeBuilder::calculate(old_rows, new_rows,
+                                                             [](size_t) { return false; },
+                                                             realm::util::none);
+            sink = sink + change.insertions.count();
+        });
+    }
+
+    // Table-order Results where scattered rows stopped matching the query
+    // and move_over() renumbering applies: the shape produced by deleting
+    // objects one at a time
+    {
+        auto old_rows = iota_rows(row_count);
+        std::vector<size_t> new_rows;
+        IndexSet move_candidates;
+        new_rows.reserve(row_count);
+        for (size_t i = 0; i < row_count; ++i) {
+            if (i % 10 == 0) {
+                old_rows[i] = IndexSet::npos;
+                move_candidates.add(i);
+            }
+            else
+                new_rows.push_back(i);
+        }
+        benchmark("table-order Results, 10% removed with move hints", "calculate", 20, [&] {
+            auto change = CollectionChangeBuilder::calculate(old_rows, new_rows,
+                                                             [](size_t) { return false; },
+                                                             Optional<IndexSet>(move_candidates));
+            sink = sink + change.deletions.count();
+        });
+    }
+
+    // Raw transact-log observation cost of interleaved move-last-over
+    // deletions, which shift and merge existing ranges on every call
+    {
+        benchmark("builder, 5k interleaved move_over deletions", "move_over", 20, [&] {
+            CollectionChangeBuilder change;
+            size_t size = row_count;
+            std::mt19937 op_rng(39578430);
+            for (size_t i = 0; i < 5000; ++i) {
+                change.move_over(op_rng() % size, size - 1);
+                --size;
+            }
+            sink = sink + change.deletions.count();
+        });
+    }
+
+    // Accumulating several commits' worth of scattered changes into one
+    // changeset, as happens when notifications are delivered less often
+    // than commits occur
+    {
+        benchmark("10 commits of scattered inserts+modifications", "merge", 20, [&] {
+            CollectionChangeBuilder accumulated;
+            std::mt19937 op_rng(39578430);
+            for (size_t commit = 0; commit < 10; ++commit) {
+                CollectionChangeBuilder change;
+                for (size_t i = 0; i < 1000; ++i)
+                    change.modify(op_rng() % row_count);
+                for (size_t i = 0; i < 100; ++i)
+                    change.insert(op_rng() % row_count);
+                accumulated.merge(std::move(change));
+            }
+            sink = sink + accumulated.modifications.count();
+        });
+    }
+
+    // Producing the immutable changeset handed to callbacks from a heavily
+    // fragmented builder (finalize() consumes the builder, so the copy cost
+    // is measured alongside it and reported separately as a baseline)
+    {
+        CollectionChangeBuilder fragmented;
+        for (size_t i = 0; i < 20000; ++i)
+            fragmented.modify(rng() % row_count);
+        for (size_t i = 0; i < 1000; ++i)
+            fragmented.insert(rng() % row_count);
+        benchmark("fragmented changeset of 20k modifications, copy only", "copy", 100, [&] {
+            CollectionChangeBuilder copy = fragmented;
+            sink = sink + copy.modifications.count();
+        });
+        benchmark("fragmented changeset of 20k modifications", "finalize", 100, [&] {
+            CollectionChangeBuilder copy = fragmented;
+            auto change = std::move(copy).finalize();
+            sink = sink + change.modifications.count();
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Benchmark for migration cost across the schema-change shapes exercised by
+// tests/migrations.cpp, replayed against generated datasets. Each scenario
+// isolates one phase of applying schema changes — creating a new table,
+// adding and removing columns, building a search index, adding a link column
+// (and with it the target table's backlink column), and running a per-row
+// migration function — so the timings show which shapes scale with the data
+// size and which are metadata-only. Every measurement opens a fresh Realm
+// file, populates it at schema version 0, and times update_schema() to
+// version 1. Row counts are given as command-line arguments (default
+// 10000 100000; anything up to 10M is reasonable if you have the time).
+// Not built by default; build the `migration-benchmark` target explicitly.
+
+#include "object_store.hpp"
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/disable_sync_to_disk.hpp>
+#include <realm/group.hpp>
+#include <realm/table.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+inline static int mkstemp(char* _template) { return _open(_mktemp(_template), _O_CREAT | _O_TEMPORARY, _S_IREAD | _S_IWRITE); }
+#else
+#include <unistd.h>
+#endif
+
+using namespace realm;
+
+namespace {
+std::string make_temp_path()
+{
+    const char* dir = getenv("TMPDIR");
+    std::string path = std::string(dir && *dir ? dir : "/tmp") + "/migration_benchmark.XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0)
+        abort();
+    close(fd);
+    unlink(path.c_str());
+    return path;
+}
+
+Schema base_schema()
+{
+    return Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    };
+}
+
+struct Scenario {
+    const char* name;
+    Schema to;
+    Realm::MigrationFunction migration;
+};
+
+std::vector<Scenario> make_scenarios()
+{
+    std::vector<Scenario> scenarios;
+
+    // Metadata-only: a new empty table is created and no existing rows are
+    // touched
+    scenarios.push_back({"create table", Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+        {"extra", {
+            {"value", PropertyType::Int},
+        }},
+    }, nullptr});
+
+    // A column is inserted into a populated table
+    scenarios.push_back({"add column", Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String},
+            {"extra", PropertyType::Int},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    }, nullptr});
+
+    // A column is removed from a populated table
+    scenarios.push_back({"remove column", Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    }, nullptr});
+
+    // A search index is built over the existing rows
+    scenarios.push_back({"add search index", Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, true, false},
+            {"name", PropertyType::String},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    }, nullptr});
+
+    // A link column is added, which also adds the backlink column to the
+    // (populated) target table
+    scenarios.push_back({"add link column", Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String},
+            {"link", PropertyType::Object, "target", "", false, false, true},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    }, nullptr});
+
+    // A migration function which touches every row: the new column is
+    // populated from the old one's values
+    scenarios.push_back({"per-row migration fn", Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String},
+            {"name length", PropertyType::Int},
+        }},
+        {"target", {
+            {"value", PropertyType::Int},
+        }},
+    }, [](SharedRealm old_realm, SharedRealm realm, Schema&) {
+        auto old_table = ObjectStore::table_for_object_type(old_realm->read_group(), "object");
+        auto table = ObjectStore::table_for_object_type(realm->read_group(), "object");
+        size_t name_col = old_table->get_column_index("name");
+        size_t length_col = table->get_column_index("name length");
+        for (size_t i = 0, n = table->size(); i < n; ++i)
+            table->set_int(length_col, i, int64_t(old_table->get_string(name_col, i).size()));
+    }});
+
+    return scenarios;
+}
+
+double run_scenario(Scenario const& scenario, size_t rows)
+{
+    Realm::Config config;
+    config.path = make_temp_path();
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema_version = 0;
+    config.schema = base_schema();
+
+    auto realm = Realm::get_shared_realm(config);
+    realm->begin_transaction();
+    auto table = realm->read_group().get_table("class_object");
+    auto target = realm->read_group().get_table("class_target");
+    table->add_empty_row(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        table->set_int(0, i, int64_t(i));
+        table->set_string(1, i, std::to_string(i));
+    }
+    size_t target_rows = rows / 10 + 1;
+    target->add_empty_row(target_rows);
+    for (size_t i = 0; i < target_rows; ++i)
+        target->set_int(0, i, int64_t(i));
+    realm->commit_transaction();
+
+    auto start = std::chrono::steady_clock::now();
+    realm->update_schema(scenario.to, 1, scenario.migration);
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    realm = nullptr;
+    unlink(config.path.c_str());
+    remove((config.path + ".lock").c_str());
+    remove((config.path + ".management").c_str());
+
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    realm::disable_sync_to_disk();
+
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back(size_t(strtoull(argv[i], nullptr, 10)));
+    if (sizes.empty())
+        sizes = {10'000, 100'000};
+
+    auto scenarios = make_scenarios();
+    for (auto rows : sizes) {
+        for (auto& scenario : scenarios) {
+            double ms = run_scenario(scenario, rows);
+            printf("%-24s %9zu rows  %10.2f ms\n", scenario.name, rows, ms);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Benchmark for the full commit-to-notification pipeline over scripted write
+// workloads against registered Results, Object and List notifiers. Each rep
+// is timed in three stages: "commit" is commit_transaction(), "advance" is
+// the background worker's run_async_notifiers() driven through
+// RealmCoordinator::on_change(), and "deliver" is Realm::notify() handing
+// the packaged changesets to the callbacks. The stages are driven
+// synchronously on one thread, so the cross-thread wakeup between them (the
+// ExternalCommitHelper's platform channel and the event loop hop) is
+// excluded; that is what makes the numbers stable enough to compare across
+// pipeline changes. Per-stage latency percentiles are reported for each
+// workload and notifier count. Not built by default; build the
+// `notifier-benchmark` target explicitly.
+
+#include "impl/realm_coordinator.hpp"
+#include "list.hpp"
+#include "object.hpp"
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/disable_sync_to_disk.hpp>
+#include <realm/group_shared.hpp>
+#include <realm/link_view.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+inline static int mkstemp(char* _template) { return _open(_mktemp(_template), _O_CREAT | _O_TEMPORARY, _S_IREAD | _S_IWRITE); }
+#else
+#include <unistd.h>
+#endif
+
+using namespace realm;
+
+namespace {
+// Accumulator which the notification callbacks feed into so that delivery
+// can't be optimized away
+volatile size_t sink;
+
+std::string make_temp_path()
+{
+    const char* dir = getenv("TMPDIR");
+    std::string path = std::string(dir && *dir ? dir : "/tmp") + "/notifier_benchmark.XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0)
+        abort();
+    close(fd);
+    unlink(path.c_str());
+    return path;
+}
+
+void report(const char* workload, size_t notifier_count, const char* stage, std::vector<double>& times)
+{
+    std::sort(times.begin(), times.end());
+    auto at = [&](double pct) { return times[size_t(pct * (times.size() - 1))]; };
+    printf("%-32s %4zu notifiers  %-8s p50 %9.2f us  p90 %9.2f us  p99 %9.2f us\n",
+           workload, notifier_count, stage, at(0.50), at(0.90), at(0.99));
+}
+
+// An open Realm with `results_count` Results notifiers over distinct
+// queries, ten Object notifiers and one List notifier registered, so every
+// notifier type is on the measured path
+struct Fixture {
+    Realm::Config config;
+    SharedRealm realm;
+    std::shared_ptr<_impl::RealmCoordinator> coordinator;
+    TableRef table;
+
+    std::vector<Results> results;
+    std::vector<Object> objects;
+    std::vector<List> lists;
+    std::vector<NotificationToken> tokens;
+
+    Fixture(size_t row_count, size_t results_count)
+    {
+        config.path = make_temp_path();
+        config.cache = false;
+        // The stages are driven manually below rather than through an
+        // event loop
+        config.automatic_change_notifications = false;
+        config.schema_version = 0;
+        config.schema = Schema{
+            {"object", {
+                {"value", PropertyType::Int}
+            }},
+            {"container", {
+                {"items", PropertyType::Array, "object"}
+            }},
+        };
+        realm = Realm::get_shared_realm(config);
+        coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+        table = realm->read_group().get_table("class_object");
+        auto container = realm->read_group().get_table("class_container");
+
+        realm->begin_transaction();
+        table->add_empty_row(row_count);
+        for (size_t i = 0; i < row_count; ++i)
+            table->set_int(0, i, int64_t(i));
+        container->add_empty_row();
+        auto link_view = container->get_linklist(0, 0);
+        for (size_t i = 0; i < row_count && i < 100; ++i)
+            link_view->add(i);
+        realm->commit_transaction();
+
+        // Distinct queries so that each Results notifier has to be run
+        // separately rather than sharing work
+        for (size_t i = 0; i < results_count; ++i) {
+            results.emplace_back(realm, table->where().greater(0, int64_t(i)));
+            tokens.push_back(results.back().add_notification_callback([](CollectionChangeSet change, std::exception_ptr) {
+                sink = sink + change.insertions.count();
+            }));
+        }
+
+        auto& object_schema = *realm->schema().find("object");
+        for (size_t i = 0; i < 10 && i < row_count; ++i) {
+            objects.emplace_back(realm, object_schema, table->get(i));
+            tokens.push_back(objects.back().add_notification_callback([](CollectionChangeSet, std::exception_ptr) {
+                sink = sink + 1;
+            }));
+        }
+
+        lists.emplace_back(realm, container->get_linklist(0, 0));
+        tokens.push_back(lists.back().add_notification_callback([](CollectionChangeSet, std::exception_ptr) {
+            sink = sink + 1;
+        }));
+
+        // Run the initial evaluation of every notifier so that the measured
+        // reps only cover incremental work
+        coordinator->on_change();
+        realm->notify();
+    }
+
+    ~Fixture()
+    {
+        tokens.clear();
+        results.clear();
+        objects.clear();
+        lists.clear();
+        realm->close();
+        remove(config.path.c_str());
+        remove((config.path + ".lock").c_str());
+        remove((config.path + ".note").c_str());
+        remove((config.path + ".management").c_str());
+    }
+
+    template<typename WriteFn>
+    void run(const char* workload, size_t reps, WriteFn&& write)
+    {
+        using namespace std::chrono;
+        std::vector<double> commit_times, advance_times, deliver_times;
+        commit_times.reserve(reps);
+        advance_times.reserve(reps);
+        deliver_times.reserve(reps);
+
+        for (size_t i = 0; i < reps; ++i) {
+            realm->begin_transaction();
+            write(i);
+
+            auto t0 = steady_clock::now();
+            realm->commit_transaction();
+            auto t1 = steady_clock::now();
+            coordinator->on_change();
+            auto t2 = steady_clock::now();
+            realm->notify();
+            auto t3 = steady_clock::now();
+
+            commit_times.push_back(duration_cast<nanoseconds>(t1 - t0).count() / 1000.0);
+            advance_times.push_back(duration_cast<nanoseconds>(t2 - t1).count() / 1000.0);
+            deliver_times.push_back(duration_cast<nanoseconds>(t3 - t2).count() / 1000.0);
+        }
+
+        size_t notifier_count = results.size() + objects.size() + lists.size();
+        report(workload, notifier_count, "commit", commit_times);
+        report(workload, notifier_count, "advance", advance_times);
+        report(workload, notifier_count, "deliver", deliver_times);
+    }
+};
+} // anonymous namespace
+
+int main()
+{
+    disable_sync_to_disk();
+
+    const size_t reps = 200;
+    const size_t row_count = 10000;
+
+    for (size_t results_count : {1, 10, 100}) {
+        // Append-heavy: the "initial download" / logging shape
+        {
+            Fixture fixture(row_count, results_count);
+            fixture.run("append-heavy (100 rows/commit)", reps, [&](size_t) {
+                size_t row = fixture.table->add_empty_row(100);
+                for (size_t i = 0; i < 100; ++i)
+                    fixture.table->set_int(0, row + i, int64_t(row + i));
+            });
+        }
+
+        // Scattered updates: the "sync wrote some objects" shape
+        {
+            Fixture fixture(row_count, results_count);
+            std::mt19937 rng(39578430);
+            fixture.run("scattered updates (100/commit)", reps, [&](size_t) {
+                for (size_t i = 0; i < 100; ++i) {
+                    size_t row = rng() % fixture.table->size();
+                    fixture.table->set_int(0, row, int64_t(rng() % row_count));
+                }
+            });
+        }
+
+        // Bulk deletes: enough rows are seeded up front for every rep to
+        // remove 100 without emptying the table
+        {
+            Fixture fixture(row_count + reps * 100, results_count);
+            std::mt19937 rng(39578430);
+            fixture.run("bulk deletes (100/commit)", reps, [&](size_t) {
+                for (size_t i = 0; i < 100; ++i)
+                    fixture.table->move_last_over(rng() % fixture.table->size());
+            });
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Benchmark for the query parser and query builder, timing parse() and
+// apply_predicate() separately for each entry of a query corpus and
+// reporting per-operation percentiles, so that grammar and builder changes
+// (PEGTL upgrades in particular) come with before/after numbers. Extra
+// queries can be appended to the corpus from a file of one query per line
+// passed as the only argument; those are timed through parse() only, since
+// their key paths need not resolve against the benchmark schema. Not built
+// by default; build the `parser-benchmark` target explicitly.
+
+#include "object_schema.hpp"
+#include "parser/parser.hpp"
+#include "parser/query_builder.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+// Accumulator which the benchmarked results are fed into so that the work
+// can't be optimized away
+volatile size_t sink;
+
+// Queries which resolve against the benchmark schema below, covering the
+// shapes bindings produce: each type of comparison, arguments, negation,
+// and compounds of various widths
+std::vector<std::string> corpus = {
+    "age > 5",
+    "age >= 5 && age <= 40",
+    "weight == 120.5",
+    "paid == true",
+    "height < 1.75",
+    "name == 'Sylvia'",
+    "name BEGINSWITH 'Syl'",
+    "name ENDSWITH[c] 'IA'",
+    "name CONTAINS 'lv'",
+    "age > $0",
+    "name == $1",
+    "!(age == 5)",
+    "NOT name BEGINSWITH 'X' AND age != 0",
+    "age == 1 || age == 2 || age == 3 || age == 4 || age == 5",
+    "(age > 5 && weight < 300.0) || (paid == false && name != '')",
+    "age > 5 && age > 6 && age > 7 && age > 8 && age > 9 && age > 10",
+    "TRUEPREDICATE",
+    "name == 'a' && (age > 1 || (weight < 2.0 && (paid == true || height > 0.5)))",
+};
+
+// Fixed values for $N arguments; the values never affect the work being
+// measured, only the code path taken
+class FixedArguments : public query_builder::Arguments {
+public:
+    bool bool_for_argument(size_t) override { return true; }
+    long long long_for_argument(size_t) override { return 5; }
+    float float_for_argument(size_t) override { return 1.5f; }
+    double double_for_argument(size_t) override { return 2.5; }
+    std::string string_for_argument(size_t) override { return "Sylvia"; }
+    std::string binary_for_argument(size_t) override { return ""; }
+    Timestamp timestamp_for_argument(size_t) override { return Timestamp(0, 0); }
+    size_t object_index_for_argument(size_t) override { return 0; }
+    bool is_argument_null(size_t) override { return false; }
+};
+
+struct Percentiles {
+    double p50, p90, p99;
+};
+
+// Time `reps` runs of `fn` individually and report the spread rather than
+// the mean, so that occasional slow runs are visible
+template<typename Fn>
+Percentiles measure(size_t reps, Fn&& fn)
+{
+    using namespace std::chrono;
+    fn(); // warm-up
+    std::vector<double> times;
+    times.reserve(reps);
+    for (size_t i = 0; i < reps; ++i) {
+        auto start = steady_clock::now();
+        fn();
+        times.push_back(duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1000.0);
+    }
+    std::sort(times.begin(), times.end());
+    auto at = [&](double pct) { return times[size_t(pct * (times.size() - 1))]; };
+    return {at(0.50), at(0.90), at(0.99)};
+}
+
+void report(const std::string& query, const char* op, Percentiles p)
+{
+    printf("%-70s %-7s p50 %8.2f us  p90 %8.2f us  p99 %8.2f us\n",
+           query.c_str(), op, p.p50, p.p90, p.p99);
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const size_t reps = 2000;
+
+    // A freestanding table and matching schema for the builder to resolve
+    // key paths against; no rows are needed since apply_predicate() only
+    // builds the query
+    Table table;
+    ObjectSchema object_schema;
+    object_schema.name = "object";
+    object_schema.persisted_properties = {
+        {"age", PropertyType::Int},
+        {"weight", PropertyType::Double},
+        {"name", PropertyType::String},
+        {"paid", PropertyType::Bool},
+        {"height", PropertyType::Float},
+    };
+    for (auto& property : object_schema.persisted_properties) {
+        property.table_column = table.add_column(DataType(property.type), property.name);
+    }
+    Schema schema({object_schema});
+    FixedArguments args;
+
+    for (auto& query : corpus) {
+        report(query, "parse", measure(reps, [&] {
+            auto predicate = parser::parse(query);
+            sink = sink + size_t(predicate.type);
+        }));
+
+        auto predicate = parser::parse(query);
+        report(query, "apply", measure(reps, [&] {
+            Query q = table.where();
+            query_builder::apply_predicate(q, predicate, args, schema, "object");
+            sink = sink + size_t(q.count());
+        }));
+    }
+
+    // Additional corpus entries from a file, parse-only
+    if (argc > 1) {
+        std::ifstream file(argv[1]);
+        std::string query;
+        while (std::getline(file, query)) {
+            if (query.empty())
+                continue;
+            report(query, "parse", measure(reps, [&] {
+                auto predicate = parser::parse(query);
+                sink = sink + size_t(predicate.type);
+            }));
+        }
+    }
+
+    return 0;
+}
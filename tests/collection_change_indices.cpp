@@ -71,6 +71,32 @@ TEST_CASE("collection_change: insert()") {
     }
 }
 
+TEST_CASE("collection_change: append()") {
+    _impl::CollectionChangeBuilder c;
+
+    SECTION("adds a trailing range to the insertions set") {
+        c.append(10, 2);
+        c.append(12);
+        REQUIRE_INDICES(c.insertions, 10, 11, 12);
+    }
+
+    SECTION("leaves lower tracked indices untouched") {
+        c.insert(5);
+        c.modify(8, 1);
+        c.append(10, 3);
+        REQUIRE_INDICES(c.insertions, 5, 10, 11, 12);
+        REQUIRE_INDICES(c.modifications, 8);
+
+        auto changes = std::move(c).finalize();
+        REQUIRE_INDICES(changes.columns[1], 8);
+    }
+
+    SECTION("records nothing when not tracking moves") {
+        c.append(10, 2, false);
+        REQUIRE(c.insertions.empty());
+    }
+}
+
 TEST_CASE("collection_change: modify()") {
     _impl::CollectionChangeBuilder c;
 
@@ -98,25 +124,31 @@ TEST_CASE("collection_change: modify()") {
 
     SECTION("marks the appropriate column as modified when applicable") {
         c.modify(5, 2);
-        REQUIRE_INDICES(c.modifications, 5);
-        REQUIRE(c.columns.size() > 2);
-        REQUIRE(c.columns[0].empty());
-        REQUIRE(c.columns[1].empty());
-        REQUIRE_INDICES(c.columns[2], 5);
-
         c.modify(4, 2);
-        REQUIRE_INDICES(c.modifications, 4, 5);
-        REQUIRE(c.columns.size() > 2);
-        REQUIRE(c.columns[0].empty());
-        REQUIRE(c.columns[1].empty());
-        REQUIRE_INDICES(c.columns[2], 4, 5);
-
         c.modify(3, 1);
         REQUIRE_INDICES(c.modifications, 3, 4, 5);
-        REQUIRE(c.columns.size() > 2);
-        REQUIRE(c.columns[0].empty());
-        REQUIRE_INDICES(c.columns[1], 3);
-        REQUIRE_INDICES(c.columns[2], 4, 5);
+
+        auto changes = std::move(c).finalize();
+        REQUIRE(changes.columns.size() > 2);
+        REQUIRE(changes.columns[0].empty());
+        REQUIRE_INDICES(changes.columns[1], 3);
+        REQUIRE_INDICES(changes.columns[2], 4, 5);
+    }
+
+    SECTION("tracks every touched column of a wide row") {
+        for (size_t col = 0; col < 70; ++col)
+            c.modify(5, col);
+        c.modify(3, 68);
+        REQUIRE_INDICES(c.modifications, 3, 5);
+
+        auto changes = std::move(c).finalize();
+        REQUIRE(changes.columns.size() == 70);
+        for (size_t col = 0; col < 70; ++col) {
+            if (col == 68)
+                REQUIRE_INDICES(changes.columns[col], 3, 5);
+            else
+                REQUIRE_INDICES(changes.columns[col], 5);
+        }
     }
 }
 
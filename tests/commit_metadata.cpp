@@ -0,0 +1,154 @@
+#include "catch.hpp"
+
+#include "util/index_helpers.hpp"
+#include "util/test_file.hpp"
+
+#include "impl/commit_metadata.hpp"
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+
+using namespace realm;
+using realm::_impl::CommitMetadata;
+
+TEST_CASE("commit metadata: table bits") {
+    REQUIRE(CommitMetadata::table_bit(0) == 1);
+    REQUIRE(CommitMetadata::table_bit(1) == 2);
+    REQUIRE(CommitMetadata::table_bit(62) == (1ULL << 62));
+
+    // Everything past the mask's capacity shares the top bit
+    REQUIRE(CommitMetadata::table_bit(63) == (1ULL << 63));
+    REQUIRE(CommitMetadata::table_bit(64) == (1ULL << 63));
+    REQUIRE(CommitMetadata::table_bit(10000) == (1ULL << 63));
+}
+
+#ifndef _WIN32 // no sidecar support on Windows yet
+TEST_CASE("commit metadata: records") {
+    TestFile config;
+    auto metadata = CommitMetadata::open(config.path, true);
+    REQUIRE(metadata);
+
+    SECTION("reports versions with no record as possibly changed") {
+        REQUIRE_FALSE(metadata->no_changes_for(1, 2, 1));
+        metadata->publish(2, 2);
+        REQUIRE(metadata->no_changes_for(1, 2, 1));
+        // Version 3 has no record
+        REQUIRE_FALSE(metadata->no_changes_for(1, 3, 1));
+    }
+
+    SECTION("reports changes only when the masks intersect") {
+        metadata->publish(2, 0b0110);
+        REQUIRE(metadata->no_changes_for(1, 2, 0b0001));
+        REQUIRE(metadata->no_changes_for(1, 2, 0b1001));
+        REQUIRE_FALSE(metadata->no_changes_for(1, 2, 0b0010));
+        REQUIRE_FALSE(metadata->no_changes_for(1, 2, 0b1111));
+    }
+
+    SECTION("checks every version in the span") {
+        metadata->publish(2, 1);
+        metadata->publish(3, 2);
+        metadata->publish(4, 1);
+        REQUIRE(metadata->no_changes_for(1, 4, 4));
+        REQUIRE_FALSE(metadata->no_changes_for(1, 4, 2));
+        REQUIRE_FALSE(metadata->no_changes_for(1, 4, 1));
+        REQUIRE(metadata->no_changes_for(2, 3, 1));
+    }
+
+    SECTION("rejects spans longer than the record capacity") {
+        REQUIRE_FALSE(metadata->no_changes_for(1, 100000, 1));
+    }
+
+    SECTION("detects records overwritten by a later version in the same slot") {
+        metadata->publish(2, 0);
+        metadata->publish(2 + 256, 0);
+        REQUIRE_FALSE(metadata->no_changes_for(1, 2, 1));
+        REQUIRE(metadata->no_changes_for(1 + 256, 2 + 256, 1));
+    }
+
+    SECTION("is readable through a separate non-creating mapping") {
+        metadata->publish(2, 2);
+        auto reader = CommitMetadata::open(config.path, false);
+        REQUIRE(reader);
+        REQUIRE(reader->no_changes_for(1, 2, 1));
+        REQUIRE_FALSE(reader->no_changes_for(1, 2, 2));
+    }
+
+    SECTION("does not open a missing sidecar unless created") {
+        REQUIRE_FALSE(CommitMetadata::open(config.path + ".other", false));
+    }
+
+    SECTION("remove() deletes the sidecar") {
+        CommitMetadata::remove(config.path);
+        REQUIRE_FALSE(CommitMetadata::open(config.path, false));
+    }
+
+    CommitMetadata::remove(config.path);
+}
+#endif
+
+TEST_CASE("commit metadata: notifications") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.publish_commit_metadata = true;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+        {"other", {
+            {"value", PropertyType::Int},
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    auto other = r->read_group().get_table("class_other");
+    Results results(r, table->where());
+
+    CollectionChangeSet change;
+    int notification_calls = 0;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = c;
+        ++notification_calls;
+    });
+
+    advance_and_notify(*r);
+    REQUIRE(notification_calls == 1);
+
+    auto write = [&](auto&& f) {
+        r->begin_transaction();
+        f();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("commits to unobserved tables produce no notifications") {
+        write([&] {
+            other->set_int(0, other->add_empty_row(), 1);
+        });
+        write([&] {
+            other->set_int(0, 0, 2);
+        });
+        REQUIRE(notification_calls == 1);
+    }
+
+    SECTION("commits to the observed table are still delivered after skipped ones") {
+        write([&] {
+            other->add_empty_row();
+        });
+        write([&] {
+            table->set_int(0, table->add_empty_row(), 1);
+        });
+        REQUIRE(notification_calls == 2);
+        REQUIRE_INDICES(change.insertions, 0);
+
+        write([&] {
+            table->set_int(0, 0, 2);
+        });
+        REQUIRE(notification_calls == 3);
+        REQUIRE_INDICES(change.modifications, 0);
+    }
+}
@@ -21,6 +21,7 @@
 #include "index_set.hpp"
 
 #include "util/index_helpers.hpp"
+#include "util/test_allocator.hpp"
 
 TEST_CASE("index_set: contains()") {
     SECTION("returns false if the index is before the first entry in the set") {
@@ -149,6 +150,71 @@ TEST_CASE("index_set: add()") {
         set.add(set2);
         REQUIRE(set.count() == 30);
     }
+
+    SECTION("combines heavily fragmented sets via the bitmap path") {
+        realm::IndexSet set2;
+        for (size_t i = 0; i < 100; ++i) {
+            set.add(i * 2);
+            set2.add(i * 2 + 1);
+        }
+        set.add(set2);
+        REQUIRE(set.count() == 200);
+        REQUIRE(set.contains(0));
+        REQUIRE(set.contains(199));
+        REQUIRE_FALSE(set.contains(200));
+        set.verify();
+    }
+
+    SECTION("bitmap merging of overlapping fragmented sets does not duplicate indices") {
+        realm::IndexSet set2;
+        for (size_t i = 0; i < 100; ++i) {
+            set.add(i * 3);
+            set2.add(i * 2);
+        }
+        set.add(set2);
+        size_t expected = 0;
+        for (size_t i = 0; i < 300; ++i)
+            expected += i % 3 == 0 || (i % 2 == 0 && i < 200);
+        REQUIRE(set.count() == expected);
+        set.verify();
+    }
+}
+
+TEST_CASE("index_set: add_sorted()") {
+    realm::IndexSet set;
+
+    SECTION("coalesces consecutive indices and duplicates") {
+        set.add_sorted({0, 1, 1, 2, 5, 7, 8});
+        REQUIRE_INDICES(set, 0, 1, 2, 5, 7, 8);
+    }
+
+    SECTION("merges the batch into an existing set") {
+        set = {0, 3, 6};
+        set.add_sorted({1, 3, 4, 10});
+        REQUIRE_INDICES(set, 0, 1, 3, 4, 6, 10);
+    }
+
+    SECTION("merges batches spanning multiple chunks") {
+        for (size_t i = 0; i < 20; ++i)
+            set.add(i * 2);
+        std::vector<size_t> batch;
+        for (size_t i = 0; i < 20; ++i)
+            batch.push_back(i * 2 + 1);
+        set.add_sorted(batch);
+        REQUIRE(set.count() == 40);
+        set.verify();
+    }
+
+    SECTION("takes the incremental path for a small batch into a large set") {
+        for (size_t i = 0; i < 100; ++i)
+            set.add(i * 3);
+        set.add_sorted({1, 4, 1000});
+        REQUIRE(set.count() == 103);
+        REQUIRE(set.contains(1));
+        REQUIRE(set.contains(4));
+        REQUIRE(set.contains(1000));
+        set.verify();
+    }
 }
 
 TEST_CASE("index_set: add_shifted()") {
@@ -368,6 +434,18 @@ TEST_CASE("index_set: shift_for_insert_at()") {
         REQUIRE_INDICES(set, 15);
     }
 
+    SECTION("shifts every chunk when the insertion point is before all of them") {
+        // More than one chunk of ranges (chunks are four ranges in debug
+        // builds), so the chunks after the insertion point are shifted
+        // whole-chunk rather than range by range
+        set = {2, 4, 6, 8, 10, 12, 14, 16, 18, 20};
+        set.shift_for_insert_at(0, 3);
+        REQUIRE_INDICES(set, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23);
+
+        set.shift_for_insert_at(8);
+        REQUIRE_INDICES(set, 5, 7, 10, 12, 14, 16, 18, 20, 22, 24);
+    }
+
     SECTION("does not shift indices before the insertion points") {
         set = {5};
 
@@ -608,3 +686,77 @@ TEST_CASE("index_set: clear()") {
         REQUIRE(set.empty());
     }
 }
+
+TEST_CASE("index_set: add() allocation budget") {
+    realm::IndexSet set;
+    set.add(0);
+
+    SECTION("extending a contiguous range does not allocate") {
+        REQUIRE_ALLOCATIONS_UNDER(0) {
+            for (size_t i = 1; i < 1000; ++i)
+                set.add(i);
+        }
+    }
+
+    SECTION("disjoint ranges only allocate when growing the chunk") {
+        // Each disjoint index adds a range within an existing chunk, so the
+        // only allocations should be the chunk vector's geometric growth
+        REQUIRE_ALLOCATIONS_UNDER(20) {
+            for (size_t i = 2; i < 400; i += 2)
+                set.add(i);
+        }
+    }
+}
+
+TEST_CASE("index_set: for_each_range()") {
+    SECTION("visits each range in order") {
+        realm::IndexSet set = {1, 2, 5, 8};
+        std::vector<std::pair<size_t, size_t>> ranges;
+        set.for_each_range([&](auto range) { ranges.push_back(range); });
+        REQUIRE(ranges == (std::vector<std::pair<size_t, size_t>>{{1, 3}, {5, 6}, {8, 9}}));
+    }
+
+    SECTION("does nothing for an empty set") {
+        realm::IndexSet set;
+        set.for_each_range([&](auto) { FAIL("should not be called"); });
+    }
+
+    SECTION("spans chunk boundaries") {
+        realm::IndexSet set;
+        size_t count = realm::_impl::ChunkedRangeVector::max_size * 4;
+        for (size_t i = 0; i < count; ++i)
+            set.add(i * 2);
+
+        size_t ranges = 0, prev_end = 0;
+        set.for_each_range([&](auto range) {
+            REQUIRE(range.first >= prev_end);
+            prev_end = range.second;
+            ++ranges;
+        });
+        REQUIRE(ranges == count);
+    }
+}
+
+TEST_CASE("index_set: as_span()") {
+    SECTION("is empty for an empty set") {
+        realm::IndexSet set;
+        REQUIRE(set.is_single_chunk());
+        REQUIRE(set.as_span().size() == 0);
+    }
+
+    SECTION("provides a flat view over a single-chunk set") {
+        realm::IndexSet set = {1, 2, 5};
+        REQUIRE(set.is_single_chunk());
+        auto span = set.as_span();
+        REQUIRE(span.size() == 2);
+        REQUIRE(span.begin()[0] == std::make_pair<size_t, size_t>(1, 3));
+        REQUIRE(span.begin()[1] == std::make_pair<size_t, size_t>(5, 6));
+    }
+
+    SECTION("is unavailable once the set spans multiple chunks") {
+        realm::IndexSet set;
+        for (size_t i = 0; i < realm::_impl::ChunkedRangeVector::max_size + 1; ++i)
+            set.add(i * 2);
+        REQUIRE_FALSE(set.is_single_chunk());
+    }
+}
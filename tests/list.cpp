@@ -20,6 +20,7 @@
 
 #include "util/test_file.hpp"
 #include "util/index_helpers.hpp"
+#include "util/test_allocator.hpp"
 
 #include "binding_context.hpp"
 #include "list.hpp"
@@ -651,9 +652,96 @@ TEST_CASE("list") {
         REQUIRE(snapshot.size() == 10);
     }
 
+    SECTION("get_range()") {
+        List list(r, lv);
+
+        auto rows = list.get_range(2, 5);
+        REQUIRE(rows.size() == 3);
+        for (size_t i = 0; i < rows.size(); ++i)
+            REQUIRE(rows[i].get_index() == i + 2);
+
+        REQUIRE(list.get_range(5, 5).empty());
+        REQUIRE(list.get_range(5, 2).empty());
+        REQUIRE_THROWS_AS(list.get_range(0, 11), List::OutOfBoundsIndexException);
+    }
+
+    SECTION("iteration") {
+        List list(r, lv);
+
+        size_t expected = 0;
+        for (auto row : list)
+            REQUIRE(row.get_index() == expected++);
+        REQUIRE(expected == 10);
+
+        auto it = list.begin();
+        REQUIRE(list.end() - it == 10);
+        REQUIRE((*(it + 5)).get_index() == 5);
+
+        List detached;
+        REQUIRE_THROWS_AS(detached.begin(), List::InvalidatedException);
+    }
+
+    SECTION("add_all() and insert_all()") {
+        List list(r, lv);
+
+        r->begin_transaction();
+        list.add_all({0, 1, 2});
+        REQUIRE(list.size() == 13);
+        REQUIRE(list.get(10).get_index() == 0);
+        REQUIRE(list.get(11).get_index() == 1);
+        REQUIRE(list.get(12).get_index() == 2);
+
+        list.insert_all(1, {5, 6});
+        REQUIRE(list.size() == 15);
+        REQUIRE(list.get(0).get_index() == 0);
+        REQUIRE(list.get(1).get_index() == 5);
+        REQUIRE(list.get(2).get_index() == 6);
+        REQUIRE(list.get(3).get_index() == 1);
+
+        REQUIRE_THROWS_AS(list.insert_all(16, {0}), List::OutOfBoundsIndexException);
+        r->cancel_transaction();
+
+        REQUIRE_THROWS_AS(list.add_all({0}), InvalidTransactionException);
+        REQUIRE_THROWS_AS(list.insert_all(0, {0}), InvalidTransactionException);
+    }
+
     SECTION("get_object_schema()") {
         List list(r, lv);
         auto objectschema = &*r->schema().find("target");
         REQUIRE(&list.get_object_schema() == objectschema);
     }
 }
+
+TEST_CASE("list: get() allocation budget") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.cache = false;
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"origin", {
+            {"array", PropertyType::Array, "target"}
+        }},
+        {"target", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto origin = r->read_group().get_table("class_origin");
+    auto target = r->read_group().get_table("class_target");
+
+    r->begin_transaction();
+    target->add_empty_row(10);
+    origin->add_empty_row();
+    LinkViewRef lv = origin->get_linklist(0, 0);
+    for (size_t i = 0; i < 10; ++i)
+        lv->add(i);
+    r->commit_transaction();
+
+    List list(r, lv);
+    list.get(0); // warm up
+
+    REQUIRE_ALLOCATIONS_UNDER(0) {
+        for (size_t i = 0; i < 10; ++i)
+            list.get(i);
+    }
+}
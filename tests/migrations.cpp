@@ -30,6 +30,9 @@
 #include <realm/table.hpp>
 #include <realm/util/scope_exit.hpp>
 
+#include <condition_variable>
+#include <mutex>
+
 #ifdef _WIN32
 #include <Windows.h>
 #endif
@@ -1463,3 +1466,68 @@ TEST_CASE("migration: Manual") {
         REQUIRE_THROWS(realm2->update_schema(remove_property(schema, "object", "value")));
     }
 }
+
+TEST_CASE("migration: Async") {
+    TestFile config;
+    auto realm = Realm::get_shared_realm(config);
+
+    Schema schema = {
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false},
+        }}
+    };
+    realm->update_schema(schema);
+
+    // Run an async migration and block until its completion handler (which is
+    // invoked on the background thread) has been called
+    auto migrate_and_wait = [&](Schema const& new_schema, uint64_t version,
+                                Realm::MigrationFunction migration) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        std::exception_ptr error;
+        realm->update_schema_async(new_schema, version, std::move(migration),
+                                   [&](std::exception_ptr e) {
+                                       std::lock_guard<std::mutex> lock(mutex);
+                                       error = e;
+                                       done = true;
+                                       cv.notify_one();
+                                   });
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return done; });
+        return error;
+    };
+
+    SECTION("migration runs in the background and becomes visible on refresh") {
+        bool migration_ran = false;
+        auto new_schema = add_property(schema, "object",
+                                       {"new", PropertyType::Int, "", "", false, false, false});
+        auto error = migrate_and_wait(new_schema, 1, [&](SharedRealm, SharedRealm, Schema&) {
+            migration_ran = true;
+        });
+        REQUIRE_FALSE(error);
+        REQUIRE(migration_ran);
+
+        // The calling Realm continues to see the pre-migration state until
+        // it refreshes
+        REQUIRE(realm->schema_version() == 0);
+        REQUIRE(realm->refresh());
+        REQUIRE(realm->schema_version() == 1);
+        REQUIRE(realm->read_group().get_table("class_object")->get_column_count() == 2);
+    }
+
+    SECTION("errors thrown by the migration are reported to the completion handler") {
+        auto new_schema = add_property(schema, "object",
+                                       {"new", PropertyType::Int, "", "", false, false, false});
+        auto error = migrate_and_wait(new_schema, 1, [](SharedRealm, SharedRealm, Schema&) {
+            throw std::runtime_error("migration failed");
+        });
+        REQUIRE(error);
+        REQUIRE_THROWS_WITH(std::rethrow_exception(error), "migration failed");
+
+        // The failed migration was rolled back and changed nothing
+        realm->refresh();
+        REQUIRE(realm->schema_version() == 0);
+        REQUIRE(realm->read_group().get_table("class_object")->get_column_count() == 1);
+    }
+}
@@ -197,6 +197,8 @@ CommandFile::CommandFile(std::istream& input)
         return;
 
     while (input.good()) {
+        input >> std::ws;
+        auto begin = input.tellg();
         char op = '\0';
         input >> op;
         if (!input.good())
@@ -209,6 +211,7 @@ CommandFile::CommandFile(std::istream& input)
         auto fn = it->second(input);
         if (!input.good())
             return;
+        command_ranges.emplace_back(size_t(begin), size_t(input.tellg()));
         commands.push_back(std::move(fn));
     }
 }
@@ -21,6 +21,7 @@
 #include <iosfwd>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace realm {
@@ -47,6 +48,10 @@ struct CommandFile {
     std::vector<int64_t> initial_values;
     std::vector<size_t> initial_list_indices;
     std::vector<std::function<void (RealmState&)>> commands;
+    // Byte range within the input stream that each command was parsed from,
+    // for tools which need to re-emit a subset of the command stream (such
+    // as the perf-mode minimizer)
+    std::vector<std::pair<size_t, size_t>> command_ranges;
 
     CommandFile(std::istream& input);
 
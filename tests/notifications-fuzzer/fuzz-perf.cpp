@@ -0,0 +1,289 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+// Performance mode for the notifications fuzzer: instead of checking the
+// correctness of the computed changesets, this measures how long computing
+// them takes. Each input command file is run against a sorted Results
+// notifier and the time spent in the final RealmCoordinator::on_change() --
+// the transact-log parse plus diff computation, including the quadratic
+// calculate_moves_sorted cases -- is recorded. Files which take an outlying
+// amount of time relative to the rest of the corpus (or an absolute
+// threshold) are flagged, optionally minimized by delta-debugging the
+// command stream while the slowness persists, and re-emitted as a
+// self-contained command file which reproduces the cliff.
+//
+// Usage: fuzz-perf [--threshold-us N] [--minimize] file...
+//
+// Commit commands ('c') inside the stream flush their changes through
+// on_change() as they run, so only the diff for the trailing uncommitted
+// span is measured; the minimizer tends to strip them out for that reason.
+
+#include "command_file.hpp"
+
+#include "impl/realm_coordinator.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+#include "shared_realm.hpp"
+
+#include <realm/disable_sync_to_disk.hpp>
+#include <realm/group_shared.hpp>
+#include <realm/link_view.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace realm;
+
+namespace {
+// Fed from the notification callback so the diff can't be optimized away
+volatile size_t sink;
+
+struct Measurement {
+    std::string path;
+    std::string buffer;
+    double time_us;
+};
+
+std::string read_file(const char* path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    return buffer.str();
+}
+
+// Rebuild a self-contained command file from parsed initial state and a
+// subset of the original command stream, in the same format the fuzzer reads
+std::string serialize(std::vector<int64_t> const& initial_values,
+                      std::vector<size_t> const& initial_list_indices,
+                      std::string const& buffer,
+                      std::vector<std::pair<size_t, size_t>> const& command_ranges)
+{
+    std::ostringstream out;
+    for (auto value : initial_values)
+        out << value << '\n';
+    out << '\n';
+    for (auto index : initial_list_indices)
+        out << index << '\n';
+    out << '\n';
+    for (auto& range : command_ranges)
+        out << buffer.substr(range.first, range.second - range.first) << '\n';
+    return out.str();
+}
+
+// Run one command file against a fresh Realm with a sorted Results notifier
+// registered and return the time spent computing the resulting changeset.
+// Returns a negative value for inputs which don't parse into anything runnable.
+double measure_once(std::string const& buffer)
+{
+    Realm::Config config;
+    config.path = "fuzz-perf.realm";
+    config.cache = false;
+    config.in_memory = true;
+    config.automatic_change_notifications = false;
+    config.schema_version = 0;
+    config.schema = Schema{
+        {"object", {
+            {"id", PropertyType::Int},
+            {"value", PropertyType::Int}
+        }},
+        {"linklist", {
+            {"list", PropertyType::Array, "object"}
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+
+    r->begin_transaction();
+    r->read_group().get_table("class_linklist")->add_empty_row();
+    r->commit_transaction();
+
+    fuzzer::RealmState state = {
+        *r,
+        *coordinator,
+        *r->read_group().get_table("class_object"),
+        r->read_group().get_table("class_linklist")->get_linklist(0, 0),
+        0,
+        {}
+    };
+
+    std::istringstream input_stream(buffer);
+    fuzzer::CommandFile command(input_stream);
+    if (command.initial_values.empty() || command.commands.empty())
+        return -1;
+    command.import(state);
+
+    // The same sorted query as fuzz-sorted-query, as sorted diffs are where
+    // the expensive move calculations live
+    auto& table = state.table;
+    Results results(r, table.where().greater(1, 100).less(1, 50000),
+                    SortDescriptor(table, {{1}, {0}}, {true, true}));
+    auto token = results.add_notification_callback([&](CollectionChangeSet change, std::exception_ptr) {
+        sink = sink + change.insertions.count() + change.moves.size();
+    });
+
+    coordinator->on_change();
+    r->notify();
+
+    command.run(state);
+
+    auto start = std::chrono::steady_clock::now();
+    coordinator->on_change();
+    auto end = std::chrono::steady_clock::now();
+    r->notify();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0;
+}
+
+// Best-of-three to keep scheduling noise from producing false outliers or
+// derailing the minimizer
+double measure(std::string const& buffer)
+{
+    double best = measure_once(buffer);
+    if (best < 0)
+        return best;
+    for (int i = 0; i < 2; ++i)
+        best = std::min(best, measure_once(buffer));
+    return best;
+}
+
+// Delta-debug the command stream down to a minimal subsequence which is
+// still slow. Repeatedly tries discarding chunks of commands, halving the
+// chunk size when no chunk can be removed, and keeps a candidate if it
+// still takes at least `keep_threshold_us` to diff.
+std::string minimize(std::string const& buffer, fuzzer::CommandFile const& command,
+                     double keep_threshold_us)
+{
+    auto ranges = command.command_ranges;
+    auto initial_values = command.initial_values;
+    auto initial_list_indices = command.initial_list_indices;
+
+    auto still_slow = [&](std::vector<std::pair<size_t, size_t>> const& candidate_ranges) {
+        auto candidate = serialize(initial_values, initial_list_indices, buffer, candidate_ranges);
+        return measure(candidate) >= keep_threshold_us;
+    };
+
+    for (size_t chunk = std::max<size_t>(ranges.size() / 2, 1); chunk >= 1;) {
+        bool removed_any = false;
+        for (size_t begin = 0; begin + chunk <= ranges.size() && ranges.size() > 1;) {
+            auto candidate = ranges;
+            candidate.erase(candidate.begin() + begin, candidate.begin() + begin + chunk);
+            if (still_slow(candidate)) {
+                ranges = std::move(candidate);
+                removed_any = true;
+            }
+            else {
+                begin += chunk;
+            }
+        }
+        if (removed_any)
+            continue;
+        if (chunk == 1)
+            break;
+        chunk /= 2;
+    }
+
+    // The initial values are usually the bulk of the file, so also try
+    // shrinking that list once the command stream is minimal
+    while (initial_values.size() > 1) {
+        auto candidate_values = initial_values;
+        candidate_values.resize(candidate_values.size() / 2);
+        auto candidate = serialize(candidate_values, initial_list_indices, buffer, ranges);
+        if (measure(candidate) < keep_threshold_us)
+            break;
+        initial_values = std::move(candidate_values);
+    }
+
+    return serialize(initial_values, initial_list_indices, buffer, ranges);
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    realm::disable_sync_to_disk();
+
+    double threshold_us = 1000;
+    bool should_minimize = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threshold-us") == 0 && i + 1 < argc)
+            threshold_us = atof(argv[++i]);
+        else if (strcmp(argv[i], "--minimize") == 0)
+            should_minimize = true;
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        fprintf(stderr, "usage: %s [--threshold-us N] [--minimize] file...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Measurement> measurements;
+    for (auto path : paths) {
+        Measurement m{path, read_file(path), 0};
+        m.time_us = measure(m.buffer);
+        if (m.time_us < 0) {
+            fprintf(stderr, "%s: skipped (no runnable commands)\n", path);
+            continue;
+        }
+        printf("%-40s %10.1f us\n", path, m.time_us);
+        measurements.push_back(std::move(m));
+    }
+    if (measurements.empty())
+        return 1;
+
+    // An input is an outlier if it's several times slower than the median of
+    // the corpus and over the absolute floor, so that a corpus of uniformly
+    // tiny inputs doesn't flag everything
+    auto times = std::vector<double>();
+    for (auto& m : measurements)
+        times.push_back(m.time_us);
+    std::sort(times.begin(), times.end());
+    double median = times[times.size() / 2];
+    double outlier_threshold = std::max(threshold_us, 4 * median);
+
+    int flagged = 0;
+    for (auto& m : measurements) {
+        if (m.time_us < outlier_threshold)
+            continue;
+        ++flagged;
+        printf("OUTLIER %s: %.1f us (threshold %.1f us)\n", m.path.c_str(), m.time_us, outlier_threshold);
+
+        if (!should_minimize)
+            continue;
+
+        std::istringstream input_stream(m.buffer);
+        fuzzer::CommandFile command(input_stream);
+        // Minimal case must retain at least half of the original slowness
+        auto minimized = minimize(m.buffer, command, m.time_us / 2);
+
+        auto out_path = m.path + ".perfcase";
+        std::ofstream(out_path, std::ios::binary) << minimized;
+        printf("  minimized to %zu bytes (%.1f us); reproduce with: %s %s\n",
+               minimized.size(), measure(minimized), argv[0], out_path.c_str());
+    }
+
+    return flagged ? 2 : 0;
+}
@@ -33,6 +33,8 @@
 
 #include <realm/group_shared.hpp>
 
+#include <cmath>
+
 using namespace realm;
 
 TEST_CASE("object") {
@@ -146,6 +148,40 @@ TEST_CASE("object") {
             write([&] { table->get(1).set_int(0, 10); });
         }
 
+        SECTION("observing multiple objects notifies only the modified ones") {
+            auto token = require_change();
+
+            std::vector<CollectionChangeSet> changes(3);
+            std::vector<int> calls(3, 0);
+            std::vector<Object> objects;
+            std::vector<NotificationToken> tokens;
+            for (size_t i = 0; i < 3; ++i) {
+                objects.emplace_back(r, *r->schema().find("table"), table->get(i + 1));
+                tokens.push_back(objects[i].add_notification_callback([&, i](CollectionChangeSet c, std::exception_ptr) {
+                    changes[i] = c;
+                    ++calls[i];
+                }));
+            }
+            advance_and_notify(*r);
+            REQUIRE(calls == std::vector<int>{1, 1, 1});
+
+            // Fewer modified rows than observed objects: the modified rows
+            // are probed against a hash of the observed ones
+            write([&] { table->get(2).set_int(0, 10); });
+            REQUIRE(calls == std::vector<int>{1, 2, 1});
+            REQUIRE_INDICES(changes[1].modifications, 0);
+
+            // More modified rows than observed objects: each observed row is
+            // looked up in the modification set instead
+            write([&] {
+                for (size_t i = 0; i < 10; ++i)
+                    table->set_int(1, i, 20);
+            });
+            REQUIRE(calls == std::vector<int>{2, 3, 2});
+            REQUIRE_INDICES(changes[0].modifications, 0);
+            REQUIRE_INDICES(changes[2].modifications, 0);
+        }
+
         SECTION("moving the object") {
             auto token = require_no_change();
             write([&] { table->swap_rows(0, 5); });
@@ -256,6 +292,50 @@ TEST_CASE("object") {
         REQUIRE(list->get(0).get_int(0) == 20);
     }
 
+    SECTION("create with zero-like values stores them correctly") {
+        auto obj = create(AnyDict{
+            {"pk", 1LL},
+            {"bool", false},
+            {"int", 0LL},
+            {"float", 0.f},
+            {"double", 0.},
+            {"string", ""s},
+            {"data", ""s},
+            {"date", Timestamp(0, 0)},
+            {"object", util::Any()},
+            {"array", AnyVector{}},
+        }, false);
+
+        auto row = obj.row();
+        REQUIRE(row.get_bool(1) == false);
+        REQUIRE(row.get_int(2) == 0);
+        REQUIRE(row.get_float(3) == 0.f);
+        REQUIRE(row.get_double(4) == 0.);
+        REQUIRE(row.get_string(5) == "");
+        REQUIRE(row.get_binary(6) == BinaryData("", 0));
+        REQUIRE(row.get_timestamp(7) == Timestamp(0, 0));
+        REQUIRE(row.is_null(8));
+        REQUIRE(row.get_linklist(9)->size() == 0);
+    }
+
+    SECTION("create preserves the sign of negative zero") {
+        auto obj = create(AnyDict{
+            {"pk", 1LL},
+            {"bool", false},
+            {"int", 0LL},
+            {"float", -0.f},
+            {"double", -0.},
+            {"string", ""s},
+            {"data", ""s},
+            {"date", Timestamp(0, 0)},
+            {"object", util::Any()},
+            {"array", AnyVector{}},
+        }, false);
+
+        REQUIRE(std::signbit(obj.row().get_float(3)));
+        REQUIRE(std::signbit(obj.row().get_double(4)));
+    }
+
     SECTION("create uses defaults for missing values") {
         context.defaults["all types"] = {
             {"bool", true},
@@ -335,6 +415,49 @@ TEST_CASE("object") {
         REQUIRE(row.get_timestamp(7) == Timestamp(10, 20));
     }
 
+    SECTION("create_bulk") {
+        std::vector<util::Any> values;
+        for (long long i = 0; i < 5; ++i)
+            values.push_back(AnyDict{{"value", i}});
+
+        r->begin_transaction();
+        IndexSet created;
+        auto objects = Object::create_bulk(&context, r, *r->schema().find("array target"), values, false, &created);
+        r->commit_transaction();
+
+        REQUIRE_INDICES(created, 0, 1, 2, 3, 4);
+        REQUIRE(objects.size() == 5);
+        auto table = r->read_group().get_table("class_array target");
+        REQUIRE(table->size() == 5);
+        for (size_t i = 0; i < 5; ++i) {
+            REQUIRE(objects[i].row().get_index() == i);
+            REQUIRE(table->get_int(0, i) == (long long)i);
+        }
+    }
+
+    SECTION("create_bulk with a primary key updates existing objects") {
+        std::vector<util::Any> values;
+        values.push_back(AnyDict{{"pk", 1LL}, {"int 1", 1LL}, {"int 2", 1LL}});
+        values.push_back(AnyDict{{"pk", 2LL}, {"int 1", 2LL}, {"int 2", 2LL}});
+
+        r->begin_transaction();
+        IndexSet created;
+        Object::create_bulk(&context, r, *r->schema().find("pk after list"), values, false, &created);
+        REQUIRE_INDICES(created, 0, 1);
+
+        values.clear();
+        values.push_back(AnyDict{{"pk", 1LL}, {"int 1", 10LL}, {"int 2", 10LL}});
+        auto objects = Object::create_bulk(&context, r, *r->schema().find("pk after list"), values, true, &created);
+        r->commit_transaction();
+
+        REQUIRE(created.empty());
+        REQUIRE(objects.size() == 1);
+        auto table = r->read_group().get_table("class_pk after list");
+        REQUIRE(table->size() == 2);
+        REQUIRE(objects[0].row().get_int(1) == 10);
+        REQUIRE(objects[0].row().get_int(3) == 10);
+    }
+
     SECTION("getters and setters") {
         r->begin_transaction();
 
@@ -383,6 +506,93 @@ TEST_CASE("object") {
         REQUIRE_THROWS(obj.set_property_value(&context, "int", util::Any(5LL), false));
     }
 
+    SECTION("repeated link traversal") {
+        r->begin_transaction();
+        auto& table = *r->read_group().get_table("class_all types");
+        table.add_empty_row();
+        Object obj(r, *r->schema().find("all types"), table[0]);
+
+        auto& link_table = *r->read_group().get_table("class_link target");
+        link_table.add_empty_row(2);
+        link_table.set_int(0, 0, 1);
+        link_table.set_int(0, 1, 2);
+        obj.set_property_value(&context, "object",
+                               util::Any(Object(r, *r->schema().find("link target"), link_table[0])), false);
+        r->commit_transaction();
+
+        auto linked_value = [&] {
+            auto linked = any_cast<Object>(obj.get_property_value<util::Any>(&context, "object"));
+            return any_cast<long long>(linked.get_property_value<util::Any>(&context, "value"));
+        };
+
+        // Repeated reads outside a write hit the cached accessor state
+        REQUIRE(linked_value() == 1);
+        REQUIRE(linked_value() == 1);
+
+        // Reassigning the link within a write is visible immediately despite
+        // the version not having advanced, and remains so after the commit
+        r->begin_transaction();
+        table.set_link(8, 0, 1);
+        REQUIRE(linked_value() == 2);
+        r->commit_transaction();
+        REQUIRE(linked_value() == 2);
+
+        r->begin_transaction();
+        auto& array_table = *r->read_group().get_table("class_array target");
+        array_table.add_empty_row();
+        array_table.set_int(0, 0, 3);
+        obj.row().get_linklist(9)->add(0);
+        r->commit_transaction();
+
+        auto list = any_cast<List>(obj.get_property_value<util::Any>(&context, "array"));
+        auto list2 = any_cast<List>(obj.get_property_value<util::Any>(&context, "array"));
+        REQUIRE(list.size() == 1);
+        REQUIRE(list2.size() == 1);
+        REQUIRE(list.get(0).get_int(0) == 3);
+    }
+
+    SECTION("get_unowned_binary()") {
+        auto& table = *r->read_group().get_table("class_all types");
+        auto col = r->schema().find("all types")->property_for_name("data")->table_column;
+        std::string old_blob(100, 'a');
+
+        r->begin_transaction();
+        table.add_empty_row();
+        table.set_binary(col, 0, BinaryData(old_blob.data(), old_blob.size()));
+        r->commit_transaction();
+
+        Object obj(r, *r->schema().find("all types"), table[0]);
+
+        SECTION("returns the stored data without copying it") {
+            auto read = obj.get_unowned_binary("data");
+            REQUIRE(read.first == BinaryData(old_blob.data(), old_blob.size()));
+        }
+
+        SECTION("the data remains valid after the blob is overwritten") {
+            auto read = obj.get_unowned_binary("data");
+            auto data = read.first;
+
+            std::string new_blob(100, 'b');
+            r->begin_transaction();
+            table.set_binary(col, 0, BinaryData(new_blob.data(), new_blob.size()));
+            r->commit_transaction();
+
+            REQUIRE(data == BinaryData(old_blob.data(), old_blob.size()));
+            REQUIRE(obj.get_unowned_binary("data").first == BinaryData(new_blob.data(), new_blob.size()));
+        }
+
+        SECTION("throws for invalid properties") {
+            REQUIRE_THROWS_AS(obj.get_unowned_binary("not a property"), InvalidPropertyException);
+            REQUIRE_THROWS_AS(obj.get_unowned_binary("int"), std::logic_error);
+        }
+
+        SECTION("cannot pin a version inside a write transaction") {
+            r->begin_transaction();
+            REQUIRE_THROWS_AS(obj.get_unowned_binary("data"), InvalidTransactionException);
+            r->cancel_transaction();
+        }
+    }
+
 #if REALM_ENABLE_SYNC
     if (!util::EventLoop::has_implementation())
         return;
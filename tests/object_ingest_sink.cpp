@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+
+#include "util/test_file.hpp"
+
+#include "object.hpp"
+#include "object_ingest_sink.hpp"
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+
+#include "impl/realm_coordinator.hpp"
+
+#include <realm/group_shared.hpp>
+
+using namespace realm;
+
+TEST_CASE("object ingest sink") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.cache = false;
+    config.schema = Schema{
+        {"object", {
+            {"pk", PropertyType::Int, "", "", true},
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String, "", "", false, false, true},
+        }},
+        {"linked", {
+            {"link", PropertyType::Object, "object", "", false, false, true},
+        }},
+    };
+    config.schema_version = 0;
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+    auto& object_schema = *r->schema().find("object");
+
+    SECTION("ingests a stream of objects in batched transactions") {
+        ObjectIngestSink sink(r, object_schema, 2);
+        for (int64_t i = 0; i < 5; ++i) {
+            sink.begin_object();
+            sink.key("pk");
+            sink.value(i);
+            sink.key("value");
+            sink.value(i * 10);
+            sink.key("name");
+            sink.value("name");
+            sink.end_object();
+        }
+        sink.complete();
+
+        REQUIRE(sink.objects_ingested() == 5);
+        REQUIRE_FALSE(r->is_in_transaction());
+        REQUIRE(table->size() == 5);
+        for (int64_t i = 0; i < 5; ++i) {
+            size_t row = table->find_first_int(0, i);
+            REQUIRE(row != npos);
+            REQUIRE(table->get_int(1, row) == i * 10);
+            REQUIRE(table->get_string(2, row) == "name");
+        }
+    }
+
+    SECTION("unset nullable properties are left null") {
+        ObjectIngestSink sink(r, object_schema);
+        sink.begin_object();
+        sink.key("pk");
+        sink.value(int64_t(1));
+        sink.key("value");
+        sink.value(int64_t(2));
+        sink.end_object();
+        sink.complete();
+
+        REQUIRE(table->size() == 1);
+        REQUIRE(table->is_null(2, 0));
+    }
+
+    SECTION("unset required properties throw") {
+        ObjectIngestSink sink(r, object_schema);
+        sink.begin_object();
+        sink.key("pk");
+        sink.value(int64_t(1));
+        REQUIRE_THROWS_AS(sink.end_object(), MissingPropertyValueException);
+    }
+
+    SECTION("destroying the sink without complete() discards uncommitted objects") {
+        {
+            ObjectIngestSink sink(r, object_schema);
+            sink.begin_object();
+            sink.key("pk");
+            sink.value(int64_t(1));
+            sink.key("value");
+            sink.value(int64_t(2));
+            sink.end_object();
+        }
+        REQUIRE_FALSE(r->is_in_transaction());
+        REQUIRE(table->size() == 0);
+    }
+
+    SECTION("writes into an existing write transaction without committing it") {
+        r->begin_transaction();
+        {
+            ObjectIngestSink sink(r, object_schema, 1);
+            sink.begin_object();
+            sink.key("pk");
+            sink.value(int64_t(1));
+            sink.key("value");
+            sink.value(int64_t(2));
+            sink.end_object();
+            sink.complete();
+        }
+        REQUIRE(r->is_in_transaction());
+        REQUIRE(table->size() == 1);
+        r->cancel_transaction();
+        REQUIRE(table->size() == 0);
+    }
+
+    SECTION("duplicate primary keys throw") {
+        ObjectIngestSink sink(r, object_schema);
+        sink.begin_object();
+        sink.key("pk");
+        sink.value(int64_t(1));
+        sink.key("value");
+        sink.value(int64_t(2));
+        sink.end_object();
+
+        sink.begin_object();
+        sink.key("pk");
+        REQUIRE_THROWS_AS(sink.value(int64_t(1)), std::logic_error);
+    }
+
+    SECTION("unknown property names throw") {
+        ObjectIngestSink sink(r, object_schema);
+        sink.begin_object();
+        REQUIRE_THROWS_AS(sink.key("not a property"), InvalidPropertyException);
+    }
+
+    SECTION("link and list properties are rejected") {
+        auto& linked_schema = *r->schema().find("linked");
+        ObjectIngestSink sink(r, linked_schema);
+        sink.begin_object();
+        REQUIRE_THROWS_AS(sink.key("link"), std::logic_error);
+    }
+
+    SECTION("mismatched value types throw") {
+        ObjectIngestSink sink(r, object_schema);
+        sink.begin_object();
+        sink.key("value");
+        REQUIRE_THROWS_AS(sink.value(true), std::logic_error);
+        sink.key("value");
+        REQUIRE_THROWS_AS(sink.value_null(), std::logic_error);
+    }
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+
+#include "util/pool_allocator.hpp"
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+using realm::util::ObjectPool;
+using realm::util::make_pooled_shared;
+
+TEST_CASE("pool allocator") {
+    SECTION("freed blocks are recycled rather than returned to the heap") {
+        void* first = ObjectPool::allocate(64);
+        ObjectPool::deallocate(first, 64);
+        void* second = ObjectPool::allocate(64);
+        REQUIRE(first == second);
+        ObjectPool::deallocate(second, 64);
+    }
+
+    SECTION("live blocks of mixed sizes do not overlap") {
+        struct Block {
+            void* ptr;
+            size_t size;
+        };
+        std::vector<Block> blocks;
+        std::set<void*> distinct;
+        for (size_t size : {1, 24, 64, 100, 256, 512}) {
+            for (int i = 0; i < 20; ++i) {
+                void* ptr = ObjectPool::allocate(size);
+                memset(ptr, int(size & 0xff), size);
+                blocks.push_back({ptr, size});
+                distinct.insert(ptr);
+            }
+        }
+        REQUIRE(distinct.size() == blocks.size());
+        for (auto& block : blocks) {
+            auto bytes = static_cast<unsigned char*>(block.ptr);
+            for (size_t i = 0; i < block.size; ++i)
+                REQUIRE(bytes[i] == (block.size & 0xff));
+            ObjectPool::deallocate(block.ptr, block.size);
+        }
+    }
+
+    SECTION("blocks are aligned for any non-over-aligned type") {
+        for (size_t size : {1, 7, 16, 130}) {
+            void* ptr = ObjectPool::allocate(size);
+            REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t) == 0);
+            ObjectPool::deallocate(ptr, size);
+        }
+    }
+
+    SECTION("oversized blocks fall through to the heap") {
+        void* ptr = ObjectPool::allocate(4096);
+        memset(ptr, 0xab, 4096);
+        ObjectPool::deallocate(ptr, 4096);
+    }
+
+    SECTION("make_pooled_shared() constructs and destroys the object") {
+        static int destructions = 0;
+        struct Counted {
+            int value;
+            Counted(int value) : value(value) { }
+            ~Counted() { ++destructions; }
+        };
+
+        destructions = 0;
+        std::weak_ptr<Counted> weak;
+        {
+            auto ptr = make_pooled_shared<Counted>(42);
+            REQUIRE(ptr->value == 42);
+            weak = ptr;
+        }
+        REQUIRE(destructions == 1);
+        REQUIRE(weak.expired());
+    }
+}
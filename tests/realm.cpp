@@ -29,9 +29,12 @@
 #include "schema.hpp"
 
 #include "impl/realm_coordinator.hpp"
+#include "impl/schema_cache.hpp"
 
 #include <realm/group.hpp>
 
+#include <fstream>
+
 namespace realm {
 class TestHelper {
 public:
@@ -121,6 +124,12 @@ TEST_CASE("SharedRealm: get_shared_realm()") {
             REQUIRE_THROWS(Realm::get_shared_realm(config));
         }
 
+        SECTION("group commit") {
+            auto realm = Realm::get_shared_realm(config);
+            config.group_commit_max_commits = 10;
+            REQUIRE_THROWS(Realm::get_shared_realm(config));
+        }
+
         SECTION("schema") {
             auto realm = Realm::get_shared_realm(config);
             config.schema = Schema{
@@ -376,6 +385,384 @@ TEST_CASE("SharedRealm: get_shared_realm()") {
     }
 }
 
+TEST_CASE("SharedRealm: get_shared_realm_async()") {
+    if (!util::EventLoop::has_implementation())
+        return;
+
+    TestFile config;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    SharedRealm realm;
+    std::exception_ptr error;
+    bool called = false;
+    auto callback = [&](SharedRealm r, std::exception_ptr e) {
+        realm = std::move(r);
+        error = e;
+        called = true;
+    };
+
+    SECTION("should deliver a Realm for the calling thread") {
+        Realm::get_shared_realm_async(config, callback);
+        util::EventLoop::main().run_until([&]{ return called; });
+        REQUIRE(realm);
+        REQUIRE(!error);
+        REQUIRE_NOTHROW(realm->verify_thread());
+        REQUIRE(realm->schema().find("object") != realm->schema().end());
+    }
+
+    SECTION("should perform the migration before delivering the Realm") {
+        // Initialize the file at version 1
+        Realm::get_shared_realm(config);
+
+        config.schema_version = 2;
+        bool migration_called = false;
+        config.migration_function = [&](auto, auto, auto) {
+            migration_called = true;
+        };
+        Realm::get_shared_realm_async(config, callback);
+        util::EventLoop::main().run_until([&]{ return called; });
+        REQUIRE(migration_called);
+        REQUIRE(realm);
+        REQUIRE(realm->schema_version() == 2);
+    }
+
+    SECTION("should report failures to open via the callback") {
+        config.schema_version = ObjectStore::NotVersioned;
+        Realm::get_shared_realm_async(config, callback);
+        util::EventLoop::main().run_until([&]{ return called; });
+        REQUIRE(!realm);
+        REQUIRE(error);
+        REQUIRE_THROWS(std::rethrow_exception(error));
+    }
+
+    SECTION("should deliver the cached Realm when one exists for the calling thread") {
+        auto cached = Realm::get_shared_realm(config);
+        Realm::get_shared_realm_async(config, callback);
+        util::EventLoop::main().run_until([&]{ return called; });
+        REQUIRE(!error);
+        REQUIRE(realm.get() == cached.get());
+    }
+}
+
+TEST_CASE("RealmCoordinator: get_cached_realm()") {
+    TestFile config;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    SECTION("returns the cached instance for the current thread") {
+        auto realm = Realm::get_shared_realm(config);
+        auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+        REQUIRE(coordinator->get_cached_realm(config.execution_context).get() == realm.get());
+    }
+
+    SECTION("returns null when there is no instance for the execution context") {
+        auto realm = Realm::get_shared_realm(config);
+        auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+        std::thread([&]{
+            REQUIRE(coordinator->get_cached_realm(std::this_thread::get_id()) == nullptr);
+        }).join();
+    }
+
+    SECTION("returns null after the cached instance is closed") {
+        auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+        {
+            auto realm = Realm::get_shared_realm(config);
+        }
+        REQUIRE(coordinator->get_cached_realm(config.execution_context) == nullptr);
+    }
+
+    SECTION("returns null when caching is disabled") {
+        config.cache = false;
+        auto realm = Realm::get_shared_realm(config);
+        auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+        REQUIRE(coordinator->get_cached_realm(config.execution_context) == nullptr);
+    }
+}
+
+TEST_CASE("RealmCoordinator: write lock stats") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+
+    SECTION("beginning and ending a write transaction updates the holder") {
+        auto before = coordinator->get_write_lock_stats();
+        realm->begin_transaction();
+
+        auto during = coordinator->get_write_lock_stats();
+        REQUIRE(during.acquisitions == before.acquisitions + 1);
+        REQUIRE(during.current_holder == std::this_thread::get_id());
+
+        realm->commit_transaction();
+        REQUIRE(coordinator->get_write_lock_stats().current_holder == std::thread::id());
+    }
+
+    SECTION("cancelling a write transaction clears the holder") {
+        realm->begin_transaction();
+        realm->cancel_transaction();
+        REQUIRE(coordinator->get_write_lock_stats().current_holder == std::thread::id());
+    }
+
+    SECTION("every acquisition lands in exactly one histogram bucket") {
+        for (int i = 0; i < 3; ++i) {
+            realm->begin_transaction();
+            realm->commit_transaction();
+        }
+        auto stats = coordinator->get_write_lock_stats();
+        uint_fast64_t total = 0;
+        for (auto count : stats.wait_histogram)
+            total += count;
+        REQUIRE(total == stats.acquisitions);
+        REQUIRE(stats.total_wait >= stats.max_wait);
+    }
+
+    SECTION("the wait callback fires when the threshold is met") {
+        int calls = 0;
+        coordinator->set_write_lock_wait_callback(std::chrono::microseconds(0),
+                                                  [&](std::chrono::microseconds) { ++calls; });
+        realm->begin_transaction();
+        realm->commit_transaction();
+        REQUIRE(calls == 1);
+    }
+}
+
+TEST_CASE("RealmCoordinator: commit notification stats") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+
+    SECTION("timestamping is off by default and can be toggled") {
+        REQUIRE_FALSE(_impl::RealmCoordinator::commit_latency_stats_enabled());
+        _impl::RealmCoordinator::set_commit_latency_stats_enabled(true);
+        REQUIRE(_impl::RealmCoordinator::commit_latency_stats_enabled());
+        _impl::RealmCoordinator::set_commit_latency_stats_enabled(false);
+        REQUIRE_FALSE(_impl::RealmCoordinator::commit_latency_stats_enabled());
+    }
+
+    SECTION("every recorded latency lands in exactly one histogram bucket") {
+        coordinator->record_commit_notification_latency(std::chrono::microseconds(0));
+        coordinator->record_commit_notification_latency(std::chrono::microseconds(3));
+        coordinator->record_commit_notification_latency(std::chrono::milliseconds(2));
+
+        auto stats = coordinator->get_commit_notification_stats();
+        REQUIRE(stats.notifications == 3);
+        REQUIRE(stats.max_latency == std::chrono::milliseconds(2));
+        REQUIRE(stats.total_latency == std::chrono::microseconds(2003));
+        uint_fast64_t total = 0;
+        for (auto count : stats.latency_histogram)
+            total += count;
+        REQUIRE(total == stats.notifications);
+    }
+
+    SECTION("cross-process clock skew does not produce negative latencies") {
+        coordinator->record_commit_notification_latency(std::chrono::microseconds(-10));
+        auto stats = coordinator->get_commit_notification_stats();
+        REQUIRE(stats.notifications == 1);
+        REQUIRE(stats.max_latency == std::chrono::microseconds(0));
+        REQUIRE(stats.total_latency == std::chrono::microseconds(0));
+    }
+}
+
+TEST_CASE("RealmCoordinator: memory stats") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+    auto table = realm->read_group().get_table("class_object");
+
+    SECTION("reports the file size and schema cache size") {
+        auto stats = coordinator->get_memory_stats();
+        REQUIRE(stats.path == config.path);
+        REQUIRE(stats.file_size > 0);
+        REQUIRE(stats.schema_cache_size > 0);
+        REQUIRE(stats.notifier_count == 0);
+        REQUIRE(stats.notifier_retained_rows == 0);
+    }
+
+    SECTION("counts registered notifiers and their retained rows") {
+        realm->begin_transaction();
+        table->add_empty_row(3);
+        realm->commit_transaction();
+
+        Results results(realm, table->where());
+        int notification_calls = 0;
+        auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            ++notification_calls;
+        });
+        advance_and_notify(*realm);
+        REQUIRE(notification_calls == 1);
+
+        auto stats = coordinator->get_memory_stats();
+        REQUIRE(stats.notifier_count == 1);
+        REQUIRE(stats.notifier_retained_rows == 3);
+    }
+
+    SECTION("the JSON dump includes this coordinator") {
+        auto json = _impl::RealmCoordinator::get_memory_stats_json();
+        REQUIRE(json.find("\"path\":") != std::string::npos);
+        REQUIRE(json.find(config.path) != std::string::npos);
+        REQUIRE(json.find("\"file_size\":") != std::string::npos);
+    }
+}
+
+TEST_CASE("RealmCoordinator: notifier stats") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+    auto table = realm->read_group().get_table("class_object");
+
+    SECTION("all counters start at zero") {
+        auto stats = coordinator->get_notifier_stats();
+        REQUIRE(stats.commits_observed == 0);
+        REQUIRE(stats.commits_per_second == 0);
+        REQUIRE(stats.deliveries == 0);
+        REQUIRE(stats.notifiers_queued == 0);
+        REQUIRE(stats.total_queue_time.count() == 0);
+        REQUIRE(stats.notifier_version_lags.empty());
+    }
+
+    SECTION("counts queued notifiers, observed commits and deliveries") {
+        Results results(realm, table->where());
+        int notification_calls = 0;
+        auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            ++notification_calls;
+        });
+        advance_and_notify(*realm);
+        REQUIRE(notification_calls == 1);
+
+        auto stats = coordinator->get_notifier_stats();
+        REQUIRE(stats.notifiers_queued == 1);
+        REQUIRE(stats.deliveries >= 1);
+        auto deliveries_before = stats.deliveries;
+
+        realm->begin_transaction();
+        table->add_empty_row();
+        realm->commit_transaction();
+        realm->begin_transaction();
+        table->add_empty_row();
+        realm->commit_transaction();
+        advance_and_notify(*realm);
+
+        stats = coordinator->get_notifier_stats();
+        REQUIRE(stats.commits_observed >= 2);
+        REQUIRE(stats.commits_per_second > 0);
+        REQUIRE(stats.deliveries > deliveries_before);
+        // Still just the one notifier, and it's fully caught up
+        REQUIRE(stats.notifiers_queued == 1);
+        REQUIRE(stats.notifier_version_lags.size() == 1);
+        REQUIRE(stats.notifier_version_lags[0] == 0);
+    }
+
+    SECTION("reports version lag for notifiers behind the newest commit") {
+        Results results(realm, table->where());
+        auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) { });
+        advance_and_notify(*realm);
+
+        // Commit without letting the background worker run
+        realm->begin_transaction();
+        table->add_empty_row();
+        realm->commit_transaction();
+
+        auto stats = coordinator->get_notifier_stats();
+        REQUIRE(stats.notifier_version_lags.size() == 1);
+        REQUIRE(stats.notifier_version_lags[0] >= 1);
+
+        advance_and_notify(*realm);
+        stats = coordinator->get_notifier_stats();
+        REQUIRE(stats.notifier_version_lags[0] == 0);
+    }
+}
+
+TEST_CASE("SharedRealm: group commit") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.group_commit_max_commits = 4;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+
+    SECTION("commits are immediately visible to other instances") {
+        auto realm = Realm::get_shared_realm(config);
+        auto realm2 = Realm::get_shared_realm(config);
+        auto table = realm->read_group().get_table("class_object");
+
+        for (int i = 0; i < 10; ++i) {
+            realm->begin_transaction();
+            table->add_empty_row();
+            realm->commit_transaction();
+        }
+        realm2->refresh();
+        REQUIRE(realm2->read_group().get_table("class_object")->size() == 10);
+    }
+
+    SECTION("flush() syncs pending commits") {
+        auto realm = Realm::get_shared_realm(config);
+        auto table = realm->read_group().get_table("class_object");
+
+        // Nothing pending to sync
+        realm->flush();
+
+        realm->begin_transaction();
+        table->add_empty_row();
+        realm->commit_transaction();
+        realm->flush();
+        REQUIRE(table->size() == 1);
+    }
+
+    SECTION("flush() is a no-op when group commit is not in use") {
+        TestFile config2;
+        auto realm = Realm::get_shared_realm(config2);
+        REQUIRE_NOTHROW(realm->flush());
+    }
+}
+
 TEST_CASE("SharedRealm: notifications") {
     if (!util::EventLoop::has_implementation())
         return;
@@ -589,6 +976,64 @@ TEST_CASE("SharedRealm: schema updating from external changes") {
     }
 }
 
+TEST_CASE("SharedRealm: scoped reads") {
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto table = realm->read_group().get_table("class_object");
+    realm->begin_transaction();
+    table->add_empty_row();
+    table->set_int(0, 0, 10);
+    realm->commit_transaction();
+
+    SECTION("returns the value produced by the callback") {
+        auto value = realm->read([&] {
+            return table->get_int(0, 0);
+        });
+        REQUIRE(value == 10);
+    }
+
+    SECTION("pins the read version for the duration of the scope") {
+        realm->read([&] {
+            auto r2 = Realm::get_shared_realm(config);
+            r2->begin_transaction();
+            r2->read_group().get_table("class_object")->set_int(0, 0, 20);
+            r2->commit_transaction();
+            REQUIRE(table->get_int(0, 0) == 10);
+        });
+        realm->refresh();
+        REQUIRE(table->get_int(0, 0) == 20);
+    }
+
+    SECTION("beginning a write transaction inside the scope throws") {
+        realm->read([&] {
+            REQUIRE_THROWS_AS(realm->begin_transaction(), InvalidTransactionException);
+        });
+        // and is allowed again once the scope has been left
+        realm->begin_transaction();
+        realm->cancel_transaction();
+    }
+
+    SECTION("scopes can be nested") {
+        realm->read([&] {
+            auto value = realm->read([&] {
+                return table->get_int(0, 0);
+            });
+            REQUIRE(value == 10);
+            REQUIRE_THROWS_AS(realm->begin_transaction(), InvalidTransactionException);
+        });
+        realm->begin_transaction();
+        realm->cancel_transaction();
+    }
+}
+
 TEST_CASE("SharedRealm: closed realm") {
     TestFile config;
     config.schema_version = 1;
@@ -614,6 +1059,60 @@ TEST_CASE("SharedRealm: closed realm") {
     REQUIRE_THROWS_AS(realm->compact(), ClosedRealmException);
 }
 
+TEST_CASE("SharedRealm: close_async()") {
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool closed = false;
+    auto completion = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        cv.notify_one();
+    };
+    auto wait_for_close = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return closed; });
+    };
+
+    SECTION("closes the Realm immediately") {
+        auto realm = Realm::get_shared_realm(config);
+        realm->close_async(completion);
+        REQUIRE(realm->is_closed());
+        REQUIRE_THROWS_AS(realm->read_group(), ClosedRealmException);
+        wait_for_close();
+    }
+
+    SECTION("releases the file") {
+        auto realm = Realm::get_shared_realm(config);
+        realm->begin_transaction();
+        auto table = realm->read_group().get_table("class_object");
+        table->add_empty_row();
+        realm->commit_transaction();
+        realm->close_async(completion);
+        realm = nullptr;
+        wait_for_close();
+
+        // The file should be openable and contain the committed write
+        realm = Realm::get_shared_realm(config);
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 1);
+    }
+
+    SECTION("invokes the completion for an already-closed Realm") {
+        auto realm = Realm::get_shared_realm(config);
+        realm->close();
+        realm->close_async(completion);
+        wait_for_close();
+    }
+}
+
 TEST_CASE("ShareRealm: in-memory mode from buffer") {
     TestFile config;
     config.schema_version = 1;
@@ -831,6 +1330,101 @@ TEST_CASE("RealmCoordinator: schema cache") {
         coordinator->advance_schema_cache(3, 15);
         REQUIRE_FALSE(coordinator->get_cached_schema(cache_schema, cache_sv, cache_tv));
     }
+
+    SECTION("schema_unchanged_between() is false with no cached schema") {
+        REQUIRE_FALSE(coordinator->schema_unchanged_between(10, 10));
+    }
+
+    SECTION("schema_unchanged_between() requires both versions to be in the cached range") {
+        coordinator->cache_schema(schema, 5, 10);
+        coordinator->advance_schema_cache(10, 15);
+
+        REQUIRE(coordinator->schema_unchanged_between(10, 10));
+        REQUIRE(coordinator->schema_unchanged_between(10, 15));
+        REQUIRE(coordinator->schema_unchanged_between(12, 14));
+
+        REQUIRE_FALSE(coordinator->schema_unchanged_between(9, 15));
+        REQUIRE_FALSE(coordinator->schema_unchanged_between(10, 16));
+        REQUIRE_FALSE(coordinator->schema_unchanged_between(16, 20));
+    }
+}
+
+TEST_CASE("RealmCoordinator: persisted schema cache") {
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 1;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    };
+    auto cache_path = _impl::schema_cache::path_for_realm(config.path);
+
+    auto cache_exists = [&] { return bool(std::ifstream(cache_path)); };
+    // The transaction version the cache was written at is not exposed, so
+    // probe for it when a test needs to tamper with the cache
+    auto load_cache = [&](uint64_t& schema_version, uint64_t& transaction_version) {
+        util::Optional<Schema> cached;
+        for (transaction_version = 0; !cached && transaction_version < 100; ++transaction_version)
+            cached = _impl::schema_cache::load(cache_path, transaction_version, schema_version);
+        --transaction_version;
+        return cached;
+    };
+
+    SECTION("closing the last Realm instance writes the cache file") {
+        REQUIRE_FALSE(cache_exists());
+        { auto realm = Realm::get_shared_realm(config); }
+        REQUIRE(cache_exists());
+
+        uint64_t schema_version = 0, transaction_version = 0;
+        auto cached = load_cache(schema_version, transaction_version);
+        REQUIRE(cached);
+        REQUIRE(schema_version == 1);
+        REQUIRE(*cached == *config.schema);
+    }
+
+    SECTION("open reads the schema from the cache when the file is unchanged") {
+        { auto realm = Realm::get_shared_realm(config); }
+
+        // Replace the cached schema with a recognizably different one; a
+        // dynamic open of the unchanged file will only see it if the cache
+        // was used instead of reading the schema from the Group
+        uint64_t schema_version = 0, transaction_version = 0;
+        REQUIRE(load_cache(schema_version, transaction_version));
+        Schema marker = {
+            {"marker", {
+                {"value", PropertyType::Int}
+            }},
+        };
+        _impl::schema_cache::write(cache_path, marker, schema_version, transaction_version);
+
+        auto dynamic_config = static_cast<Realm::Config&>(config);
+        dynamic_config.schema = util::none;
+        auto realm = Realm::get_shared_realm(dynamic_config);
+        REQUIRE(realm->schema().find("marker") != realm->schema().end());
+    }
+
+    SECTION("a damaged cache file falls back to reading from the Group") {
+        { auto realm = Realm::get_shared_realm(config); }
+        std::ofstream(cache_path, std::ios::trunc) << "not a schema cache";
+
+        auto realm = Realm::get_shared_realm(config);
+        REQUIRE(realm->schema().find("object") != realm->schema().end());
+    }
+
+    SECTION("a cache written at a different transaction version is ignored") {
+        { auto realm = Realm::get_shared_realm(config); }
+        uint64_t schema_version = 0, transaction_version = 0;
+        REQUIRE(load_cache(schema_version, transaction_version));
+        REQUIRE_FALSE(_impl::schema_cache::load(cache_path, transaction_version + 1, schema_version));
+    }
+
+    SECTION("no cache file is written for in-memory Realms") {
+        InMemoryTestFile in_memory_config;
+        in_memory_config.schema = config.schema;
+        { auto realm = Realm::get_shared_realm(in_memory_config); }
+        REQUIRE_FALSE(bool(std::ifstream(_impl::schema_cache::path_for_realm(in_memory_config.path))));
+    }
 }
 
 TEST_CASE("SharedRealm: coordinator schema cache") {
@@ -987,6 +1581,33 @@ TEST_CASE("SharedRealm: coordinator schema cache") {
         REQUIRE(cache_schema.find("object 2") != cache_schema.end());
     }
 
+    SECTION("schema is updated correctly when only some tables change externally") {
+        r->read_group();
+        external_write(config, [](auto& wt) {
+            auto table = wt.add_table("class_object 2");
+            table->add_column(type_Int, "value");
+        });
+        r->refresh();
+
+        // "object" is untouched by this write, so its ObjectSchema is reused
+        // from the cache while that of "object 2" is re-read from the group
+        external_write(config, [](auto& wt) {
+            wt.get_table("class_object 2")->insert_column(0, type_String, "new col");
+            wt.get_table("class_object")->add_empty_row();
+        });
+        r->refresh();
+
+        REQUIRE(coordinator->get_cached_schema(cache_schema, cache_sv, cache_tv));
+        REQUIRE(cache_schema.size() == 2);
+        auto& object = *cache_schema.find("object");
+        REQUIRE(object.persisted_properties.size() == 1);
+        REQUIRE(object.persisted_properties[0].table_column == 0);
+        auto& object2 = *cache_schema.find("object 2");
+        REQUIRE(object2.persisted_properties.size() == 2);
+        REQUIRE(object2.property_for_name("new col")->table_column == 0);
+        REQUIRE(object2.property_for_name("value")->table_column == 1);
+    }
+
     SECTION("update_schema() to version already on disk updates cache") {
         r->read_group();
         external_write(config, [](auto& wt) {
@@ -1101,4 +1722,143 @@ TEST_CASE("SharedRealm: compact on launch") {
     // Validate that the file still contains what it should
     REQUIRE(r->read_group().get_table("class_object")->size() == count);
 }
+
+TEST_CASE("SharedRealm: compact on close") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::String, "", "", false, false, false}
+        }},
+    };
+
+    // Build up a file which is mostly reclaimable space
+    auto r = Realm::get_shared_realm(config);
+    r->begin_transaction();
+    auto table = r->read_group().get_table("class_object");
+    int count = 1000;
+    table->add_empty_row(count);
+    for (int i = 0; i < count; ++i)
+        table->set_string(0, i, util::format("Foo_%1", i % 10).c_str());
+    r->commit_transaction();
+    r->begin_transaction();
+    table->clear();
+    r->commit_transaction();
+    r = nullptr;
+
+    size_t size_before = size_t(File(config.path).get_size());
+
+    SECTION("compacts the file when the policy matches") {
+        config.compact_on_close_bytes = 1;
+        config.compact_on_close_utilization = 1.0;
+        Realm::get_shared_realm(config);
+        REQUIRE(size_t(File(config.path).get_size()) < size_before);
+
+        // Validate that the file is still openable afterwards
+        r = Realm::get_shared_realm(config);
+        REQUIRE(r->read_group().get_table("class_object")->size() == 0);
+    }
+
+    SECTION("leaves files below the size threshold alone") {
+        config.compact_on_close_bytes = uint64_t(-1);
+        config.compact_on_close_utilization = 1.0;
+        Realm::get_shared_realm(config);
+        REQUIRE(size_t(File(config.path).get_size()) == size_before);
+    }
+
+    SECTION("leaves sufficiently utilized files alone") {
+        config.compact_on_close_bytes = 1;
+        config.compact_on_close_utilization = 0.0;
+        Realm::get_shared_realm(config);
+        REQUIRE(size_t(File(config.path).get_size()) == size_before);
+    }
+}
 #endif
+
+TEST_CASE("SharedRealm: page-cache warming") {
+    // The actual effect is on the OS page cache and isn't observable here,
+    // so just verify that opening with each strategy works
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    r->begin_transaction();
+    auto table = r->read_group().get_table("class_object");
+    table->add_empty_row(100);
+    r->commit_transaction();
+    r->close();
+
+    SECTION("advise") {
+        config.warm_strategy = Realm::Config::WarmStrategy::Advise;
+        r = Realm::get_shared_realm(config);
+        REQUIRE(r->read_group().get_table("class_object")->size() == 100);
+    }
+
+    SECTION("prefault") {
+        config.warm_strategy = Realm::Config::WarmStrategy::Prefault;
+        r = Realm::get_shared_realm(config);
+        REQUIRE(r->read_group().get_table("class_object")->size() == 100);
+    }
+}
+
+TEST_CASE("SharedRealm: freeze") {
+    TestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int, "", "", false, false, false}
+        }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    realm->begin_transaction();
+    realm->read_group().get_table("class_object")->add_empty_row(5);
+    realm->commit_transaction();
+
+    SECTION("stays pinned to the version it was frozen at") {
+        auto frozen = realm->freeze();
+        REQUIRE(frozen->is_frozen());
+        REQUIRE_FALSE(realm->is_frozen());
+
+        realm->begin_transaction();
+        realm->read_group().get_table("class_object")->add_empty_row();
+        realm->commit_transaction();
+
+        REQUIRE(realm->read_group().get_table("class_object")->size() == 6);
+        REQUIRE(frozen->read_group().get_table("class_object")->size() == 5);
+        REQUIRE_FALSE(frozen->refresh());
+        REQUIRE(frozen->read_group().get_table("class_object")->size() == 5);
+    }
+
+    SECTION("keeps the source Realm's schema") {
+        auto frozen = realm->freeze();
+        REQUIRE(frozen->schema() == realm->schema());
+    }
+
+    SECTION("does not permit writes") {
+        auto frozen = realm->freeze();
+        REQUIRE_THROWS_AS(frozen->begin_transaction(), InvalidTransactionException);
+    }
+
+    SECTION("can be used from other threads") {
+        auto frozen = realm->freeze();
+        std::thread([&] {
+            REQUIRE_NOTHROW(frozen->verify_thread());
+            Results results(frozen, frozen->read_group().get_table("class_object")->where());
+            REQUIRE(results.size() == 5);
+
+            // A thread wanting its own accessors can refreeze to get a new
+            // instance pinned to the same version
+            auto frozen2 = frozen->freeze();
+            REQUIRE(frozen2->read_group().get_table("class_object")->size() == 5);
+        }).join();
+    }
+}
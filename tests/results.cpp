@@ -20,6 +20,7 @@
 
 #include "util/event_loop.hpp"
 #include "util/index_helpers.hpp"
+#include "util/test_allocator.hpp"
 #include "util/test_file.hpp"
 #include "util/format.hpp"
 
@@ -35,6 +36,9 @@
 #include <realm/query_engine.hpp>
 #include <realm/query_expression.hpp>
 
+#include <chrono>
+#include <thread>
+
 #if REALM_ENABLE_SYNC
 #include "sync/sync_manager.hpp"
 #include "sync/sync_session.hpp"
@@ -866,6 +870,255 @@ TEST_CASE("notifications: skip") {
     }
 }
 
+TEST_CASE("notifications: throttling") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    Results results(r, table->where());
+
+    auto add_callback = [](Results& results, int& calls, CollectionChangeSet& changes,
+                           std::chrono::milliseconds interval) {
+        return results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            ++calls;
+            changes = std::move(c);
+        }, interval);
+    };
+
+    auto make_change = [&] {
+        r->begin_transaction();
+        table->add_empty_row();
+        r->commit_transaction();
+    };
+
+    SECTION("changes within the interval are not delivered") {
+        int calls = 0;
+        CollectionChangeSet changes;
+        auto token = add_callback(results, calls, changes, std::chrono::hours(1));
+
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        make_change();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        make_change();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("changes are delivered once the interval has elapsed") {
+        int calls = 0;
+        CollectionChangeSet changes;
+        auto token = add_callback(results, calls, changes, std::chrono::milliseconds(1));
+
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        make_change();
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(changes.insertions, 0);
+    }
+
+    SECTION("changes made while inside the interval are coalesced into the next delivery") {
+        int calls = 0;
+        CollectionChangeSet changes;
+        auto token = add_callback(results, calls, changes, std::chrono::milliseconds(500));
+
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        // Each of these skips both the changeset computation and the delivery
+        make_change();
+        advance_and_notify(*r);
+        r->begin_transaction();
+        table->set_int(0, 0, 5);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        make_change();
+        advance_and_notify(*r);
+
+        // A single changeset covering everything since the initial
+        // notification, with the modification to the newly-inserted row
+        // folded into its insertion
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(changes.insertions, 0, 1);
+        REQUIRE(changes.modifications.empty());
+    }
+
+    SECTION("unthrottled callbacks on the same Results are still delivered every time") {
+        int throttled_calls = 0, unthrottled_calls = 0;
+        CollectionChangeSet throttled_changes, unthrottled_changes;
+        auto token1 = add_callback(results, throttled_calls, throttled_changes, std::chrono::hours(1));
+        auto token2 = add_callback(results, unthrottled_calls, unthrottled_changes,
+                                   std::chrono::milliseconds::zero());
+
+        advance_and_notify(*r);
+        REQUIRE(throttled_calls == 1);
+        REQUIRE(unthrottled_calls == 1);
+
+        make_change();
+        advance_and_notify(*r);
+        REQUIRE(throttled_calls == 1);
+        REQUIRE(unthrottled_calls == 2);
+        REQUIRE_INDICES(unthrottled_changes.insertions, 0);
+
+        make_change();
+        advance_and_notify(*r);
+        REQUIRE(throttled_calls == 1);
+        REQUIRE(unthrottled_calls == 3);
+        REQUIRE_INDICES(unthrottled_changes.insertions, 1);
+    }
+}
+
+TEST_CASE("notifications: observed columns") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+            {"other", PropertyType::Int}
+        }},
+        {"linking", {
+            {"value", PropertyType::Int},
+            {"link", PropertyType::Object, "object", "", false, false, true}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    r->begin_transaction();
+    table->add_empty_row(5);
+    r->commit_transaction();
+
+    Results results(r, table->where());
+
+    auto add_callback = [](Results& results, int& calls, CollectionChangeSet& changes,
+                           std::vector<size_t> columns) {
+        return results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            ++calls;
+            changes = std::move(c);
+        }, std::chrono::milliseconds::zero(), std::move(columns));
+    };
+
+    SECTION("modifications to unobserved columns are not delivered") {
+        int calls = 0;
+        CollectionChangeSet changes;
+        auto token = add_callback(results, calls, changes, {0});
+
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        r->begin_transaction();
+        table->set_int(1, 2, 5);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        r->begin_transaction();
+        table->set_int(0, 2, 5);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(changes.modifications, 2);
+    }
+
+    SECTION("insertions and deletions are always delivered") {
+        int calls = 0;
+        CollectionChangeSet changes;
+        auto token = add_callback(results, calls, changes, {0});
+
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        r->begin_transaction();
+        table->add_empty_row();
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(changes.insertions, 5);
+
+        r->begin_transaction();
+        table->move_last_over(0);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 3);
+        REQUIRE(!changes.deletions.empty());
+    }
+
+    SECTION("the modification scan is shared, so it filters on the union of the observed columns") {
+        int calls1 = 0, calls2 = 0;
+        CollectionChangeSet changes1, changes2;
+        auto token1 = add_callback(results, calls1, changes1, {0});
+        auto token2 = add_callback(results, calls2, changes2, {1});
+
+        advance_and_notify(*r);
+        REQUIRE(calls1 == 1);
+        REQUIRE(calls2 == 1);
+
+        r->begin_transaction();
+        table->set_int(1, 2, 5);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls1 == 2);
+        REQUIRE(calls2 == 2);
+    }
+
+    SECTION("modifications to rows reached through links are still delivered") {
+        auto linking = r->read_group().get_table("class_linking");
+        r->begin_transaction();
+        linking->add_empty_row();
+        linking->set_link(1, 0, 2);
+        r->commit_transaction();
+
+        Results linking_results(r, linking->where());
+        int calls = 0;
+        CollectionChangeSet changes;
+        auto token = add_callback(linking_results, calls, changes, {1});
+
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        // Modifying the linked-to row is not filtered out even though only
+        // the local `link` column is observed
+        r->begin_transaction();
+        table->set_int(0, 2, 10);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+        REQUIRE_INDICES(changes.modifications, 0);
+
+        // But a modification to an unobserved local column still is
+        r->begin_transaction();
+        linking->set_int(0, 0, 10);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 2);
+    }
+}
+
 #if REALM_PLATFORM_APPLE
 TEST_CASE("notifications: async error handling") {
     _impl::RealmCoordinator::assert_no_open_realms();
@@ -1640,6 +1893,65 @@ TEST_CASE("notifications: results") {
     }
 }
 
+TEST_CASE("notifications: compute_deep_change_info disabled") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.compute_deep_change_info = false;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"link", PropertyType::Object, "linked to object", "", false, false, true}
+        }},
+        {"linked to object", {
+            {"value", PropertyType::Int}
+        }}
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+    auto linked_table = r->read_group().get_table("class_linked to object");
+
+    r->begin_transaction();
+    table->add_empty_row(2);
+    linked_table->add_empty_row(2);
+    table->set_link(1, 0, 0);
+    table->set_link(1, 1, 1);
+    r->commit_transaction();
+
+    Results results(r, *table);
+    int notification_calls = 0;
+    CollectionChangeSet change;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = c;
+        ++notification_calls;
+    });
+    advance_and_notify(*r);
+
+    auto write = [&](auto&& f) {
+        r->begin_transaction();
+        f();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("modifying a linked-to object does not send a notification") {
+        write([&] {
+            linked_table->set_int(0, 0, 10);
+        });
+        REQUIRE(notification_calls == 1);
+    }
+
+    SECTION("direct modifications are still reported") {
+        write([&] {
+            table->set_int(0, 1, 10);
+        });
+        REQUIRE(notification_calls == 2);
+        REQUIRE_INDICES(change.modifications, 1);
+    }
+}
+
 TEST_CASE("results: notifications after move") {
     InMemoryTestFile config;
     config.cache = false;
@@ -1709,7 +2021,7 @@ TEST_CASE("results: implicit background notifier") {
 
     auto table = r->read_group().get_table("class_object");
     Results results(r, table->where());
-    results.last(); // force evaluation and creation of TableView
+    results.get_tableview(); // force evaluation and creation of TableView
 
     SECTION("refresh() does not block due to implicit notifier") {
         auto r2 = coordinator->get_realm();
@@ -1739,6 +2051,57 @@ TEST_CASE("results: implicit background notifier") {
     }
 }
 
+TEST_CASE("results: evaluate_async()") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto coordinator = _impl::RealmCoordinator::get_coordinator(config.path);
+    auto r = coordinator->get_realm(std::move(config));
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    r->begin_transaction();
+    table->add_empty_row(5);
+    for (int i = 0; i < 5; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results results(r, table->where().greater(0, 1));
+
+    int calls = 0;
+    auto token = results.evaluate_async([&](std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        ++calls;
+    });
+
+    SECTION("delivers the evaluated view without evaluating on this thread") {
+        REQUIRE(results.get_mode() == Results::Mode::Query);
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+        REQUIRE(results.get_mode() == Results::Mode::TableView);
+        REQUIRE(results.size() == 3);
+    }
+
+    SECTION("is only called once even if the results change afterwards") {
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+
+        r->begin_transaction();
+        table->set_int(0, 0, 10);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE(calls == 1);
+        REQUIRE(results.size() == 4);
+    }
+}
+
 TEST_CASE("results: error messages") {
     InMemoryTestFile config;
     config.schema = Schema{
@@ -2067,6 +2430,19 @@ TEST_CASE("results: snapshots") {
         CHECK_THROWS(snapshot.add_notification_callback([](CollectionChangeSet, std::exception_ptr) {}));
     }
 
+    SECTION("snapshot remains valid after the Results it was created from is destroyed") {
+        auto table = r->read_group().get_table("class_object");
+        write([=]{ table->add_empty_row(); });
+
+        Results snapshot;
+        {
+            Results results(r, table->where());
+            snapshot = results.snapshot();
+        }
+        REQUIRE(snapshot.size() == 1);
+        REQUIRE(snapshot.get(0).is_attached());
+    }
+
     SECTION("accessors should return none for detached row") {
         auto table = r->read_group().get_table("class_object");
         write([=] {
@@ -2263,8 +2639,598 @@ TEST_CASE("distinct") {
     }
 }
 
+TEST_CASE("results: sort by key path") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
 
-TEST_CASE("aggregate") {
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"name", PropertyType::String},
+            {"value", PropertyType::Int},
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    r->begin_transaction();
+    table->add_empty_row(4);
+    const char* names[] = {"banana", "apricot", "durian", "cherry"};
+    for (int i = 0; i < 4; ++i) {
+        table->set_string(0, i, names[i]);
+        table->set_int(1, i, i);
+    }
+    r->commit_transaction();
+
+    Results results(r, *table);
+
+    SECTION("sorts by the named property") {
+        Results sorted = results.sort({{"name", true}});
+        REQUIRE(sorted.size() == 4);
+        REQUIRE(sorted.get(0).get_string(0) == "apricot");
+        REQUIRE(sorted.get(1).get_string(0) == "banana");
+        REQUIRE(sorted.get(2).get_string(0) == "cherry");
+        REQUIRE(sorted.get(3).get_string(0) == "durian");
+
+        Results reversed = results.sort({{"name", false}});
+        REQUIRE(reversed.get(0).get_string(0) == "durian");
+        REQUIRE(reversed.get(3).get_string(0) == "apricot");
+    }
+
+    SECTION("records the sorted columns") {
+        REQUIRE(results.get_sort_columns().empty());
+        REQUIRE(results.sort({{"name", true}}).get_sort_columns() == std::vector<size_t>{0});
+        REQUIRE((results.sort({{"name", true}, {"value", false}}).get_sort_columns()
+                 == std::vector<size_t>{0, 1}));
+
+        // Columns are not known for prebuilt SortDescriptors
+        REQUIRE(results.sort(SortDescriptor(*table, {{0}})).get_sort_columns().empty());
+    }
+
+    SECTION("throws for invalid properties") {
+        REQUIRE_THROWS_AS(results.sort({{"not a property", true}}), std::invalid_argument);
+    }
+
+    SECTION("notifications") {
+        Results sorted = results.sort({{"name", true}});
+
+        int notification_calls = 0;
+        CollectionChangeSet change;
+        auto token = sorted.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            change = c;
+            ++notification_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+
+        auto write = [&](auto&& f) {
+            r->begin_transaction();
+            f();
+            r->commit_transaction();
+            advance_and_notify(*r);
+        };
+
+        SECTION("modifying a column not read by the sort reports the row as modified") {
+            write([&] {
+                table->set_int(1, 0, 10);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.modifications, 1);
+            REQUIRE_INDICES(change.modifications_new, 1);
+        }
+
+        SECTION("modifying the sorted column moves the row") {
+            write([&] {
+                table->set_string(0, 0, "zucchini");
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.deletions, 1);
+            REQUIRE_INDICES(change.insertions, 3);
+        }
+
+        SECTION("modifying the sorted column without changing the order reports a modification") {
+            write([&] {
+                table->set_string(0, 0, "blueberry");
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.modifications, 1);
+            REQUIRE_INDICES(change.modifications_new, 1);
+        }
+    }
+}
+
+TEST_CASE("results: first() and last()") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    });
+    auto table = r->read_group().get_table("class_object");
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    SECTION("table") {
+        Results results(r, *table);
+        REQUIRE(results.first()->get_int(0) == 0);
+        REQUIRE(results.last()->get_int(0) == 9);
+    }
+
+    SECTION("query") {
+        Results results(r, table->where().greater(0, 2).less(0, 8));
+        REQUIRE(results.first()->get_int(0) == 3);
+        REQUIRE(results.last()->get_int(0) == 7);
+    }
+
+    SECTION("query with no matches") {
+        Results results(r, table->where().greater(0, 100));
+        REQUIRE(!results.first());
+        REQUIRE(!results.last());
+    }
+
+    SECTION("query results track changes") {
+        Results results(r, table->where().greater(0, 2));
+        REQUIRE(results.last()->get_int(0) == 9);
+
+        r->begin_transaction();
+        table->set_int(0, 9, 0);
+        r->commit_transaction();
+
+        REQUIRE(results.last()->get_int(0) == 8);
+    }
+
+    SECTION("sorted query") {
+        Results results = Results(r, table->where().greater(0, 2)).sort(SortDescriptor(*table, {{0}}, {false}));
+        REQUIRE(results.first()->get_int(0) == 9);
+        REQUIRE(results.last()->get_int(0) == 3);
+    }
+
+    SECTION("last match far from the end of the table") {
+        // Push the matches several chunks of rows away from the end so that
+        // the backwards scan in last() has to step over multiple chunks
+        r->begin_transaction();
+        table->add_empty_row(3000);
+        for (size_t i = 10; i < 3010; ++i)
+            table->set_int(0, i, 1000);
+        r->commit_transaction();
+
+        Results results(r, table->where().less(0, 10));
+        REQUIRE(results.first()->get_int(0) == 0);
+        REQUIRE(results.last()->get_int(0) == 9);
+    }
+
+    SECTION("empty table") {
+        r->begin_transaction();
+        table->clear();
+        r->commit_transaction();
+
+        Results results(r, table->where());
+        REQUIRE(!results.first());
+        REQUIRE(!results.last());
+    }
+}
+
+TEST_CASE("results: get_range") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    SECTION("table-backed Results") {
+        Results results(r, *table);
+        auto rows = results.get_range(2, 5);
+        REQUIRE(rows.size() == 3);
+        REQUIRE(rows[0].get_int(0) == 2);
+        REQUIRE(rows[2].get_int(0) == 4);
+    }
+
+    SECTION("query-backed Results") {
+        Results results(r, table->where().greater(0, 2));
+        auto rows = results.get_range(0, 3);
+        REQUIRE(rows.size() == 3);
+        REQUIRE(rows[0].get_int(0) == 3);
+        REQUIRE(rows[2].get_int(0) == 5);
+    }
+
+    SECTION("sorted Results") {
+        Results results = Results(r, table->where()).sort(SortDescriptor(*table, {{0}}, {false}));
+        auto rows = results.get_range(0, 2);
+        REQUIRE(rows.size() == 2);
+        REQUIRE(rows[0].get_int(0) == 9);
+        REQUIRE(rows[1].get_int(0) == 8);
+    }
+
+    SECTION("limited Results") {
+        Results results = Results(r, table->where()).limit(3);
+        REQUIRE(results.get_range(0, 3).size() == 3);
+        REQUIRE_THROWS_AS(results.get_range(0, 4), Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("empty and inverted ranges") {
+        Results results(r, table->where());
+        REQUIRE(results.get_range(4, 4).empty());
+        REQUIRE(results.get_range(5, 4).empty());
+    }
+
+    SECTION("out of bounds ranges throw") {
+        Results results(r, table->where());
+        REQUIRE_THROWS_AS(results.get_range(5, 11), Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("snapshot returns detached accessors for deleted rows") {
+        auto snapshot = Results(r, table->where()).snapshot();
+        r->begin_transaction();
+        table->move_last_over(0);
+        r->commit_transaction();
+
+        auto rows = snapshot.get_range(0, 2);
+        REQUIRE(rows.size() == 2);
+        REQUIRE(!rows[0].is_attached());
+        REQUIRE(rows[1].is_attached());
+    }
+}
+
+TEST_CASE("results: index_of") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results results(r, table->where().greater(0, 2));
+
+    SECTION("returns the position in the results, not the table") {
+        REQUIRE(results.index_of(3) == 0);
+        REQUIRE(results.index_of(9) == 6);
+        REQUIRE(results.index_of(0) == not_found);
+    }
+
+    SECTION("sorted results") {
+        Results sorted = results.sort(SortDescriptor(*table, {{0}}, {false}));
+        REQUIRE(sorted.index_of(9) == 0);
+        REQUIRE(sorted.index_of(3) == 6);
+        REQUIRE(sorted.index_of(0) == not_found);
+    }
+
+    SECTION("reflects changes made after the first lookup") {
+        REQUIRE(results.index_of(3) == 0);
+
+        r->begin_transaction();
+        table->set_int(0, 3, 0);
+        r->commit_transaction();
+
+        REQUIRE(results.index_of(3) == not_found);
+        REQUIRE(results.index_of(4) == 0);
+    }
+
+    SECTION("reflects changesets delivered by the notifier") {
+        auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+        });
+        advance_and_notify(*r);
+        REQUIRE(results.index_of(5) == 2);
+
+        r->begin_transaction();
+        table->set_int(0, 3, 0);  // remove row 3 from the results
+        table->set_int(0, 0, 10); // add row 0 to the results
+        r->commit_transaction();
+        advance_and_notify(*r);
+
+        REQUIRE(results.index_of(0) == 0);
+        REQUIRE(results.index_of(3) == not_found);
+        REQUIRE(results.index_of(5) == 2);
+        REQUIRE(results.index_of(9) == 6);
+    }
+}
+
+TEST_CASE("results: limit") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    Results results(r, table->where());
+
+    SECTION("unsorted limit returns the first matching rows") {
+        Results limited = results.limit(3);
+        REQUIRE(limited.size() == 3);
+        REQUIRE(limited.get(0).get_int(0) == 0);
+        REQUIRE(limited.get(1).get_int(0) == 1);
+        REQUIRE(limited.get(2).get_int(0) == 2);
+        REQUIRE(limited.last()->get_int(0) == 2);
+        REQUIRE_THROWS_AS(limited.get(3), Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("sorted limit returns the first rows in sorted order") {
+        Results limited = results.sort(SortDescriptor(*table, {{0}}, {false})).limit(3);
+        REQUIRE(limited.size() == 3);
+        REQUIRE(limited.get(0).get_int(0) == 9);
+        REQUIRE(limited.get(1).get_int(0) == 8);
+        REQUIRE(limited.get(2).get_int(0) == 7);
+        REQUIRE(limited.last()->get_int(0) == 7);
+        REQUIRE_THROWS_AS(limited.get(3), Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("index_of() returns not_found for rows beyond the limit") {
+        Results limited = results.limit(3);
+        REQUIRE(limited.index_of(2) == 2);
+        REQUIRE(limited.index_of(3) == not_found);
+    }
+
+    SECTION("limit of zero and limit larger than the result set") {
+        REQUIRE(results.limit(0).size() == 0);
+        REQUIRE(!results.limit(0).first());
+        REQUIRE(!results.limit(0).last());
+        REQUIRE(results.limit(100).size() == 10);
+    }
+
+    SECTION("limiting an already limited Results uses the smaller limit") {
+        REQUIRE(results.limit(5).limit(3).size() == 3);
+        REQUIRE(results.limit(3).limit(5).size() == 3);
+    }
+
+    SECTION("limited Results updates to reflect changes in the underlying data") {
+        Results limited = results.sort(SortDescriptor(*table, {{0}}, {false})).limit(3);
+        REQUIRE(limited.get(0).get_int(0) == 9);
+
+        r->begin_transaction();
+        table->set_int(0, table->add_empty_row(), 20);
+        r->commit_transaction();
+
+        REQUIRE(limited.size() == 3);
+        REQUIRE(limited.get(0).get_int(0) == 20);
+        REQUIRE(limited.get(1).get_int(0) == 9);
+        REQUIRE(limited.get(2).get_int(0) == 8);
+    }
+
+    SECTION("operations which cannot respect the limit throw") {
+        Results limited = results.limit(3);
+        REQUIRE_THROWS_AS(limited.sort(SortDescriptor(*table, {{0}})), Results::UnimplementedOperationException);
+        REQUIRE_THROWS_AS(limited.filter(table->where().greater(0, 0)), Results::UnimplementedOperationException);
+        REQUIRE_THROWS_AS(limited.distinct(SortDescriptor(*table, {{0}})), Results::UnimplementedOperationException);
+        REQUIRE_THROWS_AS(limited.clear(), Results::UnimplementedOperationException);
+
+        Results sorted_limited = results.sort(SortDescriptor(*table, {{0}}, {false})).limit(3);
+        REQUIRE_THROWS_AS(sorted_limited.sum(0), Results::UnimplementedOperationException);
+        REQUIRE_THROWS_AS(sorted_limited.get_tableview(), Results::UnimplementedOperationException);
+    }
+
+    SECTION("notifications only describe changes within the limited window") {
+        Results limited = results.sort(SortDescriptor(*table, {{0}}, {false})).limit(3);
+
+        int notification_calls = 0;
+        CollectionChangeSet change;
+        auto token = limited.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            change = c;
+            ++notification_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+
+        auto write = [&](auto&& f) {
+            r->begin_transaction();
+            f();
+            r->commit_transaction();
+            advance_and_notify(*r);
+        };
+
+        SECTION("modifying a row outside the window does not send a notification") {
+            write([&] {
+                table->set_int(0, 0, -1);
+            });
+            REQUIRE(notification_calls == 1);
+        }
+
+        SECTION("a new row entering the window is an insertion plus a deletion") {
+            write([&] {
+                table->set_int(0, table->add_empty_row(), 20);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.insertions, 0);
+            REQUIRE_INDICES(change.deletions, 2);
+        }
+
+        SECTION("a new row beyond the window does not send a notification") {
+            write([&] {
+                table->set_int(0, table->add_empty_row(), -1);
+            });
+            REQUIRE(notification_calls == 1);
+        }
+    }
+}
+
+TEST_CASE("results: clear") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    SECTION("query matching every row clears the entire table") {
+        Results results(r, table->where().greater_equal(0, 0));
+        REQUIRE(results.size() == 10);
+        r->begin_transaction();
+        results.clear();
+        r->commit_transaction();
+        REQUIRE(results.size() == 0);
+        REQUIRE(table->size() == 0);
+    }
+
+    SECTION("query matching a subset only removes the matching rows") {
+        Results results(r, table->where().greater_equal(0, 5));
+        r->begin_transaction();
+        results.clear();
+        r->commit_transaction();
+        REQUIRE(results.size() == 0);
+        REQUIRE(table->size() == 5);
+    }
+
+    SECTION("snapshots of a fully-covering Results keep their size after clear") {
+        Results results(r, table->where());
+        auto snapshot = results.snapshot();
+        r->begin_transaction();
+        results.clear();
+        r->commit_transaction();
+        REQUIRE(results.size() == 0);
+        REQUIRE(snapshot.size() == 10);
+        REQUIRE(!snapshot.get(0).is_attached());
+    }
+}
+
+TEST_CASE("results: unchanged query results") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int},
+            {"unqueried", PropertyType::Int},
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (int i = 0; i < 10; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    // Sorted so that modifications to matching rows force a full rerun of
+    // the query rather than taking the incremental evaluation path
+    Results results(r, table->where().greater(0, 4), SortDescriptor(*table, {{0}}));
+
+    int notification_calls = 0;
+    CollectionChangeSet change;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c, std::exception_ptr err) {
+        REQUIRE_FALSE(err);
+        change = c;
+        ++notification_calls;
+    });
+    advance_and_notify(*r);
+    REQUIRE(results.size() == 5);
+
+    auto write = [&](auto&& f) {
+        r->begin_transaction();
+        f();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("modifying a matching row without changing the matches is delivered as a modification") {
+        write([&] {
+            table->set_int(1, 7, 1);
+        });
+        REQUIRE(notification_calls == 2);
+        REQUIRE_INDICES(change.modifications, 2);
+        REQUIRE(results.size() == 5);
+        REQUIRE(results.get(2).get_int(1) == 1);
+        REQUIRE(results.index_of(7) == 2);
+    }
+
+    SECTION("changing which rows match still delivers an updated view") {
+        write([&] {
+            table->set_int(0, 0, 100);
+        });
+        REQUIRE(notification_calls == 2);
+        REQUIRE_INDICES(change.insertions, 5);
+        REQUIRE(results.size() == 6);
+        REQUIRE(results.get(5).get_index() == 0);
+    }
+
+    SECTION("an unchanged run followed by a changed run produces correct results") {
+        write([&] {
+            table->set_int(1, 7, 1);
+        });
+        write([&] {
+            table->set_int(0, 0, 100);
+        });
+        REQUIRE(notification_calls == 3);
+        REQUIRE_INDICES(change.insertions, 5);
+        REQUIRE(results.size() == 6);
+        REQUIRE(results.get(2).get_int(1) == 1);
+    }
+
+    SECTION("writes on the target thread are reflected immediately") {
+        write([&] {
+            table->set_int(1, 7, 1);
+        });
+        r->begin_transaction();
+        table->set_int(0, 0, 100);
+        REQUIRE(results.size() == 6);
+        r->cancel_transaction();
+        REQUIRE(results.size() == 5);
+    }
+}
+
+
+TEST_CASE("aggregate") {
 #define SECTIONS_RESULT_BUILT_FROM_TABLE_QUERY_TABLE_VIEW() \
     SECTION("results built from table") { \
         results = Results(r, *table); \
@@ -2485,4 +3451,394 @@ TEST_CASE("aggregate") {
             REQUIRE_THROWS_AS(results.sum(3), Results::UnsupportedColumnTypeException);
         }
     }
+
+    SECTION("cached values are invalidated by changes to the data") {
+        r->begin_transaction();
+        table->add_empty_row(2);
+        table->set_int(0, 0, 1);
+        table->set_int(0, 1, 2);
+        r->commit_transaction();
+
+        Results results(r, *table);
+
+        SECTION("repeated calls in one version give the same result") {
+            REQUIRE(results.sum(0)->get_int() == 3);
+            REQUIRE(results.sum(0)->get_int() == 3);
+            REQUIRE(results.max(0)->get_int() == 2);
+            REQUIRE(results.max(0)->get_int() == 2);
+        }
+
+        SECTION("changes are visible immediately within a write transaction") {
+            REQUIRE(results.sum(0)->get_int() == 3);
+            r->begin_transaction();
+            table->set_int(0, 0, 10);
+            REQUIRE(results.sum(0)->get_int() == 12);
+            table->set_int(0, 1, 20);
+            REQUIRE(results.sum(0)->get_int() == 30);
+            r->cancel_transaction();
+            REQUIRE(results.sum(0)->get_int() == 3);
+        }
+
+        SECTION("committed changes update the cached values") {
+            REQUIRE(results.sum(0)->get_int() == 3);
+            REQUIRE(results.min(0)->get_int() == 1);
+            r->begin_transaction();
+            table->set_int(0, 0, 5);
+            r->commit_transaction();
+            REQUIRE(results.sum(0)->get_int() == 7);
+            REQUIRE(results.min(0)->get_int() == 2);
+        }
+    }
+}
+
+TEST_CASE("results: allocation budgets") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto coordinator = _impl::RealmCoordinator::get_existing_coordinator(config.path);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(100);
+    for (int i = 0; i < 100; ++i)
+        table->set_int(0, i, i);
+    r->commit_transaction();
+
+    SECTION("get() on a table-backed Results does not allocate") {
+        Results results(r, *table);
+        results.get(0); // warm up
+        REQUIRE_ALLOCATIONS_UNDER(0) {
+            for (size_t i = 0; i < 100; ++i)
+                results.get(i);
+        }
+    }
+
+    SECTION("get() on an evaluated query-backed Results stays within budget") {
+        Results results(r, table->where().greater(0, 9));
+        results.get(0); // evaluate the query
+        REQUIRE_ALLOCATIONS_UNDER(8) {
+            for (size_t i = 0; i < 50; ++i)
+                results.get(i);
+        }
+    }
+
+    SECTION("notification delivery stays within budget") {
+        Results results(r, table->where());
+        int notification_calls = 0;
+        auto token = results.add_notification_callback([&](CollectionChangeSet, std::exception_ptr) {
+            ++notification_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+
+        r->begin_transaction();
+        table->set_int(0, 0, 200);
+        r->commit_transaction();
+
+        // Compute the changeset outside of the budgeted region so that the
+        // budget covers packaging and delivering an already-computed change
+        coordinator->on_change();
+        REQUIRE_ALLOCATIONS_UNDER(100) {
+            r->notify();
+        }
+        REQUIRE(notification_calls == 2);
+    }
+}
+
+TEST_CASE("results: encrypted read-ahead") {
+    TestFile config;
+    config.encryption_key = std::vector<char>(64, 'a');
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String, "", "", false, false, true},
+        }},
+    };
+
+    auto verify = [&] {
+        auto realm = Realm::get_shared_realm(config);
+        auto table = realm->read_group().get_table("class_object");
+
+        realm->begin_transaction();
+        table->add_empty_row(10);
+        for (size_t i = 0; i < 10; ++i) {
+            table->set_int(0, i, int64_t(i));
+            if (i % 2)
+                table->set_string(1, i, "odd");
+        }
+        realm->commit_transaction();
+
+        Results results(realm, table->where().greater(0, 4));
+        REQUIRE(results.size() == 5);
+        for (size_t i = 0; i < 5; ++i) {
+            auto row = results.get(i);
+            REQUIRE(row.get_int(0) == int64_t(i + 5));
+            if (row.get_index() % 2)
+                REQUIRE(row.get_string(1) == "odd");
+            else
+                REQUIRE(row.is_null(1));
+        }
+    };
+
+    SECTION("with the default read-ahead limit") {
+        verify();
+    }
+
+    SECTION("with a limit smaller than the result set") {
+        config.encryption_read_ahead_rows = 2;
+        verify();
+    }
+
+    SECTION("with read-ahead disabled") {
+        config.encryption_read_ahead_rows = 0;
+        verify();
+    }
+}
+
+TEST_CASE("results: distinct_values()") {
+    InMemoryTestFile config;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+            {"name", PropertyType::String, "", "", false, false, true},
+            {"link", PropertyType::Object, "object", "", false, false, true},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(6);
+    int64_t values[] = {1, 2, 1, 3, 2, 1};
+    for (size_t i = 0; i < 6; ++i) {
+        table->set_int(0, i, values[i]);
+        if (i % 2 == 0)
+            table->set_string(1, i, i < 3 ? "a" : "b");
+        else
+            table->set_null(1, i);
+    }
+    r->commit_transaction();
+
+    Results results(r, *table);
+
+    SECTION("returns each value once, in order of first appearance") {
+        auto distinct = results.distinct_values(0);
+        REQUIRE(distinct.size() == 3);
+        REQUIRE(distinct[0].get_int() == 1);
+        REQUIRE(distinct[1].get_int() == 2);
+        REQUIRE(distinct[2].get_int() == 3);
+    }
+
+    SECTION("omits null values") {
+        auto distinct = results.distinct_values(1);
+        REQUIRE(distinct.size() == 2);
+        REQUIRE(distinct[0].get_string() == "a");
+        REQUIRE(distinct[1].get_string() == "b");
+    }
+
+    SECTION("only includes values from rows matching the query") {
+        Results filtered(r, table->where().greater(0, 1));
+        auto distinct = filtered.distinct_values(0);
+        REQUIRE(distinct.size() == 2);
+        REQUIRE(distinct[0].get_int() == 2);
+        REQUIRE(distinct[1].get_int() == 3);
+    }
+
+    SECTION("produces the same set of values when a search index is present") {
+        r->begin_transaction();
+        table->add_search_index(0);
+        r->commit_transaction();
+
+        auto distinct = results.distinct_values(0);
+        std::vector<int64_t> ints;
+        for (auto& value : distinct)
+            ints.push_back(value.get_int());
+        std::sort(ints.begin(), ints.end());
+        REQUIRE(ints == std::vector<int64_t>({1, 2, 3}));
+    }
+
+    SECTION("throws for unsupported column types") {
+        REQUIRE_THROWS_AS(results.distinct_values(2), Results::UnsupportedColumnTypeException);
+    }
+
+    SECTION("throws for out-of-bounds columns") {
+        REQUIRE_THROWS_AS(results.distinct_values(3), Results::OutOfBoundsIndexException);
+    }
+}
+
+TEST_CASE("results: iteration") {
+    InMemoryTestFile config;
+    config.schema = Schema{
+        {"object", {
+            {"value", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table->set_int(0, i, int64_t(i));
+    r->commit_transaction();
+
+    SECTION("over a table-backed Results") {
+        Results results(r, *table);
+        int64_t expected = 0;
+        for (auto row : results)
+            REQUIRE(row.get_int(0) == expected++);
+        REQUIRE(expected == 10);
+    }
+
+    SECTION("over a query-backed Results") {
+        Results results(r, table->where().greater(0, 4));
+        int64_t expected = 5;
+        for (auto row : results)
+            REQUIRE(row.get_int(0) == expected++);
+        REQUIRE(expected == 10);
+    }
+
+    SECTION("iterators are random-access") {
+        Results results(r, *table);
+        auto it = results.begin();
+        REQUIRE(results.end() - it == 10);
+        REQUIRE((*(it + 5)).get_int(0) == 5);
+        it += 9;
+        REQUIRE((*it--).get_int(0) == 9);
+        REQUIRE((*it).get_int(0) == 8);
+    }
+
+    SECTION("over an empty Results") {
+        Results results;
+        REQUIRE(results.begin() == results.end());
+    }
+
+    SECTION("over a snapshot with detached rows") {
+        Results results(r, *table);
+        auto snapshot = results.snapshot();
+        r->begin_transaction();
+        table->move_last_over(0);
+        r->commit_transaction();
+
+        size_t count = 0, detached = 0;
+        for (auto row : snapshot) {
+            ++count;
+            if (!row.is_attached())
+                ++detached;
+        }
+        REQUIRE(count == 10);
+        REQUIRE(detached == 1);
+    }
+}
+
+TEST_CASE("results: derived property cache") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object", {
+            {"first", PropertyType::Int},
+            {"second", PropertyType::Int},
+        }},
+    };
+
+    auto r = Realm::get_shared_realm(config);
+    auto table = r->read_group().get_table("class_object");
+
+    r->begin_transaction();
+    table->add_empty_row(10);
+    for (size_t i = 0; i < 10; ++i)
+        table->set_int(0, i, int64_t(i));
+    r->commit_transaction();
+
+    Results results(r, table->where());
+
+    size_t compute_count = 0;
+    auto token = results.add_derived_property({0}, [&](Table const& t, size_t row) {
+        ++compute_count;
+        return util::Any(t.get_int(0, row) * 2);
+    });
+    advance_and_notify(*r);
+
+    auto write = [&](auto&& f) {
+        r->begin_transaction();
+        f();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    SECTION("values are computed lazily on first access") {
+        REQUIRE(compute_count == 0);
+        REQUIRE(util::any_cast<int64_t>(results.get_derived_value(token, 3)) == 6);
+        REQUIRE(compute_count == 1);
+
+        // and cached for later reads
+        REQUIRE(util::any_cast<int64_t>(results.get_derived_value(token, 3)) == 6);
+        REQUIRE(compute_count == 1);
+    }
+
+    SECTION("only the modified rows are recomputed") {
+        for (size_t i = 0; i < 10; ++i)
+            results.get_derived_value(token, i);
+        REQUIRE(compute_count == 10);
+
+        write([&] {
+            table->set_int(0, 2, 100);
+        });
+
+        // The dirty row was recomputed by the background worker
+        REQUIRE(compute_count == 11);
+        REQUIRE(util::any_cast<int64_t>(results.get_derived_value(token, 2)) == 200);
+        for (size_t i = 0; i < 10; ++i)
+            results.get_derived_value(token, i);
+        REQUIRE(compute_count == 11);
+    }
+
+    SECTION("modifying a column the property does not depend on recomputes nothing") {
+        for (size_t i = 0; i < 10; ++i)
+            results.get_derived_value(token, i);
+
+        write([&] {
+            table->set_int(1, 2, 100);
+        });
+        REQUIRE(compute_count == 10);
+        for (size_t i = 0; i < 10; ++i)
+            results.get_derived_value(token, i);
+        REQUIRE(compute_count == 10);
+    }
+
+    SECTION("structural changes discard the cache") {
+        results.get_derived_value(token, 5);
+        REQUIRE(compute_count == 1);
+
+        write([&] {
+            table->move_last_over(0);
+        });
+
+        REQUIRE(util::any_cast<int64_t>(results.get_derived_value(token, 5)) ==
+                2 * table->get_int(0, results.get(5).get_index()));
+        REQUIRE(compute_count == 2);
+    }
+
+    SECTION("removing the property discards its values") {
+        results.get_derived_value(token, 0);
+        results.remove_derived_property(token);
+
+        auto token2 = results.add_derived_property({0}, [&](Table const& t, size_t row) {
+            ++compute_count;
+            return util::Any(t.get_int(0, row));
+        });
+        REQUIRE(util::any_cast<int64_t>(results.get_derived_value(token2, 0)) == 0);
+        REQUIRE(compute_count == 2);
+    }
 }
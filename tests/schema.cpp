@@ -18,6 +18,7 @@
 
 #include "catch.hpp"
 
+#include "frozen_schema.hpp"
 #include "object_schema.hpp"
 #include "property.hpp"
 #include "schema.hpp"
@@ -172,6 +173,29 @@ TEST_CASE("ObjectSchema") {
         pk->set_string(1, 0, "nonexistent property");
         REQUIRE(ObjectSchema(g, "table").primary_key_property() == nullptr);
     }
+
+    SECTION("property_index()") {
+        ObjectSchema os("object", {
+            {"value", PropertyType::Int},
+            {"link", PropertyType::Object, "other", "", false, false, true},
+        }, {
+            {"origin", PropertyType::LinkingObjects, "other", "link"},
+        });
+
+        auto value = os.property_for_name("value");
+        auto link = os.property_for_name("link");
+        auto origin = os.property_for_name("origin");
+        REQUIRE(value);
+        REQUIRE(link);
+        REQUIRE(origin);
+
+        REQUIRE(os.property_index(*value) == 0);
+        REQUIRE(os.property_index(*link) == 1);
+        REQUIRE(os.property_index(*origin) == 2);
+        REQUIRE(&os.property_at(0) == value);
+        REQUIRE(&os.property_at(1) == link);
+        REQUIRE(&os.property_at(2) == origin);
+    }
 }
 
 TEST_CASE("Schema") {
@@ -296,6 +320,68 @@ TEST_CASE("Schema") {
         }
     }
 
+    SECTION("content_hash()") {
+        Schema schema = {
+            {"object", {
+                {"int", PropertyType::Int, "", "", false, true, false},
+                {"string", PropertyType::String, "", "", false, false, true},
+            }}
+        };
+
+        SECTION("separately constructed identical schemas hash identically") {
+            Schema copy = {
+                {"object", {
+                    {"int", PropertyType::Int, "", "", false, true, false},
+                    {"string", PropertyType::String, "", "", false, false, true},
+                }}
+            };
+            REQUIRE(schema.content_hash() == copy.content_hash());
+        }
+
+        SECTION("table column indices do not affect the hash") {
+            Schema copy = schema;
+            auto hash = copy.content_hash();
+            for (auto& prop : copy.begin()->persisted_properties)
+                ++prop.table_column;
+            copy.validate();
+            REQUIRE(copy.content_hash() == hash);
+        }
+
+        SECTION("changes to property attributes change the hash") {
+            auto hash = schema.content_hash();
+            auto mutate = [&](auto&& fn) {
+                Schema copy = schema;
+                fn(copy.begin()->persisted_properties[0]);
+                copy.validate();
+                return copy.content_hash();
+            };
+            REQUIRE(mutate([](Property& p) { p.name = "int 2"; }) != hash);
+            REQUIRE(mutate([](Property& p) { p.type = PropertyType::Double; }) != hash);
+            REQUIRE(mutate([](Property& p) { p.is_indexed = false; }) != hash);
+            REQUIRE(mutate([](Property& p) { p.is_nullable = true; }) != hash);
+        }
+
+        SECTION("adding a table changes the hash") {
+            Schema bigger = {
+                {"object", {
+                    {"int", PropertyType::Int, "", "", false, true, false},
+                    {"string", PropertyType::String, "", "", false, false, true},
+                }},
+                {"object 2", {
+                    {"int", PropertyType::Int, "", "", false, false, false},
+                }}
+            };
+            REQUIRE(schema.content_hash() != bigger.content_hash());
+        }
+
+        SECTION("validate() refreshes a hash made stale by mutation") {
+            auto hash = schema.content_hash();
+            schema.begin()->persisted_properties[0].name = "renamed";
+            schema.validate();
+            REQUIRE(schema.content_hash() != hash);
+        }
+    }
+
     SECTION("compare()") {
         using namespace schema_change;
         using vec = std::vector<SchemaChange>;
@@ -474,3 +560,151 @@ TEST_CASE("Schema") {
         }
     }
 }
+
+TEST_CASE("FrozenSchema") {
+    Schema schema = {
+        {"pet", {
+            {"name", PropertyType::String},
+            {"owner", PropertyType::Object, "person", "", false, false, true},
+        }},
+        {"person", {
+            {"name", PropertyType::String, "", "", true, false, false},
+            {"age", PropertyType::Int},
+        }, {
+            {"pets", PropertyType::LinkingObjects, "pet", "owner"},
+        }},
+    };
+
+    SECTION("find()") {
+        auto frozen = schema.frozen();
+        REQUIRE(frozen->size() == 2);
+        REQUIRE(frozen->find("missing") == nullptr);
+
+        auto person = frozen->find("person");
+        REQUIRE(person);
+        REQUIRE(person->name == "person");
+        REQUIRE(person->primary_key == "name");
+        REQUIRE(person->persisted_property_count == 2);
+        REQUIRE(person->property_count == 3);
+    }
+
+    SECTION("property_for_name()") {
+        auto frozen = schema.frozen();
+        auto person = frozen->find("person");
+
+        auto name = frozen->property_for_name(*person, "name");
+        REQUIRE(name);
+        REQUIRE(name->type == PropertyType::String);
+        REQUIRE(name->is_primary);
+
+        auto pets = frozen->property_for_name(*person, "pets");
+        REQUIRE(pets);
+        REQUIRE(pets->object_type == "pet");
+        REQUIRE(pets->link_origin_property_name == "owner");
+
+        REQUIRE(frozen->property_for_name(*person, "missing") == nullptr);
+    }
+
+    SECTION("properties are in one flat array in schema order") {
+        auto frozen = schema.frozen();
+        auto person = frozen->find("person");
+        auto begin = frozen->properties_begin(*person);
+        REQUIRE(frozen->properties_end(*person) - begin == 3);
+        REQUIRE(begin[0].name == "name");
+        REQUIRE(begin[1].name == "age");
+        REQUIRE(begin[2].name == "pets");
+    }
+
+    SECTION("strings are interned in the arena") {
+        auto frozen = schema.frozen();
+        auto pet = frozen->find("pet");
+        auto person = frozen->find("person");
+        auto pet_name = frozen->property_for_name(*pet, "name");
+        auto person_name = frozen->property_for_name(*person, "name");
+        REQUIRE(pet_name->name.data() == person_name->name.data());
+        REQUIRE(frozen->property_for_name(*pet, "owner")->object_type.data() == person->name.data());
+    }
+
+    SECTION("validate() builds the snapshot eagerly and shares it") {
+        schema.validate();
+        auto frozen = schema.frozen();
+        REQUIRE(schema.frozen() == frozen);
+
+        Schema copy = schema;
+        REQUIRE(copy.frozen() == frozen);
+    }
+
+    SECTION("copy_table_columns_from() produces a fresh snapshot") {
+        auto frozen = schema.frozen();
+        REQUIRE(frozen->property_for_name(*frozen->find("person"), "age")->table_column == size_t(-1));
+
+        Schema schema2 = schema;
+        schema2.find("person")->persisted_properties[1].table_column = 1;
+        schema.copy_table_columns_from(schema2);
+
+        auto updated = schema.frozen();
+        REQUIRE(updated != frozen);
+        REQUIRE(updated->property_for_name(*updated->find("person"), "age")->table_column == 1);
+    }
+
+    SECTION("the snapshot outlives the schema") {
+        std::shared_ptr<FrozenSchema const> frozen;
+        {
+            Schema temporary = schema;
+            frozen = temporary.frozen();
+        }
+        REQUIRE(frozen->find("pet")->name == "pet");
+    }
+}
+
+TEST_CASE("static_schema") {
+    static constexpr static_schema::Property pet_properties[] = {
+        static_schema::property("name", PropertyType::String),
+        static_schema::object("owner", "person"),
+    };
+    static constexpr static_schema::Property person_properties[] = {
+        static_schema::property("name", PropertyType::String, Property::PrimaryKey::yes),
+        static_schema::property("age", PropertyType::Int),
+        static_schema::linking_objects("pets", "pet", "owner"),
+    };
+    static constexpr static_schema::ObjectType types[] = {
+        static_schema::object_type("pet", pet_properties),
+        static_schema::object_type("person", person_properties),
+    };
+    static constexpr static_schema::SchemaDefinition def = static_schema::schema(types);
+
+    SECTION("object_type() splits out computed properties and the primary key") {
+        constexpr auto person = static_schema::object_type("person", person_properties);
+        static_assert(person.persisted_property_count == 2, "linking objects properties are computed");
+        static_assert(person.property_count == 3, "all properties are counted");
+        static_assert(static_schema::str_equal(person.primary_key, "name"),
+                      "the primary key is the property marked as primary");
+    }
+
+    SECTION("realize() produces the schema the equivalent initializer lists would") {
+        Schema expected = {
+            {"pet", {
+                {"name", PropertyType::String},
+                {"owner", PropertyType::Object, "person", "", false, false, true},
+            }},
+            {"person", {
+                {"name", PropertyType::String, "", "", true, false, false},
+                {"age", PropertyType::Int},
+            }, {
+                {"pets", PropertyType::LinkingObjects, "pet", "owner"},
+            }},
+        };
+        Schema realized = static_schema::realize(def);
+        REQUIRE(realized == expected);
+        REQUIRE(realized.find("person")->primary_key == "name");
+        REQUIRE(realized.content_hash() == expected.content_hash());
+    }
+
+    SECTION("validate() on a realized schema only populates the caches") {
+        Schema realized = static_schema::realize(def);
+        REQUIRE_NOTHROW(realized.validate());
+        auto frozen = realized.frozen();
+        realized.validate();
+        REQUIRE(realized.frozen() == frozen);
+    }
+}
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+
+#include "util/index_helpers.hpp"
+#include "util/test_file.hpp"
+
+#include "object_schema.hpp"
+#include "property.hpp"
+#include "results.hpp"
+#include "schema.hpp"
+#include "sectioned_results.hpp"
+
+#include <realm/group_shared.hpp>
+#include <realm/query_expression.hpp>
+
+using namespace realm;
+
+TEST_CASE("sectioned results") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::Int}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+
+    // Sections are rows with the same value / 10, i.e. 0-9, 10-19, ...
+    auto same_section = [](RowExpr a, RowExpr b) {
+        return a.get_int(0) / 10 == b.get_int(0) / 10;
+    };
+
+    auto add_row = [&](int64_t value) {
+        size_t ndx = table->add_empty_row();
+        table->set_int(0, ndx, value);
+        return ndx;
+    };
+
+    r->begin_transaction();
+    for (int64_t value : {1, 2, 3, 11, 12, 25}) {
+        add_row(value);
+    }
+    r->commit_transaction();
+
+    Results results = Results(r, table->where()).sort(SortDescriptor(*table, {{0}}));
+    SectionedResults sectioned(results, same_section);
+
+    SECTION("sections are contiguous runs of rows") {
+        REQUIRE(sectioned.section_count() == 3);
+        REQUIRE(sectioned.section_begin(0) == 0);
+        REQUIRE(sectioned.section_begin(1) == 3);
+        REQUIRE(sectioned.section_begin(2) == 5);
+        REQUIRE(sectioned.section_size(0) == 3);
+        REQUIRE(sectioned.section_size(1) == 2);
+        REQUIRE(sectioned.section_size(2) == 1);
+        REQUIRE(sectioned.get(1, 1).get_int(0) == 12);
+        REQUIRE_THROWS_AS(sectioned.section_size(3), Results::OutOfBoundsIndexException);
+        REQUIRE_THROWS_AS(sectioned.get(2, 1), Results::OutOfBoundsIndexException);
+    }
+
+    SECTION("empty results have no sections") {
+        SectionedResults empty(Results(r, table->where().greater(0, 100)), same_section);
+        REQUIRE(empty.section_count() == 0);
+    }
+
+    SECTION("sections update to reflect changes in the underlying data") {
+        REQUIRE(sectioned.section_count() == 3);
+
+        r->begin_transaction();
+        add_row(35);
+        r->commit_transaction();
+
+        REQUIRE(sectioned.section_count() == 4);
+        REQUIRE(sectioned.section_begin(3) == 6);
+        REQUIRE(sectioned.get(3, 0).get_int(0) == 35);
+    }
+
+    SECTION("notifications") {
+        int notification_calls = 0;
+        SectionedResults::SectionedChangeSet change;
+        auto token = sectioned.add_notification_callback([&](SectionedResults::SectionedChangeSet c, std::exception_ptr err) {
+            REQUIRE_FALSE(err);
+            change = std::move(c);
+            ++notification_calls;
+        });
+        advance_and_notify(*r);
+        REQUIRE(notification_calls == 1);
+        REQUIRE(sectioned.section_count() == 3);
+
+        auto write = [&](auto&& f) {
+            r->begin_transaction();
+            f();
+            r->commit_transaction();
+            advance_and_notify(*r);
+        };
+
+        SECTION("adding a row to an existing section changes no sections") {
+            write([&] {
+                add_row(13);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.rows.insertions, 5);
+            REQUIRE(change.section_deletions.empty());
+            REQUIRE(change.section_insertions.empty());
+            REQUIRE(sectioned.section_size(1) == 3);
+        }
+
+        SECTION("adding a row with a new key inserts a section") {
+            write([&] {
+                add_row(35);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE(change.section_deletions.empty());
+            REQUIRE_INDICES(change.section_insertions, 3);
+            REQUIRE(sectioned.section_count() == 4);
+        }
+
+        SECTION("removing the only row of a section deletes the section") {
+            write([&] {
+                table->set_int(0, table->where().equal(0, 25).find(), 11);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.section_deletions, 2);
+            REQUIRE(change.section_insertions.empty());
+            REQUIRE(sectioned.section_count() == 2);
+            REQUIRE(sectioned.section_size(1) == 3);
+        }
+
+        SECTION("deleting a section's first row deletes and reinserts the section") {
+            write([&] {
+                table->move_last_over(table->where().equal(0, 11).find());
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.section_deletions, 1);
+            REQUIRE_INDICES(change.section_insertions, 1);
+            REQUIRE(sectioned.section_count() == 3);
+            REQUIRE(sectioned.section_size(1) == 1);
+        }
+
+        SECTION("deleting every row of a section renumbers later sections") {
+            write([&] {
+                table->move_last_over(table->where().equal(0, 11).find());
+                table->move_last_over(table->where().equal(0, 12).find());
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE_INDICES(change.section_deletions, 1);
+            REQUIRE(change.section_insertions.empty());
+            REQUIRE(sectioned.section_count() == 2);
+            REQUIRE(sectioned.get(1, 0).get_int(0) == 25);
+        }
+    }
+}
@@ -188,6 +188,20 @@ TEST_CASE("sync_file: SyncFileManager APIs", "[sync]") {
         SECTION("deleting a Realm for an invalid user") {
             manager.remove_realm("invalid_user", relative_path);
         }
+
+        SECTION("resolving a cached path recreates a removed user directory") {
+            const std::string user_dir = manager_path + "realm-object-server/123456789/";
+            const std::string expected = user_dir + "realms%3A%2F%2Fr.example.com%2F%7E%2Fmy%2Frealm%2Fpath";
+            REQUIRE(manager.path(identity, relative_path) == expected);
+            // Resolving again is a cache hit and returns the same path.
+            REQUIRE(manager.path(identity, relative_path) == expected);
+            manager.remove_user_directory(identity);
+            REQUIRE_DIR_DOES_NOT_EXIST(user_dir);
+            // Removing the directory drops the cached paths, so resolving
+            // again recreates the directory.
+            REQUIRE(manager.path(identity, relative_path) == expected);
+            REQUIRE_DIR_EXISTS(user_dir);
+        }
     }
 
     SECTION("Utility path APIs") {
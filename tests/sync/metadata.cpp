@@ -295,6 +295,23 @@ TEST_CASE("sync_metadata: file action metadata APIs", "[sync]") {
         third.remove();
         REQUIRE(actions.size() == 0);
     }
+
+    SECTION("properly remove a batch of actions in one go") {
+        const auto filename1 = tmp_dir() + "foobar/file4";
+        const auto filename2 = tmp_dir() + "foobar/file5";
+        const auto filename3 = tmp_dir() + "foobar/file6";
+        SyncFileActionMetadata(manager, SyncAction::HandleRealmForClientReset, filename1, "asdf", "realm://realm.example.com/1");
+        SyncFileActionMetadata(manager, SyncAction::HandleRealmForClientReset, filename2, "asdf", "realm://realm.example.com/2");
+        SyncFileActionMetadata(manager, SyncAction::HandleRealmForClientReset, filename3, "asdf", "realm://realm.example.com/3");
+        auto actions = manager.all_pending_actions();
+        REQUIRE(actions.size() == 3);
+        std::vector<SyncFileActionMetadata> batch;
+        batch.emplace_back(actions.get(0));
+        batch.emplace_back(actions.get(1));
+        batch.emplace_back(actions.get(2));
+        manager.remove_file_actions(batch);
+        REQUIRE(actions.size() == 0);
+    }
 }
 
 TEST_CASE("sync_metadata: results", "[sync]") {
@@ -350,20 +367,37 @@ TEST_CASE("sync_metadata: persistence across metadata manager instances", "[sync
         const auto identity = "testcase4a";
         const std::string sample_url = "https://realm.example.org";
         const std::string sample_token = "this_is_a_user_token";
+        {
+            SyncMetadataManager first_manager(metadata_path, false);
+            auto first = SyncUserMetadata(first_manager, identity);
+            first.set_state(sample_url, sample_token);
+            first.set_is_admin(true);
+            REQUIRE(first.identity() == identity);
+            REQUIRE(first.server_url() == sample_url);
+            REQUIRE(first.user_token() == sample_token);
+            REQUIRE(first.is_admin());
+            // Destroying the manager flushes any cached state updates to disk.
+        }
+        SyncMetadataManager second_manager(metadata_path, false);
+        auto second = SyncUserMetadata(second_manager, identity, false);
+        REQUIRE(second.identity() == identity);
+        REQUIRE(second.server_url() == sample_url);
+        REQUIRE(second.user_token() == sample_token);
+        REQUIRE(second.is_admin());
+    }
+
+    SECTION("explicitly flushing makes cached updates visible to other managers") {
+        const auto identity = "testcase4b";
+        const std::string sample_url = "https://realm.example.org";
+        const std::string sample_token = "this_is_a_user_token";
         SyncMetadataManager first_manager(metadata_path, false);
         auto first = SyncUserMetadata(first_manager, identity);
         first.set_state(sample_url, sample_token);
-        first.set_is_admin(true);
-        REQUIRE(first.identity() == identity);
-        REQUIRE(first.server_url() == sample_url);
-        REQUIRE(first.user_token() == sample_token);
-        REQUIRE(first.is_admin());
+        first_manager.flush_user_state();
         SyncMetadataManager second_manager(metadata_path, false);
         auto second = SyncUserMetadata(second_manager, identity, false);
-        REQUIRE(second.identity() == identity);
         REQUIRE(second.server_url() == sample_url);
         REQUIRE(second.user_token() == sample_token);
-        REQUIRE(second.is_admin());
     }
 }
 
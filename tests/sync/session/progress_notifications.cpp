@@ -144,6 +144,57 @@ TEST_CASE("progress notifications stale data flag", "[sync]") {
     }
 }
 
+TEST_CASE("progress notification coalescing", "[sync]") {
+    if (!EventLoop::has_implementation())
+        return;
+
+    auto cleanup = util::make_scope_exit([=]() noexcept { SyncManager::shared().reset_for_testing(); });
+    SyncServer server;
+    // Disable file-related functionality and metadata functionality for testing purposes.
+    SyncManager::shared().configure_file_system(tmp_dir(), SyncManager::MetadataMode::NoMetadata);
+    std::atomic<bool> bind_handler_called(false);
+    auto user = SyncManager::shared().get_user("user-test-sync-coalescing", "not_a_real_token");
+    // Keep the session stuck in 'waiting for upload' so that the sync client
+    // doesn't deliver progress updates of its own while the test runs.
+    auto session = sync_session_with_bind_handler(server, user, "/test-sync-progress-coalescing",
+                                                  [&](auto&, auto&, std::shared_ptr<SyncSession>) {
+                                                      bind_handler_called = true;
+                                                  },
+                                                  [](auto, auto) { },
+                                                  SyncSessionStopPolicy::Immediately);
+    EventLoop::main().run_until([&] { return bind_handler_called == true && SyncSession::OnlyForTesting::has_stale_progress(*session); });
+
+    std::atomic<int> call_count(0);
+    std::atomic<uint64_t> transferred(0);
+    std::atomic<uint64_t> transferrable(0);
+
+    session->register_progress_notifier([&](auto xferred, auto xferable) {
+        transferred = xferred;
+        transferrable = xferable;
+        ++call_count;
+    }, SyncSession::NotifierType::download, true);
+    // Wait for the initial callback.
+    EventLoop::main().run_until([&] { return call_count.load() > 0; });
+
+    // Make the interval long enough that the rest of the test happens within
+    // a single one.
+    session->set_progress_notification_interval(std::chrono::hours(1));
+    int base_count = call_count.load();
+
+    // Updates with bytes still outstanding arriving within the interval are
+    // coalesced away.
+    SyncSession::OnlyForTesting::handle_progress_update(*session, 20, 200, 0, 0, false);
+    SyncSession::OnlyForTesting::handle_progress_update(*session, 30, 200, 0, 0, false);
+    CHECK(call_count.load() == base_count);
+
+    // An update which leaves no bytes outstanding is delivered immediately,
+    // carrying the latest values.
+    SyncSession::OnlyForTesting::handle_progress_update(*session, 200, 200, 0, 0, false);
+    CHECK(call_count.load() == base_count + 1);
+    CHECK(transferred.load() == 200);
+    CHECK(transferrable.load() == 200);
+}
+
 // FIXME: break this up into smaller discrete test cases
 TEST_CASE("progress notification", "[sync]") {
     if (!EventLoop::has_implementation())
@@ -318,6 +318,40 @@ TEST_CASE("SyncSession: close() API", "[sync]") {
     }
 }
 
+TEST_CASE("SyncManager: revive_all_sessions()", "[sync]") {
+    if (!EventLoop::has_implementation())
+        return;
+
+    auto cleanup = util::make_scope_exit([=]() noexcept { SyncManager::shared().reset_for_testing(); });
+    SyncServer server;
+    SyncManager::shared().configure_file_system(tmp_dir(), SyncManager::MetadataMode::NoMetadata);
+
+    auto user = SyncManager::shared().get_user("user-revive-all", "not_a_real_token");
+    auto session1 = sync_session(server, user, "/test-revive-all-1",
+                                 [](auto&, auto&) { return s_test_token; },
+                                 [](auto, auto) { },
+                                 SyncSessionStopPolicy::Immediately);
+    auto session2 = sync_session(server, user, "/test-revive-all-2",
+                                 [](auto&, auto&) { return s_test_token; },
+                                 [](auto, auto) { },
+                                 SyncSessionStopPolicy::Immediately);
+    EventLoop::main().run_until([&] { return sessions_are_active(*session1, *session2); });
+
+    // Close both sessions. They remain registered with the manager because
+    // we still hold external references to them.
+    session1->close();
+    session2->close();
+    EventLoop::main().run_until([&] { return sessions_are_inactive(*session1, *session2); });
+
+    // Reviving everything at once should bring both sessions back up.
+    SyncManager::shared().revive_all_sessions();
+    EventLoop::main().run_until([&] { return sessions_are_active(*session1, *session2); });
+
+    // Calling it again with every session already active is a no-op.
+    SyncManager::shared().revive_all_sessions();
+    REQUIRE(sessions_are_active(*session1, *session2));
+}
+
 TEST_CASE("sync: error handling", "[sync]") {
     using ProtocolError = realm::sync::ProtocolError;
     auto cleanup = util::make_scope_exit([=]() noexcept { SyncManager::shared().reset_for_testing(); });
@@ -84,6 +84,9 @@ std::shared_ptr<SyncSession> sync_session_with_bind_handler(SyncServer& server,
         auto realm = Realm::get_shared_realm(config);
         session = SyncManager::shared().get_session(config.path, *config.sync_config);
     }
+    // The progress tests drive the progress handler directly and expect each
+    // update to be delivered, so disable time-based coalescing.
+    session->set_progress_notification_interval(std::chrono::milliseconds(0));
     return session;
 }
 
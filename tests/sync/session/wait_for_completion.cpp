@@ -246,3 +246,40 @@ TEST_CASE("SyncSession: wait_for_upload_completion() API", "[sync]") {
         REQUIRE(!session->wait_for_upload_completion([](auto) { }));
     }
 }
+
+TEST_CASE("SyncManager: wait_for_all_uploads() API", "[sync]") {
+    if (!EventLoop::has_implementation())
+        return;
+
+    auto cleanup = util::make_scope_exit([=]() noexcept { SyncManager::shared().reset_for_testing(); });
+    SyncServer server;
+    // Disable file-related functionality and metadata functionality for testing purposes.
+    SyncManager::shared().configure_file_system(tmp_dir(), SyncManager::MetadataMode::NoMetadata);
+
+    std::atomic<bool> handler_called(false);
+
+    SECTION("calls the callback once all the sessions have uploaded") {
+        auto user = SyncManager::shared().get_user("user-wait-all-uploads-1", "not_a_real_token");
+        auto session1 = sync_session(server, user, "/wait-all-uploads-1a",
+                                     [](const std::string&, const std::string&) { return s_test_token; },
+                                     [](auto, auto) { });
+        auto session2 = sync_session(server, user, "/wait-all-uploads-1b",
+                                     [](const std::string&, const std::string&) { return s_test_token; },
+                                     [](auto, auto) { });
+        EventLoop::main().run_until([&] { return sessions_are_active(*session1, *session2); });
+        // A single handler observes the completion of both sessions.
+        SyncManager::shared().wait_for_all_uploads([&](std::error_code error) {
+            REQUIRE(!error);
+            handler_called = true;
+        });
+        EventLoop::main().run_until([&] { return handler_called == true; });
+    }
+
+    SECTION("calls the callback immediately when there are no sessions") {
+        SyncManager::shared().wait_for_all_uploads([&](std::error_code error) {
+            REQUIRE(!error);
+            handler_called = true;
+        });
+        REQUIRE(handler_called == true);
+    }
+}
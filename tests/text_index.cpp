@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "catch.hpp"
+
+#include "util/test_file.hpp"
+
+#include "collection_notifications.hpp"
+#include "property.hpp"
+#include "schema.hpp"
+#include "text_index.hpp"
+
+#include <realm/group_shared.hpp>
+
+using namespace realm;
+
+TEST_CASE("TextTokenIndex::tokenize()") {
+    SECTION("splits on non-alphanumeric characters") {
+        REQUIRE(TextTokenIndex::tokenize("one two,three--four") ==
+                std::vector<std::string>({"one", "two", "three", "four"}));
+    }
+
+    SECTION("lowercases tokens") {
+        REQUIRE(TextTokenIndex::tokenize("One TWO") == std::vector<std::string>({"one", "two"}));
+    }
+
+    SECTION("empty and all-separator strings produce no tokens") {
+        REQUIRE(TextTokenIndex::tokenize("").empty());
+        REQUIRE(TextTokenIndex::tokenize(" ,.- ").empty());
+    }
+
+    SECTION("non-ASCII bytes are token characters") {
+        REQUIRE(TextTokenIndex::tokenize("grün blau") == std::vector<std::string>({"grün", "blau"}));
+    }
+}
+
+TEST_CASE("TextTokenIndex") {
+    InMemoryTestFile config;
+    config.cache = false;
+    config.automatic_change_notifications = false;
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object", {
+            {"value", PropertyType::String}
+        }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    r->begin_transaction();
+    table->add_empty_row(3);
+    table->set_string(0, 0, "the quick brown fox");
+    table->set_string(0, 1, "the lazy dog");
+    table->set_string(0, 2, "quick dog");
+    r->commit_transaction();
+
+    TextTokenIndex index(*table, 0);
+
+    SECTION("matches rows containing a single token") {
+        REQUIRE(index.rows_matching("quick") == std::vector<size_t>({0, 2}));
+        REQUIRE(index.rows_matching("dog") == std::vector<size_t>({1, 2}));
+    }
+
+    SECTION("multiple tokens require every token to match") {
+        REQUIRE(index.rows_matching("quick dog") == std::vector<size_t>({2}));
+        REQUIRE(index.rows_matching("the quick") == std::vector<size_t>({0}));
+    }
+
+    SECTION("matching is case-insensitive and order-independent") {
+        REQUIRE(index.rows_matching("DOG, quick!") == std::vector<size_t>({2}));
+    }
+
+    SECTION("unknown tokens match nothing") {
+        REQUIRE(index.rows_matching("cat").empty());
+        REQUIRE(index.rows_matching("quick cat").empty());
+    }
+
+    SECTION("update() indexes inserted rows") {
+        r->begin_transaction();
+        table->add_empty_row();
+        table->set_string(0, 3, "another quick fox");
+        r->commit_transaction();
+
+        CollectionChangeSet changes;
+        changes.insertions.add(3);
+        index.update(*table, changes);
+
+        REQUIRE(index.rows_matching("quick") == std::vector<size_t>({0, 2, 3}));
+    }
+
+    SECTION("update() reindexes modified rows") {
+        r->begin_transaction();
+        table->set_string(0, 1, "the energetic dog");
+        r->commit_transaction();
+
+        CollectionChangeSet changes;
+        changes.modifications.add(1);
+        changes.modifications_new.add(1);
+        index.update(*table, changes);
+
+        REQUIRE(index.rows_matching("lazy").empty());
+        REQUIRE(index.rows_matching("energetic") == std::vector<size_t>({1}));
+    }
+
+    SECTION("update() tracks rows moved by move_last_over deletion") {
+        r->begin_transaction();
+        table->move_last_over(0);
+        r->commit_transaction();
+
+        // move_last_over() reports the moved row in both deletions and
+        // insertions, as notification callbacks observe it
+        CollectionChangeSet changes;
+        changes.deletions.add(0);
+        changes.deletions.add(2);
+        changes.insertions.add(0);
+        index.update(*table, changes);
+
+        REQUIRE(index.rows_matching("fox").empty());
+        REQUIRE(index.rows_matching("quick") == std::vector<size_t>({0}));
+        REQUIRE(index.rows_matching("lazy") == std::vector<size_t>({1}));
+    }
+}
@@ -526,4 +526,73 @@ TEST_CASE("thread safe reference") {
         r->resolve_thread_safe_reference(std::move(ref));
         REQUIRE_THROWS(r->resolve_thread_safe_reference(std::move(ref)));
     }
+
+    SECTION("bundle") {
+        r->begin_transaction();
+        Object str = create_object(r, string_object);
+        str.row().set_string(0, "hello");
+        Object num = create_object(r, int_object);
+        num.row().set_int(0, 7);
+        Object zero = create_object(r, int_object);
+        zero.row().set_int(0, 0);
+        Object array = create_object(r, int_array_object);
+        List list = get_list(array, 0);
+        list.add(num.row().get_index());
+        r->commit_transaction();
+        Results results(r, get_table(*r, int_object)->where().greater(0, 0));
+
+        SECTION("resolving delivers all of the bundled values") {
+            auto bundle = r->obtain_thread_safe_reference_bundle();
+            bundle.add(str);
+            bundle.add(num);
+            bundle.add(list);
+            bundle.add(results);
+            std::thread([bundle = std::move(bundle), config]() mutable {
+                SharedRealm r = Realm::get_shared_realm(config);
+                auto resolved = r->resolve_thread_safe_reference(std::move(bundle));
+                REQUIRE(resolved.objects.size() == 2);
+                REQUIRE(resolved.objects[0].row().get_string(0) == "hello");
+                REQUIRE(resolved.objects[1].row().get_int(0) == 7);
+                REQUIRE(resolved.lists.size() == 1);
+                REQUIRE(resolved.lists[0].size() == 1);
+                REQUIRE(resolved.lists[0].get(0).get_int(0) == 7);
+                REQUIRE(resolved.results.size() == 1);
+                REQUIRE(resolved.results[0].size() == 1);
+            }).join();
+        }
+
+        SECTION("resolving on a Realm ahead of the bundle advances the whole bundle") {
+            auto bundle = r->obtain_thread_safe_reference_bundle();
+            bundle.add(num);
+            bundle.add(results);
+            std::thread([bundle = std::move(bundle), config]() mutable {
+                SharedRealm r = Realm::get_shared_realm(config);
+                r->begin_transaction();
+                auto table = ObjectStore::table_for_object_type(r->read_group(), "int_object");
+                table->set_int(0, table->add_empty_row(), 9);
+                r->commit_transaction();
+
+                auto resolved = r->resolve_thread_safe_reference(std::move(bundle));
+                REQUIRE(resolved.objects[0].row().get_int(0) == 7);
+                REQUIRE(resolved.results[0].size() == 2);
+            }).join();
+        }
+
+        SECTION("rejects values from a different Realm") {
+            auto r2 = Realm::get_shared_realm(config);
+            r2->begin_transaction();
+            Object num2 = create_object(r2, int_object);
+            r2->cancel_transaction();
+
+            auto bundle = r->obtain_thread_safe_reference_bundle();
+            REQUIRE_THROWS(bundle.add(num2));
+        }
+
+        SECTION("disallow multiple resolves") {
+            auto bundle = r->obtain_thread_safe_reference_bundle();
+            bundle.add(num);
+            r->resolve_thread_safe_reference(std::move(bundle));
+            REQUIRE_THROWS(r->resolve_thread_safe_reference(std::move(bundle)));
+        }
+    }
 }
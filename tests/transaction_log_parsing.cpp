@@ -430,6 +430,20 @@ TEST_CASE("Transaction log parsing: changeset calcuation") {
             REQUIRE(info.tables.empty());
         }
 
+        SECTION("changes interleaved with untracked tables are reported correctly") {
+            auto info = track_changes({false, false, true}, [&] {
+                auto untracked = r->read_group().add_table("untracked");
+                untracked->add_column(type_Int, "value");
+                untracked->add_empty_row(2);
+                table.set_int(1, 1, 5);
+                untracked->set_int(0, 0, 1);
+                table.add_empty_row();
+            });
+            REQUIRE(info.tables.size() == 3);
+            REQUIRE_INDICES(info.tables[2].modifications, 1);
+            REQUIRE_INDICES(info.tables[2].insertions, 10);
+        }
+
         SECTION("new row additions are reported") {
             auto info = track_changes({false, false, true}, [&] {
                 table.add_empty_row();
@@ -1913,6 +1927,127 @@ TEST_CASE("Transaction log parsing: changeset calcuation") {
     }
 }
 
+TEST_CASE("Transaction log parsing: registered row observation") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.cache = false;
+
+    auto realm = Realm::get_shared_realm(config);
+    realm->update_schema({
+        {"table", {
+            {"value 1", PropertyType::Int},
+            {"value 2", PropertyType::Int},
+        }},
+    });
+
+    auto table = realm->read_group().get_table("class_table");
+    realm->begin_transaction();
+    table->add_empty_row(10);
+    realm->commit_transaction();
+
+    // Unlike the Contexts above, this does not override get_observed_rows();
+    // the observed rows are registered on the context incrementally
+    class Context : public BindingContext {
+    public:
+        std::vector<ObserverState> observed;
+        std::vector<void*> invalidated;
+
+        bool modified(void* info, size_t col) const noexcept
+        {
+            auto it = std::find_if(begin(observed), end(observed),
+                                   [=](auto&& observer) { return observer.info == info; });
+            if (it == observed.end() || col >= it->changes.size())
+                return false;
+            return it->changes[col].kind != ColumnInfo::Kind::None;
+        }
+
+    private:
+        void did_change(std::vector<ObserverState> const& observers,
+                        std::vector<void*> const& invalid, bool) override
+        {
+            observed = observers;
+            invalidated = invalid;
+        }
+    };
+
+    auto history = make_in_realm_history(config.path);
+    auto sg = std::make_unique<SharedGroup>(*history, config.options());
+    sg->begin_read();
+
+    Context context;
+    context.realm = realm;
+
+    auto write_and_advance = [&](auto&& fn) {
+        realm->begin_transaction();
+        fn();
+        realm->commit_transaction();
+        _impl::NotifierPackage notifiers;
+        _impl::transaction::advance(sg, &context, notifiers);
+    };
+
+    SECTION("changes to a registered row are delivered") {
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)1);
+        write_and_advance([&] {
+            table->set_int(0, 2, 1);
+        });
+        REQUIRE(context.modified((void*)1, 0));
+        REQUIRE_FALSE(context.modified((void*)1, 1));
+    }
+
+    SECTION("changes to unregistered rows are not delivered") {
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)1);
+        write_and_advance([&] {
+            table->set_int(0, 3, 1);
+        });
+        REQUIRE_FALSE(context.modified((void*)1, 0));
+    }
+
+    SECTION("registered rows track insertions above them across advances") {
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)1);
+        write_and_advance([&] {
+            table->insert_empty_row(0, 3);
+        });
+        // The registered row is now at index 5, and changes to it should
+        // still be delivered without the registration being renewed
+        write_and_advance([&] {
+            table->set_int(0, 5, 1);
+        });
+        REQUIRE(context.modified((void*)1, 0));
+    }
+
+    SECTION("deleting a registered row invalidates it and ends observation") {
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)1);
+        write_and_advance([&] {
+            table->move_last_over(2);
+        });
+        REQUIRE(context.invalidated == std::vector<void*>{(void*)1});
+
+        write_and_advance([&] {
+            table->set_int(0, 2, 1);
+        });
+        REQUIRE_FALSE(context.modified((void*)1, 0));
+    }
+
+    SECTION("remove_observed_row() ends observation") {
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)1);
+        context.remove_observed_row(table->get_index_in_group(), 2, (void*)1);
+        write_and_advance([&] {
+            table->set_int(0, 2, 1);
+        });
+        REQUIRE_FALSE(context.modified((void*)1, 0));
+    }
+
+    SECTION("multiple observers registered on one row are each reported") {
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)1);
+        context.add_observed_row(table->get_index_in_group(), 2, (void*)2);
+        write_and_advance([&] {
+            table->set_int(1, 2, 1);
+        });
+        REQUIRE(context.modified((void*)1, 1));
+        REQUIRE(context.modified((void*)2, 1));
+    }
+}
+
 TEST_CASE("DeepChangeChecker") {
     InMemoryTestFile config;
     config.automatic_change_notifications = false;
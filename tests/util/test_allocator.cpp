@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "util/test_allocator.hpp"
+
+#include "catch.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local size_t g_allocation_count = 0;
+} // anonymous namespace
+
+// Instrumented global allocator for the test binary. Only the call count is
+// recorded; the allocations themselves go straight to malloc.
+
+void* operator new(size_t size)
+{
+    ++g_allocation_count;
+    while (true) {
+        if (void* ptr = malloc(size))
+            return ptr;
+        if (auto handler = std::get_new_handler())
+            handler();
+        else
+            throw std::bad_alloc();
+    }
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace realm {
+namespace test_util {
+
+size_t heap_allocation_count() noexcept
+{
+    return g_allocation_count;
+}
+
+void AllocationChecker::complete()
+{
+    auto allocations = heap_allocation_count() - m_start;
+    if (allocations > m_budget) {
+        FAIL("Allocation budget at " << m_file << ":" << m_line << " exceeded: "
+             << allocations << " allocations, budget " << m_budget);
+    }
+}
+
+} // namespace test_util
+} // namespace realm
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2017 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_TEST_UTIL_TEST_ALLOCATOR_HPP
+#define REALM_TEST_UTIL_TEST_ALLOCATOR_HPP
+
+#include <cstddef>
+
+namespace realm {
+namespace test_util {
+
+// Total number of heap allocations (operator new calls) made by the calling
+// thread. Allocations made by other threads, such as the notifier worker, are
+// counted on those threads and do not affect this thread's count.
+size_t heap_allocation_count() noexcept;
+
+// Implementation detail of REQUIRE_ALLOCATIONS_UNDER. Counts the allocations
+// made between construction and complete(), and fails the enclosing Catch
+// test if the budget was exceeded.
+class AllocationChecker {
+public:
+    AllocationChecker(size_t budget, const char* file, int line) noexcept
+    : m_budget(budget)
+    , m_file(file)
+    , m_line(line)
+    , m_start(heap_allocation_count())
+    {
+    }
+
+    bool loop()
+    {
+        if (!m_done) {
+            m_done = true;
+            return true;
+        }
+        complete();
+        return false;
+    }
+
+private:
+    void complete();
+
+    size_t m_budget;
+    const char* m_file;
+    int m_line;
+    size_t m_start;
+    bool m_done = false;
+};
+
+} // namespace test_util
+} // namespace realm
+
+// Fail the test if the statement block performs more than `budget` heap
+// allocations on the current thread:
+//
+//     REQUIRE_ALLOCATIONS_UNDER(0) {
+//         results.get(i);
+//     }
+//
+// Used to put allocation budgets on hot paths so that accidentally
+// introduced boxing or copies fail CI rather than shipping.
+#define REQUIRE_ALLOCATIONS_UNDER(budget) \
+    for (realm::test_util::AllocationChecker allocation_checker_(budget, __FILE__, __LINE__); allocation_checker_.loop();)
+
+#endif // REALM_TEST_UTIL_TEST_ALLOCATOR_HPP
@@ -80,6 +80,7 @@ TestFile::TestFile()
 TestFile::~TestFile()
 {
     unlink(path.c_str());
+    unlink((path + ".schema_cache").c_str());
 }
 
 InMemoryTestFile::InMemoryTestFile()
@@ -22,6 +22,8 @@
 
 #include <algorithm>
 #include <cctype>
+#include <set>
+#include <vector>
 
 using namespace realm;
 
@@ -48,3 +50,20 @@ TEST_CASE("uuid") {
     CHECK(uuid[23] == '-');
     CHECK(std::all_of(&uuid[24], &uuid[36], isxdigit));
 }
+
+TEST_CASE("uuid batch") {
+    std::vector<std::string> uuids(100);
+    util::uuid_strings(uuids.data(), uuids.size());
+
+    std::set<std::string> distinct;
+    for (auto& uuid : uuids) {
+        INFO("uuid: " << uuid);
+        CHECK(uuid.size() == 36);
+        // Version 4.
+        CHECK(uuid[14] == '4');
+        // Variant 1 (IETF).
+        CHECK((uuid[19] == '8' || uuid[19] == '9' || uuid[19] == 'a' || uuid[19] == 'b'));
+        distinct.insert(uuid);
+    }
+    CHECK(distinct.size() == uuids.size());
+}